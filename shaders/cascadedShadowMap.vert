@@ -0,0 +1,20 @@
+#version 450
+
+// Depth of a mesh seen from one shadow cascade(Features/CascadedShadowMap.h).
+
+layout(std140, set = 0, binding = 0) uniform MeshUniformBufferObject
+{
+   mat4 model;
+} mesh;
+
+layout(std140, set = 1, binding = 0) uniform CascadeUniformBufferObject
+{
+   mat4 lightSpace;
+} cascade;
+
+layout(location = 0) in vec3 inPosition;
+
+void main()
+{
+   gl_Position = (cascade.lightSpace * mesh.model * vec4(inPosition, 1.0));
+}
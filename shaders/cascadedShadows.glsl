@@ -0,0 +1,69 @@
+// Cascaded shadow map of the directional light(Features/CascadedShadowMap.h),
+// included by the shaders shading with it. Expects the PCF_RANGE constant.
+// Must stay in sync with ShadowCascades.
+
+// Config::SHADOW_CASCADE_COUNT
+#define SHADOW_CASCADE_COUNT 4
+
+layout(binding = 10) uniform sampler2DArray shadowMapSampler;
+
+layout(std140, binding = 11) uniform ShadowCascades
+{
+    mat4 view;                                  // camera
+    mat4 lightSpace[SHADOW_CASCADE_COUNT];
+    vec4 splitDepths;                           // view space far depth of each cascade
+} shadowCascades;
+
+
+// 1.0 if the texel is closer to the light than the fragment.
+float calculateShadow(vec3 shadowCoords, vec2 off, int cascade)
+{
+    float closestDepth = texture(shadowMapSampler, vec3(shadowCoords.xy + off, float(cascade))).r;
+    return (closestDepth > shadowCoords.z) ? 0.0 : 1.0;
+}
+
+float filterPCF(vec3 shadowCoords, int cascade)
+{
+    vec2 texelSize = textureSize(shadowMapSampler, 0).xy;
+    float scale = 1.5;
+    float dx = scale * 1.0 / float(texelSize.x);
+    float dy = scale * 1.0 / float(texelSize.y);
+
+    float shadow = 0.0;
+    int count = 0;
+    int range = PCF_RANGE;
+
+    for (int x = -range; x <= range; x++)
+    {
+        for (int y = -range; y <= range; y++)
+        {
+            shadow += calculateShadow(shadowCoords, vec2(dx * x, dy * y), cascade);
+            count++;
+        }
+    }
+    return shadow / count;
+}
+
+// Cascades are picked by view depth, the first one reaching the fragment.
+// Returns how much of the directional light reaches worldPos.
+float getDirectionalShadow(vec3 worldPos)
+{
+    float viewDepth = -(shadowCascades.view * vec4(worldPos, 1.0)).z;
+
+    int cascade = 0;
+    while (cascade < SHADOW_CASCADE_COUNT && viewDepth > shadowCascades.splitDepths[cascade])
+        cascade++;
+
+    // Past the shadow distance.
+    if (cascade == SHADOW_CASCADE_COUNT)
+        return 1.0;
+
+    vec4 shadowCoords = shadowCascades.lightSpace[cascade] * vec4(worldPos, 1.0);
+    shadowCoords.xyz /= shadowCoords.w;
+    shadowCoords.xy = shadowCoords.xy * 0.5 + 0.5;
+
+    if (shadowCoords.z <= 0.0 || shadowCoords.z >= 1.0)
+        return 1.0;
+
+    return 1.0 - filterPCF(shadowCoords.xyz, cascade);
+}
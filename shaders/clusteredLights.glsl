@@ -0,0 +1,69 @@
+// Clustered lighting(Culling/ClusteredLights.h), included by the shaders
+// shading with it(set 1) and by clusterLights.comp(set 0).
+// Must stay in sync with ClusterParams and ClusteredLights::binReference.
+
+#ifndef CLUSTER_SET
+#define CLUSTER_SET 1
+#endif
+
+// Only clusterLights.comp writes the per cluster lists.
+#ifndef CLUSTER_LISTS_ACCESS
+#define CLUSTER_LISTS_ACCESS readonly
+#endif
+
+struct Light
+{
+    vec4    pos;
+    vec4    dir;
+    vec4    color;
+    float   attenuation;
+    float   radius;
+    float   intensity;
+    int     type;
+};
+
+layout(std140, set = CLUSTER_SET, binding = 0) uniform ClusterParams
+{
+    mat4  view;
+    mat4  invProj;
+    uvec4 gridSize;                 // w = max lights per cluster
+    vec4  attenuation;              // constant, linear, quadratic
+    vec2  screenSize;
+    float zNear;
+    float zFar;
+    uint  lightsCount;
+    uint  directionalLightsCount;   // directional lights come first
+} clusterParams;
+
+layout(std430, set = CLUSTER_SET, binding = 1) readonly buffer Lights
+{
+    Light lights[];
+};
+
+layout(std430, set = CLUSTER_SET, binding = 2) CLUSTER_LISTS_ACCESS buffer ClusterLightCounts
+{
+    uint clusterLightCounts[];
+};
+
+// gridSize.w slots per cluster.
+layout(std430, set = CLUSTER_SET, binding = 3) CLUSTER_LISTS_ACCESS buffer ClusterLightIndices
+{
+    uint clusterLightIndices[];
+};
+
+// Depth slices are exponential: every slice covers the same depth ratio.
+uint getClusterIndex(vec2 fragCoord, vec3 worldPos)
+{
+    uvec3 gridSize = clusterParams.gridSize.xyz;
+
+    // View space looks down -z.
+    float viewDepth = -(clusterParams.view * vec4(worldPos, 1.0)).z;
+    float slice = log(viewDepth / clusterParams.zNear) * float(gridSize.z) / log(clusterParams.zFar / clusterParams.zNear);
+
+    uvec3 cluster;
+    cluster.xy = uvec2(fragCoord / clusterParams.screenSize * vec2(gridSize.xy));
+    cluster.z = uint(max(slice, 0.0));
+    cluster = min(cluster, gridSize - 1);
+
+    return cluster.x + cluster.y * gridSize.x + cluster.z * gridSize.x * gridSize.y;
+}
@@ -17,26 +17,38 @@ layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inNormal;
 
-layout(location = 0) out vec4 outColor;
-layout(location = 1) out vec4 outPosition;
-layout(location = 2) out vec4 outNormal;
-layout(location = 3) out vec4 outAlbedo;
-layout(location = 4) out vec4 outMetallicRoughness;
-layout(location = 5) out vec4 outEmissiveColor;
-layout(location = 6) out vec4 outAO;
+// Compact G-Buffer(DeferredRenderPass), the position is rebuilt from the depth.
+layout(location = 0) out vec4 outAlbedo;
+layout(location = 1) out vec2 outNormal;
+// Metallic, roughness, AO
+layout(location = 2) out vec4 outMaterial;
+layout(location = 3) out vec4 outEmissiveColor;
 
 vec3 calculateNormal();
+vec2 encodeNormal(vec3 normal);
 
 void main()
 {
-   outColor = vec4(1.0f);
-   outPosition = vec4(inPosition, 1.0f);
-   outNormal = vec4(calculateNormal(), 1.0f);
    outAlbedo = texture(baseColorSampler, inTexCoord);
-   outMetallicRoughness = texture(metallicRoughnessSampler, inTexCoord);
+   outNormal = encodeNormal(calculateNormal());
+
+   vec2 metallicRoughness = texture(metallicRoughnessSampler, inTexCoord).bg;
+   outMaterial = vec4(metallicRoughness, texture(AOsampler, inTexCoord).r, 1.0f);
+
    outEmissiveColor = texture(emissiveColorSampler, inTexCoord);
-   outAO = texture(AOsampler, inTexCoord);
+}
+
+// Octahedral encoding: the unit sphere is folded onto [-1, 1]^2(RG16 SNORM).
+vec2 encodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
 
+    if (normal.z < 0.0)
+    {
+        vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+        normal.xy = (1.0 - abs(normal.yx)) * signs;
+    }
+    return normal.xy;
 }
 
 vec3 calculateNormal()
@@ -0,0 +1,94 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless variant of deferred_off.frag: material textures are fetched from the
+// scene wide arrays(set 1) with the indices of the object's material.
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 model;
+   mat4 view;
+   mat4 proj;
+} ubo;
+
+// Per object material, indexed with the object index(GPUCulling order).
+struct MaterialData
+{
+    uint textures[5];
+    uint samplers[5];
+};
+
+layout(std430, binding = 2) readonly buffer MaterialBuffer
+{
+    MaterialData materials[];
+};
+
+// Every material texture/sampler of the scene(BindlessMaterials).
+layout(set = 1, binding = 0) uniform texture2D  bindlessTextures[];
+layout(set = 1, binding = 1) uniform sampler    bindlessSamplers[];
+
+// Indices can differ inside a subgroup(several draws may share one).
+#define materialSampler(slot) sampler2D(bindlessTextures[nonuniformEXT(materials[inObjectIndex].textures[slot])], bindlessSamplers[nonuniformEXT(materials[inObjectIndex].samplers[slot])])
+
+#define baseColorSampler            materialSampler(0)
+#define metallicRoughnessSampler    materialSampler(1)
+#define emissiveColorSampler        materialSampler(2)
+#define AOsampler                   materialSampler(3)
+#define normalSampler               materialSampler(4)
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) flat in uint inObjectIndex;
+
+// Compact G-Buffer(DeferredRenderPass), the position is rebuilt from the depth.
+layout(location = 0) out vec4 outAlbedo;
+layout(location = 1) out vec2 outNormal;
+// Metallic, roughness, AO
+layout(location = 2) out vec4 outMaterial;
+layout(location = 3) out vec4 outEmissiveColor;
+
+vec3 calculateNormal();
+vec2 encodeNormal(vec3 normal);
+
+void main()
+{
+   outAlbedo = texture(baseColorSampler, inTexCoord);
+   outNormal = encodeNormal(calculateNormal());
+
+   vec2 metallicRoughness = texture(metallicRoughnessSampler, inTexCoord).bg;
+   outMaterial = vec4(metallicRoughness, texture(AOsampler, inTexCoord).r, 1.0f);
+
+   outEmissiveColor = texture(emissiveColorSampler, inTexCoord);
+}
+
+// Octahedral encoding: the unit sphere is folded onto [-1, 1]^2(RG16 SNORM).
+vec2 encodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+
+    if (normal.z < 0.0)
+    {
+        vec2 signs = vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+        normal.xy = (1.0 - abs(normal.yx)) * signs;
+    }
+    return normal.xy;
+}
+
+vec3 calculateNormal()
+{
+    vec3 tangentNormal = texture(normalSampler,inTexCoord).xyz ;
+
+	vec3 q1 = dFdx(inPosition);
+	vec3 q2 = dFdy(inPosition);
+	vec2 st1 = dFdx(inTexCoord);
+	vec2 st2 = dFdy(inTexCoord);
+
+    vec3 N = normalize(inNormal);
+	vec3 T = normalize(q1 * st2.t - q2 * st1.t);
+	vec3 B = -normalize(cross(N, T));
+	mat3 TBN = mat3(T, B, N);
+
+    return normalize(TBN * tangentNormal);
+}
\ No newline at end of file
@@ -1,42 +1,36 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Specialization constants(Pipeline/ShaderVariants.h).
+layout(constant_id = 2) const int PCF_RANGE = 1;
 
 layout(std140, binding = 0) uniform NormalInfos
 {
-	mat4 lightSpace;
+    mat4 invViewProj;
     vec4 cameraPos;
-    int  lightsCount;
 } uboInfo;
 
-struct Light
-{
-    vec4    pos;
-    vec4    dir;
-    vec4    color;
-    float   attenuation;
-    float   radius;
-    float   intensity;
-    int     type;
-};
+// Lights: set 1
+#include "clusteredLights.glsl"
 
-layout(std140, binding = 1) uniform Lights
-{
-    Light lights[10];
-};
-
-layout (input_attachment_index = 0, binding = 2) uniform subpassInput samplerposition;
+// Compact G-Buffer(deferred_off.frag)
+layout (input_attachment_index = 0, binding = 2) uniform subpassInput samplerAlbedo;
 layout (input_attachment_index = 1, binding = 3) uniform subpassInput samplerNormal;
-layout (input_attachment_index = 2, binding = 4) uniform subpassInput samplerAlbedo;
-layout (input_attachment_index = 3, binding = 5) uniform subpassInput samplerMetallicRoughness;
-layout (input_attachment_index = 4, binding = 6) uniform subpassInput samplerEmissiveColor;
-layout (input_attachment_index = 5, binding = 7) uniform subpassInput samplerAO;
+layout (input_attachment_index = 2, binding = 4) uniform subpassInput samplerMaterial;
+layout (input_attachment_index = 3, binding = 5) uniform subpassInput samplerEmissiveColor;
+layout (input_attachment_index = 4, binding = 6) uniform subpassInput samplerDepth;
 
 
 // IBL Samplers
-layout(binding = 8) uniform samplerCube irradianceMapSampler;
-layout(binding = 9) uniform sampler2D BRDFlutSampler;
-layout(binding = 10) uniform samplerCube prefilteredEnvMapSampler;
+layout(binding = 7) uniform samplerCube irradianceMapSampler;
+layout(binding = 8) uniform sampler2D BRDFlutSampler;
+layout(binding = 9) uniform samplerCube prefilteredEnvMapSampler;
+
+// Directional light shadows: bindings 10 and 11
+#include "cascadedShadows.glsl"
 
-layout(binding = 11) uniform sampler2D shadowMapSampler;
+// Point and spot light shadows: bindings 12 and 13
+#include "shadowAtlas.glsl"
 
 layout (location = 0) in vec2 inUV;
 
@@ -97,7 +91,8 @@ vec3 fresnelSchlick(PBRinfo pbrInfo);
 
 ///////////////////////////////////////////////////////////////////////////////
 
-vec3 calculateNormal();
+vec3 decodeNormal(vec2 encoded);
+vec3 reconstructPosition(float depth);
 vec3 calculateDirLight(int i,vec3 fragPos,vec3 normal,vec3 view,Material material,PBRinfo pbrInfo);
 vec3 calculatePointLight(int i,vec3 fragPos,vec3 normal,vec3 view,Material material,PBRinfo pbrInfo);
 vec3 calculateSpotLight(int i,vec3 fragPos,vec3 normal,vec3 view,Material material,PBRinfo pbrInfo);
@@ -105,9 +100,6 @@ vec3 calculateSpotLight(int i,vec3 fragPos,vec3 normal,vec3 view,Material materi
 vec3 calculateDirLight(int i, Material material, PBRinfo pbrInfo);
 void calculatePointLight();
 
-float filterPCF(vec3 shadowCoords);
-float calculateShadow(vec3 shadowCoords, vec2 off);
-
 vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material);
 float ambient = 0.5;
 
@@ -115,9 +107,9 @@ float ambient = 0.5;
 void main() 
 {
 	// ǰͨȡG-Bufferֵ
-	vec3 fragPos = subpassLoad(samplerposition).rgb;
+	vec3 fragPos = reconstructPosition(subpassLoad(samplerDepth).r);
 
-	vec3 normal = subpassLoad(samplerNormal).rgb;
+	vec3 normal = decodeNormal(subpassLoad(samplerNormal).rg);
 	vec3 view = normalize(uboInfo.cameraPos.xyz - fragPos);
     vec3 reflection = - normalize(reflect(view, normal));
     reflection.y = -reflection.y;
@@ -126,10 +118,11 @@ void main()
     {
         material.albedo = subpassLoad(samplerAlbedo).rgb;
         
-        material.metallicFactor = subpassLoad(samplerMetallicRoughness).b;
-        material.roughnessFactor = subpassLoad(samplerMetallicRoughness).g;
+        vec3 packedMaterial = subpassLoad(samplerMaterial).rgb;
+        material.metallicFactor = packedMaterial.r;
+        material.roughnessFactor = packedMaterial.g;
 
-		material.AO = subpassLoad(samplerAO).r;
+		material.AO = packedMaterial.b;
         material.AO = (material.AO < 0.01) ? 1.0 : material.AO;
 
 		material.emissiveColor = subpassLoad(samplerEmissiveColor).rgb;
@@ -176,26 +169,30 @@ void main()
 	
      vec3 color = getIBLcontribution(pbrInfo, iblInfo, material);;
 
-     for(int i = 0 ; i < uboInfo.lightsCount; ++i)
+    // Directional Lights
+    for (int i = 0; i < int(clusterParams.directionalLightsCount); ++i)
     {
-        // Directional Light
-        if (lights[i].type == 0)
-        {
-            vec4 ShadowCoords = uboInfo.lightSpace * vec4(fragPos, 1.0f);
-            float shadow = (1.0 - filterPCF(ShadowCoords.xyz / ShadowCoords.w));
-            color += calculateDirLight(i, fragPos, normal,view,material,pbrInfo) * shadow;
+        float shadow = getDirectionalShadow(fragPos);
+        color += calculateDirLight(i, fragPos, normal,view,material,pbrInfo) * shadow;
+    }
+
+    // Point and spot lights of the fragment's cluster
+    uint clusterIndex = getClusterIndex(gl_FragCoord.xy, fragPos);
+    uint firstSlot = clusterIndex * clusterParams.gridSize.w;
+
+    for (uint slot = 0; slot < clusterLightCounts[clusterIndex]; ++slot)
+    {
+        int i = int(clusterLightIndices[firstSlot + slot]);
 
         // Point Light
-        } 
-        else if(lights[i].type == 1)
+        if (lights[i].type == 1)
         {
-            color += calculatePointLight(i,fragPos,normal,view,material,pbrInfo);
+            color += calculatePointLight(i,fragPos,normal,view,material,pbrInfo) * getLocalShadow(i, fragPos);
         } 
         else
         {
-            color += calculateSpotLight(i,fragPos,normal, view, material, pbrInfo
-         );
-      }
+            color += calculateSpotLight(i,fragPos,normal, view, material, pbrInfo) * getLocalShadow(i, fragPos);
+        }
     }
 
     // AO
@@ -212,53 +209,32 @@ void main()
 
 }
 
-vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material)
+vec3 reconstructPosition(float depth)
 {
-
-   vec3 diffuse = iblInfo.diffuseLight * pbrInfo.diffuseColor;
-   vec3 specular = (iblInfo.specularLight *(pbrInfo.specularColor * iblInfo.brdf.x + iblInfo.brdf.y));
-
-   return diffuse + specular;
+    vec4 position = uboInfo.invViewProj * vec4(inUV * 2.0 - 1.0, depth, 1.0);
+    return position.xyz / position.w;
 }
 
-float filterPCF(vec3 shadowCoords)
+vec3 decodeNormal(vec2 encoded)
 {
-    shadowCoords.xy = shadowCoords.xy * 0.5 + 0.5;
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
 
-    vec2 texelSize = textureSize(shadowMapSampler, 0);
-    float scale = 1.5;
-    float dx = scale * 1.0 / float(texelSize.x);
-    float dy = scale * 1.0 / float(texelSize.y);
+    float t = clamp(-normal.z, 0.0, 1.0);
+    normal.x += normal.x >= 0.0 ? -t : t;
+    normal.y += normal.y >= 0.0 ? -t : t;
 
-    float shadow = 0.0;
-    int count = 0;
-    int range = 1;
-
-    for (int x = -range; x <= range; x++)
-    {
-        for (int y = -range; y <= range; y++)
-        {
-            shadow += calculateShadow(shadowCoords,vec2(dx * x, dy * y));
-            count++;
-        }
-    }
-    return shadow / count;
+    return normalize(normal);
 }
 
-
-float calculateShadow(vec3 shadowCoords, vec2 off)
+vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material)
 {
-    if (shadowCoords.z > -1.0 && shadowCoords.z < 1.0 && shadowCoords.x > 0.0 && shadowCoords.x < 1.0&& shadowCoords.y > 0.0 && shadowCoords.y < 1.0 )
-    {
-        float closestDepth = texture(shadowMapSampler, shadowCoords.xy + off).r;
-        float currentDepth = shadowCoords.z;
 
-        if (closestDepth> currentDepth)
-            return 0.0;
-    }
-    return 1.0;
+   vec3 diffuse = iblInfo.diffuseLight * pbrInfo.diffuseColor;
+   vec3 specular = (iblInfo.specularLight *(pbrInfo.specularColor * iblInfo.brdf.x + iblInfo.brdf.y));
+
+   return diffuse + specular;
 }
-  
+
 vec3 calculateDirLight(int i,vec3 fragPos, vec3 normal, vec3 view, Material material, PBRinfo pbrInfo) 
 {
     ////////////////////////////////////////////////////////////////////////////
@@ -333,9 +309,9 @@ vec3 calculatePointLight(int i, vec3 fragPos, vec3 normal, vec3 view, Material m
 
     // TODO: Make these const. adjustable by the GUI.
     // Distance of 50:
-    float lightConst = 1.0;
-    float lightLinear = 0.09;
-    float lightQuadratic = 0.032;
+    float lightConst = clusterParams.attenuation.x;
+    float lightLinear = clusterParams.attenuation.y;
+    float lightQuadratic = clusterParams.attenuation.z;
 
     float distance = length(vec3(lights[i].pos) - fragPos);
     float attenuation = ( 1.0 /( lightConst + lightLinear * distance + lightQuadratic * (distance * distance)) );
@@ -384,9 +360,9 @@ vec3 calculateSpotLight(int i,vec3 fragPos, vec3 normal, vec3 view, Material mat
 
    // TODO: Make these const. adjustable by the GUI.
    // Distance of 50:
-   float lightConst = 1.0;
-   float lightLinear = 0.09;
-   float lightQuadratic = 0.032;
+   float lightConst = clusterParams.attenuation.x;
+   float lightLinear = clusterParams.attenuation.y;
+   float lightQuadratic = clusterParams.attenuation.z;
 
    float distance = length(vec3(lights[i].pos) - fragPos);
    float attenuation = (1.0 /(lightConst + lightLinear * distance + lightQuadratic * (distance * distance) ));
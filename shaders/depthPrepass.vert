@@ -0,0 +1,23 @@
+#version 450
+
+// Depth prepass of ForwardPBRPass and SHLightingPass. The shading subpass tests
+// against it with EQUAL: gl_Position must be computed exactly like in
+// scene.vert and shLighting.vert.
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 model;
+   mat4 view;
+   mat4 proj;
+} ubo;
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main()
+{
+   gl_Position = (
+         ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0)
+   );
+}
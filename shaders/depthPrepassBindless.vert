@@ -0,0 +1,41 @@
+#version 450
+
+// Bindless variant of depthPrepass.vert(SHLightingPass, ForwardPBRPass): the
+// model matrix comes from the object buffer, gl_Position must be computed
+// exactly like in shLightingBindless.vert and sceneBindless.vert.
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 model;
+   mat4 view;
+   mat4 proj;
+} ubo;
+
+// Must match GPUObjectData(GPUCulling.h).
+struct ObjectData
+{
+   mat4  model;
+   vec4  boundsMin;
+   vec4  boundsMax;
+   uint  firstIndex;
+   uint  indexCount;
+   int   vertexOffset;
+   uint  objectIndex;
+};
+
+layout(std430, binding = 3) readonly buffer ObjectBuffer
+{
+   ObjectData objects[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+invariant gl_Position;
+
+void main()
+{
+   mat4 model = objects[gl_InstanceIndex].model;
+
+   gl_Position = (
+         ubo.proj * ubo.view * model * vec4(inPosition, 1.0)
+   );
+}
@@ -1,4 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Specialization constants(Pipeline/ShaderVariants.h).
+layout(constant_id = 2) const int PCF_RANGE = 1;
 
 layout(std140, binding = 0) uniform UniformBufferObject
 {
@@ -11,21 +15,8 @@ layout(std140, binding = 0) uniform UniformBufferObject
 } ubo;
 
 
-struct Light
-{
-    vec4    pos;
-    vec4    dir;
-    vec4    color;
-    float   attenuation;
-    float   radius;
-    float   intensity;
-    int     type;
-};
-
-layout(std140, binding = 1) uniform Lights
-{
-    Light lights[10];
-};
+// Lights: set 1
+#include "clusteredLights.glsl"
 
 
 layout(binding = 2) uniform sampler2D   baseColorSampler;
@@ -39,14 +30,17 @@ layout(binding = 7) uniform samplerCube irradianceMapSampler;
 layout(binding = 8) uniform sampler2D   BRDFlutSampler;
 layout(binding = 9) uniform samplerCube prefilteredEnvMapSampler;
 
-layout(binding = 10) uniform sampler2D   shadowMapSampler;
+// Directional light shadows: bindings 10 and 11
+#include "cascadedShadows.glsl"
+
+// Point and spot light shadows: bindings 12 and 13
+#include "shadowAtlas.glsl"
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec3 inTangent;
 layout(location = 4) in vec3 inBitangent;
-layout(location = 5) in vec4 inShadowCoords;
 
 layout(location = 0) out vec4 outColor;
 
@@ -111,9 +105,6 @@ vec3 calculateSpotLight(int i,vec3 normal,vec3 view,Material material,PBRinfo pb
 vec3 calculateDirLight(int i, Material material, PBRinfo pbrInfo);
 void calculatePointLight();
 
-float filterPCF(vec3 shadowCoords);
-float calculateShadow(vec3 shadowCoords, vec2 off);
-
 vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material);
 
 vec3 getSHIrradianceContribution(vec3 dir);
@@ -179,25 +170,30 @@ void main()
 
     vec3 color = getIBLcontribution(pbrInfo, iblInfo, material);
 
-    for(int i = 0 ; i < ubo.lightsCount; ++i)
+    // Directional Lights
+    for (int i = 0; i < int(clusterParams.directionalLightsCount); ++i)
     {
-        // Directional Light
-        if (lights[i].type == 0)
-        {
-            float shadow = (1.0 - filterPCF(inShadowCoords.xyz / inShadowCoords.w));
-            color += calculateDirLight(i,normal,view,material,pbrInfo) * shadow;
+        float shadow = getDirectionalShadow(inPosition);
+        color += calculateDirLight(i,normal,view,material,pbrInfo) * shadow;
+    }
+
+    // Point and spot lights of the fragment's cluster
+    uint clusterIndex = getClusterIndex(gl_FragCoord.xy, inPosition);
+    uint firstSlot = clusterIndex * clusterParams.gridSize.w;
+
+    for (uint slot = 0; slot < clusterLightCounts[clusterIndex]; ++slot)
+    {
+        int i = int(clusterLightIndices[firstSlot + slot]);
 
         // Point Light
-        } 
-        else if(lights[i].type == 1)
+        if (lights[i].type == 1)
         {
-            color += calculatePointLight(i,normal,view,material,pbrInfo);
+            color += calculatePointLight(i,normal,view,material,pbrInfo) * getLocalShadow(i, inPosition);
         } 
         else
         {
-            color += calculateSpotLight(i,normal, view, material, pbrInfo
-         );
-      }
+            color += calculateSpotLight(i,normal, view, material, pbrInfo) * getLocalShadow(i, inPosition);
+        }
     }
 
     // AO
@@ -246,44 +242,6 @@ vec3 calculateNormal()
     return normalize(TBN * tangentNormal);
 }
 
-float filterPCF(vec3 shadowCoords)
-{
-    shadowCoords.xy = shadowCoords.xy * 0.5 + 0.5;
-
-    vec2 texelSize = textureSize(shadowMapSampler, 0);
-    float scale = 1.5;
-    float dx = scale * 1.0 / float(texelSize.x);
-    float dy = scale * 1.0 / float(texelSize.y);
-
-    float shadow = 0.0;
-    int count = 0;
-    int range = 1;
-
-    for (int x = -range; x <= range; x++)
-    {
-        for (int y = -range; y <= range; y++)
-        {
-            shadow += calculateShadow(shadowCoords,vec2(dx * x, dy * y));
-            count++;
-        }
-    }
-    return shadow / count;
-}
-
-
-float calculateShadow(vec3 shadowCoords, vec2 off)
-{
-    if (shadowCoords.z > -1.0 && shadowCoords.z < 1.0 && shadowCoords.x > 0.0 && shadowCoords.x < 1.0&& shadowCoords.y > 0.0 && shadowCoords.y < 1.0 )
-    {
-        float closestDepth = texture(shadowMapSampler, shadowCoords.xy + off).r;
-        float currentDepth = shadowCoords.z;
-
-        if (closestDepth> currentDepth)
-            return 0.0;
-    }
-    return 1.0;
-}
-  
 vec3 calculateDirLight(int i, vec3 normal, vec3 view, Material material, PBRinfo pbrInfo) 
 {
     ////////////////////////////////////////////////////////////////////////////
@@ -358,9 +316,9 @@ vec3 calculatePointLight(int i, vec3 normal, vec3 view, Material material, PBRin
 
     // TODO: Make these const. adjustable by the GUI.
     // Distance of 50:
-    float lightConst = 1.0;
-    float lightLinear = 0.09;
-    float lightQuadratic = 0.032;
+    float lightConst = clusterParams.attenuation.x;
+    float lightLinear = clusterParams.attenuation.y;
+    float lightQuadratic = clusterParams.attenuation.z;
 
     float distance = length(vec3(lights[i].pos) - inPosition);
     float attenuation = ( 1.0 /( lightConst + lightLinear * distance + lightQuadratic * (distance * distance)) );
@@ -409,9 +367,9 @@ vec3 calculateSpotLight(int i, vec3 normal, vec3 view, Material material, PBRinf
 
    // TODO: Make these const. adjustable by the GUI.
    // Distance of 50:
-   float lightConst = 1.0;
-   float lightLinear = 0.09;
-   float lightQuadratic = 0.032;
+   float lightConst = clusterParams.attenuation.x;
+   float lightLinear = clusterParams.attenuation.y;
+   float lightQuadratic = clusterParams.attenuation.z;
 
    float distance = length(vec3(lights[i].pos) - inPosition);
    float attenuation = (1.0 /(lightConst + lightLinear * distance + lightQuadratic * (distance * distance) ));
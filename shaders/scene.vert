@@ -21,7 +21,9 @@ layout(location = 1) out vec2 outTexCoord;
 layout(location = 2) out vec3 outNormal;
 layout(location = 3) out vec3 outTangent;
 layout(location = 4) out vec3 outBitangent;
-layout(location = 5) out vec4 outShadowCoords;
+
+// Same depth as depthPrepass.vert(tested with EQUAL after the prepass).
+invariant gl_Position;
 
 
 void main()
@@ -38,6 +40,4 @@ void main()
    outNormal    = normalize(normalMatrix * inNormal);
 
    outBitangent = normalize(cross(outTangent, outNormal));
-
-   outShadowCoords = (( ubo.lightSpace * ubo.model) * vec4(inPosition, 1.0));
 }
\ No newline at end of file
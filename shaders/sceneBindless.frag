@@ -0,0 +1,454 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Specialization constants(Pipeline/ShaderVariants.h).
+layout(constant_id = 2) const int PCF_RANGE = 1;
+
+// Bindless variant of scene.frag: material textures are fetched from the
+// scene wide arrays(set 1) with the indices of the object's material, the
+// lights move to set 2.
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+    mat4 model;
+    mat4 view;
+    mat4 proj;
+    mat4 lightSpace;
+    vec4 cameraPos;
+    int  lightsCount;
+} ubo;
+
+
+// Lights: set 2
+#define CLUSTER_SET 2
+#include "clusteredLights.glsl"
+
+
+// Per object material, indexed with the object index(GPUCulling order).
+struct MaterialData
+{
+    uint textures[5];
+    uint samplers[5];
+};
+
+layout(std430, binding = 4) readonly buffer MaterialBuffer
+{
+    MaterialData materials[];
+};
+
+// Every material texture/sampler of the scene(BindlessMaterials).
+layout(set = 1, binding = 0) uniform texture2D  bindlessTextures[];
+layout(set = 1, binding = 1) uniform sampler    bindlessSamplers[];
+
+// Indices can differ inside a subgroup(several draws may share one).
+#define materialSampler(slot) sampler2D(bindlessTextures[nonuniformEXT(materials[inObjectIndex].textures[slot])], bindlessSamplers[nonuniformEXT(materials[inObjectIndex].samplers[slot])])
+
+#define baseColorSampler            materialSampler(0)
+#define metallicRoughnessSampler    materialSampler(1)
+#define emissiveColorSampler        materialSampler(2)
+#define AOsampler                   materialSampler(3)
+#define normalSampler               materialSampler(4)
+
+// IBL Samplers
+layout(binding = 7) uniform samplerCube irradianceMapSampler;
+layout(binding = 8) uniform sampler2D   BRDFlutSampler;
+layout(binding = 9) uniform samplerCube prefilteredEnvMapSampler;
+
+// Directional light shadows: bindings 10 and 11
+#include "cascadedShadows.glsl"
+
+// Point and spot light shadows: bindings 12 and 13
+#include "shadowAtlas.glsl"
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec3 inTangent;
+layout(location = 4) in vec3 inBitangent;
+layout(location = 5) flat in uint inObjectIndex;
+
+layout(location = 0) out vec4 outColor;
+
+struct Material
+{
+   vec3 albedo;
+   float metallicFactor;
+   float roughnessFactor;
+   vec3 emissiveColor;
+   float AO;
+};
+
+struct PBRinfo
+{
+   // cos angle between normal and light direction.
+	float NdotL;          
+   // cos angle between normal and view direction.
+	float NdotV;          
+   // cos angle between normal and half vector.
+	float NdotH;          
+   // cos angle between view direction and half vector.
+	float VdotH;
+   // Roughness value, as authored by the model creator.
+    float perceptualRoughness;
+   // Roughness mapped to a more linear value.
+    float alphaRoughness;
+   // color contribution from diffuse lighting.
+	vec3 diffuseColor;    
+   // color contribution from specular lighting.
+	vec3 specularColor;
+
+    // full reflectance color(normal incidence angle)
+    vec3 reflectance0;
+   // reflectance color at grazing angle
+    vec3 reflectance90;
+};
+
+struct IBLinfo
+{
+   vec3 diffuseLight;
+   vec3 specularLight;
+//   vec3 brdf;
+   vec2 brdf;
+};
+
+const float PI = 3.14159265359;
+
+
+//////////////////////////////////////PBR//////////////////////////////////////
+
+float distributionGGX(float nDotH, float rough);
+float geometricOcclusion(PBRinfo pbrInfo);
+vec3 fresnelSchlick(PBRinfo pbrInfo);
+
+///////////////////////////////////////////////////////////////////////////////
+
+vec3 calculateNormal();
+vec3 calculateDirLight(int i,vec3 normal,vec3 view,Material material,PBRinfo pbrInfo);
+vec3 calculatePointLight(int i,vec3 normal,vec3 view,Material material,PBRinfo pbrInfo);
+vec3 calculateSpotLight(int i,vec3 normal,vec3 view,Material material,PBRinfo pbrInfo);
+
+vec3 calculateDirLight(int i, Material material, PBRinfo pbrInfo);
+void calculatePointLight();
+
+vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material);
+
+vec3 getSHIrradianceContribution(vec3 dir);
+
+float ambient = 0.5;
+
+
+void main()
+{
+    vec3 normal = calculateNormal();
+    vec3 view = normalize(vec3(ubo.cameraPos) - inPosition);
+    vec3 reflection = - normalize(reflect(view, normal));
+    reflection.y = -reflection.y;
+
+    Material material;
+    {
+        material.albedo = texture(baseColorSampler, inTexCoord).rgb;
+        
+        material.metallicFactor = texture(metallicRoughnessSampler, inTexCoord).b;
+        material.roughnessFactor = texture(metallicRoughnessSampler, inTexCoord).g;
+        
+        material.AO = texture(AOsampler, inTexCoord).r;
+        material.AO = (material.AO < 0.01) ? 1.0 : material.AO;
+        material.emissiveColor = texture(emissiveColorSampler, inTexCoord).rgb;
+    }
+
+    PBRinfo pbrInfo;
+    {
+        float F0 = 0.04;
+
+        pbrInfo.NdotV = clamp(dot(normal, view), 0.001, 1.0);
+        
+        pbrInfo.diffuseColor = material.albedo.rgb * (vec3(1.0) - vec3(F0));
+        pbrInfo.diffuseColor *= 1.0 - material.metallicFactor;
+      
+        pbrInfo.specularColor = mix(vec3(F0),material.albedo,material.metallicFactor);
+
+        pbrInfo.perceptualRoughness = clamp(material.roughnessFactor, 0.04, 1.0);
+        //alpha = r*r
+        pbrInfo.alphaRoughness = (pbrInfo.perceptualRoughness * pbrInfo.perceptualRoughness);
+
+        // Reflectance
+        float reflectance = max(max(pbrInfo.specularColor.r, pbrInfo.specularColor.g),pbrInfo.specularColor.b);
+        // - For typical incident reflectance range (between 4% to 100%) set the
+        // grazing reflectance to 100% for typical fresnel effect.
+	    // - For very low reflectance range on highly diffuse objects (below 4%),
+        // incrementally reduce grazing reflecance to 0%.
+        pbrInfo.reflectance0 = pbrInfo.specularColor.rgb;
+        pbrInfo.reflectance90 = vec3(clamp(reflectance * 25.0, 0.0, 1.0));
+    }
+
+    IBLinfo iblInfo;
+    {
+        // HDR textures are already linear
+        iblInfo.diffuseLight = texture(irradianceMapSampler, vec3(normal.x, -normal.y, normal.z)).rgb;
+
+        float mipCount = float(textureQueryLevels(prefilteredEnvMapSampler));
+        float lod = pbrInfo.perceptualRoughness * mipCount;
+
+        iblInfo.brdf = texture(BRDFlutSampler, vec2( max(pbrInfo.NdotV, 0.0), pbrInfo.perceptualRoughness)).rg;
+        iblInfo.specularLight = textureLod(prefilteredEnvMapSampler,reflection.xyz,lod).rgb;
+   }
+
+    vec3 color = getIBLcontribution(pbrInfo, iblInfo, material);
+
+    // Directional Lights
+    for (int i = 0; i < int(clusterParams.directionalLightsCount); ++i)
+    {
+        float shadow = getDirectionalShadow(inPosition);
+        color += calculateDirLight(i,normal,view,material,pbrInfo) * shadow;
+    }
+
+    // Point and spot lights of the fragment's cluster
+    uint clusterIndex = getClusterIndex(gl_FragCoord.xy, inPosition);
+    uint firstSlot = clusterIndex * clusterParams.gridSize.w;
+
+    for (uint slot = 0; slot < clusterLightCounts[clusterIndex]; ++slot)
+    {
+        int i = int(clusterLightIndices[firstSlot + slot]);
+
+        // Point Light
+        if (lights[i].type == 1)
+        {
+            color += calculatePointLight(i,normal,view,material,pbrInfo) * getLocalShadow(i, inPosition);
+        } 
+        else
+        {
+            color += calculateSpotLight(i,normal, view, material, pbrInfo) * getLocalShadow(i, inPosition);
+        }
+    }
+
+    // AO
+    color = material.AO * color;
+
+    // Emissive
+    color = material.emissiveColor + color;
+
+    color = pow(color,vec3(1.0 / 2.2));
+
+    outColor = ambient * vec4(color, 1.0);
+
+//    outColor =  vec4(iblInfo.specularLight * (pbrInfo.specularColor* iblInfo.brdf.x + iblInfo.brdf.y) , 1.0);
+    
+
+//    vec3 shadowCoords = inShadowCoords.xyz / inShadowCoords.w;
+//    shadowCoords.xy = shadowCoords.xy * 0.5 + 0.5;
+//    outColor = vec4( shadowCoords.z - texture(shadowMapSampler, shadowCoords.xy).r); 
+
+}
+
+vec3 getIBLcontribution(PBRinfo pbrInfo, IBLinfo iblInfo, Material material)
+{
+
+   vec3 diffuse = iblInfo.diffuseLight * pbrInfo.diffuseColor;
+   vec3 specular = (iblInfo.specularLight *(pbrInfo.specularColor * iblInfo.brdf.x + iblInfo.brdf.y));
+
+   return diffuse + specular;
+}
+
+
+vec3 calculateNormal()
+{
+    vec3 tangentNormal = texture(normalSampler,inTexCoord).xyz ;
+
+	vec3 q1 = dFdx(inPosition);
+	vec3 q2 = dFdy(inPosition);
+	vec2 st1 = dFdx(inTexCoord);
+	vec2 st2 = dFdy(inTexCoord);
+
+    vec3 N = normalize(inNormal);
+	vec3 T = normalize(q1 * st2.t - q2 * st1.t);
+	vec3 B = -normalize(cross(N, T));
+	mat3 TBN = mat3(T, B, N);
+
+    return normalize(TBN * tangentNormal);
+}
+
+vec3 calculateDirLight(int i, vec3 normal, vec3 view, Material material, PBRinfo pbrInfo) 
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // Fills the data left for PBR
+    vec3 lightDir = normalize(-vec3(lights[i].dir));
+
+    vec3 halfway = normalize(view + lightDir);
+    {
+        pbrInfo.NdotL = max(dot(normal, lightDir), 0.0);
+        pbrInfo.NdotH = max(dot(normal, halfway), 0.0);
+        pbrInfo.VdotH = max(dot(halfway, view), 0.0);
+    }
+    ////////////////////////////////////////////////////////////////////////////
+    vec3 inRadiance = lights[i].intensity * lights[i].color.rbg;
+
+    //Cook-torrance brdf
+    vec3 F = fresnelSchlick(pbrInfo);
+    float D = distributionGGX(pbrInfo.NdotH, material.roughnessFactor);
+    float G = geometricOcclusion(pbrInfo);
+
+    // Energy conservation
+    // Specular and Diffuse
+    vec3 kS = F;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - material.metallicFactor;
+
+//    vec3 numerator = D * G * F;
+    vec3 numerator = D*G*F;
+    float denominator = (4.0 *pbrInfo.NdotV * pbrInfo.NdotL);
+    
+    vec3 diffuse = kD * (pbrInfo.diffuseColor / PI);
+    vec3 specular = numerator / max(denominator, 0.0001);
+
+    vec3 Lo =  (diffuse + specular) * inRadiance * pbrInfo.NdotL ;
+
+    return Lo;
+}
+
+vec3 calculatePointLight(int i, vec3 normal, vec3 view, Material material, PBRinfo pbrInfo ) 
+{
+    ////////////////////////////////////////////////////////////////////////////
+    // Fills the data left for PBR
+    vec3 lightDir = normalize(vec3(lights[i].pos) - inPosition);
+    vec3 halfway = normalize(view + lightDir);
+
+    {
+        pbrInfo.NdotL = max(dot(normal, lightDir), 0.0);
+        pbrInfo.NdotH = max(dot(normal, halfway), 0.0);
+        pbrInfo.VdotH = max(dot(halfway, view), 0.0);
+    }
+    ////////////////////////////////////////////////////////////////////////////
+
+
+    vec3 inRadiance = lights[i].intensity * lights[i].color.rgb;
+
+    // Cook-torrance brdf
+    vec3 F = fresnelSchlick(pbrInfo);
+    float D = distributionGGX(pbrInfo.NdotH, material.roughnessFactor);
+    float G = geometricOcclusion(pbrInfo);
+
+    // Energy conservation
+    // Specular and Diffuse
+    vec3 kS = F;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - material.metallicFactor;
+
+    vec3 numerator = D * G * F;
+    float denominator = 4.0 * pbrInfo.NdotV * pbrInfo.NdotL;
+
+    vec3 diffuse = kD * (pbrInfo.diffuseColor / PI);
+    vec3 specular = numerator / max(denominator, 0.0001);
+
+    // TODO: Make these const. adjustable by the GUI.
+    // Distance of 50:
+    float lightConst = clusterParams.attenuation.x;
+    float lightLinear = clusterParams.attenuation.y;
+    float lightQuadratic = clusterParams.attenuation.z;
+
+    float distance = length(vec3(lights[i].pos) - inPosition);
+    float attenuation = ( 1.0 /( lightConst + lightLinear * distance + lightQuadratic * (distance * distance)) );
+
+   return (attenuation * (diffuse + specular) * inRadiance * pbrInfo.NdotL);
+}
+
+vec3 calculateSpotLight(int i, vec3 normal, vec3 view, Material material, PBRinfo pbrInfo) 
+{
+   ////////////////////////////////////////////////////////////////////////////
+   // Fills the data left for PBR
+   vec3 lightDir = normalize(vec3(lights[i].pos) - inPosition);
+   vec3 halfway = normalize(view + lightDir);
+
+   {
+      pbrInfo.NdotL = max(dot(normal, lightDir), 0.0);
+      pbrInfo.NdotH = max(dot(normal, halfway), 0.0);
+      pbrInfo.VdotH = max(dot(halfway, view), 0.0);
+   }
+   ////////////////////////////////////////////////////////////////////////////
+
+   float theta = dot(lightDir, normalize(-vec3(lights[i].dir)));
+   // TODO: Make these const. adjustable by the GUI.
+   // 15 degrees
+   float epsilon = 0.9978 - 0.953;
+   float intensity = clamp((theta - 0.953) / epsilon, 0.0, 1.0);
+
+   vec3 inRadiance = lights[i].intensity * lights[i].color.rgb;
+
+   // Cook-torrance brdf
+   vec3 F = fresnelSchlick(pbrInfo);
+   float D = distributionGGX(pbrInfo.NdotH, material.roughnessFactor);
+   float G = geometricOcclusion(pbrInfo);
+
+   // Energy conservation
+   // Specular and Diffuse
+   vec3 kS = F;
+   vec3 kD = vec3(1.0) - kS;
+   kD *= 1.0 - material.metallicFactor;
+
+   vec3 numerator = D * G * F;
+   float denominator = 4.0 * pbrInfo.NdotV * pbrInfo.NdotL;
+
+   vec3 diffuse = kD * (pbrInfo.diffuseColor / PI) * intensity;
+   vec3 specular = numerator / max(denominator, 0.0001) * intensity;
+
+   // TODO: Make these const. adjustable by the GUI.
+   // Distance of 50:
+   float lightConst = clusterParams.attenuation.x;
+   float lightLinear = clusterParams.attenuation.y;
+   float lightQuadratic = clusterParams.attenuation.z;
+
+   float distance = length(vec3(lights[i].pos) - inPosition);
+   float attenuation = (1.0 /(lightConst + lightLinear * distance + lightQuadratic * (distance * distance) ));
+
+   return (attenuation * (diffuse + specular) * inRadiance * pbrInfo.NdotL);
+}
+
+
+///////////////////////////////PBR - Helper functions//////////////////////////
+
+/*
+ * Trowbridge-Reitz GGX approximation.
+ */
+float distributionGGX(float nDotH, float rough)
+{
+   float a = rough * rough;
+   float a2 = a * a;
+
+   float denominator = nDotH * nDotH * (a2 - 1.0) + 1.0;
+   denominator = 1 / (PI * denominator * denominator);
+
+   return a2 * denominator;
+}
+
+float geometricOcclusion(PBRinfo pbrInfo)
+{
+   float alphaRoughness2 = pbrInfo.alphaRoughness * pbrInfo.alphaRoughness;
+   float NdotL2 = pbrInfo.NdotL * pbrInfo.NdotL;
+   float NdotV2 = pbrInfo.NdotV * pbrInfo.NdotV;
+
+   float attenuationL = (
+         2.0 * pbrInfo.NdotL /
+         (
+            pbrInfo.NdotL +
+            sqrt(alphaRoughness2 + (1.0 - alphaRoughness2) * (NdotL2))
+         )
+   );
+
+   float attenuationV = (
+         2.0 * pbrInfo.NdotV /
+         (
+            pbrInfo.NdotV +
+            sqrt(alphaRoughness2 + (1.0 - alphaRoughness2) * (NdotV2))
+         )
+   );
+
+   return attenuationL * attenuationV;
+}
+
+/*
+ * Fresnel Schlick approximation(for specular reflection).
+ */
+vec3 fresnelSchlick(PBRinfo pbrInfo)
+{
+    return (pbrInfo.reflectance0 + (pbrInfo.reflectance90 - pbrInfo.reflectance0) *pow(clamp(1.0 - pbrInfo.VdotH, 0.0, 1.0), 5.0));
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#version 450
+
+// Bindless variant of scene.vert: the model matrix comes from the object
+// buffer(firstInstance of each draw is the object index), ubo.model is unused.
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 model;
+   mat4 view;
+   mat4 proj;
+   mat4 lightSpace;
+   vec4 cameraPos;
+   int  lightsCount;
+   bool hasNormalMap;
+} ubo;
+
+// Must match GPUObjectData(GPUCulling.h).
+struct ObjectData
+{
+   mat4  model;
+   vec4  boundsMin;
+   vec4  boundsMax;
+   uint  firstIndex;
+   uint  indexCount;
+   int   vertexOffset;
+   uint  objectIndex;
+};
+
+layout(std430, binding = 3) readonly buffer ObjectBuffer
+{
+   ObjectData objects[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec3 inTangent;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec2 outTexCoord;
+layout(location = 2) out vec3 outNormal;
+layout(location = 3) out vec3 outTangent;
+layout(location = 4) out vec3 outBitangent;
+layout(location = 5) flat out uint outObjectIndex;
+
+// Same depth as depthPrepassBindless.vert(tested with EQUAL after the prepass).
+invariant gl_Position;
+
+
+void main()
+{
+   mat4 model = objects[gl_InstanceIndex].model;
+
+   gl_Position = (
+         ubo.proj * ubo.view * model * vec4(inPosition, 1.0)
+   );
+
+   outPosition = vec3(model * vec4(inPosition, 1.0));
+   outTexCoord = inTexCoord;
+
+   mat3 normalMatrix = transpose(inverse(mat3(model)));
+   outTangent   = normalize(normalMatrix * inTangent);
+   outNormal    = normalize(normalMatrix * inNormal);
+
+   outBitangent = normalize(cross(outTangent, outNormal));
+
+   outObjectIndex = uint(gl_InstanceIndex);
+}
\ No newline at end of file
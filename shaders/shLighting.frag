@@ -1,5 +1,9 @@
 #version 450
 
+// Specialization constants(Pipeline/ShaderVariants.h).
+layout(constant_id = 1) const int SH_COEF_NUM = 25;
+layout(constant_id = 3) const bool HAS_NORMAL_MAP = true;
+
 layout(std140, binding = 0) uniform UniformBufferObject
 {
     mat4 model;
@@ -183,7 +187,7 @@ void main()
 	Basis[24] = -0.41667 * 0.625836 * (z*z * (z*z - 3.0 * x*x) - x*x * (3.0 * z*z - x*x));
 
     vec3 Diffuse = vec3(0,0,0);
-	for (int i = 0; i < 25; i++)
+	for (int i = 0; i < SH_COEF_NUM; i++)
 		Diffuse += coefficent[i].rgb * Basis[i];
 //    Diffuse += Basis[0] *  coefficent[0].rgb ;
 
@@ -225,7 +229,7 @@ void main()
 	Basis[24] = -0.41667 * 0.625836 * (z*z * (z*z - 3.0 * x*x) - x*x * (3.0 * z*z - x*x));
 
     vec3 Specular = vec3(0,0,0);
-	for (int i = 0; i < 25; i++)
+	for (int i = 0; i < SH_COEF_NUM; i++)
 		Specular += coefficent[i].rgb * Basis[i];
 
     vec2 SHBRDF  = texture(SHBRDFlutSampler, vec2( max(pbrInfo.NdotV, 0.0), pbrInfo.perceptualRoughness)).rg;
@@ -246,6 +250,10 @@ void main()
 
 vec3 calculateNormal()
 {
+    // No normal map: the default texture would only cost a fetch.
+    if (!HAS_NORMAL_MAP)
+        return normalize(inNormal);
+
     vec3 tangentNormal = texture(normalSampler,inTexCoord).xyz ;
 
 	vec3 q1 = dFdx(inPosition);
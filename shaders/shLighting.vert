@@ -22,6 +22,9 @@ layout(location = 3) out vec3 outTangent;
 layout(location = 4) out vec3 outBitangent;
 layout(location = 5) out vec4 outShadowCoords;
 
+// Same depth as depthPrepass.vert(tested with EQUAL after the prepass).
+invariant gl_Position;
+
 
 void main()
 {
@@ -0,0 +1,76 @@
+// Shadows of the point and spot lights(Features/ShadowAtlas.h), included by
+// the shaders shading with it after clusteredLights.glsl. Expects the
+// PCF_RANGE constant. Must stay in sync with ShadowAtlasTile.
+
+// Config::MAX_LIGHTS
+#define SHADOW_ATLAS_MAX_LIGHTS 4096
+
+struct ShadowAtlasTile
+{
+    mat4 viewProj;
+    vec4 rect;                                  // xy = offset, zw = size(atlas uv)
+};
+
+layout(binding = 12) uniform sampler2D shadowAtlasSampler;
+
+layout(std430, binding = 13) readonly buffer ShadowAtlas
+{
+    // First tile of each light(index in lights[]), -1 when not shadowed.
+    // Point lights have 6 tiles, one per cube face(+x, -x, +y, -y, +z, -z).
+    int             lightFirstTile[SHADOW_ATLAS_MAX_LIGHTS];
+    ShadowAtlasTile tiles[];
+} shadowAtlas;
+
+
+// The cube face the direction goes through.
+int getCubeFace(vec3 direction)
+{
+    vec3 absDirection = abs(direction);
+    if (absDirection.x >= absDirection.y && absDirection.x >= absDirection.z)
+        return direction.x > 0.0 ? 0 : 1;
+    if (absDirection.y >= absDirection.z)
+        return direction.y > 0.0 ? 2 : 3;
+    return direction.z > 0.0 ? 4 : 5;
+}
+
+// Returns how much of the light i reaches worldPos.
+float getLocalShadow(int i, vec3 worldPos)
+{
+    int tileIndex = shadowAtlas.lightFirstTile[i];
+    if (tileIndex < 0)
+        return 1.0;
+
+    // Point Light
+    if (lights[i].type == 1)
+        tileIndex += getCubeFace(worldPos - vec3(lights[i].pos));
+
+    ShadowAtlasTile tile = shadowAtlas.tiles[tileIndex];
+
+    vec4 shadowCoords = tile.viewProj * vec4(worldPos, 1.0);
+    shadowCoords.xyz /= shadowCoords.w;
+
+    if (shadowCoords.w <= 0.0 || shadowCoords.z <= 0.0 || shadowCoords.z >= 1.0)
+        return 1.0;
+
+    vec2 tileCoords = clamp(shadowCoords.xy * 0.5 + 0.5, 0.0, 1.0);
+
+    // The taps stay inside the tile, its neighbours belong to other lights.
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowAtlasSampler, 0));
+    vec2 minCoords = tile.rect.xy + 0.5 * texelSize;
+    vec2 maxCoords = tile.rect.xy + tile.rect.zw - 0.5 * texelSize;
+    vec2 atlasCoords = tile.rect.xy + tileCoords * tile.rect.zw;
+
+    float shadow = 0.0;
+    int count = 0;
+    for (int x = -PCF_RANGE; x <= PCF_RANGE; x++)
+    {
+        for (int y = -PCF_RANGE; y <= PCF_RANGE; y++)
+        {
+            vec2 coords = clamp(atlasCoords + vec2(x, y) * texelSize, minCoords, maxCoords);
+            float closestDepth = texture(shadowAtlasSampler, coords).r;
+            shadow += (closestDepth > shadowCoords.z) ? 0.0 : 1.0;
+            count++;
+        }
+    }
+    return 1.0 - shadow / count;
+}
@@ -0,0 +1,32 @@
+#version 450
+
+// GPU-driven variant of shadowMap.vert: the model matrix comes from the object
+// buffer(firstInstance of each indirect draw is the object index).
+
+struct ObjectData
+{
+    mat4 model;
+    vec4 boundsMin;
+    vec4 boundsMax;
+    uint firstIndex;
+    uint indexCount;
+    int  vertexOffset;
+    uint objectIndex;
+};
+
+layout(std140, binding = 0) uniform UniformBufferObject
+{
+   mat4 lightSpace;
+} ubo;
+
+layout(std430, binding = 1) readonly buffer Objects
+{
+   ObjectData objects[];
+};
+
+layout(location = 0) in vec3 inPosition;
+
+void main()
+{
+   gl_Position = (ubo.lightSpace * objects[gl_InstanceIndex].model * vec4(inPosition, 1.0));
+}
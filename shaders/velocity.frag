@@ -0,0 +1,17 @@
+#version 450
+
+// See velocity.vert: screen motion in UV units, current minus previous.
+
+layout(location = 0) in vec4 inCurrentPosition;
+layout(location = 1) in vec4 inPreviousPosition;
+
+layout(location = 0) out vec2 outVelocity;
+
+void main()
+{
+   // Divided per pixel, the clip positions are interpolated linearly.
+   vec2 current = inCurrentPosition.xy / inCurrentPosition.w;
+   vec2 previous = inPreviousPosition.xy / inPreviousPosition.w;
+
+   outVelocity = (current - previous) * 0.5;
+}
@@ -0,0 +1,32 @@
+#version 450
+
+// Motion vectors of the meshes(TemporalAA): rasterized with the jittered
+// projection like the scene, the velocity is the screen motion of the
+// unjittered position since the previous frame(camera and model matrix).
+
+layout(std140, set = 0, binding = 0) uniform FrameUniformBufferObject
+{
+   mat4 jitteredViewProj;
+   mat4 viewProj;
+   mat4 prevViewProj;
+} frame;
+
+layout(push_constant) uniform PushConsts {
+   mat4 model;
+   mat4 prevModel;
+} consts;
+
+layout(location = 0) in vec3 inPosition;
+
+layout(location = 0) out vec4 outCurrentPosition;
+layout(location = 1) out vec4 outPreviousPosition;
+
+void main()
+{
+   vec4 worldPosition = consts.model * vec4(inPosition, 1.0);
+
+   outCurrentPosition = frame.viewProj * worldPosition;
+   outPreviousPosition = frame.prevViewProj * consts.prevModel * vec4(inPosition, 1.0);
+
+   gl_Position = frame.jitteredViewProj * worldPosition;
+}
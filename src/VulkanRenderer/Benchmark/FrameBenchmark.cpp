@@ -0,0 +1,124 @@
+#include "VulkanRenderer/Benchmark/FrameBenchmark.h"
+
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+void FrameBenchmark::beginRun(const std::string& name)
+{
+    m_runs.push_back({ name, {}, {}, {} });
+}
+
+void FrameBenchmark::addFrame(const double frameMs, const double recordMs)
+{
+    if (m_runs.empty())
+        throw std::runtime_error("Failed to add a benchmark frame, no run has begun!");
+
+    m_runs.back().frameTimes.push_back(frameMs);
+    m_runs.back().recordTimes.push_back(recordMs);
+}
+
+void FrameBenchmark::addLatency(const double latencyMs)
+{
+    if (m_runs.empty())
+        throw std::runtime_error("Failed to add a benchmark latency, no run has begun!");
+
+    m_runs.back().latencies.push_back(latencyMs);
+}
+
+std::vector<FrameBenchmark::Summary> FrameBenchmark::getSummaries() const
+{
+    std::vector<Summary> summaries;
+
+    for (auto& run : m_runs)
+    {
+        Summary summary;
+        summary.name = run.name;
+        summary.frames = static_cast<uint32_t>(run.frameTimes.size());
+
+        if (run.frameTimes.empty())
+        {
+            summaries.push_back(summary);
+            continue;
+        }
+
+        std::vector<double> sorted = run.frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+
+        const double frames = static_cast<double>(sorted.size());
+        summary.meanMs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / frames;
+        summary.medianMs = sorted[sorted.size() / 2];
+        summary.p95Ms = sorted[std::min(sorted.size() - 1, static_cast<size_t>(frames * 0.95))];
+        summary.minMs = sorted.front();
+        summary.maxMs = sorted.back();
+        summary.meanRecordMs = std::accumulate(run.recordTimes.begin(), run.recordTimes.end(), 0.0) / frames;
+
+        if (!run.latencies.empty())
+        {
+            std::vector<double> latencies = run.latencies;
+            std::sort(latencies.begin(), latencies.end());
+
+            summary.medianLatencyMs = latencies[latencies.size() / 2];
+            summary.p99LatencyMs = latencies[std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * 0.99))];
+        }
+
+        summaries.push_back(summary);
+    }
+
+    return summaries;
+}
+
+void FrameBenchmark::print() const
+{
+    std::cout << "Benchmark(ms per frame):\n";
+    std::cout << std::left << std::setw(40) << "run"
+        << std::right << std::setw(8) << "frames"
+        << std::setw(10) << "mean"
+        << std::setw(10) << "median"
+        << std::setw(10) << "p95"
+        << std::setw(10) << "min"
+        << std::setw(10) << "max"
+        << std::setw(10) << "record"
+        << std::setw(10) << "lat p50"
+        << std::setw(10) << "lat p99"
+        << std::setw(10) << "fps" << "\n";
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto& summary : getSummaries())
+    {
+        std::cout << std::left << std::setw(40) << summary.name
+            << std::right << std::setw(8) << summary.frames
+            << std::setw(10) << summary.meanMs
+            << std::setw(10) << summary.medianMs
+            << std::setw(10) << summary.p95Ms
+            << std::setw(10) << summary.minMs
+            << std::setw(10) << summary.maxMs
+            << std::setw(10) << summary.meanRecordMs
+            << std::setw(10) << summary.medianLatencyMs
+            << std::setw(10) << summary.p99LatencyMs
+            << std::setw(10) << ((summary.meanMs > 0.0) ? 1000.0 / summary.meanMs : 0.0) << "\n";
+    }
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+void FrameBenchmark::writeCSV(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to write the benchmark results to " << path << "\n";
+        return;
+    }
+
+    file << "run,frames,mean_ms,median_ms,p95_ms,min_ms,max_ms,record_ms,latency_p50_ms,latency_p99_ms\n";
+    for (auto& summary : getSummaries())
+    {
+        file << summary.name << "," << summary.frames << ","
+            << summary.meanMs << "," << summary.medianMs << "," << summary.p95Ms << ","
+            << summary.minMs << "," << summary.maxMs << "," << summary.meanRecordMs << ","
+            << summary.medianLatencyMs << "," << summary.p99LatencyMs << "\n";
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+ * Frame times of the benchmark mode, grouped in runs(a pass and its settings):
+ *  - beginRun() starts a run, addFrame() gives it the measured frames and
+ *    addLatency() their end to end latency(Benchmark/LatencyMeter.h).
+ *  - print() writes a summary per run to stdout, writeCSV() one row per run.
+ * Times are measured on the CPU: the frame time includes the wait on the
+ * frame's fence, so a GPU bound run shows its GPU cost.
+ */
+class FrameBenchmark
+{
+public:
+    struct Summary
+    {
+        std::string name;
+        uint32_t    frames = 0;
+        // Milliseconds per frame.
+        double      meanMs = 0.0;
+        double      medianMs = 0.0;
+        double      p95Ms = 0.0;
+        double      minMs = 0.0;
+        double      maxMs = 0.0;
+        // Milliseconds spent updating and recording the frame.
+        double      meanRecordMs = 0.0;
+        // Input to GPU completion, 0 without timestamps.
+        double      medianLatencyMs = 0.0;
+        double      p99LatencyMs = 0.0;
+    };
+
+    FrameBenchmark() {};
+    ~FrameBenchmark() {};
+
+    void beginRun(const std::string& name);
+    void addFrame(const double frameMs, const double recordMs);
+    void addLatency(const double latencyMs);
+
+    std::vector<Summary> getSummaries() const;
+
+    void print() const;
+    void writeCSV(const std::string& path) const;
+
+private:
+    struct Run
+    {
+        std::string         name;
+        std::vector<double> frameTimes;
+        std::vector<double> recordTimes;
+        std::vector<double> latencies;
+    };
+
+    std::vector<Run>        m_runs;
+};
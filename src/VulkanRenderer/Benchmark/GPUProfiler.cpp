@@ -0,0 +1,193 @@
+#include "VulkanRenderer/Benchmark/GPUProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/config.h"
+#include "VulkanRenderer/Benchmark/TimestampQueries.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+GPUProfiler::Scope::Scope(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const std::string& name)
+    : m_commandBuffer(commandBuffer), m_frameIndex(frameIndex)
+{
+    m_scope = getRendererPointer()->getGPUProfiler()->beginScope(commandBuffer, frameIndex, name);
+}
+
+GPUProfiler::Scope::~Scope()
+{
+    getRendererPointer()->getGPUProfiler()->endScope(m_commandBuffer, m_frameIndex, m_scope);
+}
+
+GPUProfiler::GPUProfiler()
+{
+    m_isSupported = TimestampQueries::querySupport(m_timestampPeriod);
+
+    m_scopes.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_isRecording.assign(Config::MAX_FRAMES_IN_FLIGHT, false);
+
+    if (!m_isSupported)
+        return;
+
+    // Begin and end of each scope, per frame.
+    m_queryPool = TimestampQueries::createQueryPool(2 * Config::GPU_PROFILER_MAX_SCOPES * Config::MAX_FRAMES_IN_FLIGHT, "GPU profiler");
+}
+
+void GPUProfiler::update(const uint32_t frameIndex)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    std::vector<ScopeQuery>& scopes = m_scopes[frameIndex];
+    if (scopes.empty())
+        return;
+
+    // The fence of the slot was waited on, the results are there: no wait.
+    std::vector<uint64_t> timestamps(2 * scopes.size());
+    const VkResult result = vkGetQueryPoolResults(
+        getRendererPointer()->getDevice(),
+        m_queryPool,
+        2 * Config::GPU_PROFILER_MAX_SCOPES * frameIndex,
+        static_cast<uint32_t>(timestamps.size()),
+        timestamps.size() * sizeof(uint64_t),
+        timestamps.data(),
+        sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT
+    );
+
+    if (result == VK_SUCCESS)
+    {
+        const uint64_t first = *std::min_element(timestamps.begin(), timestamps.end());
+        const uint64_t last = *std::max_element(timestamps.begin(), timestamps.end());
+
+        FrameTimes frame;
+        frame.frame = m_frameCount++;
+        frame.totalMs = TimestampQueries::toMilliseconds(last - first, m_timestampPeriod);
+
+        for (size_t i = 0; i < scopes.size(); ++i)
+        {
+            PassTime pass;
+            pass.name = scopes[i].name;
+            pass.depth = scopes[i].depth;
+            pass.startMs = TimestampQueries::toMilliseconds(timestamps[2 * i] - first, m_timestampPeriod);
+            pass.durationMs = TimestampQueries::toMilliseconds(timestamps[2 * i + 1] - timestamps[2 * i], m_timestampPeriod);
+            frame.passes.push_back(pass);
+        }
+
+        m_frames.push_back(frame);
+        if (m_frames.size() > Config::GPU_PROFILER_HISTORY_FRAMES)
+            m_frames.pop_front();
+    }
+
+    scopes.clear();
+}
+
+void GPUProfiler::beginFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex)
+{
+    m_scopes[frameIndex].clear();
+    m_isRecording[frameIndex] = m_isSupported && m_isEnabled;
+    m_depth = 0;
+
+    if (!m_isRecording[frameIndex])
+        return;
+
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, 2 * Config::GPU_PROFILER_MAX_SCOPES * frameIndex, 2 * Config::GPU_PROFILER_MAX_SCOPES);
+}
+
+int32_t GPUProfiler::beginScope(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const std::string& name)
+{
+    std::vector<ScopeQuery>& scopes = m_scopes[frameIndex];
+    if (!m_isRecording[frameIndex] || scopes.size() >= Config::GPU_PROFILER_MAX_SCOPES)
+        return -1;
+
+    const int32_t scope = static_cast<int32_t>(scopes.size());
+    scopes.push_back({ name, m_depth++ });
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 2 * (Config::GPU_PROFILER_MAX_SCOPES * frameIndex + scope));
+
+    return scope;
+}
+
+void GPUProfiler::endScope(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const int32_t scope)
+{
+    if (scope < 0)
+        return;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 2 * (Config::GPU_PROFILER_MAX_SCOPES * frameIndex + scope) + 1);
+    m_depth--;
+}
+
+std::vector<float> GPUProfiler::getHistory(const std::string& name) const
+{
+    std::vector<float> history;
+    history.reserve(m_frames.size());
+
+    for (auto& frame : m_frames)
+    {
+        float duration = 0.0f;
+        for (auto& pass : frame.passes)
+        {
+            if (pass.name == name)
+                duration += float(pass.durationMs);
+        }
+        history.push_back(duration);
+    }
+
+    return history;
+}
+
+void GPUProfiler::writeCSV(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to write the GPU profile to " << path << "\n";
+        return;
+    }
+
+    file << "frame,pass,depth,start_ms,duration_ms\n";
+    for (auto& frame : m_frames)
+    {
+        file << frame.frame << ",frame,0,0," << frame.totalMs << "\n";
+        for (auto& pass : frame.passes)
+            file << frame.frame << ",\"" << pass.name << "\"," << pass.depth << "," << pass.startMs << "," << pass.durationMs << "\n";
+    }
+}
+
+void GPUProfiler::writeJSON(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to write the GPU profile to " << path << "\n";
+        return;
+    }
+
+    file << "{\n  \"frames\": [";
+    for (size_t i = 0; i < m_frames.size(); ++i)
+    {
+        const FrameTimes& frame = m_frames[i];
+        file << (i ? "," : "") << "\n    { \"frame\": " << frame.frame << ", \"total_ms\": " << frame.totalMs << ", \"passes\": [";
+
+        for (size_t j = 0; j < frame.passes.size(); ++j)
+        {
+            const PassTime& pass = frame.passes[j];
+            file << (j ? ", " : "") << "{ \"name\": \"" << pass.name << "\", \"depth\": " << pass.depth
+                << ", \"start_ms\": " << pass.startMs << ", \"duration_ms\": " << pass.durationMs << " }";
+        }
+        file << "] }";
+    }
+    file << "\n  ]\n}\n";
+}
+
+void GPUProfiler::destroy()
+{
+    if (m_queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(getRendererPointer()->getDevice(), m_queryPool, nullptr);
+}
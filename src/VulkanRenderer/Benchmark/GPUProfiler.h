@@ -0,0 +1,109 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/*
+ * GPU time of the passes, from timestamp queries around scopes of the frame's
+ * command buffer:
+ *  - beginFrame() resets the slot's queries, then every Scope writes a
+ *    timestamp where it's created and destroyed(nested scopes keep their depth).
+ *    RenderGraph::execute() opens one per pass, the scenes a few inside them.
+ *  - update() reads the slot's last frame when it comes around again(after its
+ *    fence), that is the frames in flight later: the results are there, no wait.
+ * The last Config::GPU_PROFILER_HISTORY_FRAMES frames are kept for the GUI's
+ * graphs and the CSV/JSON exports.
+ * Scopes past Config::GPU_PROFILER_MAX_SCOPES in a frame are dropped. Inside
+ * a render pass a scope must be recorded in the command buffer of its subpass
+ * contents: the primary(INLINE) or the secondary(SECONDARY_COMMAND_BUFFERS).
+ */
+class GPUProfiler
+{
+public:
+    struct PassTime
+    {
+        std::string name;
+        uint32_t    depth = 0;
+        // Milliseconds, the start from the frame's first timestamp.
+        double      startMs = 0.0;
+        double      durationMs = 0.0;
+    };
+
+    struct FrameTimes
+    {
+        uint64_t                frame = 0;
+        // First to last timestamp.
+        double                  totalMs = 0.0;
+        // In recording order.
+        std::vector<PassTime>   passes;
+    };
+
+    // Timestamps around its lifetime(nothing when the profiler is disabled).
+    class Scope
+    {
+    public:
+        Scope(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const std::string& name);
+        ~Scope();
+
+    private:
+        VkCommandBuffer m_commandBuffer;
+        uint32_t        m_frameIndex;
+        int32_t         m_scope;
+    };
+
+    GPUProfiler();
+    ~GPUProfiler() {};
+
+    // Reads the timings of the slot's last frame.
+    void update(const uint32_t frameIndex);
+
+    // First command of the frame, outside of a render pass.
+    void beginFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex);
+
+    // -1 when the scope is dropped.
+    int32_t beginScope(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const std::string& name);
+    void endScope(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const int32_t scope);
+
+    const bool& isEnabled() const                       { return m_isEnabled; }
+    void setEnabled(const bool enabled)                 { m_isEnabled = enabled; }
+    // False when the graphics queue has no timestamps.
+    const bool& isSupported() const                     { return m_isSupported; }
+
+    // Oldest first.
+    const std::deque<FrameTimes>& getFrames() const     { return m_frames; }
+    // Duration of the pass in each frame of getFrames(), 0 where it didn't run.
+    std::vector<float> getHistory(const std::string& name) const;
+
+    // One row per pass and frame / an array of frames.
+    void writeCSV(const std::string& path) const;
+    void writeJSON(const std::string& path) const;
+
+    void destroy();
+
+private:
+    struct ScopeQuery
+    {
+        std::string name;
+        uint32_t    depth;
+    };
+
+    bool                                    m_isEnabled = true;
+    bool                                    m_isSupported = false;
+
+    VkQueryPool                             m_queryPool = VK_NULL_HANDLE;
+    // Nanoseconds per tick.
+    float                                   m_timestampPeriod = 1.0f;
+
+    // Scopes recorded in each slot since it was last read, their queries
+    // are 2 * index(begin) and 2 * index + 1(end) from the slot's first one.
+    std::vector<std::vector<ScopeQuery>>    m_scopes;
+    // Whether the slot's frame began while enabled(its queries were reset).
+    std::vector<bool>                       m_isRecording;
+    uint32_t                                m_depth = 0;
+
+    uint64_t                                m_frameCount = 0;
+    std::deque<FrameTimes>                  m_frames;
+};
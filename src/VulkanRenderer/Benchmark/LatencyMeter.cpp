@@ -0,0 +1,137 @@
+#include "VulkanRenderer/Benchmark/LatencyMeter.h"
+
+#include <algorithm>
+
+#include "VulkanRenderer/Settings/config.h"
+#include "VulkanRenderer/Command/CommandManager.h"
+#include "VulkanRenderer/Benchmark/TimestampQueries.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+LatencyMeter::LatencyMeter() : m_startTime(std::chrono::steady_clock::now())
+{
+    m_isSupported = TimestampQueries::querySupport(m_timestampPeriod);
+
+    m_frames.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+    if (!m_isSupported)
+        return;
+
+    // One per frame slot, the last one for calibrate().
+    m_queryPool = TimestampQueries::createQueryPool(Config::MAX_FRAMES_IN_FLIGHT + 1, "latency");
+
+    calibrate();
+}
+
+double LatencyMeter::now() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+void LatencyMeter::calibrate()
+{
+    if (!m_isSupported)
+        return;
+
+    const VkDevice device = getRendererPointer()->getDevice();
+    const uint32_t query = Config::MAX_FRAMES_IN_FLIGHT;
+
+    VkCommandBuffer commandBuffer = CommandManager::cmdBeginSingleTimeCommands(device, getRendererPointer()->getCommandPool());
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, query, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, query);
+
+    // The timestamp is somewhere between the submission and the end of the wait.
+    const double before = now();
+    CommandManager::cmdEndSingleTimeCommands(device, getRendererPointer()->getGraphicsQueue(), getRendererPointer()->getCommandPool(), commandBuffer);
+    const double after = now();
+
+    uint64_t timestamp = 0;
+    vkGetQueryPoolResults(device, m_queryPool, query, 1, sizeof(timestamp), &timestamp, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+    m_gpuOffset = 0.5 * (before + after) - TimestampQueries::toMilliseconds(timestamp, m_timestampPeriod);
+}
+
+void LatencyMeter::beginFrame(const uint32_t frameIndex, const double inputTime)
+{
+    FrameTimes& frame = m_frames[frameIndex];
+
+    if (frame.isSubmitted)
+    {
+        addTime(m_submitTimes, frame.submit - frame.input);
+        addTime(m_presentTimes, frame.present - frame.input);
+
+        uint64_t timestamp = 0;
+        if (m_isSupported && vkGetQueryPoolResults(getRendererPointer()->getDevice(), m_queryPool, frameIndex, 1, sizeof(timestamp), &timestamp, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+        {
+            m_lastEndToEnd = TimestampQueries::toMilliseconds(timestamp, m_timestampPeriod) + m_gpuOffset - frame.input;
+            addTime(m_endToEndTimes, m_lastEndToEnd);
+        }
+
+        m_frameCount++;
+    }
+
+    frame = FrameTimes();
+    frame.input = inputTime;
+}
+
+void LatencyMeter::writeTimestamp(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex)
+{
+    if (!m_isSupported)
+        return;
+
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, frameIndex, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, frameIndex);
+}
+
+void LatencyMeter::markSubmit(const uint32_t frameIndex)
+{
+    m_frames[frameIndex].submit = now();
+    m_frames[frameIndex].isSubmitted = true;
+}
+
+void LatencyMeter::markPresent(const uint32_t frameIndex)
+{
+    m_frames[frameIndex].present = now();
+}
+
+void LatencyMeter::reset()
+{
+    for (auto& frame : m_frames)
+        frame = FrameTimes();
+
+    m_endToEndTimes.clear();
+    m_submitTimes.clear();
+    m_presentTimes.clear();
+}
+
+void LatencyMeter::addTime(std::deque<double>& times, const double time)
+{
+    times.push_back(time);
+    if (times.size() > Config::LATENCY_HISTORY_FRAMES)
+        times.pop_front();
+}
+
+LatencyMeter::Percentiles LatencyMeter::getPercentiles(const std::deque<double>& times)
+{
+    Percentiles percentiles;
+    if (times.empty())
+        return percentiles;
+
+    std::vector<double> sorted(times.begin(), times.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    const auto at = [&sorted](const double percentile) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(percentile * sorted.size()))];
+    };
+    percentiles.p50 = at(0.5);
+    percentiles.p90 = at(0.9);
+    percentiles.p99 = at(0.99);
+
+    return percentiles;
+}
+
+void LatencyMeter::destroy()
+{
+    if (m_queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(getRendererPointer()->getDevice(), m_queryPool, nullptr);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <chrono>
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Latency of the frames, from the moment their input is sampled(the events
+ * polled before drawFrame()) to:
+ *  - submit: the frame's command buffer was submitted(CPU).
+ *  - GPU: its last command finished, a timestamp query mapped to the CPU
+ *    clock with the offset measured by calibrate().
+ *  - present: vkQueuePresentKHR() returned(CPU).
+ * Input to GPU completion is the end to end latency: the image is handed to
+ * the presentation engine then at the latest, the scanout itself can't be
+ * measured without the present timing extensions.
+ * A slot's frame is collected when its fence was waited on again(beginFrame()),
+ * the query results are there, no wait. The last Config::LATENCY_HISTORY_FRAMES
+ * frames are kept for the percentiles.
+ */
+class LatencyMeter
+{
+public:
+    struct Percentiles
+    {
+        double  p50 = 0.0;
+        double  p90 = 0.0;
+        double  p99 = 0.0;
+    };
+
+    LatencyMeter();
+    ~LatencyMeter() {};
+
+    // Matches the GPU timestamps to the CPU clock, waits for a submission.
+    void calibrate();
+
+    // After the slot's fence: collects its last frame and starts this one.
+    void beginFrame(const uint32_t frameIndex, const double inputTime);
+    // Last command of the frame, outside of a render pass.
+    void writeTimestamp(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex);
+    void markSubmit(const uint32_t frameIndex);
+    void markPresent(const uint32_t frameIndex);
+
+    // Drops the history(the frames in flight changed).
+    void reset();
+
+    // Milliseconds on the meter's CPU clock.
+    double now() const;
+
+    // False when the graphics queue has no timestamps: no GPU/end to end latency.
+    const bool& isSupported() const                     { return m_isSupported; }
+
+    Percentiles getEndToEnd() const                     { return getPercentiles(m_endToEndTimes); }
+    Percentiles getSubmit() const                       { return getPercentiles(m_submitTimes); }
+    Percentiles getPresent() const                      { return getPercentiles(m_presentTimes); }
+    // End to end latency of the last collected frame, and how many were collected.
+    const double& getLastEndToEnd() const               { return m_lastEndToEnd; }
+    const uint64_t& getFrameCount() const               { return m_frameCount; }
+
+    void destroy();
+
+private:
+    struct FrameTimes
+    {
+        double  input = 0.0;
+        double  submit = 0.0;
+        double  present = 0.0;
+        bool    isSubmitted = false;
+    };
+
+    static Percentiles getPercentiles(const std::deque<double>& times);
+    static void addTime(std::deque<double>& times, const double time);
+
+    std::chrono::steady_clock::time_point   m_startTime;
+
+    bool                        m_isSupported = false;
+    VkQueryPool                 m_queryPool = VK_NULL_HANDLE;
+    // Nanoseconds per tick.
+    float                       m_timestampPeriod = 1.0f;
+    // CPU milliseconds of the GPU tick 0.
+    double                      m_gpuOffset = 0.0;
+
+    std::vector<FrameTimes>     m_frames;
+
+    std::deque<double>          m_endToEndTimes;
+    std::deque<double>          m_submitTimes;
+    std::deque<double>          m_presentTimes;
+    double                      m_lastEndToEnd = 0.0;
+    uint64_t                    m_frameCount = 0;
+};
@@ -0,0 +1,37 @@
+#include "VulkanRenderer/Benchmark/TimestampQueries.h"
+
+#include <vector>
+#include <stdexcept>
+
+#include "VulkanRenderer/Renderer.h"
+
+bool TimestampQueries::querySupport(float& outPeriod)
+{
+    const VkPhysicalDevice physicalDevice = getRendererPointer()->getPhysicalDevice();
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    outPeriod = properties.limits.timestampPeriod;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    const uint32_t graphicsFamily = getRendererPointer()->getQueueFamilyIndices().graphicsFamily.value();
+    return queueFamilies[graphicsFamily].timestampValidBits > 0;
+}
+
+VkQueryPool TimestampQueries::createQueryPool(const uint32_t queryCount, const std::string& name)
+{
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = queryCount;
+
+    VkQueryPool queryPool;
+    if (vkCreateQueryPool(getRendererPointer()->getDevice(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create the " + name + " query pool!");
+
+    return queryPool;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Timestamp queries on the graphics queue, shared by the GPU profiler, the
+ * latency meter and the dynamic resolution.
+ */
+namespace TimestampQueries
+{
+    // Nanoseconds per tick, false when the graphics queue has no timestamps.
+    bool querySupport(float& outPeriod);
+
+    // The name goes in the error.
+    VkQueryPool createQueryPool(const uint32_t queryCount, const std::string& name);
+
+    inline double toMilliseconds(const uint64_t ticks, const float period)  { return double(ticks) * period / 1e6; }
+};
@@ -148,12 +148,23 @@ glm::mat4 Camera::getViewMatrix() const
 glm::mat4 Camera::getProjectionMatrix() const
 {
 	//return glm::ortho(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f, 1000.0f);;
-	glm::mat4 proj = glm::perspective(glm::radians(m_Fov), (double)Config::RESOLUTION_W / Config::RESOLUTION_H, m_Near, m_Far);
+	glm::mat4 proj = glm::perspective(glm::radians(m_Fov), m_Aspect, m_Near, m_Far);
 
 	proj[1][1] *= -1;
 	return proj;
 }
 
+//************************************************************************************
+//Function:
+glm::mat4 Camera::getJitteredProjectionMatrix() const
+{
+	glm::mat4 proj = getProjectionMatrix();
+
+	proj[2][0] += m_Jitter.x;
+	proj[2][1] += m_Jitter.y;
+	return proj;
+}
+
 //************************************************************************************
 //Function:
 void Camera::update(float deltatime)
@@ -4,6 +4,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "VulkanRenderer/Settings/config.h"
+
 class Camera
 {
 public:
@@ -19,6 +21,8 @@ public:
 	glm::mat4  getViewMatrix() const;  //not need const reference
 	glm::mat4  getPrevViewMatrix() const;
 	glm::mat4  getProjectionMatrix() const;
+	// Offset by the jitter(TemporalAA), for the passes rendering the scene.
+	glm::mat4  getJitteredProjectionMatrix() const;
 	glm::fvec3 getLookAtPos() const;
 	glm::fvec3 getCameraFront() const;
 	const glm::fvec3& getCameraPos() const;
@@ -30,6 +34,11 @@ public:
 	void setMoveSpeed(double vMoveSpeed) { m_MoveSpeed = vMoveSpeed; }
 	void setFov(double vFov) { m_Fov = vFov; }
 	void setEnableCursor(bool vIsEnableCursor) { m_IsEnableCursor = vIsEnableCursor; }
+	// Width / height of the swapchain.
+	void setAspect(double vAspect) { m_Aspect = vAspect; }
+	double getAspect() const { return m_Aspect; }
+	// Subpixel offset of the projection, in NDC.
+	void setJitter(const glm::vec2& vJitter) { m_Jitter = vJitter; }
 
 private:
 	void processMovement4KeyCallback(int vKey, int vScancode, int vAction, int vMode);
@@ -45,9 +54,11 @@ private:
 	glm::fvec3 m_CameraRight = glm::vec3(0.0);
 	glm::mat4 m_ViewMatrix = glm::mat4();
 	glm::mat4 m_ProjectionMatrix = glm::mat4();
+	glm::vec2 m_Jitter = glm::vec2(0.0);
 	double m_Pitch = 0.0;
 	double m_Yaw = 0.0;
 	double m_Fov = 45.0;
+	double m_Aspect = (double)Config::RESOLUTION_W / Config::RESOLUTION_H;
 	double m_MoveSpeed = 0.005;
 	double m_Sensitivity = 0.2;
 	double m_Near = 0.1;
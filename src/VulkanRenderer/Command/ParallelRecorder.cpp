@@ -0,0 +1,149 @@
+#include "VulkanRenderer/Command/ParallelRecorder.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Command/CommandManager.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+ParallelRecorder::ParallelRecorder(const uint32_t threadCount)
+    : m_threadPool(std::max(threadCount, 1u))
+{
+    m_contexts.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+    for (auto& frameContexts : m_contexts)
+    {
+        frameContexts.resize(m_threadPool.getThreadCount() + 1);
+
+        for (auto& context : frameContexts)
+        {
+            auto status = CommandManager::cmdCreateCommandPool(
+                getRendererPointer()->getDevice(),
+                VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                getRendererPointer()->getQueueFamilyIndices().graphicsFamily.value(),
+                &context.commandPool
+            );
+            if (status != VK_SUCCESS)
+                throw std::runtime_error("Failed to create command pool!");
+        }
+    }
+}
+
+/*
+ * The fence of frameIndex must have been waited on.
+ */
+void ParallelRecorder::beginFrame(const uint32_t frameIndex)
+{
+    for (auto& context : m_contexts[frameIndex])
+    {
+        vkResetCommandPool(getRendererPointer()->getDevice(), context.commandPool, 0);
+        context.usedCount = 0;
+    }
+}
+
+VkCommandBuffer ParallelRecorder::beginSecondary(
+    ThreadContext& context,
+    const VkRenderPass& renderPass,
+    const uint32_t subpass,
+    const VkFramebuffer& framebuffer
+) {
+    if (context.usedCount == context.commandBuffers.size())
+    {
+        VkCommandBuffer commandBuffer;
+        CommandManager::cmdCreateCommandBuffers(getRendererPointer()->getDevice(), context.commandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY, 1, &commandBuffer);
+        context.commandBuffers.push_back(commandBuffer);
+    }
+
+    VkCommandBuffer commandBuffer = context.commandBuffers[context.usedCount++];
+
+    CommandManager::cmdBeginCommandBuffer(
+        getRendererPointer()->getDevice(),
+        renderPass,
+        subpass,
+        framebuffer,
+        commandBuffer,
+        (VkCommandBufferUsageFlagBits)(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT)
+    );
+
+    return commandBuffer;
+}
+
+void ParallelRecorder::record(
+    const VkCommandBuffer& primaryCommandBuffer,
+    const uint32_t frameIndex,
+    const VkRenderPass& renderPass,
+    const uint32_t subpass,
+    const VkFramebuffer& framebuffer,
+    const uint32_t itemCount,
+    const SliceFunc& recordSlice
+) {
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    if (itemCount == 0)
+        return;
+
+    const uint32_t sliceCount = std::min(getSliceCount(), itemCount);
+    const uint32_t sliceSize = (itemCount + sliceCount - 1) / sliceCount;
+
+    std::vector<VkCommandBuffer> secondaries(sliceCount, VK_NULL_HANDLE);
+
+    for (uint32_t slice = 0; slice < sliceCount; ++slice)
+    {
+        const uint32_t begin = slice * sliceSize;
+        const uint32_t end = std::min(begin + sliceSize, itemCount);
+        if (begin >= end)
+            break;
+
+        // One slice per worker context, so no pool is shared between threads.
+        ThreadContext& context = m_contexts[frameIndex][slice];
+
+        m_threadPool.submit([&, slice, begin, end]() {
+#ifdef RELEASE_MODE_ON
+            ZoneScopedN("Record slice");
+#endif
+            VkCommandBuffer commandBuffer = beginSecondary(context, renderPass, subpass, framebuffer);
+            recordSlice(commandBuffer, begin, end, slice);
+            vkEndCommandBuffer(commandBuffer);
+
+            secondaries[slice] = commandBuffer;
+        });
+    }
+
+    m_threadPool.wait();
+
+    secondaries.erase(std::remove(secondaries.begin(), secondaries.end(), VK_NULL_HANDLE), secondaries.end());
+    vkCmdExecuteCommands(primaryCommandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+}
+
+void ParallelRecorder::recordInline(
+    const VkCommandBuffer& primaryCommandBuffer,
+    const uint32_t frameIndex,
+    const VkRenderPass& renderPass,
+    const uint32_t subpass,
+    const VkFramebuffer& framebuffer,
+    const std::function<void(VkCommandBuffer& commandBuffer)>& recordFunc
+) {
+    VkCommandBuffer commandBuffer = beginSecondary(m_contexts[frameIndex].back(), renderPass, subpass, framebuffer);
+    recordFunc(commandBuffer);
+    vkEndCommandBuffer(commandBuffer);
+
+    vkCmdExecuteCommands(primaryCommandBuffer, 1, &commandBuffer);
+}
+
+void ParallelRecorder::destroy()
+{
+    for (auto& frameContexts : m_contexts)
+    {
+        for (auto& context : frameContexts)
+            vkDestroyCommandPool(getRendererPointer()->getDevice(), context.commandPool, nullptr);
+    }
+    m_contexts.clear();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanRenderer/Thread/ThreadPool.h"
+
+/*
+ * Records the content of a subpass into secondary command buffers.
+ *  - Every worker owns one command pool per frame in flight(pools can't be
+ *    used from 2 threads), reset as a whole in beginFrame().
+ *  - record() splits [0, itemCount) in contiguous slices, one per worker,
+ *    and executes the secondaries in slice order so the draw order is kept.
+ *  - recordInline() records on the calling thread, for the few draws of a
+ *    subpass that is already in SECONDARY_COMMAND_BUFFERS mode.
+ */
+class ParallelRecorder
+{
+public:
+    using SliceFunc = std::function<void(const VkCommandBuffer& commandBuffer, const uint32_t begin, const uint32_t end, const uint32_t slice)>;
+
+    ParallelRecorder(const uint32_t threadCount);
+    ~ParallelRecorder() {};
+
+    void beginFrame(const uint32_t frameIndex);
+
+    void record(
+        const VkCommandBuffer& primaryCommandBuffer,
+        const uint32_t frameIndex,
+        const VkRenderPass& renderPass,
+        const uint32_t subpass,
+        const VkFramebuffer& framebuffer,
+        const uint32_t itemCount,
+        const SliceFunc& recordSlice
+    );
+
+    void recordInline(
+        const VkCommandBuffer& primaryCommandBuffer,
+        const uint32_t frameIndex,
+        const VkRenderPass& renderPass,
+        const uint32_t subpass,
+        const VkFramebuffer& framebuffer,
+        const std::function<void(VkCommandBuffer& commandBuffer)>& recordFunc
+    );
+
+    // Upper bound of the slices record() splits the items into.
+    uint32_t getSliceCount() const { return m_threadPool.getThreadCount(); }
+
+    void destroy();
+
+private:
+    struct ThreadContext
+    {
+        VkCommandPool                   commandPool;
+        std::vector<VkCommandBuffer>    commandBuffers;
+        uint32_t                        usedCount = 0;
+    };
+
+    VkCommandBuffer beginSecondary(
+        ThreadContext& context,
+        const VkRenderPass& renderPass,
+        const uint32_t subpass,
+        const VkFramebuffer& framebuffer
+    );
+
+    ThreadPool                                  m_threadPool;
+
+    // [frame][worker], the last one of each frame is the calling thread.
+    std::vector<std::vector<ThreadContext>>     m_contexts;
+};
@@ -0,0 +1,92 @@
+#include "VulkanRenderer/Command/StaticCommandCache.h"
+
+#include <stdexcept>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Command/CommandManager.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+StaticCommandCache::StaticCommandCache()
+{
+    auto status = CommandManager::cmdCreateCommandPool(
+        getRendererPointer()->getDevice(),
+        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        getRendererPointer()->getQueueFamilyIndices().graphicsFamily.value(),
+        &m_commandPool
+    );
+    if (status != VK_SUCCESS)
+        throw std::runtime_error("Failed to create command pool!");
+}
+
+const VkCommandBuffer& StaticCommandCache::get(
+    const uint32_t slot,
+    const uint64_t signature,
+    const VkRenderPass& renderPass,
+    const uint32_t subpass,
+    const VkFramebuffer& framebuffer,
+    const std::function<void(VkCommandBuffer& commandBuffer)>& recordFunc
+) {
+    if (signature != m_signature)
+    {
+        invalidate();
+        m_signature = signature;
+    }
+
+    if (slot >= m_entries.size())
+        m_entries.resize(slot + 1);
+
+    Entry& entry = m_entries[slot];
+    m_wasRecorded = !entry.isValid;
+
+    if (entry.isValid)
+        return entry.commandBuffer;
+
+#ifdef RELEASE_MODE_ON
+    ZoneScopedN("Record static commands");
+#endif
+
+    if (entry.commandBuffer == VK_NULL_HANDLE)
+        CommandManager::cmdCreateCommandBuffers(getRendererPointer()->getDevice(), m_commandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY, 1, &entry.commandBuffer);
+    else
+        vkResetCommandBuffer(entry.commandBuffer, 0);
+
+    CommandManager::cmdBeginCommandBuffer(
+        getRendererPointer()->getDevice(),
+        renderPass,
+        subpass,
+        framebuffer,
+        entry.commandBuffer,
+        (VkCommandBufferUsageFlagBits)(VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT)
+    );
+    recordFunc(entry.commandBuffer);
+    vkEndCommandBuffer(entry.commandBuffer);
+
+    entry.isValid = true;
+    m_recordCount++;
+
+    return entry.commandBuffer;
+}
+
+void StaticCommandCache::invalidate()
+{
+    bool isAnyValid = false;
+    for (auto& entry : m_entries)
+    {
+        isAnyValid |= entry.isValid;
+        entry.isValid = false;
+    }
+
+    // Entries recorded before may still be pending.
+    if (isAnyValid)
+        vkQueueWaitIdle(getRendererPointer()->getGraphicsQueue());
+}
+
+void StaticCommandCache::destroy()
+{
+    vkDestroyCommandPool(getRendererPointer()->getDevice(), m_commandPool, nullptr);
+    m_entries.clear();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Secondary command buffers recorded once per slot(swapchain image, possibly
+ * combined with the frame in flight) and replayed every frame, for draws whose commands don't change between frames(their
+ * per frame data flows through buffers).
+ *
+ * Each entry is tagged with a signature of what it was recorded from(scene
+ * membership, pipeline, framebuffer...). When the signature of a frame
+ * differs, the device is waited on once and every entry becomes stale; each
+ * image then re-records its entry the next time it is drawn. Stale entries are
+ * never submitted, so they are never pending when re-recorded.
+ */
+class StaticCommandCache
+{
+public:
+    StaticCommandCache();
+    ~StaticCommandCache() {};
+
+    // Returns the secondary to execute for slot, recording it first if needed.
+    const VkCommandBuffer& get(
+        const uint32_t slot,
+        const uint64_t signature,
+        const VkRenderPass& renderPass,
+        const uint32_t subpass,
+        const VkFramebuffer& framebuffer,
+        const std::function<void(VkCommandBuffer& commandBuffer)>& recordFunc
+    );
+
+    bool wasRecordedLastCall() const { return m_wasRecorded; }
+    uint32_t getRecordCount() const { return m_recordCount; }
+
+    void invalidate();
+    void destroy();
+
+    // Signature helper(boost style hash combine).
+    static void combine(uint64_t& signature, const uint64_t value)
+    {
+        signature ^= value + 0x9e3779b97f4a7c15ull + (signature << 6) + (signature >> 2);
+    }
+
+private:
+    struct Entry
+    {
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        bool            isValid = false;
+    };
+
+    VkCommandPool           m_commandPool;
+    std::vector<Entry>      m_entries;
+
+    uint64_t                m_signature = 0;
+    bool                    m_wasRecorded = false;
+    uint32_t                m_recordCount = 0;
+};
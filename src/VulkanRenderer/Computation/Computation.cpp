@@ -20,7 +20,7 @@ Computation::Computation(
     const uint32_t& inSize,
     const uint32_t& outSize,
     const QueueFamilyIndices& queueFamilyIndices,
-    VkDescriptorPool& descriptorPool,
+    DescriptorAllocator& descriptorAllocator,
     const std::vector<DescriptorInfo>& bufferInfos
 ) 
 {
@@ -100,7 +100,7 @@ Computation::Computation(
     pipelineInfo.basePipelineHandle = 0;
     pipelineInfo.basePipelineIndex = 0;
 
-    status = vkCreateComputePipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    status = getRendererPointer()->getPipelineCache().createComputePipeline(pipelineInfo, &m_pipeline, "compute " + shaderName);
 
     if (status != VK_SUCCESS)
         throw std::runtime_error("Failed to create compute pipeline!");
@@ -110,7 +110,8 @@ Computation::Computation(
 
 
     //DescriptorSet
-    DescriptorManager::allocDescriptorSet(descriptorPool, m_descriptorSetLayout, &m_descriptorSet);
+    descriptorAllocator.reserve(bufferInfos, 1);
+    descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSet);
 
     VkDescriptorBufferInfo inBuffer = DescriptorManager::descriptorBufferInfo(m_inBuffer);
     VkDescriptorBufferInfo outBuffer = DescriptorManager::descriptorBufferInfo(m_outBuffer);
@@ -6,6 +6,7 @@
 #include <vk_mem_alloc.h>
 
 #include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
 #include "VulkanRenderer/Queue/QueueFamilyIndices.h"
 
 class Computation
@@ -19,7 +20,7 @@ public:
         const uint32_t& inSize,
         const uint32_t& outSize,
         const QueueFamilyIndices& queueFamilyIndices,
-        VkDescriptorPool& descriptorPool,
+        DescriptorAllocator& descriptorAllocator,
         const std::vector<DescriptorInfo>& bufferInfos
     );
     
@@ -0,0 +1,382 @@
+#include "VulkanRenderer/Culling/BVH.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace
+{
+    const uint32_t SAH_BINS_COUNT = 12;
+    const uint32_t MAX_LEAF_PRIMITIVES = 2;
+    // Initial capacity of the traversal stacks, they grow past it.
+    const uint32_t TRAVERSAL_STACK_RESERVE = 64;
+    // Past this depth the build splits at the median: lopsided SAH splits
+    // can't make the tree(and the recursion) as deep as the primitive count.
+    const uint32_t MAX_SAH_DEPTH = 32;
+
+    // Relative cost of visiting a node against testing a primitive.
+    const float TRAVERSAL_COST = 1.0f;
+    const float INTERSECTION_COST = 1.0f;
+
+    // Refits may grow the tree cost up to this factor before a rebuild is requested.
+    const float MAX_REFIT_DEGRADATION = 1.5f;
+}
+
+void BVH::clear()
+{
+    m_nodes.clear();
+    m_primitives.clear();
+    m_primitiveSlots.clear();
+    m_primitiveLeaves.clear();
+    m_dirtyLeaves.clear();
+    m_builtSAHCost = 0.0f;
+    m_currentSAHCost = 0.0f;
+}
+
+void BVH::build(const std::vector<BVHPrimitive>& primitives)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    clear();
+
+    m_primitives = primitives;
+    if (!m_primitives.empty())
+    {
+        m_nodes.reserve(2 * m_primitives.size());
+        m_primitiveLeaves.resize(m_primitives.size(), -1);
+
+        buildRecursive(-1, 0, static_cast<uint32_t>(m_primitives.size()), 0);
+
+        for (uint32_t i = 0; i < m_primitives.size(); ++i)
+            m_primitiveSlots[m_primitives[i].id] = i;
+
+        m_builtSAHCost = computeSAHCost();
+        m_currentSAHCost = m_builtSAHCost;
+    }
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_lastBuildTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+/*
+ * Binned SAH split along the largest axis of the centroids' bounds. Falls back
+ * to a median split when every candidate is worse than keeping a leaf but the
+ * range is still too big for one, and always past MAX_SAH_DEPTH.
+ */
+int32_t BVH::buildRecursive(const int32_t parent, const uint32_t begin, const uint32_t end, const uint32_t depth)
+{
+    const int32_t nodeIndex = static_cast<int32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes[nodeIndex].parent = parent;
+
+    AxisAlignedBox bounds;
+    AxisAlignedBox centroidBounds;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        bounds.merge(m_primitives[i].bounds);
+        centroidBounds.merge(m_primitives[i].bounds.getCenter());
+    }
+    m_nodes[nodeIndex].bounds = bounds;
+
+    const uint32_t count = end - begin;
+
+    auto makeLeaf = [&]()
+    {
+        m_nodes[nodeIndex].firstPrimitive = begin;
+        m_nodes[nodeIndex].primitiveCount = count;
+        for (uint32_t i = begin; i < end; ++i)
+            m_primitiveLeaves[i] = nodeIndex;
+        return nodeIndex;
+    };
+
+    if (count <= MAX_LEAF_PRIMITIVES)
+        return makeLeaf();
+
+    const glm::fvec3 centroidExtent = centroidBounds.getExtent();
+    int axis = 0;
+    if (centroidExtent.y > centroidExtent[axis]) axis = 1;
+    if (centroidExtent.z > centroidExtent[axis]) axis = 2;
+
+    uint32_t mid = begin + count / 2;
+
+    if (centroidExtent[axis] <= 0.0f || depth >= MAX_SAH_DEPTH)
+    {
+        // All centroids overlap, any partition is as good as another(or too deep for SAH).
+        std::nth_element(m_primitives.begin() + begin, m_primitives.begin() + mid, m_primitives.begin() + end,
+            [axis](const BVHPrimitive& a, const BVHPrimitive& b) { return a.bounds.getCenter()[axis] < b.bounds.getCenter()[axis]; });
+    }
+    else
+    {
+        struct Bin
+        {
+            AxisAlignedBox  bounds;
+            uint32_t        count = 0;
+        };
+        std::array<Bin, SAH_BINS_COUNT> bins{};
+
+        const float binScale = SAH_BINS_COUNT / centroidExtent[axis];
+        auto binIndexOf = [&](const BVHPrimitive& primitive)
+        {
+            uint32_t index = static_cast<uint32_t>((primitive.bounds.getCenter()[axis] - centroidBounds.min[axis]) * binScale);
+            return std::min(index, SAH_BINS_COUNT - 1);
+        };
+
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            Bin& bin = bins[binIndexOf(m_primitives[i])];
+            bin.bounds.merge(m_primitives[i].bounds);
+            bin.count++;
+        }
+
+        // Sweep from the right to get the cost of every split plane in O(bins).
+        std::array<float, SAH_BINS_COUNT - 1> rightAreas{};
+        std::array<uint32_t, SAH_BINS_COUNT - 1> rightCounts{};
+        {
+            AxisAlignedBox accum;
+            uint32_t accumCount = 0;
+            for (uint32_t i = SAH_BINS_COUNT - 1; i > 0; --i)
+            {
+                accum.merge(bins[i].bounds);
+                accumCount += bins[i].count;
+                rightAreas[i - 1] = accum.getHalfArea();
+                rightCounts[i - 1] = accumCount;
+            }
+        }
+
+        float bestCost = std::numeric_limits<float>::max();
+        uint32_t bestSplit = 0;
+        {
+            AxisAlignedBox accum;
+            uint32_t accumCount = 0;
+            for (uint32_t i = 0; i < SAH_BINS_COUNT - 1; ++i)
+            {
+                accum.merge(bins[i].bounds);
+                accumCount += bins[i].count;
+
+                if (accumCount == 0 || rightCounts[i] == 0)
+                    continue;
+
+                const float cost = accum.getHalfArea() * accumCount + rightAreas[i] * rightCounts[i];
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        const float parentArea = bounds.getHalfArea();
+        const float leafCost = INTERSECTION_COST * count;
+        const float splitCost = TRAVERSAL_COST + INTERSECTION_COST * (parentArea > 0.0f ? bestCost / parentArea : 0.0f);
+
+        if (splitCost < leafCost && bestCost < std::numeric_limits<float>::max())
+        {
+            auto it = std::partition(m_primitives.begin() + begin, m_primitives.begin() + end,
+                [&](const BVHPrimitive& primitive) { return binIndexOf(primitive) <= bestSplit; });
+            mid = static_cast<uint32_t>(it - m_primitives.begin());
+        }
+        else
+        {
+            std::nth_element(m_primitives.begin() + begin, m_primitives.begin() + mid, m_primitives.begin() + end,
+                [axis](const BVHPrimitive& a, const BVHPrimitive& b) { return a.bounds.getCenter()[axis] < b.bounds.getCenter()[axis]; });
+        }
+
+        if (mid == begin || mid == end)
+            mid = begin + count / 2;
+    }
+
+    const int32_t left = buildRecursive(nodeIndex, begin, mid, depth + 1);
+    const int32_t right = buildRecursive(nodeIndex, mid, end, depth + 1);
+    m_nodes[nodeIndex].left = left;
+    m_nodes[nodeIndex].right = right;
+
+    return nodeIndex;
+}
+
+float BVH::computeSAHCost() const
+{
+    if (m_nodes.empty())
+        return 0.0f;
+
+    const float rootArea = m_nodes[0].bounds.getHalfArea();
+    if (rootArea <= 0.0f)
+        return 0.0f;
+
+    float cost = 0.0f;
+    for (const Node& node : m_nodes)
+    {
+        const float relativeArea = node.bounds.getHalfArea() / rootArea;
+        cost += relativeArea * (node.isLeaf() ? INTERSECTION_COST * node.primitiveCount : TRAVERSAL_COST);
+    }
+    return cost;
+}
+
+bool BVH::updatePrimitive(const uint32_t id, const AxisAlignedBox& bounds)
+{
+    auto iter = m_primitiveSlots.find(id);
+    if (iter == m_primitiveSlots.end())
+        return false;
+
+    m_primitives[iter->second].bounds = bounds;
+    m_dirtyLeaves.push_back(m_primitiveLeaves[iter->second]);
+    return true;
+}
+
+void BVH::refit()
+{
+    if (m_dirtyLeaves.empty())
+        return;
+
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (int32_t leaf : m_dirtyLeaves)
+    {
+        Node& leafNode = m_nodes[leaf];
+        leafNode.bounds = AxisAlignedBox();
+        for (uint32_t i = 0; i < leafNode.primitiveCount; ++i)
+            leafNode.bounds.merge(m_primitives[leafNode.firstPrimitive + i].bounds);
+
+        int32_t nodeIndex = leafNode.parent;
+        while (nodeIndex != -1)
+        {
+            Node& node = m_nodes[nodeIndex];
+            AxisAlignedBox newBounds = m_nodes[node.left].bounds;
+            newBounds.merge(m_nodes[node.right].bounds);
+            node.bounds = newBounds;
+            nodeIndex = node.parent;
+        }
+    }
+    m_dirtyLeaves.clear();
+
+    m_currentSAHCost = computeSAHCost();
+
+    const auto endTime = std::chrono::high_resolution_clock::now();
+    m_lastRefitTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+bool BVH::needsRebuild() const
+{
+    return m_currentSAHCost > m_builtSAHCost * MAX_REFIT_DEGRADATION;
+}
+
+template<typename Overlaps>
+void BVH::collect(Overlaps overlaps, std::vector<uint32_t>& outIds) const
+{
+    if (m_nodes.empty())
+        return;
+
+    std::vector<int32_t> stack;
+    stack.reserve(TRAVERSAL_STACK_RESERVE);
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (!overlaps(node.bounds))
+            continue;
+
+        if (node.isLeaf())
+        {
+            for (uint32_t i = 0; i < node.primitiveCount; ++i)
+            {
+                const BVHPrimitive& primitive = m_primitives[node.firstPrimitive + i];
+                if (overlaps(primitive.bounds))
+                    outIds.push_back(primitive.id);
+            }
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& outIds) const
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+    collect([&frustum](const AxisAlignedBox& box) { return BoundingVolumes::intersectsFrustum(frustum, box); }, outIds);
+}
+
+void BVH::querySphere(const BoundingSphere& sphere, std::vector<uint32_t>& outIds) const
+{
+    collect([&sphere](const AxisAlignedBox& box) { return BoundingVolumes::intersectsSphere(sphere, box); }, outIds);
+}
+
+/*
+ * Closest hit against the primitives' boxes. Children are visited near first
+ * so that farther subtrees are usually rejected by the current closest t.
+ */
+bool BVH::queryRay(const Ray& ray, uint32_t& outId, float& outT) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    const glm::fvec3 invDirection = 1.0f / ray.direction;
+
+    float closestT = std::numeric_limits<float>::max();
+    bool hit = false;
+
+    std::vector<int32_t> stack;
+    stack.reserve(TRAVERSAL_STACK_RESERVE);
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        float tEnter;
+        if (!BoundingVolumes::intersectsRay(ray, invDirection, node.bounds, closestT, tEnter))
+            continue;
+
+        if (node.isLeaf())
+        {
+            for (uint32_t i = 0; i < node.primitiveCount; ++i)
+            {
+                const BVHPrimitive& primitive = m_primitives[node.firstPrimitive + i];
+                if (BoundingVolumes::intersectsRay(ray, invDirection, primitive.bounds, closestT, tEnter))
+                {
+                    closestT = tEnter;
+                    outId = primitive.id;
+                    hit = true;
+                }
+            }
+        }
+        else
+        {
+            float tLeft = std::numeric_limits<float>::max();
+            float tRight = std::numeric_limits<float>::max();
+            const bool hitLeft = BoundingVolumes::intersectsRay(ray, invDirection, m_nodes[node.left].bounds, closestT, tLeft);
+            const bool hitRight = BoundingVolumes::intersectsRay(ray, invDirection, m_nodes[node.right].bounds, closestT, tRight);
+
+            // Pushed last means popped first.
+            if (hitLeft && hitRight)
+            {
+                stack.push_back(tLeft < tRight ? node.right : node.left);
+                stack.push_back(tLeft < tRight ? node.left : node.right);
+            }
+            else if (hitLeft)
+                stack.push_back(node.left);
+            else if (hitRight)
+                stack.push_back(node.right);
+        }
+    }
+
+    if (hit)
+        outT = closestT;
+    return hit;
+}
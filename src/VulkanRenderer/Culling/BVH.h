@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+
+struct BVHPrimitive
+{
+    uint32_t        id;
+    AxisAlignedBox  bounds;
+};
+
+/*
+ * Bounding volume hierarchy over world space boxes.
+ *  - build() : binned SAH build, O(n log n).
+ *  - refit() : only walks the ancestors of the primitives updated since the
+ *              last refit, so moving k objects costs O(k log n).
+ * When refits degrade the tree too much(see needsRebuild) the owner should
+ * call build() again.
+ */
+class BVH
+{
+public:
+    BVH() {};
+    ~BVH() {};
+
+    void build(const std::vector<BVHPrimitive>& primitives);
+    void clear();
+
+    bool updatePrimitive(const uint32_t id, const AxisAlignedBox& bounds);
+    void refit();
+
+    bool needsRebuild() const;
+
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& outIds) const;
+    void querySphere(const BoundingSphere& sphere, std::vector<uint32_t>& outIds) const;
+    bool queryRay(const Ray& ray, uint32_t& outId, float& outT) const;
+
+    bool isEmpty() const                        { return m_nodes.empty(); }
+    // Bounds of every primitive(invalid when empty).
+    AxisAlignedBox getBounds() const            { return m_nodes.empty() ? AxisAlignedBox() : m_nodes[0].bounds; }
+    size_t getPrimitiveCount() const            { return m_primitives.size(); }
+    size_t getNodeCount() const                 { return m_nodes.size(); }
+    const double& getLastBuildTimeMs() const    { return m_lastBuildTimeMs; }
+    const double& getLastRefitTimeMs() const    { return m_lastRefitTimeMs; }
+
+private:
+    struct Node
+    {
+        AxisAlignedBox  bounds;
+        int32_t         parent = -1;
+        int32_t         left = -1;
+        int32_t         right = -1;
+        uint32_t        firstPrimitive = 0;
+        uint32_t        primitiveCount = 0;
+
+        bool isLeaf() const { return primitiveCount > 0; }
+    };
+
+    int32_t buildRecursive(const int32_t parent, const uint32_t begin, const uint32_t end, const uint32_t depth);
+    float computeSAHCost() const;
+
+    template<typename Overlaps>
+    void collect(Overlaps overlaps, std::vector<uint32_t>& outIds) const;
+
+    std::vector<Node>                       m_nodes;
+    std::vector<BVHPrimitive>               m_primitives;
+
+    // id -> slot in m_primitives
+    std::unordered_map<uint32_t, uint32_t>  m_primitiveSlots;
+    // slot in m_primitives -> leaf node
+    std::vector<int32_t>                    m_primitiveLeaves;
+    std::vector<int32_t>                    m_dirtyLeaves;
+
+    float                                   m_builtSAHCost = 0.0f;
+    float                                   m_currentSAHCost = 0.0f;
+
+    double                                  m_lastBuildTimeMs = 0.0;
+    double                                  m_lastRefitTimeMs = 0.0;
+};
@@ -0,0 +1,404 @@
+#include "VulkanRenderer/Culling/ClusteredLights.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Settings/ComputePipelineConfig.h"
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+#include "VulkanRenderer/Model/ModelManager.h"
+#include "VulkanRenderer/RenderResource.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+ClusteredLights::ClusteredLights() : m_binningWorker(1)
+{
+    createStressLights();
+    createBuffers();
+    createPipeline();
+    createDescriptorSets();
+}
+
+/*
+ * Dim point lights(a few meters of influence) at random positions inside the
+ * scene's bounds, always the same ones.
+ */
+void ClusteredLights::createStressLights()
+{
+    if (Config::STRESS_TEST_LIGHTS == 0)
+        return;
+
+    AxisAlignedBox sceneBounds;
+    for (auto& ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+            sceneBounds.merge(BoundingVolumes::transformBox(getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh->boundingBox, ptr->getModelMatrix()));
+    }
+
+    if (!sceneBounds.isValid())
+        return;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for (uint32_t i = 0; i < Config::STRESS_TEST_LIGHTS; ++i)
+    {
+        LightInfo info{};
+        info.pos = sceneBounds.min + glm::fvec3(unit(generator), unit(generator), unit(generator)) * sceneBounds.getExtent();
+        info.m_color = glm::fvec3(unit(generator), unit(generator), unit(generator));
+        info.m_intensity = 0.2f;
+        info.m_lightType = LightType::POINT_LIGHT;
+
+        GPULight light{};
+        light.pos = glm::vec4(info.pos, 1.0f);
+        light.color = glm::vec4(info.m_color, 1.0f);
+        light.radius = getRenderResource()->getLightInfluenceRadius(info);
+        light.intensity = info.m_intensity;
+        light.type = static_cast<int>(info.m_lightType);
+
+        m_stressLights.push_back(light);
+    }
+}
+
+void ClusteredLights::createBuffers()
+{
+    const VkDeviceSize clusterCount = getClusterCount();
+
+    m_paramsBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_paramsAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_lightBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_lightAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_countBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_countAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_indexBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_indexAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_countStagingBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_countStagingAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_indexStagingBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_indexStagingAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_isBinnedOnCPU.resize(Config::MAX_FRAMES_IN_FLIGHT, false);
+
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(ClusterParams),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_paramsBuffers[i],
+            &m_paramsAllocations[i]
+        );
+
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            Config::MAX_LIGHTS * sizeof(GPULight),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_lightBuffers[i],
+            &m_lightAllocations[i]
+        );
+
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            clusterCount * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY,
+            &m_countBuffers[i],
+            &m_countAllocations[i]
+        );
+
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            clusterCount * Config::MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY,
+            &m_indexBuffers[i],
+            &m_indexAllocations[i]
+        );
+
+        // CPU binning
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            clusterCount * sizeof(uint32_t),
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_CPU_ONLY,
+            &m_countStagingBuffers[i],
+            &m_countStagingAllocations[i]
+        );
+
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            clusterCount * Config::MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t),
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_CPU_ONLY,
+            &m_indexStagingBuffers[i],
+            &m_indexStagingAllocations[i]
+        );
+    }
+}
+
+void ClusteredLights::createPipeline()
+{
+    const std::vector<DescriptorInfo>& bufferInfos = COMPUTE_PIPELINE::LIGHT_CLUSTERING::BUFFERS_INFO;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings(bufferInfos.size());
+    for (uint32_t i = 0; i < bufferInfos.size(); i++)
+    {
+        bindings[i].binding = bufferInfos[i].bindingNumber;
+        bindings[i].descriptorType = bufferInfos[i].descriptorType;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = bufferInfos[i].shaderStage;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    auto status = vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_descriptorSetLayout);
+    if (status != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor set layout!");
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+    status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+    if (status != VK_SUCCESS)
+        throw std::runtime_error("Failed to create pipeline layout!");
+
+    ComputePipelineDesc desc;
+    desc.name = "light clustering";
+    desc.shader = { shaderType::COMPUTE, "clusterLights" };
+    desc.layout = m_pipelineLayout;
+
+    getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
+}
+
+void ClusteredLights::createDescriptorSets()
+{
+    m_descriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    getRendererPointer()->getDescriptorAllocator().reserve(COMPUTE_PIPELINE::LIGHT_CLUSTERING::BUFFERS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        getRendererPointer()->getDescriptorAllocator().allocate(m_descriptorSetLayout, &m_descriptorSets[i]);
+
+        VkDescriptorBufferInfo paramsInfo = DescriptorManager::descriptorBufferInfo(m_paramsBuffers[i]);
+        VkDescriptorBufferInfo lightsInfo = DescriptorManager::descriptorBufferInfo(m_lightBuffers[i]);
+        VkDescriptorBufferInfo countsInfo = DescriptorManager::descriptorBufferInfo(m_countBuffers[i]);
+        VkDescriptorBufferInfo indicesInfo = DescriptorManager::descriptorBufferInfo(m_indexBuffers[i]);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(m_descriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &paramsInfo),
+            DescriptorManager::writeDescriptorSet(m_descriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &lightsInfo),
+            DescriptorManager::writeDescriptorSet(m_descriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, &countsInfo),
+            DescriptorManager::writeDescriptorSet(m_descriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &indicesInfo),
+        };
+        vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+}
+
+uint32_t ClusteredLights::getClusterCount() const
+{
+    return Config::CLUSTER_GRID_X * Config::CLUSTER_GRID_Y * Config::CLUSTER_GRID_Z;
+}
+
+void ClusteredLights::update(const VkExtent2D& extent, const uint32_t frameIndex)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    const Camera& camera = getRenderResource()->m_camera;
+
+    // Directional lights first: the shaders shade them all, only the others are binned.
+    m_lights.clear();
+    m_params.directionalLightsCount = 0;
+    for (const bool directional : { true, false })
+    {
+        for (auto& info : getRenderResource()->m_lightsInfo)
+        {
+            if ((info.m_lightType == LightType::DIRECTIONAL_LIGHT) != directional)
+                continue;
+
+            GPULight light{};
+            light.pos = glm::vec4(info.pos, 1.0f);
+            light.color = glm::vec4(info.m_color, 1.0f);
+            light.dir = glm::vec4(info.m_targetPos - info.pos, 1.0f);
+            light.radius = directional ? 0.0f : getRenderResource()->getLightInfluenceRadius(info);
+            light.intensity = info.m_intensity;
+            light.type = static_cast<int>(info.m_lightType);
+
+            m_lights.push_back(light);
+            if (directional)
+                m_params.directionalLightsCount = static_cast<uint32_t>(m_lights.size());
+        }
+    }
+    m_lights.insert(m_lights.end(), m_stressLights.begin(), m_stressLights.end());
+    m_lights.resize(std::min(static_cast<uint32_t>(m_lights.size()), Config::MAX_LIGHTS));
+
+    m_params.view = camera.getViewMatrix();
+    m_params.invProj = glm::inverse(camera.getProjectionMatrix());
+    m_params.gridSize = glm::uvec4(Config::CLUSTER_GRID_X, Config::CLUSTER_GRID_Y, Config::CLUSTER_GRID_Z, Config::MAX_LIGHTS_PER_CLUSTER);
+    m_params.attenuation = glm::vec4(Config::LIGHT_ATTENUATION_CONSTANT, Config::LIGHT_ATTENUATION_LINEAR, Config::LIGHT_ATTENUATION_QUADRATIC, 0.0f);
+    m_params.screenSize = glm::vec2(extent.width, extent.height);
+    m_params.zNear = static_cast<float>(camera.getCameraNear());
+    m_params.zFar = static_cast<float>(camera.getCameraFar());
+    m_params.lightsCount = getLightCount();
+    m_params.directionalLightsCount = std::min(m_params.directionalLightsCount, m_params.lightsCount);
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_paramsAllocations[frameIndex], &data);
+    memcpy(data, &m_params, sizeof(m_params));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_paramsAllocations[frameIndex]);
+
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_lightAllocations[frameIndex], &data);
+    memcpy(data, m_lights.data(), m_lights.size() * sizeof(GPULight));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_lightAllocations[frameIndex]);
+
+    // The staging buffers of this frame are no longer in use(frame's fence),
+    // m_params and m_lights aren't modified until build() has waited.
+    m_isBinnedOnCPU[frameIndex] = m_isCPUBinningEnabled;
+    if (m_isCPUBinningEnabled)
+    {
+        m_binningWorker.submit([this, frameIndex]()
+        {
+            binReference(m_params, m_lights, m_binnedCounts, m_binnedIndices);
+
+            void* data;
+            vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_countStagingAllocations[frameIndex], &data);
+            memcpy(data, m_binnedCounts.data(), m_binnedCounts.size() * sizeof(uint32_t));
+            vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_countStagingAllocations[frameIndex]);
+
+            vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_indexStagingAllocations[frameIndex], &data);
+            memcpy(data, m_binnedIndices.data(), m_binnedIndices.size() * sizeof(uint32_t));
+            vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_indexStagingAllocations[frameIndex]);
+        });
+    }
+}
+
+void ClusteredLights::build(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex)
+{
+    if (m_isBinnedOnCPU[frameIndex])
+    {
+        m_binningWorker.wait();
+
+        VkBufferCopy countRegion{ 0, 0, m_binnedCounts.size() * sizeof(uint32_t) };
+        vkCmdCopyBuffer(commandBuffer, m_countStagingBuffers[frameIndex], m_countBuffers[frameIndex], 1, &countRegion);
+
+        VkBufferCopy indexRegion{ 0, 0, m_binnedIndices.size() * sizeof(uint32_t) };
+        vkCmdCopyBuffer(commandBuffer, m_indexStagingBuffers[frameIndex], m_indexBuffers[frameIndex], 1, &indexRegion);
+
+        VkMemoryBarrier copyBarrier{};
+        copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        copyBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+        return;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &m_descriptorSets[frameIndex], 0, nullptr);
+
+    const uint32_t groupSize = COMPUTE_PIPELINE::LIGHT_CLUSTERING::WORKGROUP_SIZE;
+    vkCmdDispatch(commandBuffer, (getClusterCount() + groupSize - 1) / groupSize, 1, 1);
+
+    VkMemoryBarrier listsBarrier{};
+    listsBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    listsBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    listsBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 1, &listsBarrier, 0, nullptr, 0, nullptr);
+}
+
+uint32_t ClusteredLights::binReference(const ClusterParams& params, const std::vector<GPULight>& lights, std::vector<uint32_t>& outCounts, std::vector<uint32_t>& outIndices)
+{
+    const glm::uvec3 gridSize = glm::uvec3(params.gridSize);
+    const uint32_t clusterCount = gridSize.x * gridSize.y * gridSize.z;
+    const uint32_t lightsCount = std::min(params.lightsCount, static_cast<uint32_t>(lights.size()));
+
+    outCounts.assign(clusterCount, 0);
+    outIndices.assign(clusterCount * params.gridSize.w, 0);
+
+    // View space lights, the same for every cluster.
+    std::vector<BoundingSphere> spheres(lightsCount);
+    for (uint32_t i = params.directionalLightsCount; i < lightsCount; ++i)
+        spheres[i] = { glm::fvec3(params.view * glm::vec4(glm::fvec3(lights[i].pos), 1.0f)), lights[i].radius };
+
+    auto screenToView = [&](const glm::vec2& ndc)
+    {
+        const glm::vec4 position = params.invProj * glm::vec4(ndc, 1.0f, 1.0f);
+        return glm::fvec3(position) / position.w;
+    };
+
+    uint32_t total = 0;
+    for (uint32_t clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex)
+    {
+        const glm::uvec3 cluster(
+            clusterIndex % gridSize.x,
+            (clusterIndex / gridSize.x) % gridSize.y,
+            clusterIndex / (gridSize.x * gridSize.y)
+        );
+
+        const glm::vec2 tileSize = 2.0f / glm::vec2(gridSize);
+        const glm::fvec3 cornerMin = screenToView(glm::vec2(cluster) * tileSize - 1.0f);
+        const glm::fvec3 cornerMax = screenToView(glm::vec2(glm::uvec2(cluster) + 1u) * tileSize - 1.0f);
+
+        const float depthRatio = params.zFar / params.zNear;
+        const float sliceNear = params.zNear * std::pow(depthRatio, float(cluster.z) / float(gridSize.z));
+        const float sliceFar = params.zNear * std::pow(depthRatio, float(cluster.z + 1) / float(gridSize.z));
+
+        AxisAlignedBox bounds;
+        bounds.merge(cornerMin * (sliceNear / -cornerMin.z));
+        bounds.merge(cornerMin * (sliceFar / -cornerMin.z));
+        bounds.merge(cornerMax * (sliceNear / -cornerMax.z));
+        bounds.merge(cornerMax * (sliceFar / -cornerMax.z));
+
+        const uint32_t firstSlot = clusterIndex * params.gridSize.w;
+        uint32_t& count = outCounts[clusterIndex];
+
+        for (uint32_t i = params.directionalLightsCount; i < lightsCount && count < params.gridSize.w; ++i)
+        {
+            if (BoundingVolumes::intersectsSphere(spheres[i], bounds))
+                outIndices[firstSlot + count++] = i;
+        }
+
+        total += count;
+    }
+
+    return total;
+}
+
+void ClusteredLights::destroy()
+{
+    m_binningWorker.wait();
+
+    VmaAllocator allocator = getRendererPointer()->getVmaAllocator();
+
+    for (uint32_t i = 0; i < m_paramsBuffers.size(); ++i)
+    {
+        vmaDestroyBuffer(allocator, m_paramsBuffers[i], m_paramsAllocations[i]);
+        vmaDestroyBuffer(allocator, m_lightBuffers[i], m_lightAllocations[i]);
+        vmaDestroyBuffer(allocator, m_countBuffers[i], m_countAllocations[i]);
+        vmaDestroyBuffer(allocator, m_indexBuffers[i], m_indexAllocations[i]);
+        vmaDestroyBuffer(allocator, m_countStagingBuffers[i], m_countStagingAllocations[i]);
+        vmaDestroyBuffer(allocator, m_indexStagingBuffers[i], m_indexStagingAllocations[i]);
+    }
+
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
+}
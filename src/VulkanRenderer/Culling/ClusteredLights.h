@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "VulkanRenderer/Descriptor/DescriptorTypes.h"
+#include "VulkanRenderer/Thread/ThreadPool.h"
+
+// std430 light, same layout as the lights UBO used to have.
+using GPULight = DescriptorTypes::UniformBufferObject::LightInfo;
+
+// Layout must match clusteredLights.glsl(std140).
+struct ClusterParams
+{
+    glm::mat4   view;
+    glm::mat4   invProj;
+    glm::uvec4  gridSize;       // w = max lights per cluster
+    glm::vec4   attenuation;    // constant, linear, quadratic(Config::LIGHT_ATTENUATION_*)
+    glm::vec2   screenSize;
+    float       zNear;
+    float       zFar;
+    uint32_t    lightsCount;
+    uint32_t    directionalLightsCount;
+};
+
+/*
+ * Clustered light culling:
+ *  - The camera frustum is split in a 3D grid of clusters(froxels), screen
+ *    tiles times exponential depth slices between the camera near and far.
+ *  - update() uploads the scene lights to a storage buffer, directional
+ *    lights first, with the radius their influence ends at.
+ *  - build() runs clusterLights.comp, which lists the point and spot lights
+ *    touching each cluster(at most Config::MAX_LIGHTS_PER_CLUSTER).
+ *  - With CPU binning, update() hands the lists to a worker thread instead
+ *    (binReference(), written to staging buffers) and build() waits for it
+ *    and copies them: the GPU doesn't spend time on the binning.
+ * Shaders include clusteredLights.glsl, shade the directional lights and only
+ * the lights of their cluster: the cost per pixel no longer grows with the
+ * scene's light count.
+ */
+class ClusteredLights
+{
+public:
+    ClusteredLights();
+    ~ClusteredLights() {};
+
+    void update(const VkExtent2D& extent, const uint32_t frameIndex);
+    // Must be recorded outside of a render pass.
+    void build(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex);
+
+    // Set 1 of the pipelines shading with the clusters(fragment stage).
+    const VkDescriptorSetLayout& getDescriptorSetLayout() const         { return m_descriptorSetLayout; }
+    const VkDescriptorSet& getDescriptorSet(const uint32_t frameIndex) const { return m_descriptorSets[frameIndex]; }
+    uint32_t getLightCount() const                                      { return static_cast<uint32_t>(m_lights.size()); }
+    // Lights of the last update(), in the order the shaders index them.
+    const std::vector<GPULight>& getLights() const                      { return m_lights; }
+    uint32_t getClusterCount() const;
+
+    // Takes effect with the next update().
+    const bool& isCPUBinningEnabled() const                             { return m_isCPUBinningEnabled; }
+    void setCPUBinningEnabled(const bool enabled)                       { m_isCPUBinningEnabled = enabled; }
+
+    // CPU reference of clusterLights.comp, returns the number of listed lights.
+    // outIndices has params.gridSize.w slots per cluster.
+    static uint32_t binReference(const ClusterParams& params, const std::vector<GPULight>& lights, std::vector<uint32_t>& outCounts, std::vector<uint32_t>& outIndices);
+
+    void destroy();
+
+private:
+    void createStressLights();
+    void createBuffers();
+    void createPipeline();
+    void createDescriptorSets();
+
+    VkPipeline                      m_pipeline;
+    VkPipelineLayout                m_pipelineLayout;
+    VkDescriptorSetLayout           m_descriptorSetLayout;
+    std::vector<VkDescriptorSet>    m_descriptorSets;
+
+    ClusterParams                   m_params{};
+    std::vector<GPULight>           m_lights;
+    // Extra point lights scattered over the scene(Config::STRESS_TEST_LIGHTS).
+    std::vector<GPULight>           m_stressLights;
+
+    std::vector<VkBuffer>           m_paramsBuffers;
+    std::vector<VmaAllocation>      m_paramsAllocations;
+    std::vector<VkBuffer>           m_lightBuffers;
+    std::vector<VmaAllocation>      m_lightAllocations;
+    std::vector<VkBuffer>           m_countBuffers;
+    std::vector<VmaAllocation>      m_countAllocations;
+    std::vector<VkBuffer>           m_indexBuffers;
+    std::vector<VmaAllocation>      m_indexAllocations;
+
+    // CPU binning: lists written by the worker, copied to the buffers above.
+    bool                            m_isCPUBinningEnabled = false;
+    std::vector<bool>               m_isBinnedOnCPU;
+    ThreadPool                      m_binningWorker;
+    std::vector<uint32_t>           m_binnedCounts;
+    std::vector<uint32_t>           m_binnedIndices;
+    std::vector<VkBuffer>           m_countStagingBuffers;
+    std::vector<VmaAllocation>      m_countStagingAllocations;
+    std::vector<VkBuffer>           m_indexStagingBuffers;
+    std::vector<VmaAllocation>      m_indexStagingAllocations;
+};
@@ -0,0 +1,455 @@
+#include "VulkanRenderer/Culling/GPUCulling.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Settings/ComputePipelineConfig.h"
+#include "VulkanRenderer/Command/CommandManager.h"
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Pipeline/PipelineManager.h"
+#include "VulkanRenderer/Shader/ShaderManager.h"
+#include "VulkanRenderer/Model/ModelManager.h"
+#include "VulkanRenderer/RenderResource.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+GPUCulling::GPUCulling()
+{
+    createPooledGeometry();
+    createObjectBuffers();
+    createPipeline();
+
+    if (getRendererPointer()->isDeviceExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+    {
+        m_cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(getRendererPointer()->getDevice(), "vkCmdDrawIndexedIndirectCountKHR")
+        );
+    }
+}
+
+/*
+ * Copies the (already uploaded) per mesh buffers into one vertex and one index
+ * buffer, so a single bind covers every object.
+ */
+void GPUCulling::createPooledGeometry()
+{
+    VkDeviceSize verticesSize = 0;
+    VkDeviceSize indicesSize = 0;
+
+    for (auto& ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+
+            GPUObjectData object{};
+            object.firstIndex = static_cast<uint32_t>(indicesSize / sizeof(uint32_t));
+            object.indexCount = meshInfo->meshIndexCount;
+            object.vertexOffset = static_cast<int32_t>(verticesSize / sizeof(MeshVertex));
+            object.objectIndex = static_cast<uint32_t>(m_objects.size());
+
+            m_meshObjectIndices[meshIndex] = object.objectIndex;
+            m_objects.push_back(object);
+            m_objectMeshIndices.push_back(meshIndex);
+
+            verticesSize += meshInfo->meshVertexCount * sizeof(MeshVertex);
+            indicesSize += meshInfo->meshIndexCount * sizeof(uint32_t);
+        }
+    }
+
+    if (m_objects.empty())
+        throw std::runtime_error("GPU culling needs at least 1 model.");
+
+    m_staleFrames.assign(m_objects.size(), 0);
+
+    BufferManager::bufferCreateBuffer(
+        getRendererPointer()->getVmaAllocator(),
+        verticesSize,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        &m_vertexBuffer,
+        &m_vertexAllocation
+    );
+
+    BufferManager::bufferCreateBuffer(
+        getRendererPointer()->getVmaAllocator(),
+        indicesSize,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        &m_indexBuffer,
+        &m_indexAllocation
+    );
+
+    VkCommandBuffer commandBuffer = CommandManager::cmdBeginSingleTimeCommands(getRendererPointer()->getDevice(), getRendererPointer()->getCommandPool());
+
+    for (uint32_t i = 0; i < m_objects.size(); ++i)
+    {
+        const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[m_objectMeshIndices[i]].ref_mesh;
+
+        VkBufferCopy vertexRegion{};
+        vertexRegion.srcOffset = 0;
+        vertexRegion.dstOffset = m_objects[i].vertexOffset * sizeof(MeshVertex);
+        vertexRegion.size = meshInfo->meshVertexCount * sizeof(MeshVertex);
+        vkCmdCopyBuffer(commandBuffer, *meshInfo->vertexBuffer, m_vertexBuffer, 1, &vertexRegion);
+
+        VkBufferCopy indexRegion{};
+        indexRegion.srcOffset = 0;
+        indexRegion.dstOffset = m_objects[i].firstIndex * sizeof(uint32_t);
+        indexRegion.size = meshInfo->meshIndexCount * sizeof(uint32_t);
+        vkCmdCopyBuffer(commandBuffer, *meshInfo->indexBuffer, m_indexBuffer, 1, &indexRegion);
+    }
+
+    CommandManager::cmdEndSingleTimeCommands(getRendererPointer()->getDevice(), getRendererPointer()->getGraphicsQueue(), getRendererPointer()->getCommandPool(), commandBuffer);
+}
+
+void GPUCulling::createObjectBuffers()
+{
+    m_objectBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_objectAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            m_objects.size() * sizeof(GPUObjectData),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_objectBuffers[i],
+            &m_objectAllocations[i]
+        );
+    }
+}
+
+void GPUCulling::createPipeline()
+{
+    const std::vector<DescriptorInfo>& bufferInfos = COMPUTE_PIPELINE::CULLING::BUFFERS_INFO;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings(bufferInfos.size());
+    for (uint32_t i = 0; i < bufferInfos.size(); i++)
+    {
+        bindings[i].binding = bufferInfos[i].bindingNumber;
+        bindings[i].descriptorType = bufferInfos[i].descriptorType;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = bufferInfos[i].shaderStage;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    auto status = vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_descriptorSetLayout);
+    if (status != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor set layout!");
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+    status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+    if (status != VK_SUCCESS)
+        throw std::runtime_error("Failed to create pipeline layout!");
+
+    ComputePipelineDesc desc;
+    desc.name = "GPU culling";
+    desc.shader = { shaderType::COMPUTE, "cull" };
+    desc.layout = m_pipelineLayout;
+
+    getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
+}
+
+uint32_t GPUCulling::createView()
+{
+    for (uint32_t i = 0; i < m_views.size(); ++i)
+    {
+        if (m_views[i].isReleased)
+        {
+            m_views[i].isReleased = false;
+            return i;
+        }
+    }
+
+    View view;
+    view.paramsBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    view.paramsAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    view.commandBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    view.commandAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    view.countBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    view.countAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    view.descriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    getRendererPointer()->getDescriptorAllocator().reserve(COMPUTE_PIPELINE::CULLING::BUFFERS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(GPUCullParams),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &view.paramsBuffers[i],
+            &view.paramsAllocations[i]
+        );
+
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            m_objects.size() * sizeof(VkDrawIndexedIndirectCommand),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY,
+            &view.commandBuffers[i],
+            &view.commandAllocations[i]
+        );
+
+        // Host visible, so the last count can be shown in the profiler.
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            &view.countBuffers[i],
+            &view.countAllocations[i]
+        );
+
+        getRendererPointer()->getDescriptorAllocator().allocate(m_descriptorSetLayout, &view.descriptorSets[i]);
+
+        VkDescriptorBufferInfo paramsInfo = DescriptorManager::descriptorBufferInfo(view.paramsBuffers[i]);
+        VkDescriptorBufferInfo objectsInfo = DescriptorManager::descriptorBufferInfo(m_objectBuffers[i]);
+        VkDescriptorBufferInfo commandsInfo = DescriptorManager::descriptorBufferInfo(view.commandBuffers[i]);
+        VkDescriptorBufferInfo countInfo = DescriptorManager::descriptorBufferInfo(view.countBuffers[i]);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(view.descriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &paramsInfo),
+            DescriptorManager::writeDescriptorSet(view.descriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &objectsInfo),
+            DescriptorManager::writeDescriptorSet(view.descriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, &commandsInfo),
+            DescriptorManager::writeDescriptorSet(view.descriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &countInfo),
+        };
+        vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+
+    m_views.push_back(view);
+    return static_cast<uint32_t>(m_views.size() - 1);
+}
+
+void GPUCulling::releaseView(const uint32_t viewIndex)
+{
+    m_views[viewIndex].isReleased = true;
+}
+
+uint32_t GPUCulling::getActiveViewCount() const
+{
+    uint32_t count = 0;
+    for (const View& view : m_views)
+        count += view.isReleased ? 0 : 1;
+    return count;
+}
+
+void GPUCulling::updateObjects(const uint32_t frameIndex)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    m_currentFrame = frameIndex;
+
+    // A changed object is stale in every frame's buffer.
+    const uint32_t allFrames = (1u << Config::MAX_FRAMES_IN_FLIGHT) - 1;
+
+    uint32_t objectIndex = 0;
+    for (auto& ptr : getRenderResource()->m_normalModels)
+    {
+        const glm::mat4 modelMatrix = ptr->getModelMatrix();
+        const float enabled = ptr->isHidden() ? 0.0f : 1.0f;
+
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            GPUObjectData& object = m_objects[objectIndex];
+
+            if (!m_hasObjectData || object.model != modelMatrix || object.boundsMin.w != enabled)
+            {
+                const AxisAlignedBox worldBounds = BoundingVolumes::transformBox(getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh->boundingBox, modelMatrix);
+
+                object.model = modelMatrix;
+                object.boundsMin = glm::vec4(worldBounds.min, enabled);
+                object.boundsMax = glm::vec4(worldBounds.max, 0.0f);
+
+                m_staleFrames[objectIndex] = allFrames;
+            }
+            ++objectIndex;
+        }
+    }
+    m_hasObjectData = true;
+
+    // Only the stale objects are written, one flush covers them.
+    const uint32_t frameBit = 1u << frameIndex;
+    uint32_t firstStale = getObjectCount();
+    uint32_t lastStale = 0;
+    for (uint32_t i = 0; i < m_staleFrames.size(); ++i)
+    {
+        if (m_staleFrames[i] & frameBit)
+        {
+            firstStale = std::min(firstStale, i);
+            lastStale = i;
+        }
+    }
+
+    if (firstStale == getObjectCount())
+        return;
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_objectAllocations[frameIndex], &data);
+    for (uint32_t i = firstStale; i <= lastStale; ++i)
+    {
+        if (m_staleFrames[i] & frameBit)
+        {
+            memcpy(static_cast<GPUObjectData*>(data) + i, &m_objects[i], sizeof(GPUObjectData));
+            m_staleFrames[i] &= ~frameBit;
+        }
+    }
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_objectAllocations[frameIndex]);
+
+    vmaFlushAllocation(getRendererPointer()->getVmaAllocator(), m_objectAllocations[frameIndex], firstStale * sizeof(GPUObjectData), (lastStale - firstStale + 1) * sizeof(GPUObjectData));
+}
+
+/*
+ * Must be recorded outside of a render pass.
+ */
+void GPUCulling::cull(const VkCommandBuffer& commandBuffer, const uint32_t viewIndex, const uint32_t frameIndex, const glm::mat4& viewProj)
+{
+    View& view = m_views[viewIndex];
+
+    GPUCullParams params{};
+    const Frustum frustum = BoundingVolumes::extractFrustum(viewProj);
+    for (uint32_t i = 0; i < 6; ++i)
+        params.planes[i] = frustum.planes[i];
+    params.objectCount = getObjectCount();
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), view.paramsAllocations[frameIndex], &data);
+    memcpy(data, &params, sizeof(params));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), view.paramsAllocations[frameIndex]);
+
+    // Resets the count and the commands(the latter only matters for the
+    // fallback path, which draws every slot).
+    vkCmdFillBuffer(commandBuffer, view.countBuffers[frameIndex], 0, VK_WHOLE_SIZE, 0);
+    vkCmdFillBuffer(commandBuffer, view.commandBuffers[frameIndex], 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &view.descriptorSets[frameIndex], 0, nullptr);
+
+    const uint32_t groupSize = COMPUTE_PIPELINE::CULLING::WORKGROUP_SIZE;
+    vkCmdDispatch(commandBuffer, (getObjectCount() + groupSize - 1) / groupSize, 1, 1);
+
+    VkMemoryBarrier indirectBarrier{};
+    indirectBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    indirectBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    indirectBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &indirectBarrier, 0, nullptr, 0, nullptr);
+}
+
+/*
+ * The caller binds the pipeline and its descriptor sets.
+ */
+void GPUCulling::drawIndirect(const VkCommandBuffer& commandBuffer, const uint32_t viewIndex, const uint32_t frameIndex)
+{
+    View& view = m_views[viewIndex];
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+    if (m_cmdDrawIndexedIndirectCount != nullptr)
+    {
+        m_cmdDrawIndexedIndirectCount(
+            commandBuffer,
+            view.commandBuffers[frameIndex], 0,
+            view.countBuffers[frameIndex], 0,
+            getObjectCount(),
+            sizeof(VkDrawIndexedIndirectCommand)
+        );
+    }
+    else
+    {
+        // Slots past the draw count were cleared, so they draw 0 instances.
+        vkCmdDrawIndexedIndirect(commandBuffer, view.commandBuffers[frameIndex], 0, getObjectCount(), sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+uint32_t GPUCulling::getLastDrawCount(const uint32_t viewIndex)
+{
+    uint32_t count = 0;
+    if (m_views[viewIndex].isReleased)
+        return count;
+
+    // GPU_TO_CPU memory may not be host coherent.
+    vmaInvalidateAllocation(getRendererPointer()->getVmaAllocator(), m_views[viewIndex].countAllocations[m_currentFrame], 0, VK_WHOLE_SIZE);
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_views[viewIndex].countAllocations[m_currentFrame], &data);
+    memcpy(&count, data, sizeof(count));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_views[viewIndex].countAllocations[m_currentFrame]);
+
+    return count;
+}
+
+bool GPUCulling::getPooledRange(const uint32_t meshIndex, uint32_t& firstIndex, int32_t& vertexOffset) const
+{
+    auto iter = m_meshObjectIndices.find(meshIndex);
+    if (iter == m_meshObjectIndices.end())
+        return false;
+
+    firstIndex = m_objects[iter->second].firstIndex;
+    vertexOffset = m_objects[iter->second].vertexOffset;
+    return true;
+}
+
+bool GPUCulling::getObjectIndex(const uint32_t meshIndex, uint32_t& objectIndex) const
+{
+    auto iter = m_meshObjectIndices.find(meshIndex);
+    if (iter == m_meshObjectIndices.end())
+        return false;
+
+    objectIndex = iter->second;
+    return true;
+}
+
+void GPUCulling::destroy()
+{
+    VmaAllocator allocator = getRendererPointer()->getVmaAllocator();
+
+    for (auto& view : m_views)
+    {
+        for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            vmaDestroyBuffer(allocator, view.paramsBuffers[i], view.paramsAllocations[i]);
+            vmaDestroyBuffer(allocator, view.commandBuffers[i], view.commandAllocations[i]);
+            vmaDestroyBuffer(allocator, view.countBuffers[i], view.countAllocations[i]);
+        }
+    }
+    m_views.clear();
+
+    for (uint32_t i = 0; i < m_objectBuffers.size(); ++i)
+        vmaDestroyBuffer(allocator, m_objectBuffers[i], m_objectAllocations[i]);
+
+    vmaDestroyBuffer(allocator, m_vertexBuffer, m_vertexAllocation);
+    vmaDestroyBuffer(allocator, m_indexBuffer, m_indexAllocation);
+
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+
+// Layouts must match cull.comp(std430 / std140).
+struct GPUObjectData
+{
+    glm::mat4   model;
+    glm::vec4   boundsMin;      // w = 1 if the object is enabled
+    glm::vec4   boundsMax;
+    uint32_t    firstIndex;
+    uint32_t    indexCount;
+    int32_t     vertexOffset;
+    uint32_t    objectIndex;
+};
+
+struct GPUCullParams
+{
+    glm::vec4   planes[6];
+    uint32_t    objectCount;
+};
+
+/*
+ * GPU-driven submission for the meshes of m_normalModels:
+ *  - All their vertices/indices are pooled in a single vertex and index buffer.
+ *  - Per object data(model matrix, world bounds, draw ranges) lives in a storage buffer.
+ *  - cull() runs cull.comp, which writes compacted VkDrawIndexedIndirectCommand
+ *    entries plus a draw count for a view.
+ *  - drawIndirect() issues a single vkCmdDrawIndexedIndirectCount(or a plain
+ *    multi draw indirect when VK_KHR_draw_indirect_count is missing).
+ * Shaders fetch their object with gl_InstanceIndex(firstInstance = object index).
+ */
+class GPUCulling
+{
+public:
+    GPUCulling();
+    ~GPUCulling() {};
+
+    uint32_t createView();
+    // The view's buffers are kept and handed to the next createView().
+    void releaseView(const uint32_t viewIndex);
+
+    // Uploads the objects whose model matrix or hidden state changed since the
+    // frame's buffer was last written.
+    void updateObjects(const uint32_t frameIndex);
+    void cull(const VkCommandBuffer& commandBuffer, const uint32_t viewIndex, const uint32_t frameIndex, const glm::mat4& viewProj);
+    void drawIndirect(const VkCommandBuffer& commandBuffer, const uint32_t viewIndex, const uint32_t frameIndex);
+
+    const VkBuffer& getObjectBuffer(const uint32_t frameIndex) const    { return m_objectBuffers[frameIndex]; }
+    uint32_t getObjectCount() const                                     { return static_cast<uint32_t>(m_objects.size()); }
+    const VkBuffer& getVertexBuffer() const                             { return m_vertexBuffer; }
+    const VkBuffer& getIndexBuffer() const                              { return m_indexBuffer; }
+    // Location of a mesh inside the pooled buffers, false if it isn't pooled.
+    bool getPooledRange(const uint32_t meshIndex, uint32_t& firstIndex, int32_t& vertexOffset) const;
+    // Object index of a mesh(what shaders get as gl_InstanceIndex), false if it isn't pooled.
+    bool getObjectIndex(const uint32_t meshIndex, uint32_t& objectIndex) const;
+    uint32_t getObjectMeshIndex(const uint32_t objectIndex) const      { return m_objectMeshIndices[objectIndex]; }
+    // Created views, released ones included(getLastDrawCount() returns 0 for them).
+    uint32_t getViewCount() const                                       { return static_cast<uint32_t>(m_views.size()); }
+    uint32_t getActiveViewCount() const;
+    // Draw count written by the last completed cull of the view(frame given to updateObjects).
+    uint32_t getLastDrawCount(const uint32_t viewIndex);
+
+    // CPU reference of cull.comp(same p-vertex test), returns the draw count.
+    // Commands keep the order of the objects, the shader's order depends on its atomics.
+    static uint32_t cullReference(const std::vector<GPUObjectData>& objects, const Frustum& frustum, std::vector<VkDrawIndexedIndirectCommand>& outCommands);
+
+    void destroy();
+
+private:
+    struct View
+    {
+        std::vector<VkBuffer>           paramsBuffers;
+        std::vector<VmaAllocation>      paramsAllocations;
+        std::vector<VkBuffer>           commandBuffers;
+        std::vector<VmaAllocation>      commandAllocations;
+        std::vector<VkBuffer>           countBuffers;
+        std::vector<VmaAllocation>      countAllocations;
+        std::vector<VkDescriptorSet>    descriptorSets;
+        bool                            isReleased = false;
+    };
+
+    void createPooledGeometry();
+    void createObjectBuffers();
+    void createPipeline();
+
+    VkPipeline                      m_pipeline;
+    VkPipelineLayout                m_pipelineLayout;
+    VkDescriptorSetLayout           m_descriptorSetLayout;
+
+    VkBuffer                        m_vertexBuffer;
+    VmaAllocation                   m_vertexAllocation;
+    VkBuffer                        m_indexBuffer;
+    VmaAllocation                   m_indexAllocation;
+
+    // CPU copy of the object buffer, objects keep the order of m_normalModels.
+    std::vector<GPUObjectData>      m_objects;
+    std::vector<uint32_t>           m_objectMeshIndices;
+    std::unordered_map<uint32_t, uint32_t> m_meshObjectIndices;
+    // Per object, one bit per frame in flight whose object buffer is out of date.
+    std::vector<uint32_t>           m_staleFrames;
+    bool                            m_hasObjectData = false;
+
+    std::vector<VkBuffer>           m_objectBuffers;
+    std::vector<VmaAllocation>      m_objectAllocations;
+
+    std::vector<View>               m_views;
+    uint32_t                        m_currentFrame = 0;
+
+    PFN_vkCmdDrawIndexedIndirectCountKHR m_cmdDrawIndexedIndirectCount = nullptr;
+};
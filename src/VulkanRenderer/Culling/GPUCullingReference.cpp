@@ -0,0 +1,40 @@
+#include "VulkanRenderer/Culling/GPUCulling.h"
+
+// Only needs the header, so tests/GPUCullingTest.cpp links it without a device.
+
+namespace
+{
+    // isVisible() of cull.comp: the corner furthest along each plane normal(p-vertex)
+    // must be on the inner side.
+    bool isVisible(const Frustum& frustum, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            const glm::vec3 positive = glm::mix(boundsMin, boundsMax, glm::greaterThanEqual(glm::vec3(plane), glm::vec3(0.0f)));
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+}
+
+uint32_t GPUCulling::cullReference(const std::vector<GPUObjectData>& objects, const Frustum& frustum, std::vector<VkDrawIndexedIndirectCommand>& outCommands)
+{
+    outCommands.clear();
+
+    for (const GPUObjectData& object : objects)
+    {
+        if (object.boundsMin.w == 0.0f || !isVisible(frustum, glm::vec3(object.boundsMin), glm::vec3(object.boundsMax)))
+            continue;
+
+        VkDrawIndexedIndirectCommand command{};
+        command.indexCount = object.indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = object.firstIndex;
+        command.vertexOffset = object.vertexOffset;
+        command.firstInstance = object.objectIndex;
+        outCommands.push_back(command);
+    }
+
+    return static_cast<uint32_t>(outCommands.size());
+}
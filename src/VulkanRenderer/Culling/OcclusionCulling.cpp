@@ -0,0 +1,595 @@
+#include "VulkanRenderer/Culling/OcclusionCulling.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Settings/ComputePipelineConfig.h"
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Pipeline/PipelineManager.h"
+#include "VulkanRenderer/Shader/ShaderManager.h"
+#include "VulkanRenderer/Model/ModelManager.h"
+#include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/RenderResource.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+namespace
+{
+    uint32_t previousPowerOfTwo(const uint32_t value)
+    {
+        uint32_t result = 1;
+        while (result * 2 <= value)
+            result *= 2;
+        return result;
+    }
+
+    // Twice the signed area of abp, in framebuffer coordinates(y down).
+    float edgeFunction(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p)
+    {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+
+    VkDescriptorSetLayout createDescriptorSetLayout(const std::vector<DescriptorInfo>& bufferInfos)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings(bufferInfos.size());
+        for (uint32_t i = 0; i < bufferInfos.size(); i++)
+        {
+            bindings[i].binding = bufferInfos[i].bindingNumber;
+            bindings[i].descriptorType = bufferInfos[i].descriptorType;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = bufferInfos[i].shaderStage;
+            bindings[i].pImmutableSamplers = nullptr;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        VkDescriptorSetLayout descriptorSetLayout;
+        auto status = vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &descriptorSetLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+
+        return descriptorSetLayout;
+    }
+
+    VkPipelineLayout createPipelineLayout(const VkDescriptorSetLayout& descriptorSetLayout, const uint32_t pushConstantSize = 0)
+    {
+        const VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = (pushConstantSize > 0) ? 1 : 0;
+        pipelineLayoutInfo.pPushConstantRanges = (pushConstantSize > 0) ? &pushConstantRange : nullptr;
+
+        VkPipelineLayout pipelineLayout;
+        auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline layout!");
+
+        return pipelineLayout;
+    }
+}
+
+OcclusionCulling::OcclusionCulling()
+{
+    for (auto& ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+            m_meshOwners[meshIndex] = ptr.get();
+    }
+
+    createBuffers();
+    createPipelines();
+
+    // Every shader fetches texels.
+    m_sampler = new ImageSampler(VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 0.0f, VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE);
+
+    // Same aspect as the camera's projection.
+    const uint32_t width = Config::SOFTWARE_OCCLUSION_WIDTH;
+    const uint32_t height = previousPowerOfTwo(std::max(width * Config::RESOLUTION_H / Config::RESOLUTION_W, 1u));
+
+    VkExtent2D levelExtent = { width, height };
+    while (true)
+    {
+        m_softwarePyramid.extents.push_back(levelExtent);
+        m_softwarePyramid.levels.push_back(std::vector<float>(levelExtent.width * levelExtent.height, 1.0f));
+
+        if (levelExtent.width == 1 && levelExtent.height == 1)
+            break;
+
+        levelExtent = { std::max(levelExtent.width / 2, 1u), std::max(levelExtent.height / 2, 1u) };
+    }
+}
+
+void OcclusionCulling::createBuffers()
+{
+    const uint32_t objectCount = getRendererPointer()->getGPUCulling()->getObjectCount();
+
+    m_paramsBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_paramsAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_visibilityBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_visibilityAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_hasResults.resize(Config::MAX_FRAMES_IN_FLIGHT, false);
+    m_viewProjs.resize(Config::MAX_FRAMES_IN_FLIGHT, glm::mat4(1.0f));
+
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(OcclusionParams),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_paramsBuffers[i],
+            &m_paramsAllocations[i]
+        );
+
+        // Read back by cull() once the frame's fence is signaled.
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            objectCount * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            &m_visibilityBuffers[i],
+            &m_visibilityAllocations[i]
+        );
+    }
+}
+
+void OcclusionCulling::createPipelines()
+{
+    m_buildDescriptorSetLayout = createDescriptorSetLayout(COMPUTE_PIPELINE::HIZ_BUILD::BUFFERS_INFO);
+    // Source size(hiZBuild.comp).
+    m_buildPipelineLayout = createPipelineLayout(m_buildDescriptorSetLayout, sizeof(glm::ivec2));
+
+    m_cullDescriptorSetLayout = createDescriptorSetLayout(COMPUTE_PIPELINE::HIZ_CULLING::BUFFERS_INFO);
+    m_cullPipelineLayout = createPipelineLayout(m_cullDescriptorSetLayout);
+
+    ComputePipelineDesc buildDesc;
+    buildDesc.name = "Hi-Z build";
+    buildDesc.shader = { shaderType::COMPUTE, "hiZBuild" };
+    buildDesc.layout = m_buildPipelineLayout;
+    getRendererPointer()->getPipelineCompiler().add(buildDesc, &m_buildPipeline);
+
+    // First level from a multisampled depth.
+    ComputePipelineDesc buildMSDesc;
+    buildMSDesc.name = "Hi-Z build(MSAA)";
+    buildMSDesc.shader = { shaderType::COMPUTE, "hiZBuildMS" };
+    buildMSDesc.layout = m_buildPipelineLayout;
+    getRendererPointer()->getPipelineCompiler().add(buildMSDesc, &m_buildMSPipeline);
+
+    ComputePipelineDesc cullDesc;
+    cullDesc.name = "Hi-Z culling";
+    cullDesc.shader = { shaderType::COMPUTE, "hiZCull" };
+    cullDesc.layout = m_cullPipelineLayout;
+    getRendererPointer()->getPipelineCompiler().add(cullDesc, &m_cullPipeline);
+}
+
+void OcclusionCulling::createPyramid(const VkExtent2D& extent)
+{
+    // The previous frames may still test against it.
+    if (m_pyramid != nullptr)
+    {
+        vkDeviceWaitIdle(getRendererPointer()->getDevice());
+        destroyPyramid();
+    }
+
+    m_pyramidExtent = extent;
+    m_pyramidLevelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+
+    m_pyramid = Image::Create2DImage(
+        m_pyramidExtent,
+        VK_FORMAT_R32_SFLOAT,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_SAMPLE_COUNT_1_BIT,
+        m_pyramidLevelCount
+    );
+
+    // Written one level at a time, the default view(every level) is tested against.
+    for (uint32_t i = 0; i < m_pyramidLevelCount; ++i)
+        m_pyramid->AddImageView("Mip" + std::to_string(i), VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, i, 1);
+}
+
+void OcclusionCulling::destroyPyramid()
+{
+    if (m_pyramid == nullptr)
+        return;
+
+    m_pyramid->destroy();
+    delete m_pyramid;
+    m_pyramid = nullptr;
+}
+
+void OcclusionCulling::cull(const glm::mat4& viewProj, const uint32_t frameIndex, const std::vector<uint32_t>& frustumVisible, std::vector<uint32_t>& outVisible)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    m_viewProjs[frameIndex] = viewProj;
+    outVisible.clear();
+
+    if (!m_isEnabled)
+    {
+        m_hasResults[frameIndex] = false;
+        m_occludedCount = 0;
+        outVisible = frustumVisible;
+        return;
+    }
+
+    if (m_isCPURasterizationEnabled)
+    {
+        m_hasResults[frameIndex] = false;
+
+        // Last frame's visible meshes are the occluders, likely to still cover most of the screen.
+        std::vector<uint32_t> occluders;
+        for (uint32_t meshIndex : frustumVisible)
+        {
+            if (m_lastVisibleMeshes.find(meshIndex) != m_lastVisibleMeshes.end())
+                occluders.push_back(meshIndex);
+        }
+
+        rasterizeOccluders(viewProj, occluders);
+        buildPyramidReference(m_softwarePyramid);
+
+        // Then every mesh, including the ones hidden last frame.
+        for (uint32_t meshIndex : frustumVisible)
+        {
+            auto iter = m_meshOwners.find(meshIndex);
+            if (iter != m_meshOwners.end())
+            {
+                const AxisAlignedBox bounds = BoundingVolumes::transformBox(getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh->boundingBox, iter->second->getModelMatrix());
+                if (!testBoxReference(viewProj, bounds, m_softwarePyramid))
+                    continue;
+            }
+
+            outVisible.push_back(meshIndex);
+        }
+
+        m_lastVisibleMeshes.clear();
+        m_lastVisibleMeshes.insert(outVisible.begin(), outVisible.end());
+    }
+    else
+    {
+        const GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+
+        // Written by the build() of the last frame using this slot(fence waited).
+        uint32_t* visibility = nullptr;
+        if (m_hasResults[frameIndex])
+            vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_visibilityAllocations[frameIndex], reinterpret_cast<void**>(&visibility));
+
+        for (uint32_t meshIndex : frustumVisible)
+        {
+            uint32_t objectIndex;
+            if (visibility != nullptr && gpuCulling->getObjectIndex(meshIndex, objectIndex) && visibility[objectIndex] == 0)
+                continue;
+
+            outVisible.push_back(meshIndex);
+        }
+
+        if (visibility != nullptr)
+            vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_visibilityAllocations[frameIndex]);
+
+        // Until build() writes it again.
+        m_hasResults[frameIndex] = false;
+    }
+
+    m_occludedCount = static_cast<uint32_t>(frustumVisible.size() - outVisible.size());
+}
+
+void OcclusionCulling::build(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const VkImageView& depthView, const VkExtent2D& extent, const VkExtent2D& renderExtent, const VkSampleCountFlagBits sampleCount)
+{
+    if (!isGPUTestEnabled())
+        return;
+
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    const VkExtent2D pyramidExtent = { previousPowerOfTwo(extent.width), previousPowerOfTwo(extent.height) };
+    if (m_pyramid == nullptr || pyramidExtent.width != m_pyramidExtent.width || pyramidExtent.height != m_pyramidExtent.height)
+        createPyramid(pyramidExtent);
+
+    const VkDevice& device = getRendererPointer()->getDevice();
+    DescriptorAllocator& frameAllocator = getRendererPointer()->getFrameDescriptorAllocator(frameIndex);
+
+    // Every level is rewritten, after the tests of the previous frames are done with it.
+    VkImageMemoryBarrier pyramidBarrier{};
+    pyramidBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    pyramidBarrier.srcAccessMask = 0;
+    pyramidBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    pyramidBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    pyramidBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    pyramidBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    pyramidBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    pyramidBarrier.image = m_pyramid->getImage();
+    pyramidBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, m_pyramidLevelCount, 0, 1 };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &pyramidBarrier);
+
+    // - Pyramid: level 0 from the depth buffer, then each level from the previous one.
+    const uint32_t groupSize = COMPUTE_PIPELINE::HIZ_BUILD::WORKGROUP_SIZE;
+    for (uint32_t level = 0; level < m_pyramidLevelCount; ++level)
+    {
+        VkDescriptorSet descriptorSet;
+        frameAllocator.allocate(m_buildDescriptorSetLayout, &descriptorSet);
+
+        VkDescriptorImageInfo sourceInfo = (level == 0) ?
+            DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), depthView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) :
+            DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), m_pyramid->getImageView("Mip" + std::to_string(level - 1)), VK_IMAGE_LAYOUT_GENERAL);
+        VkDescriptorImageInfo destinationInfo = DescriptorManager::descriptorImageInfo(VK_NULL_HANDLE, m_pyramid->getImageView("Mip" + std::to_string(level)), VK_IMAGE_LAYOUT_GENERAL);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &sourceInfo),
+            DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, &destinationInfo),
+        };
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+        const VkPipeline& pipeline = (level == 0 && sampleCount != VK_SAMPLE_COUNT_1_BIT) ? m_buildMSPipeline : m_buildPipeline;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_buildPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+        // Only the rendered part of the depth buffer.
+        const VkExtent2D sourceExtent = (level == 0) ? renderExtent : m_pyramid->getExtent2D(level - 1);
+        const glm::ivec2 sourceSize(sourceExtent.width, sourceExtent.height);
+        vkCmdPushConstants(commandBuffer, m_buildPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sourceSize), &sourceSize);
+
+        const VkExtent2D levelExtent = m_pyramid->getExtent2D(level);
+        vkCmdDispatch(commandBuffer, (levelExtent.width + groupSize - 1) / groupSize, (levelExtent.height + groupSize - 1) / groupSize, 1);
+
+        // Read by the next level(or the test).
+        VkImageMemoryBarrier levelBarrier = pyramidBarrier;
+        levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        levelBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        levelBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        levelBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &levelBarrier);
+    }
+
+    // - Test, with the view the depth was rendered with.
+    OcclusionParams params{};
+    params.viewProj = m_viewProjs[frameIndex];
+    params.objectCount = getRendererPointer()->getGPUCulling()->getObjectCount();
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_paramsAllocations[frameIndex], &data);
+    memcpy(data, &params, sizeof(params));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_paramsAllocations[frameIndex]);
+
+    VkDescriptorSet descriptorSet;
+    frameAllocator.allocate(m_cullDescriptorSetLayout, &descriptorSet);
+
+    VkDescriptorBufferInfo paramsInfo = DescriptorManager::descriptorBufferInfo(m_paramsBuffers[frameIndex]);
+    VkDescriptorBufferInfo objectsInfo = DescriptorManager::descriptorBufferInfo(getRendererPointer()->getGPUCulling()->getObjectBuffer(frameIndex));
+    VkDescriptorImageInfo pyramidInfo = DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), m_pyramid->getImageView(), VK_IMAGE_LAYOUT_GENERAL);
+    VkDescriptorBufferInfo visibilityInfo = DescriptorManager::descriptorBufferInfo(m_visibilityBuffers[frameIndex]);
+
+    std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &paramsInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &objectsInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &pyramidInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &visibilityInfo),
+    };
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+
+    const uint32_t cullGroupSize = COMPUTE_PIPELINE::HIZ_CULLING::WORKGROUP_SIZE;
+    vkCmdDispatch(commandBuffer, (params.objectCount + cullGroupSize - 1) / cullGroupSize, 1, 1);
+
+    VkMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+    m_hasResults[frameIndex] = true;
+}
+
+void OcclusionCulling::rasterizeOccluders(const glm::mat4& viewProj, const std::vector<uint32_t>& meshIndices)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    std::vector<float>& depth = m_softwarePyramid.levels[0];
+    std::fill(depth.begin(), depth.end(), 1.0f);
+
+    std::vector<glm::vec4> clipPositions;
+    for (uint32_t meshIndex : meshIndices)
+    {
+        auto iter = m_meshOwners.find(meshIndex);
+        if (iter == m_meshOwners.end() || iter->second->isHidden())
+            continue;
+
+        const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+        const glm::mat4 modelViewProj = viewProj * iter->second->getModelMatrix();
+
+        clipPositions.resize(meshInfo->positions.size());
+        for (uint32_t i = 0; i < meshInfo->positions.size(); ++i)
+            clipPositions[i] = modelViewProj * glm::vec4(meshInfo->positions[i], 1.0f);
+
+        for (uint32_t i = 0; i + 2 < meshInfo->indices.size(); i += 3)
+            rasterizeTriangle(clipPositions[meshInfo->indices[i]], clipPositions[meshInfo->indices[i + 1]], clipPositions[meshInfo->indices[i + 2]]);
+    }
+}
+
+void OcclusionCulling::rasterizeTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2)
+{
+    const VkExtent2D& extent = m_softwarePyramid.extents[0];
+    std::vector<float>& depth = m_softwarePyramid.levels[0];
+
+    const glm::vec4 clips[3] = { clip0, clip1, clip2 };
+    glm::vec2 vertices[3];
+    float depths[3];
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        // Not clipped: triangles crossing the near plane are simply left out,
+        // fewer occluders never hide anything visible.
+        if (clips[i].w <= 0.0f || clips[i].z < 0.0f)
+            return;
+
+        const glm::vec3 ndc = glm::vec3(clips[i]) / clips[i].w;
+        vertices[i] = glm::vec2((ndc.x * 0.5f + 0.5f) * extent.width, (ndc.y * 0.5f + 0.5f) * extent.height);
+        depths[i] = ndc.z;
+    }
+
+    // Negative for the front faces(counter clockwise as Vulkan defines it),
+    // back faces are culled as the pipelines do.
+    const float area = edgeFunction(vertices[0], vertices[1], vertices[2]);
+    if (area >= 0.0f)
+        return;
+
+    const float minX = std::min({ vertices[0].x, vertices[1].x, vertices[2].x });
+    const float maxX = std::max({ vertices[0].x, vertices[1].x, vertices[2].x });
+    const float minY = std::min({ vertices[0].y, vertices[1].y, vertices[2].y });
+    const float maxY = std::max({ vertices[0].y, vertices[1].y, vertices[2].y });
+
+    const int32_t firstX = std::max(static_cast<int32_t>(std::floor(minX)), 0);
+    const int32_t lastX = std::min(static_cast<int32_t>(std::ceil(maxX)), static_cast<int32_t>(extent.width) - 1);
+    const int32_t firstY = std::max(static_cast<int32_t>(std::floor(minY)), 0);
+    const int32_t lastY = std::min(static_cast<int32_t>(std::ceil(maxY)), static_cast<int32_t>(extent.height) - 1);
+
+    for (int32_t y = firstY; y <= lastY; ++y)
+    {
+        for (int32_t x = firstX; x <= lastX; ++x)
+        {
+            const glm::vec2 pixelCenter(x + 0.5f, y + 0.5f);
+
+            // Inside when every edge has the sign of the area.
+            const float w0 = edgeFunction(vertices[1], vertices[2], pixelCenter);
+            const float w1 = edgeFunction(vertices[2], vertices[0], pixelCenter);
+            const float w2 = edgeFunction(vertices[0], vertices[1], pixelCenter);
+            if (w0 > 0.0f || w1 > 0.0f || w2 > 0.0f)
+                continue;
+
+            // Depth is linear in screen space.
+            const float z = (w0 * depths[0] + w1 * depths[1] + w2 * depths[2]) / area;
+
+            float& texel = depth[y * extent.width + x];
+            texel = std::min(texel, z);
+        }
+    }
+}
+
+void OcclusionCulling::buildPyramidReference(DepthPyramid& pyramid)
+{
+    for (uint32_t level = 1; level < pyramid.levels.size(); ++level)
+    {
+        const VkExtent2D& source = pyramid.extents[level - 1];
+        const VkExtent2D& destination = pyramid.extents[level];
+        const std::vector<float>& sourceDepth = pyramid.levels[level - 1];
+        std::vector<float>& destinationDepth = pyramid.levels[level];
+
+        for (uint32_t y = 0; y < destination.height; ++y)
+        {
+            // Source texels covered by the texel.
+            const uint32_t firstY = (y * source.height) / destination.height;
+            const uint32_t lastY = std::max(firstY, ((y + 1) * source.height + destination.height - 1) / destination.height - 1);
+
+            for (uint32_t x = 0; x < destination.width; ++x)
+            {
+                const uint32_t firstX = (x * source.width) / destination.width;
+                const uint32_t lastX = std::max(firstX, ((x + 1) * source.width + destination.width - 1) / destination.width - 1);
+
+                float depth = 0.0f;
+                for (uint32_t sy = firstY; sy <= lastY; ++sy)
+                    for (uint32_t sx = firstX; sx <= lastX; ++sx)
+                        depth = std::max(depth, sourceDepth[std::min(sy, source.height - 1) * source.width + std::min(sx, source.width - 1)]);
+
+                destinationDepth[y * destination.width + x] = depth;
+            }
+        }
+    }
+}
+
+bool OcclusionCulling::testBoxReference(const glm::mat4& viewProj, const AxisAlignedBox& bounds, const DepthPyramid& pyramid)
+{
+    glm::vec2 rectMin(1.0f);
+    glm::vec2 rectMax(-1.0f);
+    float nearestDepth = 1.0f;
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const glm::vec3 corner(
+            (i & 1) ? bounds.max.x : bounds.min.x,
+            (i & 2) ? bounds.max.y : bounds.min.y,
+            (i & 4) ? bounds.max.z : bounds.min.z
+        );
+
+        const glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+        // Crosses the near plane.
+        if (clip.w <= 0.0f || clip.z < 0.0f)
+            return true;
+
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        rectMin = glm::min(rectMin, glm::vec2(ndc));
+        rectMax = glm::max(rectMax, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z);
+    }
+
+    // Outside of the screen: left to the frustum culling.
+    if (rectMin.x > 1.0f || rectMin.y > 1.0f || rectMax.x < -1.0f || rectMax.y < -1.0f)
+        return true;
+
+    const glm::vec2 uvMin = glm::clamp(rectMin * 0.5f + 0.5f, 0.0f, 1.0f);
+    const glm::vec2 uvMax = glm::clamp(rectMax * 0.5f + 0.5f, 0.0f, 1.0f);
+
+    // Level where the rectangle covers 2x2 texels at most.
+    const VkExtent2D& size = pyramid.extents[0];
+    const glm::vec2 rectSize = (uvMax - uvMin) * glm::vec2(size.width, size.height);
+    const int32_t levelCount = static_cast<int32_t>(pyramid.levels.size());
+    const int32_t level = glm::clamp(static_cast<int32_t>(std::ceil(std::log2(std::max(std::max(rectSize.x, rectSize.y), 1.0f)))), 0, levelCount - 1);
+
+    const VkExtent2D& levelSize = pyramid.extents[level];
+    const glm::ivec2 maxTexel(levelSize.width - 1, levelSize.height - 1);
+    const glm::ivec2 texelMin = glm::clamp(glm::ivec2(uvMin * glm::vec2(levelSize.width, levelSize.height)), glm::ivec2(0), maxTexel);
+    const glm::ivec2 texelMax = glm::clamp(glm::ivec2(uvMax * glm::vec2(levelSize.width, levelSize.height)), glm::ivec2(0), maxTexel);
+
+    const std::vector<float>& depth = pyramid.levels[level];
+    const float farthestDepth = std::max(
+        std::max(depth[texelMin.y * levelSize.width + texelMin.x], depth[texelMin.y * levelSize.width + texelMax.x]),
+        std::max(depth[texelMax.y * levelSize.width + texelMin.x], depth[texelMax.y * levelSize.width + texelMax.x])
+    );
+
+    return nearestDepth <= farthestDepth;
+}
+
+void OcclusionCulling::destroy()
+{
+    VmaAllocator allocator = getRendererPointer()->getVmaAllocator();
+
+    for (uint32_t i = 0; i < m_paramsBuffers.size(); ++i)
+    {
+        vmaDestroyBuffer(allocator, m_paramsBuffers[i], m_paramsAllocations[i]);
+        vmaDestroyBuffer(allocator, m_visibilityBuffers[i], m_visibilityAllocations[i]);
+    }
+
+    destroyPyramid();
+    m_sampler->destroy();
+
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_buildDescriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_buildPipeline, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_buildMSPipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_buildPipelineLayout, nullptr);
+
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_cullDescriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_cullPipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_cullPipelineLayout, nullptr);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+
+class Image;
+class ImageSampler;
+class Model;
+
+// Layout must match hiZCull.comp(std140).
+struct OcclusionParams
+{
+    glm::mat4   viewProj;
+    uint32_t    objectCount;
+};
+
+/*
+ * Occlusion culling of the meshes of m_normalModels, on top of the frustum
+ * culling(RenderResource::cullScene()). Depth is 0 near and 1 far, a mesh is
+ * occluded when the nearest depth of its bounds lies behind the farthest depth
+ * of the screen rectangle they cover, found in a pyramid of the depth buffer
+ * where each level keeps the farthest depth of the previous one(Hi-Z).
+ *  - GPU: after the scene pass, build() reduces its depth buffer to the
+ *    pyramid(hiZBuild.comp) and runs hiZCull.comp over the GPU culling objects
+ *    with the same view, writing a visibility flag per object to a host
+ *    visible buffer. The passes are recorded on the CPU before the GPU runs,
+ *    so cull() reads the flags of the frame that last used the slot
+ *    (Renderer::getFramesInFlight() frames ago): meshes coming out from behind
+ *    an occluder show up that many frames late.
+ *  - CPU: the meshes visible last frame are rasterized(depth only, at pixel
+ *    centers) in a Config::SOFTWARE_OCCLUSION_WIDTH wide buffer, reduced to
+ *    the same pyramid, then every frustum visible mesh is tested against it,
+ *    all in cull(): no latency, at the cost of a coarse buffer(a mesh seen
+ *    through a gap thinner than its texels can be culled).
+ * Meshes crossing the near plane or outside of the screen are never occluded.
+ * The culled set is what RenderResource::isMeshVisible() reports, so it
+ * applies to the CPU-driven passes that record their draws every frame.
+ * Experimental, off by default and not finished: only the first phase of the
+ * two-phase Hi-Z culling is implemented. The meshes the GPU test rejected
+ * aren't re-tested against the pyramid of the frame that drew without them(the
+ * second phase, which would draw the newly visible ones in that same frame),
+ * so disoccluded meshes pop in late and the culling isn't conservative.
+ */
+class OcclusionCulling
+{
+public:
+    // Farthest depth per texel, level 0 first(row major).
+    struct DepthPyramid
+    {
+        std::vector<VkExtent2D>             extents;
+        std::vector<std::vector<float>>     levels;
+    };
+
+    OcclusionCulling();
+    ~OcclusionCulling() {};
+
+    // After RenderResource::cullScene(), keeps the frustum visible meshes that aren't occluded.
+    void cull(const glm::mat4& viewProj, const uint32_t frameIndex, const std::vector<uint32_t>& frustumVisible, std::vector<uint32_t>& outVisible);
+    // GPU path, must be recorded outside of a render pass once the scene's depth
+    // is written(view of its depth aspect, in SHADER_READ_ONLY). The scene covers
+    // the top left renderExtent of the extent the depth was created with.
+    void build(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const VkImageView& depthView, const VkExtent2D& extent, const VkExtent2D& renderExtent, const VkSampleCountFlagBits sampleCount);
+
+    const bool& isEnabled() const                                       { return m_isEnabled; }
+    void setEnabled(const bool enabled)                                 { m_isEnabled = enabled; }
+    // Software rasterized occluders instead of the Hi-Z pyramid of the scene's depth.
+    const bool& isCPURasterizationEnabled() const                       { return m_isCPURasterizationEnabled; }
+    void setCPURasterizationEnabled(const bool enabled)                 { m_isCPURasterizationEnabled = enabled; }
+    // The GPU culling objects must be uploaded every frame.
+    bool isGPUTestEnabled() const                                       { return m_isEnabled && !m_isCPURasterizationEnabled; }
+
+    // Frustum visible meshes the last cull() removed.
+    uint32_t getOccludedCount() const                                   { return m_occludedCount; }
+
+    // CPU reference of hiZBuild.comp: fills the levels after the first one.
+    static void buildPyramidReference(DepthPyramid& pyramid);
+    // CPU reference of hiZCull.comp, true when the box may be visible.
+    static bool testBoxReference(const glm::mat4& viewProj, const AxisAlignedBox& bounds, const DepthPyramid& pyramid);
+
+    void destroy();
+
+private:
+    void createPipelines();
+    void createBuffers();
+    // Level 0 is the previous power of two of the extent(not the render extent,
+    // the pyramid isn't recreated when the render scale changes).
+    void createPyramid(const VkExtent2D& extent);
+    void destroyPyramid();
+
+    void rasterizeOccluders(const glm::mat4& viewProj, const std::vector<uint32_t>& meshIndices);
+    void rasterizeTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+
+    bool                            m_isEnabled = false;
+    bool                            m_isCPURasterizationEnabled = false;
+    uint32_t                        m_occludedCount = 0;
+
+    // Owner of each mesh of m_normalModels.
+    std::unordered_map<uint32_t, Model*> m_meshOwners;
+
+    // GPU path
+    VkPipeline                      m_buildPipeline;
+    VkPipeline                      m_buildMSPipeline;
+    VkPipelineLayout                m_buildPipelineLayout;
+    VkDescriptorSetLayout           m_buildDescriptorSetLayout;
+
+    VkPipeline                      m_cullPipeline;
+    VkPipelineLayout                m_cullPipelineLayout;
+    VkDescriptorSetLayout           m_cullDescriptorSetLayout;
+
+    Image*                          m_pyramid = nullptr;
+    ImageSampler*                   m_sampler;
+    VkExtent2D                      m_pyramidExtent{};
+    uint32_t                        m_pyramidLevelCount = 0;
+
+    // Per frame
+    std::vector<VkBuffer>           m_paramsBuffers;
+    std::vector<VmaAllocation>      m_paramsAllocations;
+    std::vector<VkBuffer>           m_visibilityBuffers;
+    std::vector<VmaAllocation>      m_visibilityAllocations;
+    // The visibility buffer was written by a build() since the slot was last read.
+    std::vector<bool>               m_hasResults;
+    std::vector<glm::mat4>          m_viewProjs;
+
+    // CPU path
+    DepthPyramid                    m_softwarePyramid;
+    std::unordered_set<uint32_t>    m_lastVisibleMeshes;
+};
@@ -0,0 +1,170 @@
+#include "VulkanRenderer/Descriptor/BindlessMaterials.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/RenderResource.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+BindlessMaterials::BindlessMaterials()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(getRendererPointer()->getPhysicalDevice(), &properties);
+
+    // Half of the stage limits at most: the passes using the arrays also bind
+    // samplers of their own(set 0).
+    m_maxTextures = std::min(Config::MAX_BINDLESS_TEXTURES, properties.limits.maxPerStageDescriptorSampledImages / 2);
+    m_maxSamplers = std::min(Config::MAX_BINDLESS_SAMPLERS, properties.limits.maxPerStageDescriptorSamplers / 2);
+
+    createDescriptorSet();
+    createMaterials();
+}
+
+void BindlessMaterials::createDescriptorSet()
+{
+    std::vector<VkDescriptorSetLayoutBinding> bindings(2);
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+    bindings[0].descriptorCount = m_maxTextures;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[0].pImmutableSamplers = nullptr;
+
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+    bindings[1].descriptorCount = m_maxSamplers;
+    bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    bindings[1].pImmutableSamplers = nullptr;
+
+    // Only the registered entries are written, the rest of the arrays stays empty.
+    std::vector<VkDescriptorBindingFlagsEXT> bindingFlags = {
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create bindless descriptor set layout!");
+
+    // Own pool: its size depends on the arrays, not on the scene.
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, m_maxTextures},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, m_maxSamplers}
+    };
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+
+    if (vkCreateDescriptorPool(getRendererPointer()->getDevice(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create bindless descriptor pool!");
+
+    if (DescriptorManager::allocDescriptorSet(m_descriptorPool, m_descriptorSetLayout, &m_descriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate bindless descriptor set!");
+}
+
+uint32_t BindlessMaterials::registerTexture(const VkImageView& imageView)
+{
+    auto iter = m_textureIndices.find((uint64_t)imageView);
+    if (iter != m_textureIndices.end())
+        return iter->second;
+
+    const uint32_t index = static_cast<uint32_t>(m_textureIndices.size());
+    if (index >= m_maxTextures)
+        throw std::runtime_error("Failed to register bindless texture, the array is full!");
+
+    VkDescriptorImageInfo imageInfo = DescriptorManager::descriptorImageInfo(VK_NULL_HANDLE, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    VkWriteDescriptorSet write = DescriptorManager::writeDescriptorSet(m_descriptorSet, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0, &imageInfo);
+    write.dstArrayElement = index;
+    vkUpdateDescriptorSets(getRendererPointer()->getDevice(), 1, &write, 0, nullptr);
+
+    m_textureIndices[(uint64_t)imageView] = index;
+    return index;
+}
+
+uint32_t BindlessMaterials::registerSampler(const VkSampler& sampler)
+{
+    auto iter = m_samplerIndices.find((uint64_t)sampler);
+    if (iter != m_samplerIndices.end())
+        return iter->second;
+
+    const uint32_t index = static_cast<uint32_t>(m_samplerIndices.size());
+    if (index >= m_maxSamplers)
+        throw std::runtime_error("Failed to register bindless sampler, the array is full!");
+
+    VkDescriptorImageInfo imageInfo = DescriptorManager::descriptorImageInfo(sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED);
+
+    VkWriteDescriptorSet write = DescriptorManager::writeDescriptorSet(m_descriptorSet, VK_DESCRIPTOR_TYPE_SAMPLER, 1, &imageInfo);
+    write.dstArrayElement = index;
+    vkUpdateDescriptorSets(getRendererPointer()->getDevice(), 1, &write, 0, nullptr);
+
+    m_samplerIndices[(uint64_t)sampler] = index;
+    return index;
+}
+
+void BindlessMaterials::createMaterials()
+{
+    const GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+
+    std::vector<GPUMaterialData> materials(gpuCulling->getObjectCount());
+
+    for (uint32_t objectIndex = 0; objectIndex < materials.size(); ++objectIndex)
+    {
+        const MaterialInfo* material = getRenderResource()->m_meshInfoMap[gpuCulling->getObjectMeshIndex(objectIndex)].ref_material;
+
+        const Texture* textures[5] = {
+            &material->colorTexture,
+            &material->metallic_RoughnessTexture,
+            &material->emissiveTexture,
+            &material->AOTexture,
+            &material->normalTexture
+        };
+
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            materials[objectIndex].textures[i] = registerTexture(textures[i]->image->getImageView());
+            materials[objectIndex].samplers[i] = registerSampler(textures[i]->sampler->getSampler());
+        }
+    }
+
+    const VkDeviceSize size = materials.size() * sizeof(GPUMaterialData);
+
+    BufferManager::bufferCreateBuffer(
+        getRendererPointer()->getVmaAllocator(),
+        size,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_CPU_TO_GPU,
+        &m_materialBuffer,
+        &m_materialAllocation
+    );
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_materialAllocation, &data);
+    memcpy(data, materials.data(), size);
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_materialAllocation);
+}
+
+void BindlessMaterials::destroy()
+{
+    vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_materialBuffer, m_materialAllocation);
+
+    vkDestroyDescriptorPool(getRendererPointer()->getDevice(), m_descriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+// Layout must match MaterialData of the bindless shaders(std430).
+struct GPUMaterialData
+{
+    // colorTexture, metallic_RoughnessTexture, emissiveTexture, AOTexture, normalTexture
+    uint32_t    textures[5];
+    uint32_t    samplers[5];
+};
+
+/*
+ * Bindless material textures(VK_EXT_descriptor_indexing):
+ *  - One descriptor set holding every material texture of the scene in a
+ *    sampled image array(binding 0) and every sampler in a sampler
+ *    array(binding 1), both partially bound. Textures and samplers are
+ *    deduplicated by handle.
+ *  - A storage buffer with the texture/sampler indices of each object's
+ *    material, in GPUCulling object order(the shaders index it with
+ *    gl_InstanceIndex, like the object buffer).
+ * The set is bound once per pass instead of one set per mesh.
+ */
+class BindlessMaterials
+{
+public:
+    BindlessMaterials();
+    ~BindlessMaterials() {};
+
+    const VkDescriptorSetLayout& getDescriptorSetLayout() const     { return m_descriptorSetLayout; }
+    const VkDescriptorSet& getDescriptorSet() const                 { return m_descriptorSet; }
+    const VkBuffer& getMaterialBuffer() const                       { return m_materialBuffer; }
+    uint32_t getTextureCount() const                                { return static_cast<uint32_t>(m_textureIndices.size()); }
+    uint32_t getSamplerCount() const                                { return static_cast<uint32_t>(m_samplerIndices.size()); }
+
+    void destroy();
+
+private:
+    void createDescriptorSet();
+    void createMaterials();
+
+    uint32_t registerTexture(const VkImageView& imageView);
+    uint32_t registerSampler(const VkSampler& sampler);
+
+    uint32_t                                m_maxTextures;
+    uint32_t                                m_maxSamplers;
+
+    VkDescriptorPool                        m_descriptorPool;
+    VkDescriptorSetLayout                   m_descriptorSetLayout;
+    VkDescriptorSet                         m_descriptorSet;
+
+    std::unordered_map<uint64_t, uint32_t>  m_textureIndices;
+    std::unordered_map<uint64_t, uint32_t>  m_samplerIndices;
+
+    VkBuffer                                m_materialBuffer;
+    VmaAllocation                           m_materialAllocation;
+};
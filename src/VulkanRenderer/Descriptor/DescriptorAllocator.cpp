@@ -0,0 +1,119 @@
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "VulkanRenderer/Renderer.h"
+
+namespace
+{
+    // Descriptors per set of the unreserved pools.
+    struct PoolSizeRatio
+    {
+        VkDescriptorType    type;
+        float               ratio;
+    };
+
+    const std::vector<PoolSizeRatio> GROWTH_POOL_RATIOS = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f}
+    };
+
+    constexpr uint32_t MAX_GROWTH_SET_COUNT = 4096;
+}
+
+void DescriptorAllocator::addPoolSizes(const std::vector<DescriptorInfo>& descriptorInfo, const uint32_t setCount, std::vector<VkDescriptorPoolSize>& poolSizes)
+{
+    for (const DescriptorInfo& info : descriptorInfo)
+    {
+        auto iter = std::find_if(poolSizes.begin(), poolSizes.end(), [&](const VkDescriptorPoolSize& size) { return size.type == info.descriptorType; });
+
+        if (iter != poolSizes.end())
+            iter->descriptorCount += setCount;
+        else
+            poolSizes.push_back({ info.descriptorType, setCount });
+    }
+}
+
+VkDescriptorPool DescriptorAllocator::createPool(const std::vector<VkDescriptorPoolSize>& poolSizes, const uint32_t maxSets)
+{
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = maxSets;
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(getRendererPointer()->getDevice(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor pool!");
+
+    return pool;
+}
+
+void DescriptorAllocator::createGrowthPool()
+{
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (const PoolSizeRatio& ratio : GROWTH_POOL_RATIOS)
+        poolSizes.push_back({ ratio.type, static_cast<uint32_t>(ratio.ratio * m_growthSetCount) });
+
+    m_pools.push_back(createPool(poolSizes, m_growthSetCount));
+
+    m_growthSetCount = std::min(m_growthSetCount * 2, MAX_GROWTH_SET_COUNT);
+}
+
+void DescriptorAllocator::reserve(const std::vector<DescriptorInfo>& descriptorInfo, const uint32_t setCount)
+{
+    if (setCount == 0)
+        return;
+
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    addPoolSizes(descriptorInfo, setCount, poolSizes);
+
+    // After the current pool, which is used up first.
+    m_pools.push_back(createPool(poolSizes, setCount));
+}
+
+void DescriptorAllocator::allocate(const VkDescriptorSetLayout& layout, VkDescriptorSet* descriptorSet)
+{
+    while (true)
+    {
+        const bool isNewPool = (m_currentPool == m_pools.size());
+        if (isNewPool)
+            createGrowthPool();
+
+        const VkResult result = DescriptorManager::allocDescriptorSet(m_pools[m_currentPool], layout, descriptorSet);
+
+        // A fresh pool that can't hold the set never will.
+        if ((result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) && !isNewPool)
+        {
+            m_currentPool++;
+            continue;
+        }
+
+        if (result != VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate descriptor set!");
+        return;
+    }
+}
+
+void DescriptorAllocator::reset()
+{
+    for (auto& pool : m_pools)
+        vkResetDescriptorPool(getRendererPointer()->getDevice(), pool, 0);
+
+    m_currentPool = 0;
+}
+
+void DescriptorAllocator::destroy()
+{
+    for (auto& pool : m_pools)
+        vkDestroyDescriptorPool(getRendererPointer()->getDevice(), pool, nullptr);
+
+    m_pools.clear();
+    m_currentPool = 0;
+}
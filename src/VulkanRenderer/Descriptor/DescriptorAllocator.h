@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+
+/*
+ * Descriptor sets allocated from a chain of pools:
+ *  - reserve() appends a pool sized exactly for setCount sets of a layout(its
+ *    DESCRIPTORS_INFO) to the chain, so passes that know their set count up
+ *    front never waste descriptors.
+ *  - When the current pool is exhausted(VK_ERROR_OUT_OF_POOL_MEMORY or
+ *    VK_ERROR_FRAGMENTED_POOL) allocate() moves on to the next pool of the
+ *    chain, creating a new one if needed. Unreserved pools use generic sizes
+ *    and double their capacity every time, so descriptors never limit the
+ *    scene size and allocation stays O(1) amortized. Any other failure
+ *    throws.
+ *  - reset() resets every pool at once(sets aren't freed one by one). That's
+ *    what the per frame(transient) allocators of the Renderer are for: reset
+ *    when the frame's fence is signaled, then reused.
+ * Each owner destroys its allocator with itself: the scene and its features
+ * have their own(rebuilt with the scene), the Renderer's is for the ones
+ * living as long as it.
+ * Not thread safe: sets are allocated on the main thread.
+ */
+class DescriptorAllocator
+{
+public:
+    DescriptorAllocator() {};
+    ~DescriptorAllocator() {};
+
+    void reserve(const std::vector<DescriptorInfo>& descriptorInfo, const uint32_t setCount);
+
+    void allocate(const VkDescriptorSetLayout& layout, VkDescriptorSet* descriptorSet);
+
+    void reset();
+    void destroy();
+
+    uint32_t getPoolCount() const { return static_cast<uint32_t>(m_pools.size()); }
+
+    // Adds the descriptors of setCount sets of a layout to poolSizes.
+    static void addPoolSizes(const std::vector<DescriptorInfo>& descriptorInfo, const uint32_t setCount, std::vector<VkDescriptorPoolSize>& poolSizes);
+
+private:
+    VkDescriptorPool createPool(const std::vector<VkDescriptorPoolSize>& poolSizes, const uint32_t maxSets);
+    void createGrowthPool();
+
+    std::vector<VkDescriptorPool>   m_pools;
+    // Pool allocations are made from, pools before it are full(until reset()).
+    uint32_t                        m_currentPool = 0;
+
+    uint32_t                        m_growthSetCount = 32;
+};
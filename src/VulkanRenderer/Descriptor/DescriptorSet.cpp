@@ -8,7 +8,7 @@ VkDescriptorSet& DescriptorSet::get()
 }
 
 
-DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkBuffer& buffer, VkDeviceSize offset, VkDeviceSize range)
+DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkBuffer& buffer, VkDeviceSize offset, VkDeviceSize range)
 	: binding(binding)
 	, type(type)
 	, buffer(buffer)
@@ -17,7 +17,7 @@ DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding,
 {
 }
 
-DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkBuffer& buffer, VkBufferView& bufferView, VkDeviceSize offset, VkDeviceSize range)
+DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkBuffer& buffer, const VkBufferView& bufferView, VkDeviceSize offset, VkDeviceSize range)
 	: binding(binding)
 	, type(type)
 	, buffer(buffer)
@@ -27,7 +27,7 @@ DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding,
 {
 }
 
-DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkSampler& sampler, VkImageView& imageView, VkImageLayout imageLayout)
+DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkSampler& sampler, const VkImageView& imageView, VkImageLayout imageLayout)
 	: binding(binding)
 	, type(type)
 	, sampler(sampler)
@@ -36,7 +36,7 @@ DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding,
 {
 }
 
-DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkImageView& imageView, VkImageLayout imageLayout)
+DescriptorSet::DescriptorSetWriteData::DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkImageView& imageView, VkImageLayout imageLayout)
 	: binding(binding)
 	, type(type)
 	, sampler(VK_NULL_HANDLE)
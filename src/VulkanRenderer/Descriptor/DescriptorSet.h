@@ -17,10 +17,10 @@ public:
 		VkSampler sampler;
 		VkImageView imageView;
 		VkImageLayout imageLayout;
-		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkBuffer& buffer, VkDeviceSize offset, VkDeviceSize range);
-		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkBuffer& buffer, VkBufferView& bufferView, VkDeviceSize offset, VkDeviceSize range);
-		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkSampler& sampler, VkImageView& imageView, VkImageLayout imageLayout);
-		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, VkImageView& imageView, VkImageLayout imageLayout);
+		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkBuffer& buffer, VkDeviceSize offset, VkDeviceSize range);
+		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkBuffer& buffer, const VkBufferView& bufferView, VkDeviceSize offset, VkDeviceSize range);
+		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkSampler& sampler, const VkImageView& imageView, VkImageLayout imageLayout);
+		DescriptorSetWriteData(uint32_t binding, VkDescriptorType type, const VkImageView& imageView, VkImageLayout imageLayout);
 	};
 	DescriptorSet() {};
 	~DescriptorSet() {};
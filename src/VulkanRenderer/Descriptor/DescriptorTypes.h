@@ -57,9 +57,9 @@ namespace DescriptorTypes
 
         struct alignas(16) Deferred
         {
-            glm::mat4 lightSpace;
+            // Rebuilds the position from the depth.
+            glm::mat4 invViewProj;
             glm::vec4 cameraPos;
-            int lightsCount;
         };
     };
 };
\ No newline at end of file
@@ -60,14 +60,49 @@ void Device::createLogicalDevice(
     deviceFeatures.shaderUniformBufferArrayDynamicIndexing = VK_TRUE;
     deviceFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
     deviceFeatures.shaderStorageImageArrayDynamicIndexing = VK_TRUE;
+    // GPU-driven submission(GPUCulling).
+    deviceFeatures.multiDrawIndirect = VK_TRUE;
+    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
 
-    VkPhysicalDeviceDescriptorIndexingFeaturesEXT ext = {};
-    ext.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    // - Specifies which device EXTENSIONS we want to use.
+    // The optional ones are only enabled if the device has them.
+    m_enabledExtensions = m_requiredExtensions;
+    for (const auto& optionalExtension : m_optionalExtensions)
+    {
+        if (isExtensionSupported(m_physicalDevice, optionalExtension))
+            m_enabledExtensions.push_back(optionalExtension);
+    }
+
+    // Descriptor indexing(bindless material textures), only what BindlessMaterials uses.
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedIndexingFeatures{};
+    supportedIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+
+    if (isExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceFeatures2 supportedFeatures2{};
+        supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures2.pNext = &supportedIndexingFeatures;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures2);
+    }
+
+    m_isDescriptorIndexingSupported =
+        supportedIndexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+        supportedIndexingFeatures.descriptorBindingPartiallyBound &&
+        supportedIndexingFeatures.runtimeDescriptorArray;
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    indexingFeatures.pNext = pNextChain;
+    indexingFeatures.shaderSampledImageArrayNonUniformIndexing = m_isDescriptorIndexingSupported;
+    indexingFeatures.descriptorBindingPartiallyBound = m_isDescriptorIndexingSupported;
+    indexingFeatures.runtimeDescriptorArray = m_isDescriptorIndexingSupported;
+
+    if (m_isDescriptorIndexingSupported)
+        pNextChain = &indexingFeatures;
 
     // Now we can create the logical device.
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.pNext = &ext;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -86,10 +121,9 @@ void Device::createLogicalDevice(
         createInfo.pEnabledFeatures = &deviceFeatures;
     }
 
-    // - Specifies which device EXTENSIONS we want to use.
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_requiredExtensions.size());
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(m_enabledExtensions.size());
 
-    createInfo.ppEnabledExtensionNames = m_requiredExtensions.data();
+    createInfo.ppEnabledExtensionNames = m_enabledExtensions.data();
 
     // Previous implementations of Vulkan made a distinction between instance 
     // and device specific validation layers, but this is no longer the 
@@ -174,6 +208,9 @@ bool Device::isPhysicalDeviceSuitable(
     if (!deviceFeatures.samplerAnisotropy)
         return false;
 
+    if (!deviceFeatures.multiDrawIndirect || !deviceFeatures.drawIndirectFirstInstance)
+        return false;
+
     // For now, we will just return the dedicated one.
     if (deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
         return false;
@@ -231,6 +268,36 @@ bool Device::areAllExtensionsSupported(
     return true;
 }
 
+bool Device::isExtensionSupported(
+    const VkPhysicalDevice& physicalDevice,
+    const char* extension
+) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto& availableExtension : availableExtensions)
+    {
+        if (std::strcmp(extension, availableExtension.extensionName) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool Device::isExtensionEnabled(const char* extension) const
+{
+    for (const auto& enabledExtension : m_enabledExtensions)
+    {
+        if (std::strcmp(extension, enabledExtension) == 0)
+            return true;
+    }
+
+    return false;
+}
+
 const VkDevice& Device::getLogicalDevice() const
 {
     return m_logicalDevice;
@@ -246,6 +313,11 @@ const SwapchainSupportedProperties& Device::getSupportedProperties() const
     return m_supportedProperties;
 }
 
+void Device::updateSupportedProperties(const VkSurfaceKHR& surface)
+{
+    findSupportedProperties(m_physicalDevice, surface, m_supportedProperties);
+}
+
 /*
  * Verifies if the device is compatible with the swapchain.
 */
@@ -24,6 +24,10 @@ public:
     const std::string& getDeviceName() const;
     const uint32_t& getApiVersion() const;
     const SwapchainSupportedProperties& getSupportedProperties() const;
+    // The surface's capabilities(extent) change with the window: before recreating the swapchain.
+    void updateSupportedProperties(const VkSurfaceKHR& surface);
+    bool isExtensionEnabled(const char* extension) const;
+    bool isDescriptorIndexingSupported() const { return m_isDescriptorIndexingSupported; }
 
 
 private:
@@ -55,6 +59,10 @@ private:
     bool areAllExtensionsSupported(
         const VkPhysicalDevice& possiblePhysicalDevice
     );
+    bool isExtensionSupported(
+        const VkPhysicalDevice& physicalDevice,
+        const char* extension
+    );
 
     VkPhysicalDevice               m_physicalDevice;
     VkDevice                       m_logicalDevice;
@@ -63,4 +71,11 @@ private:
     SwapchainSupportedProperties   m_supportedProperties;
 
     const std::vector<const char*> m_requiredExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME ,VK_KHR_DEVICE_GROUP_EXTENSION_NAME };
+    const std::vector<const char*> m_optionalExtensions = {
+        VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME,
+        VK_KHR_MAINTENANCE3_EXTENSION_NAME,
+        VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
+    };
+    std::vector<const char*>       m_enabledExtensions;
+    bool                           m_isDescriptorIndexingSupported = false;
 };
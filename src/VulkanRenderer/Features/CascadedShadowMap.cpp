@@ -1,463 +1,1030 @@
-//#include "VulkanRenderer/Features/CascadedShadowMap.h"
-//
-//#include <memory>
-//
-//#include <vulkan/vulkan.h>
-//
-//#include <glm/glm.hpp>
-//#include <glm/gtc/matrix_transform.hpp>
-//#include <stdexcept>
-//
-//#include "VulkanRenderer/Settings/GraphicsPipelineConfig.h"
-//#include "VulkanRenderer/Settings/Config.h"
-//#include "VulkanRenderer/Framebuffer/FramebufferManager.h"
-//#include "VulkanRenderer/Math/MathUtils.h"
-//#include "VulkanRenderer/Model/Attributes.h"
-//#include "VulkanRenderer/RenderPass/AttachmentUtils.h"
-//
-//#include "VulkanRenderer/Command/CommandManager.h"
-//#include "VulkanRenderer/Buffer/BufferManager.h"
-//#include "VulkanRenderer/Descriptor/DescriptorTypes.h"
-//#include "VulkanRenderer/Descriptor/DescriptorManager.h"
-//#include "VulkanRenderer/Pipeline/PipelineManager.h"
-//#include "VulkanRenderer/Shader/ShaderManager.h"
-//
-//#include "VulkanRenderer/Model/ModelManager.h"
-//#include "VulkanRenderer/Renderer.h" 
-//
-//
-//CascadedShadowMap::CascadedShadowMap(
-//    const VkExtent2D& extent,
-//    const uint32_t imagesCount,
-//    const VkFormat& format,
-//    const float& lambda,
-//    const float& near_offset,
-//    const uint32_t& split_count
-//) : m_width(extent.width), m_height(extent.height),m_lambda(lambda),m_near_offset(near_offset),m_split_count(split_count)
-//{
-//    m_clearValuesCascadedShadowMap.resize(2);
-//    m_clearValuesCascadedShadowMap[0].depthStencil.depth = 1.0f;
-//    m_clearValuesCascadedShadowMap[1].depthStencil.depth = 1.0f;
-//    m_clearValuesCascadedShadowMap[0].depthStencil.stencil = 0.0f;
-//    m_clearValuesCascadedShadowMap[1].depthStencil.stencil = 0.0f;
-//
-//    m_texture = std::make_shared<NormalTexture>("CascadedShadowMap");
-//    m_texture->getFormat() = format;
-//    m_texture->getExtent() = VkExtent2D({ m_width,m_height });
-//
-//
-//    BufferManager::bufferCreateOffscreenResources(
-//        getRendererPointer()->getDevice(),
-//        getRendererPointer()->getVmaAllocator(),
-//        getRendererPointer()->getGraphicsQueue(),
-//        m_texture->getExtent(),
-//        m_texture->getFormat(),
-//        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-//        1,
-//        m_split_count,
-//        0,
-//        VK_SAMPLE_COUNT_1_BIT,
-//        VK_IMAGE_VIEW_TYPE_2D,
-//        &m_texture->getAllocation(),
-//        m_texture
-//    );
-//
-//
-//    BufferManager::bufferTransitionImageLayout(
-//        getRendererPointer()->getDevice(),
-//        getRendererPointer()->getGraphicsQueue(),
-//        getRendererPointer()->getCommandPool(),
-//        m_texture->getImage(),
-//        format,
-//        VK_IMAGE_ASPECT_DEPTH_BIT,
-//        1,
-//        m_split_count,
-//        VK_IMAGE_LAYOUT_UNDEFINED,
-//        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-//    );
-//
-//
-//
-//    createRenderPass(format);
-//    createFramebuffer(imagesCount);
-//    createGraphicsPipeline(extent);
-//
-//    //Create UBOs && DescriptorSets PerMesh
-//    createUBOs();
-//    createDescriptorSets();
-//
-//
-//    //Create CommandPool
-//    CommandManager::cmdCreateCommandPool(
-//        getRendererPointer()->getDevice(),
-//        VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-//        getRendererPointer()->getQueueFamilyIndices().graphicsFamily.value(),
-//        &m_commandPool
-//    );
-//
-//    //Create CommandBuffers
-//    m_commandBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
-//    CommandManager::cmdCreateCommandBuffers(
-//        getRendererPointer()->getDevice(),
-//        m_commandPool,
-//        VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-//        Config::MAX_FRAMES_IN_FLIGHT,
-//        &m_commandBuffers[0]
-//    );
-//
-//}
-//
-//
-//void CascadedShadowMap::createGraphicsPipeline(const VkExtent2D& extent)
-//{
-//    //-------------------------------- Shadow Pipeline --------------------------------------
-//    {
-//        const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::SHADOWMAP::DESCRIPTORS_INFO;
-//
-//        std::vector<VkDescriptorSetLayoutBinding> bindings(descriptorInfo.size());
-//        for (uint32_t i = 0; i < descriptorInfo.size(); i++)
-//        {
-//            bindings[i].binding = descriptorInfo[i].bindingNumber;
-//            bindings[i].descriptorType = descriptorInfo[i].descriptorType;
-//            bindings[i].descriptorCount = 1;
-//            bindings[i].stageFlags = descriptorInfo[i].shaderStage;
-//            bindings[i].pImmutableSamplers = nullptr;
-//        }
-//
-//        VkDescriptorSetLayoutCreateInfo layoutInfo{};
-//        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-//        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-//        layoutInfo.pBindings = bindings.data();
-//
-//        if (vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
-//            throw std::runtime_error("Failed to create descriptor set layout!");
-//
-//
-//        // -------------------Shader Modules--------------------
-//        const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "shadowMap"} };
-//
-//        std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-//        std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-//        for (uint32_t i = 0; i < shaderInfos.size(); i++)
-//        {
-//            PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-//            PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-//        }
-//
-//
-//        // Dynamic states
-//        std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-//        VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-//
-//
-//        // Viewport state info
-//        VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-//        // Vertex input(attributes)
-//        std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::SHADOWMAP::getAttributeDescriptions();
-//        VkVertexInputBindingDescription bindingDescription = Attributes::PBR::getBindingDescription();
-//        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-//        PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-//        // Input assembly
-//        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-//        // Rasterizer
-//        VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0, VK_TRUE, 4.0f, 1.5f);
-//        // Multisampling 
-//        VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(VK_SAMPLE_COUNT_1_BIT, 0);
-//        // Color blending(attachment)
-//        VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-//        // Color blending(global)
-//        VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-//
-//        // Pipeline layout
-//        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-//        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-//        pipelineLayoutInfo.setLayoutCount = 1;
-//        pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-//        pipelineLayoutInfo.pushConstantRangeCount = 0;
-//        pipelineLayoutInfo.pPushConstantRanges = nullptr;
-//        auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
-//        if (status != VK_SUCCESS)
-//            throw std::runtime_error("Failed to create pipeline layout!");
-//
-//        // Depth and stencil
-//        VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS_OR_EQUAL);
-//
-//        VkGraphicsPipelineCreateInfo pipelineInfo{};
-//        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-//        pipelineInfo.stageCount = shaderInfos.size();
-//        pipelineInfo.pStages = shaderStagesInfos.data();
-//        pipelineInfo.pVertexInputState = &vertexInputInfo;
-//        pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-//        pipelineInfo.pViewportState = &viewportState;
-//        pipelineInfo.pRasterizationState = &rasterizationState;
-//        pipelineInfo.pMultisampleState = &multisampleState;
-//        pipelineInfo.pDepthStencilState = &depthStencilState;
-//        pipelineInfo.pColorBlendState = &colorBlendState;
-//        pipelineInfo.pDynamicState = &dynamicState;
-//        pipelineInfo.pTessellationState = nullptr;
-//        pipelineInfo.pNext = nullptr;
-//        pipelineInfo.layout = m_pipelineLayout;
-//        pipelineInfo.renderPass = m_renderPass.get();
-//        pipelineInfo.subpass = 0;
-//        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-//        pipelineInfo.basePipelineIndex = -1;
-//
-//        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
-//        if (status != VK_SUCCESS)
-//            throw std::runtime_error("Failed to create graphics pipeline!");
-//
-//        for (auto& shaderModule : shaderModules)
-//        {
-//            ShaderManager::destroyShaderModule(shaderModule);
-//        }
-//    }
-//}
-//
-//
-//CascadedShadowMap::~CascadedShadowMap() {}
-//
-//
-//
-//void CascadedShadowMap::updateUBO()
-//{
-//    for (auto ptr : getRenderResource()->m_normalModels)
-//    {
-//
-//        for (uint32_t meshIndex : ptr->getMeshIndices())
-//        {
-//            m_basicInfo.model = ptr->getModelMatrix();
-//
-//            //glm::mat4 proj = MathUtils::getUpdatedProjMatrix(glm::radians(Config::FOV), 1.0, Config::Z_NEAR_SHADOW, Config::Z_FAR_SHADOW);
-//            glm::mat4 proj = glm::ortho(-8.0f, 8.0f, -8.0f, 8.0f, 0.5f, 50.0f);
-//
-//            proj[1][1] *= -1;
-//
-//            LightInfo& info = getRenderResource()->m_lightsInfo[getRenderResource()->m_directionalLightIndex];
-//
-//            glm::fvec3 lightDir = glm::normalize(info.m_targetPos - info.pos);
-//
-//            glm::mat4 view = glm::lookAt(info.pos, info.pos + lightDir, glm::fvec3(0.0f, 1.0f, 0.0f));
-//
-//            m_basicInfo.lightSpace = proj * view;
-//
-//            void* data;
-//            vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_uboAllocationsMap[meshIndex], &data);
-//            memcpy(data, &m_basicInfo, sizeof(m_basicInfo));
-//            vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_uboAllocationsMap[meshIndex]);
-//        }
-//
-//    }
-//}
-//
-//void CascadedShadowMap::draw(uint32_t imageIndex, uint32_t currentFrame)
-//{
-//    VkCommandBuffer& commandBuffer = getRendererPointer()->getGraphicsCommandBuffer(currentFrame);
-//
-//    //--------------------------------RenderPass-----------------------------
-//    m_renderPass.begin(m_framebuffers[imageIndex], VkExtent2D({ m_width,m_height }), m_clearValuesCascadedShadowMap, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
-//
-//    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
-//
-//    // Set Dynamic States
-//    VkViewport viewport{ 0.0f, 0.0f,m_width,m_height, 0.0f, 1.0f };
-//    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-//
-//    VkRect2D scissor{ {0,0}, {m_width,m_height} };
-//    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-//    {
-//        for (auto ptr : getRenderResource()->m_normalModels)
-//        {
-//            for (uint32_t meshIndex : ptr->getMeshIndices())
-//            {
-//                RenderMeshInfo& meshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
-//
-//                std::vector<VkDeviceSize> offsets = { 0 };
-//                vkCmdBindVertexBuffers(commandBuffer, 0, 1, meshInfo.ref_mesh->vertexBuffer, offsets.data());
-//                vkCmdBindIndexBuffer(commandBuffer, *meshInfo.ref_mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-//
-//                const std::vector<VkDescriptorSet> sets = { m_descriptorSetsMap[meshIndex] };
-//                vkCmdBindDescriptorSets(
-//                    commandBuffer,
-//                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-//                    m_pipelineLayout,
-//                    0,
-//                    sets.size(), sets.data(),
-//                    0, {}
-//                );
-//
-//                vkCmdDrawIndexed(commandBuffer, meshInfo.ref_mesh->meshIndexCount, 1, 0, 0, 0);
-//            }
-//        }
-//    }
-//    m_renderPass.end(commandBuffer);
-//}
-//
-//
-//
-//const VkCommandBuffer& CascadedShadowMap::getCommandBuffer(const uint32_t index) const
-//{
-//    return m_commandBuffers[index];
-//}
-//
-//const std::shared_ptr<TextureBase> CascadedShadowMap::get() const
-//{
-//    return m_texture;
-//}
-//
-//
-//const VkImageView& CascadedShadowMap::getCascadedShadowMapView() const
-//{
-//    return m_texture->getImageView();
-//}
-//
-//
-//const VkSampler& CascadedShadowMap::getSampler() const
-//{
-//    return m_texture->getSampler();
-//}
-//
-//const VkFramebuffer& CascadedShadowMap::getFramebuffer(const uint32_t imageIndex) const
-//{
-//    return m_framebuffers[imageIndex];
-//}
-//
-//
-//const VkCommandPool& CascadedShadowMap::getCommandPool() const
-//{
-//    return m_commandPool;
-//}
-//
-//
-//const glm::mat4& CascadedShadowMap::getLightSpace() const
-//{
-//    return m_basicInfo.lightSpace;
-//}
-//
-//
-//const RenderPass& CascadedShadowMap::getRenderPass() const
-//{
-//    return m_renderPass;
-//}
-//
-//
-//
-//void CascadedShadowMap::createFramebuffer(const uint32_t& imagesCount)
-//{
-//
-//    m_framebuffers.resize(imagesCount);
-//    std::vector<VkImageView> attachments = { m_texture->getImageView() };
-//
-//    for (uint32_t i = 0; i < imagesCount; i++)
-//    {
-//        FramebufferManager::createFramebuffer(getRendererPointer()->getDevice(), m_renderPass.get(), attachments, m_width, m_height, 1, &m_framebuffers[i]);
-//    }
-//}
-//
-//void CascadedShadowMap::createUBOs()
-//{
-//    for (auto ptr : getRenderResource()->m_normalModels)
-//    {
-//        for (uint32_t meshIndex : ptr->getMeshIndices())
-//        {
-//            BufferManager::bufferCreateBuffer(
-//                getRendererPointer()->getVmaAllocator(),
-//                sizeof(DescriptorTypes::UniformBufferObject::ShadowMap),
-//                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-//                VMA_MEMORY_USAGE_CPU_TO_GPU,
-//                &m_ubosMap[meshIndex],
-//                &m_uboAllocationsMap[meshIndex]
-//            );
-//        }
-//    }
-//}
-//
-//void CascadedShadowMap::createDescriptorSets()
-//{
-//    //------------------------------- DescriptorSets  ----------------------------------
-//    for (auto ptr : getRenderResource()->m_normalModels)
-//    {
-//        for (uint32_t meshIndex : ptr->getMeshIndices())
-//        {
-//            m_descriptorSetsMap[meshIndex];
-//            {
-//                DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayout, &m_descriptorSetsMap[meshIndex]);
-//
-//                VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_ubosMap[meshIndex]);
-//
-//                std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
-//                    DescriptorManager::writeDescriptorSet(m_descriptorSetsMap[meshIndex], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
-//                };
-//                vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
-//            }
-//        }
-//    }
-//
-//}
-//
-//
-//
-//
-//void CascadedShadowMap::destroy()
-//{
-//    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
-//    vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
-//    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
-//
-//
-//    m_texture->destroy();
-//
-//
-//    for (auto& uboInfo : m_ubosMap)
-//    {
-//        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), uboInfo.second, m_uboAllocationsMap[uboInfo.first]);
-//    }
-//
-//
-//    vkDestroyCommandPool(getRendererPointer()->getDevice(), m_commandPool, nullptr);
-//
-//    m_renderPass.destroy();
-//
-//    for (auto& framebuffer : m_framebuffers)
-//        vkDestroyFramebuffer(getRendererPointer()->getDevice(), framebuffer, nullptr);
-//}
-//
-//
-//void CascadedShadowMap::createRenderPass(const VkFormat& depthBufferFormat)
-//{
-//    // - Attachments
-//    VkAttachmentDescription shadowMapAttachment{};
-//    AttachmentUtils::createAttachmentDescriptionWithStencil(
-//        depthBufferFormat,
-//        VK_SAMPLE_COUNT_1_BIT,
-//        VK_ATTACHMENT_LOAD_OP_CLEAR,
-//        VK_ATTACHMENT_STORE_OP_STORE,
-//        VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-//        VK_ATTACHMENT_STORE_OP_DONT_CARE,
-//        VK_IMAGE_LAYOUT_UNDEFINED,
-//        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-//        shadowMapAttachment
-//    );
-//
-//
-//    // Attachment references
-//    VkAttachmentReference shadowMapAttachmentRef{};
-//    AttachmentUtils::createAttachmentReference(
-//        0,
-//        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-//        shadowMapAttachmentRef
-//    );
-//
-//    // Subpasses
-//    VkSubpassDescription subpass = {};
-//    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-//    subpass.flags = 0;
-//    subpass.pDepthStencilAttachment = &shadowMapAttachmentRef;
-//
-//    m_renderPass = RenderPass(
-//        { shadowMapAttachment },
-//        { subpass },
-//        {}
-//        //dependencies
-//    );
-//
-//}
+#include "VulkanRenderer/Features/CascadedShadowMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "VulkanRenderer/Settings/GraphicsPipelineConfig.h"
+#include "VulkanRenderer/Settings/config.h"
+#include "VulkanRenderer/Framebuffer/FramebufferManager.h"
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+#include "VulkanRenderer/Model/Attributes.h"
+#include "VulkanRenderer/RenderPass/AttachmentUtils.h"
+#include "VulkanRenderer/RenderPass/SubPassUtils.h"
+
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Pipeline/PipelineManager.h"
+
+#include "VulkanRenderer/Model/ModelManager.h"
+#include "VulkanRenderer/Renderer.h"
+
+
+static_assert(Config::SHADOW_CASCADE_COUNT <= 4, "The split depths of the cascades are a vec4.");
+
+
+CascadedShadowMap::CascadedShadowMap(
+    const uint32_t resolution,
+    const VkFormat& format,
+    const float lambda,
+    const uint32_t cascadeCount
+) : m_lambda(lambda), m_cascadeCount(cascadeCount), m_resolution(resolution)
+{
+    if (m_cascadeCount == 0 || m_cascadeCount > Config::SHADOW_CASCADE_COUNT)
+        throw std::runtime_error("Failed to create cascaded shadow map: unsupported cascade count!");
+
+    m_clearValues.resize(1);
+    m_clearValues[0].depthStencil.depth = 1.0f;
+    m_clearValues[0].depthStencil.stencil = 0;
+
+    // Barriers on a depth/stencil image cover both aspects.
+    const bool hasStencil = (format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT);
+    m_aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+
+    m_image = Image::Create2DImageArray(
+        VkExtent2D({ m_resolution, m_resolution }),
+        format,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        VK_IMAGE_ASPECT_DEPTH_BIT,
+        m_cascadeCount
+    );
+
+    m_staticImage = Image::Create2DImageArray(
+        VkExtent2D({ m_resolution, m_resolution }),
+        format,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        VK_IMAGE_ASPECT_DEPTH_BIT,
+        m_cascadeCount
+    );
+
+    // Rendered through a view per layer.
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        m_image->AddImageView("Cascade" + std::to_string(i), VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT, i, 1);
+        m_staticImage->AddImageView("Cascade" + std::to_string(i), VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_ASPECT_DEPTH_BIT, i, 1);
+    }
+
+    // Every frame leaves it ready to be sampled(the render graph imports it so).
+    BufferManager::bufferTransitionImageLayout(
+        getRendererPointer()->getDevice(),
+        getRendererPointer()->getGraphicsQueue(),
+        getRendererPointer()->getCommandPool(),
+        m_image->getImage(),
+        format,
+        VK_IMAGE_ASPECT_DEPTH_BIT,
+        1,
+        m_cascadeCount,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    );
+
+    m_isStaticValid.assign(m_cascadeCount, false);
+    m_staticLightSpaces.assign(m_cascadeCount, glm::mat4(1.0f));
+    m_isOnlyStatic.assign(m_cascadeCount, false);
+
+    // White border: the PCF taps past a cascade's edges are lit.
+    m_imageSampler = new ImageSampler(
+        VK_FILTER_NEAREST,
+        VK_FILTER_NEAREST,
+        VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        16,
+        VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+        1
+    );
+
+    createRenderPass(format);
+    createFramebuffers();
+    createGraphicsPipeline();
+
+    createUBOs();
+    createDescriptorSets();
+
+    m_staticCache = std::make_unique<StaticCommandCache>();
+}
+
+
+void CascadedShadowMap::createGraphicsPipeline()
+{
+    //---------------------------- Cascaded Shadow Pipeline ----------------------------
+    {
+        const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::CASCADED_SHADOWMAP::DESCRIPTORS_INFO;
+
+        std::vector<VkDescriptorSetLayoutBinding> bindings(descriptorInfo.size());
+        for (uint32_t i = 0; i < descriptorInfo.size(); i++)
+        {
+            bindings[i].binding = descriptorInfo[i].bindingNumber;
+            bindings[i].descriptorType = descriptorInfo[i].descriptorType;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = descriptorInfo[i].shaderStage;
+            bindings[i].pImmutableSamplers = nullptr;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if (vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+
+        // Set 0: mesh, set 1: cascade
+        std::vector<VkDescriptorSetLayout> setLayouts = { m_descriptorSetLayout, m_descriptorSetLayout };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pPushConstantRanges = nullptr;
+        auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline layout!");
+
+        GraphicsPipelineDesc desc;
+        desc.name = "cascaded shadow map";
+        desc.shaders = { {shaderType::VERTEX, "cascadedShadowMap"} };
+        desc.vertexBinding = Attributes::PBR::getBindingDescription();
+        desc.vertexAttributes = Attributes::SHADOWMAP::getAttributeDescriptions();
+        desc.layout = m_pipelineLayout;
+        desc.renderPass = m_renderPass.get();
+        desc.subpass = 0;
+        desc.depthBiasEnable = VK_TRUE;
+        desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        desc.colorAttachmentCount = 0;
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
+
+        //------------------------- Indirect Cascaded Shadow Pipeline ----------------------
+        // shadowMapIndirect.vert, with the cascade's light space as UBO.
+        const std::vector<DescriptorInfo>& indirectDescriptorInfo = GRAPHICS_PIPELINE::SHADOWMAP_INDIRECT::DESCRIPTORS_INFO;
+
+        std::vector<VkDescriptorSetLayoutBinding> indirectBindings(indirectDescriptorInfo.size());
+        for (uint32_t i = 0; i < indirectDescriptorInfo.size(); i++)
+        {
+            indirectBindings[i].binding = indirectDescriptorInfo[i].bindingNumber;
+            indirectBindings[i].descriptorType = indirectDescriptorInfo[i].descriptorType;
+            indirectBindings[i].descriptorCount = 1;
+            indirectBindings[i].stageFlags = indirectDescriptorInfo[i].shaderStage;
+            indirectBindings[i].pImmutableSamplers = nullptr;
+        }
+
+        layoutInfo.bindingCount = static_cast<uint32_t>(indirectBindings.size());
+        layoutInfo.pBindings = indirectBindings.data();
+
+        if (vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_indirectDescriptorSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_indirectDescriptorSetLayout;
+        status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_indirectPipelineLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline layout!");
+
+        desc.name = "cascaded shadow map indirect";
+        desc.shaders = { {shaderType::VERTEX, "shadowMapIndirect"} };
+        desc.layout = m_indirectPipelineLayout;
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_indirectPipeline);
+    }
+}
+
+
+/*
+ * Practical split scheme(Zhang et al.): the far depth of cascade i is
+ *   lambda * n * (f / n)^(i / N) + (1 - lambda) * (n + (f - n) * i / N)
+ * between the camera near and the shadow distance.
+ */
+void CascadedShadowMap::updateCascades()
+{
+    const Camera& camera = getRenderResource()->m_camera;
+
+    const float zNear = static_cast<float>(camera.getCameraNear());
+    const float zFar = std::min(static_cast<float>(camera.getCameraFar()), Config::SHADOW_DISTANCE);
+    const float tanHalfFov = std::tan(glm::radians(static_cast<float>(camera.getCameraFov())) * 0.5f);
+    const float aspect = static_cast<float>(camera.getAspect());
+
+    const glm::mat4 view = camera.getViewMatrix();
+    const glm::mat4 invView = glm::inverse(view);
+
+    const LightInfo& light = getRenderResource()->m_lightsInfo[getRenderResource()->m_directionalLightIndex];
+    const glm::fvec3 lightDir = glm::normalize(light.m_targetPos - light.pos);
+    const glm::fvec3 up = (std::abs(lightDir.y) > 0.99f) ? glm::fvec3(0.0f, 0.0f, 1.0f) : glm::fvec3(0.0f, 1.0f, 0.0f);
+
+    // Light orientation only, the cascades are snapped in this space.
+    const glm::mat4 lightRotation = glm::lookAt(glm::fvec3(0.0f), lightDir, up);
+    const glm::mat4 invLightRotation = glm::inverse(lightRotation);
+
+    // Closest point of the scene to the light(looking down -z).
+    float sceneTop = std::numeric_limits<float>::lowest();
+    const AxisAlignedBox sceneBounds = getRenderResource()->m_sceneBVH.getBounds();
+    if (sceneBounds.isValid())
+    {
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            const glm::fvec3 point(
+                (corner & 1) ? sceneBounds.max.x : sceneBounds.min.x,
+                (corner & 2) ? sceneBounds.max.y : sceneBounds.min.y,
+                (corner & 4) ? sceneBounds.max.z : sceneBounds.min.z
+            );
+            sceneTop = std::max(sceneTop, (lightRotation * glm::vec4(point, 1.0f)).z);
+        }
+    }
+
+    m_cascades.view = view;
+
+    float splitNear = zNear;
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        const float ratio = static_cast<float>(i + 1) / m_cascadeCount;
+        const float logSplit = zNear * std::pow(zFar / zNear, ratio);
+        const float uniformSplit = zNear + (zFar - zNear) * ratio;
+        const float splitFar = m_lambda * logSplit + (1.0f - m_lambda) * uniformSplit;
+
+        // Sub-frustum corners(world space).
+        glm::fvec3 corners[8];
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            const float depth = (corner & 4) ? splitFar : splitNear;
+            const glm::fvec3 viewPoint(
+                ((corner & 1) ? 1.0f : -1.0f) * depth * tanHalfFov * aspect,
+                ((corner & 2) ? 1.0f : -1.0f) * depth * tanHalfFov,
+                -depth
+            );
+            corners[corner] = glm::fvec3(invView * glm::vec4(viewPoint, 1.0f));
+        }
+
+        glm::fvec3 center(0.0f);
+        for (const glm::fvec3& corner : corners)
+            center += corner;
+        center /= 8.0f;
+
+        // The sphere only depends on the split depths: same size whichever way the camera looks.
+        float radius = 0.0f;
+        for (const glm::fvec3& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // Moves by whole texels only.
+        const float texelSize = 2.0f * radius / m_resolution;
+        glm::vec4 lightCenter = lightRotation * glm::vec4(center, 1.0f);
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+        center = glm::fvec3(invLightRotation * lightCenter);
+
+        // From the closest caster to the back of the sphere.
+        const float casterDistance = std::max(radius, sceneTop - lightCenter.z);
+
+        const glm::mat4 lightView = glm::lookAt(center, center + lightDir, up);
+        glm::mat4 proj = glm::orthoZO(-radius, radius, -radius, radius, -casterDistance, radius);
+        proj[1][1] *= -1;
+
+        m_cascades.lightSpace[i] = proj * lightView;
+        m_cascades.splitDepths[i] = splitFar;
+
+        splitNear = splitFar;
+    }
+
+    // Unused cascades are never picked.
+    for (uint32_t i = m_cascadeCount; i < Config::SHADOW_CASCADE_COUNT; i++)
+        m_cascades.splitDepths[i] = std::numeric_limits<float>::lowest();
+}
+
+
+/*
+ * Only the model matrices that changed are uploaded. A model switching between
+ * static and dynamic changes what the static cascades hold: they all become stale.
+ */
+void CascadedShadowMap::updateCasters()
+{
+    bool hasStaticSetChanged = false;
+
+    for (auto ptr : getRenderResource()->m_normalModels)
+    {
+        const glm::mat4 modelMatrix = ptr->getModelMatrix();
+
+        auto iter = m_casterStates.find(ptr.get());
+        const bool isNew = (iter == m_casterStates.end());
+
+        CasterState& state = m_casterStates[ptr.get()];
+        const bool wasDynamic = !isNew && state.stillFrames < Config::SHADOW_STATIC_FRAMES;
+        const bool hasMoved = isNew || state.modelMatrix != modelMatrix;
+
+        if (isNew)
+            state.stillFrames = Config::SHADOW_STATIC_FRAMES;
+        else if (hasMoved || state.isHidden != ptr->isHidden())
+            state.stillFrames = 0;
+        else if (state.stillFrames < Config::SHADOW_STATIC_FRAMES)
+            state.stillFrames++;
+
+        state.modelMatrix = modelMatrix;
+        state.isHidden = ptr->isHidden();
+
+        const bool isDynamic = state.stillFrames < Config::SHADOW_STATIC_FRAMES;
+        hasStaticSetChanged |= isNew || (isDynamic != wasDynamic);
+
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            if (isDynamic && !state.isHidden)
+                m_dynamicMeshes.insert(meshIndex);
+            else
+                m_dynamicMeshes.erase(meshIndex);
+
+            if (!hasMoved)
+                continue;
+
+            void* data;
+            vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_uboAllocationsMap[meshIndex], &data);
+            memcpy(data, &modelMatrix, sizeof(glm::mat4));
+            vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_uboAllocationsMap[meshIndex]);
+        }
+    }
+
+    if (hasStaticSetChanged)
+    {
+        m_staticSetVersion++;
+        m_isStaticValid.assign(m_cascadeCount, false);
+    }
+}
+
+void CascadedShadowMap::updateUBO(const uint32_t frameIndex)
+{
+    updateCascades();
+    updateCasters();
+
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        const uint32_t ubo = frameIndex * m_cascadeCount + i;
+
+        void* data;
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_cascadeUBOAllocations[ubo], &data);
+        memcpy(data, &m_cascades.lightSpace[i], sizeof(glm::mat4));
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_cascadeUBOAllocations[ubo]);
+    }
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_cascadesUBOAllocations[frameIndex], &data);
+    memcpy(data, &m_cascades, sizeof(m_cascades));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_cascadesUBOAllocations[frameIndex]);
+}
+
+/*
+ * Per cascade:
+ *  - The static depth is re-rendered when it's stale(cascade moved, static set
+ *    changed), it's left in the static image as transfer source.
+ *  - The sampled layer is refreshed when the static depth changed or dynamic
+ *    casters overlap it(or did last frame): the static depth is copied and the
+ *    dynamic casters drawn on top. Otherwise it keeps last frame's content.
+ */
+void CascadedShadowMap::draw(uint32_t imageIndex, uint32_t currentFrame)
+{
+    VkCommandBuffer& commandBuffer = getRendererPointer()->getGraphicsCommandBuffer(currentFrame);
+
+    GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+    const bool isGPUDriven = getRendererPointer()->isGPUDrivenEnabled();
+
+    // The GPU-driven path draws the dynamic casters in the static cascades.
+    if (isGPUDriven != m_isStaticGPUDriven)
+    {
+        m_isStaticGPUDriven = isGPUDriven;
+        m_isStaticValid.assign(m_cascadeCount, false);
+    }
+
+    std::vector<bool> isStaticStale(m_cascadeCount);
+    std::vector<bool> isRefreshed(m_cascadeCount);
+    std::vector<std::vector<uint32_t>> dynamicCasters(m_cascadeCount);
+
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        isStaticStale[i] = !m_isStaticValid[i] || m_staticLightSpaces[i] != m_cascades.lightSpace[i] || (isGPUDriven && !m_dynamicMeshes.empty());
+
+        if (!isGPUDriven)
+        {
+            collectDynamicCasters(i);
+            dynamicCasters[i] = m_dynamicCasterMeshIndices;
+        }
+
+        // A layer with dynamic casters last frame must get rid of them.
+        isRefreshed[i] = isStaticStale[i] || !dynamicCasters[i].empty() || !m_isOnlyStatic[i];
+    }
+
+    // The culling dispatches can't be recorded inside the render pass.
+    if (isGPUDriven)
+    {
+        for (uint32_t i = 0; i < m_cascadeCount; i++)
+        {
+            if (isStaticStale[i])
+                gpuCulling->cull(commandBuffer, m_cullingViews[i], currentFrame, m_cascades.lightSpace[i]);
+        }
+    }
+
+    // Only the CPU-driven path has enough draws to be worth recording in
+    // parallel or caching(the indirect one depends on per frame buffers).
+    const bool isCached = !isGPUDriven && getRendererPointer()->isStaticCachingEnabled();
+    const bool isParallel = !isGPUDriven && !isCached && getRendererPointer()->isParallelRecordingEnabled();
+
+    const VkExtent2D extent = { m_resolution, m_resolution };
+    VkViewport viewport{ 0.0f, 0.0f, (float)m_resolution, (float)m_resolution, 0.0f, 1.0f };
+    VkRect2D scissor{ {0,0}, extent };
+
+    // The cached cascades draw every static caster: only the targets, the
+    // pipeline and the static set can invalidate them(the casters change as
+    // the camera moves).
+    uint64_t signature = 0;
+    StaticCommandCache::combine(signature, (uint64_t)m_pipeline);
+    StaticCommandCache::combine(signature, m_staticSetVersion);
+    for (const VkFramebuffer& framebuffer : m_staticFramebuffers)
+        StaticCommandCache::combine(signature, (uint64_t)framebuffer);
+
+    m_staticRenderCount = 0;
+    m_dynamicRenderCount = 0;
+
+    //-------------------------------- Static casters -----------------------------
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        if (!isStaticStale[i])
+            continue;
+
+        m_staticRenderPass.begin(m_staticFramebuffers[i], extent, m_clearValues, commandBuffer, (isParallel || isCached) ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+
+        if (isGPUDriven)
+        {
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_indirectPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_indirectPipelineLayout, 0, 1, &m_indirectDescriptorSets[currentFrame * m_cascadeCount + i], 0, nullptr);
+
+            gpuCulling->drawIndirect(commandBuffer, m_cullingViews[i], currentFrame);
+        }
+        else if (isCached)
+        {
+            // Per frame too: the draws bind the frame's cascade set.
+            const uint32_t slot = (imageIndex * Config::MAX_FRAMES_IN_FLIGHT + currentFrame) * m_cascadeCount + i;
+            const VkCommandBuffer& secondary = m_staticCache->get(slot, signature, m_staticRenderPass.get(), 0, m_staticFramebuffers[i],
+                [&](VkCommandBuffer& cachedCommandBuffer)
+                {
+                    collectStaticCasters(i, false);
+                    buildRenderQueue(currentFrame, i, m_casterMeshIndices);
+
+                    vkCmdSetViewport(cachedCommandBuffer, 0, 1, &viewport);
+                    vkCmdSetScissor(cachedCommandBuffer, 0, 1, &scissor);
+
+                    RenderQueueStats recordStats;
+                    m_renderQueue.record(cachedCommandBuffer, recordStats);
+                }
+            );
+
+            vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+
+            getRendererPointer()->getRenderQueueStats().cachedDraws += getRenderResource()->getNormalMeshCount() - static_cast<uint32_t>(m_dynamicMeshes.size());
+        }
+        else
+        {
+            collectStaticCasters(i, true);
+            buildRenderQueue(currentFrame, i, m_casterMeshIndices);
+
+            if (isParallel)
+            {
+                ParallelRecorder* recorder = getRendererPointer()->getParallelRecorder();
+                std::vector<RenderQueueStats> sliceStats(recorder->getSliceCount());
+
+                recorder->record(
+                    commandBuffer,
+                    currentFrame,
+                    m_staticRenderPass.get(),
+                    0,
+                    m_staticFramebuffers[i],
+                    static_cast<uint32_t>(m_renderQueue.getItems().size()),
+                    [&](const VkCommandBuffer& secondary, const uint32_t begin, const uint32_t end, const uint32_t slice)
+                    {
+                        vkCmdSetViewport(secondary, 0, 1, &viewport);
+                        vkCmdSetScissor(secondary, 0, 1, &scissor);
+
+                        m_renderQueue.record(secondary, begin, end, sliceStats[slice]);
+                    }
+                );
+
+                for (auto& stats : sliceStats)
+                    getRendererPointer()->getRenderQueueStats().add(stats);
+            }
+            else
+            {
+                vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+                vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+                m_renderQueue.record(commandBuffer, getRendererPointer()->getRenderQueueStats());
+            }
+        }
+        m_staticRenderPass.end(commandBuffer);
+
+        m_isStaticValid[i] = true;
+        m_staticLightSpaces[i] = m_cascades.lightSpace[i];
+        m_staticRenderCount++;
+    }
+
+    //----------------------------- Sampled cascades ------------------------------
+    // The render graph left every layer as depth attachment: the refreshed ones
+    // are overwritten by the copy, the others are sampled as they are.
+    std::vector<VkImageMemoryBarrier> barriers;
+    std::vector<VkImageCopy> copyRegions;
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = m_image->getImage();
+        barrier.subresourceRange = { m_aspectMask, 0, 1, i, 1 };
+
+        if (isRefreshed[i])
+        {
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            VkImageCopy region{};
+            region.srcSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, i, 1 };
+            region.dstSubresource = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, i, 1 };
+            region.extent = { m_resolution, m_resolution, 1 };
+            copyRegions.push_back(region);
+        }
+        else
+        {
+            barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        }
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        static_cast<uint32_t>(barriers.size()), barriers.data()
+    );
+
+    if (!copyRegions.empty())
+    {
+        vkCmdCopyImage(
+            commandBuffer,
+            m_staticImage->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            m_image->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(copyRegions.size()), copyRegions.data()
+        );
+    }
+
+    barriers.clear();
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        if (!isRefreshed[i])
+            continue;
+
+        m_isOnlyStatic[i] = dynamicCasters[i].empty();
+
+        if (m_isOnlyStatic[i])
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = m_image->getImage();
+            barrier.subresourceRange = { m_aspectMask, 0, 1, i, 1 };
+            barriers.push_back(barrier);
+            continue;
+        }
+
+        // Few draws: always recorded inline.
+        m_renderPass.begin(m_framebuffers[i], extent, m_clearValues, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        buildRenderQueue(currentFrame, i, dynamicCasters[i]);
+        m_renderQueue.record(commandBuffer, getRendererPointer()->getRenderQueueStats());
+
+        m_renderPass.end(commandBuffer);
+
+        m_dynamicRenderCount++;
+    }
+
+    if (!barriers.empty())
+    {
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0, nullptr,
+            0, nullptr,
+            static_cast<uint32_t>(barriers.size()), barriers.data()
+        );
+    }
+}
+
+
+/*
+ * With cullCasters, only the meshes overlapping the cascade's box(scene BVH)
+ * are kept. The box already reaches back to the casters between the light
+ * and the cascade.
+ */
+void CascadedShadowMap::collectStaticCasters(const uint32_t cascade, const bool cullCasters)
+{
+    const BVH& sceneBVH = getRenderResource()->m_sceneBVH;
+
+    m_casterMeshIndices.clear();
+
+    if (cullCasters && !sceneBVH.isEmpty())
+    {
+        sceneBVH.queryFrustum(BoundingVolumes::extractFrustum(m_cascades.lightSpace[cascade]), m_casterMeshIndices);
+    }
+    else
+    {
+        for (auto ptr : getRenderResource()->m_normalModels)
+        {
+            if (ptr->isHidden())
+                continue;
+            m_casterMeshIndices.insert(m_casterMeshIndices.end(), ptr->getMeshIndices().begin(), ptr->getMeshIndices().end());
+        }
+    }
+
+    m_casterMeshIndices.erase(
+        std::remove_if(m_casterMeshIndices.begin(), m_casterMeshIndices.end(),
+            [&](const uint32_t meshIndex) { return m_dynamicMeshes.count(meshIndex) != 0; }),
+        m_casterMeshIndices.end()
+    );
+}
+
+// The dynamic meshes overlapping the cascade's box.
+void CascadedShadowMap::collectDynamicCasters(const uint32_t cascade)
+{
+    m_dynamicCasterMeshIndices.clear();
+    if (m_dynamicMeshes.empty())
+        return;
+
+    const Frustum frustum = BoundingVolumes::extractFrustum(m_cascades.lightSpace[cascade]);
+
+    for (auto ptr : getRenderResource()->m_normalModels)
+    {
+        const auto iter = m_casterStates.find(ptr.get());
+        if (iter == m_casterStates.end())
+            continue;
+
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            if (m_dynamicMeshes.count(meshIndex) == 0)
+                continue;
+
+            const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+            const AxisAlignedBox box = BoundingVolumes::transformBox(meshInfo->boundingBox, iter->second.modelMatrix);
+            if (BoundingVolumes::intersectsFrustum(frustum, box))
+                m_dynamicCasterMeshIndices.push_back(meshIndex);
+        }
+    }
+}
+
+void CascadedShadowMap::buildRenderQueue(const uint32_t frameIndex, const uint32_t cascade, const std::vector<uint32_t>& meshIndices)
+{
+    GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+
+    m_renderQueue.clear();
+
+    for (uint32_t meshIndex : meshIndices)
+    {
+        const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+
+        DrawItem item{};
+        item.pipeline = m_pipeline;
+        item.pipelineLayout = m_pipelineLayout;
+        item.descriptorSet = m_descriptorSetsMap[meshIndex];
+        item.materialDescriptorSet = m_cascadeDescriptorSets[frameIndex * m_cascadeCount + cascade];
+        item.indexCount = meshInfo->meshIndexCount;
+
+        if (gpuCulling->getPooledRange(meshIndex, item.firstIndex, item.vertexOffset))
+        {
+            item.vertexBuffer = gpuCulling->getVertexBuffer();
+            item.indexBuffer = gpuCulling->getIndexBuffer();
+        }
+        else
+        {
+            item.vertexBuffer = *meshInfo->vertexBuffer;
+            item.indexBuffer = *meshInfo->indexBuffer;
+        }
+
+        // Depth only: no need for a front-to-back order.
+        item.key = m_renderQueue.makeKey(0, item.pipeline, item.descriptorSet, item.vertexBuffer, 0.0f, 1.0f);
+        m_renderQueue.push(item);
+    }
+
+    m_renderQueue.sort();
+}
+
+Image* CascadedShadowMap::getImage() const
+{
+    return m_image;
+}
+
+
+const VkImageView& CascadedShadowMap::getShadowMapView() const
+{
+    return m_image->getImageView();
+}
+
+
+VkSampler& CascadedShadowMap::getSampler() const
+{
+    return m_imageSampler->getSampler();
+}
+
+
+const RenderPass& CascadedShadowMap::getRenderPass() const
+{
+    return m_renderPass;
+}
+
+
+void CascadedShadowMap::createFramebuffers()
+{
+    m_framebuffers.resize(m_cascadeCount);
+
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        std::vector<VkImageView> attachments = { m_image->getImageView("Cascade" + std::to_string(i)) };
+        FramebufferManager::createFramebuffer(getRendererPointer()->getDevice(), m_renderPass.get(), attachments, m_resolution, m_resolution, 1, &m_framebuffers[i]);
+    }
+
+    m_staticFramebuffers.resize(m_cascadeCount);
+
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+    {
+        std::vector<VkImageView> attachments = { m_staticImage->getImageView("Cascade" + std::to_string(i)) };
+        FramebufferManager::createFramebuffer(getRendererPointer()->getDevice(), m_staticRenderPass.get(), attachments, m_resolution, m_resolution, 1, &m_staticFramebuffers[i]);
+    }
+}
+
+void CascadedShadowMap::createUBOs()
+{
+    for (auto ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            BufferManager::bufferCreateBuffer(
+                getRendererPointer()->getVmaAllocator(),
+                sizeof(glm::mat4),
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU,
+                &m_ubosMap[meshIndex],
+                &m_uboAllocationsMap[meshIndex]
+            );
+        }
+    }
+
+    m_cascadeUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT * m_cascadeCount);
+    m_cascadeUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT * m_cascadeCount);
+    for (uint32_t i = 0; i < m_cascadeUBOs.size(); i++)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(glm::mat4),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_cascadeUBOs[i],
+            &m_cascadeUBOAllocations[i]
+        );
+    }
+
+    m_cascadesUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_cascadesUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(ShadowCascades),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_cascadesUBOs[frame],
+            &m_cascadesUBOAllocations[frame]
+        );
+    }
+}
+
+void CascadedShadowMap::createDescriptorSets()
+{
+    //------------------------------- DescriptorSets  ----------------------------------
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::CASCADED_SHADOWMAP::DESCRIPTORS_INFO, getRenderResource()->getNormalMeshCount() + Config::MAX_FRAMES_IN_FLIGHT * m_cascadeCount);
+
+    for (auto ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSetsMap[meshIndex]);
+
+            VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_ubosMap[meshIndex]);
+
+            std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+                DescriptorManager::writeDescriptorSet(m_descriptorSetsMap[meshIndex], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+            };
+            vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+        }
+    }
+
+    m_cascadeDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT * m_cascadeCount);
+    for (uint32_t i = 0; i < m_cascadeDescriptorSets.size(); i++)
+    {
+        m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_cascadeDescriptorSets[i]);
+
+        VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_cascadeUBOs[i]);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(m_cascadeDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+        };
+        vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+
+    //------------------------ Indirect(GPU-driven) DescriptorSets ---------------------
+    m_cullingViews.resize(m_cascadeCount);
+    for (uint32_t i = 0; i < m_cascadeCount; i++)
+        m_cullingViews[i] = getRendererPointer()->getGPUCulling()->createView();
+
+    m_indirectDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT * m_cascadeCount);
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::SHADOWMAP_INDIRECT::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT * m_cascadeCount);
+    for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
+    {
+        VkDescriptorBufferInfo objectBufferInfo = DescriptorManager::descriptorBufferInfo(getRendererPointer()->getGPUCulling()->getObjectBuffer(frame));
+
+        for (uint32_t i = 0; i < m_cascadeCount; i++)
+        {
+            VkDescriptorSet& descriptorSet = m_indirectDescriptorSets[frame * m_cascadeCount + i];
+            m_descriptorAllocator.allocate(m_indirectDescriptorSetLayout, &descriptorSet);
+
+            VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_cascadeUBOs[frame * m_cascadeCount + i]);
+
+            std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+                DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+                DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &objectBufferInfo),
+            };
+            vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+        }
+    }
+}
+
+
+void CascadedShadowMap::destroy()
+{
+    m_descriptorAllocator.destroy();
+    for (const uint32_t view : m_cullingViews)
+        getRendererPointer()->getGPUCulling()->releaseView(view);
+
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
+
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_indirectDescriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_indirectPipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_indirectPipelineLayout, nullptr);
+
+    m_staticCache->destroy();
+
+    m_image->destroy();
+    m_staticImage->destroy();
+    m_imageSampler->destroy();
+
+    for (auto& uboInfo : m_ubosMap)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), uboInfo.second, m_uboAllocationsMap[uboInfo.first]);
+
+    for (uint32_t i = 0; i < m_cascadeUBOs.size(); i++)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_cascadeUBOs[i], m_cascadeUBOAllocations[i]);
+
+    for (uint32_t frame = 0; frame < m_cascadesUBOs.size(); frame++)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_cascadesUBOs[frame], m_cascadesUBOAllocations[frame]);
+
+    m_renderPass.destroy();
+    m_staticRenderPass.destroy();
+
+    for (auto& framebuffer : m_framebuffers)
+        vkDestroyFramebuffer(getRendererPointer()->getDevice(), framebuffer, nullptr);
+    for (auto& framebuffer : m_staticFramebuffers)
+        vkDestroyFramebuffer(getRendererPointer()->getDevice(), framebuffer, nullptr);
+}
+
+
+void CascadedShadowMap::createRenderPass(const VkFormat& depthBufferFormat)
+{
+    // Attachment references
+    VkAttachmentReference shadowMapAttachmentRef{};
+    AttachmentUtils::createAttachmentReference(
+        0,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        shadowMapAttachmentRef
+    );
+
+    // Subpasses
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.flags = 0;
+    subpass.pDepthStencilAttachment = &shadowMapAttachmentRef;
+
+    //------------------------------- Static casters --------------------------------
+    // - Attachments
+    // Cleared and left to be copied to the sampled cascade.
+    {
+        VkAttachmentDescription staticAttachment{};
+        AttachmentUtils::createAttachmentDescriptionWithStencil(
+            depthBufferFormat,
+            VK_SAMPLE_COUNT_1_BIT,
+            VK_ATTACHMENT_LOAD_OP_CLEAR,
+            VK_ATTACHMENT_STORE_OP_STORE,
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            staticAttachment
+        );
+
+        std::vector<VkSubpassDependency> dependencies(1);
+        SubPassUtils::createSubPassDependency(
+            0,
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            VK_SUBPASS_EXTERNAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_TRANSFER_READ_BIT,
+            VK_DEPENDENCY_BY_REGION_BIT,
+            dependencies[0]
+        );
+
+        m_staticRenderPass = RenderPass(
+            { staticAttachment },
+            { subpass },
+            dependencies
+        );
+    }
+
+    //------------------------------- Dynamic casters -------------------------------
+    // - Attachments
+    // Loads the copied static depth and leaves the cascade ready to be sampled.
+    {
+        VkAttachmentDescription shadowMapAttachment{};
+        AttachmentUtils::createAttachmentDescriptionWithStencil(
+            depthBufferFormat,
+            VK_SAMPLE_COUNT_1_BIT,
+            VK_ATTACHMENT_LOAD_OP_LOAD,
+            VK_ATTACHMENT_STORE_OP_STORE,
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            shadowMapAttachment
+        );
+
+        std::vector<VkSubpassDependency> dependencies(2);
+        SubPassUtils::createSubPassDependency(
+            VK_SUBPASS_EXTERNAL,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_ACCESS_TRANSFER_WRITE_BIT,
+            0,
+            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            VK_DEPENDENCY_BY_REGION_BIT,
+            dependencies[0]
+        );
+        SubPassUtils::createSubPassDependency(
+            0,
+            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            VK_SUBPASS_EXTERNAL,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            VK_ACCESS_SHADER_READ_BIT,
+            VK_DEPENDENCY_BY_REGION_BIT,
+            dependencies[1]
+        );
+
+        m_renderPass = RenderPass(
+            { shadowMapAttachment },
+            { subpass },
+            dependencies
+        );
+    }
+}
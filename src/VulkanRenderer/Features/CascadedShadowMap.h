@@ -1,84 +1,185 @@
-//#pragma once 
-//
-//#include <memory>
-//
-//#include <vulkan/vulkan.h>
-//#include <glm/glm.hpp>
-//#include <unordered_map>
-//
-//#include "VulkanRenderer/Descriptor/DescriptorTypes.h"
-//
-//#include "VulkanRenderer/RenderPass/RenderPass.h"
-//
-//
-//
-//
-//class CascadedShadowMap
-//{
-//public:
-//
-//	CascadedShadowMap(
-//		const VkExtent2D& extent,
-//		const uint32_t imagesCount,
-//		const VkFormat& format,
-//		const float& lambda,
-//		const float& near_offser,
-//		const uint32_t& split_count
-//	);
-//
-//	~CascadedShadowMap();
-//	void destroy();
-//
-//	void updateUBO();
-//
-//	void draw(uint32_t imageIndex, uint32_t frameIndex);
-//
-//	const std::shared_ptr<TextureBase> get() const;
-//	const VkImageView& getCascadedShadowMapView() const;
-//	const VkSampler& getSampler() const;
-//	const glm::mat4& getLightSpace() const;
-//	//const VkDescriptorSet& getDescriptorSet(const uint32_t index, const uint32_t currentFrame) const;
-//	const VkFramebuffer& getFramebuffer(const uint32_t imageIndex) const;
-//	const VkCommandBuffer& getCommandBuffer(const uint32_t index) const;
-//
-//	const VkCommandPool& getCommandPool() const;
-//	const RenderPass& getRenderPass() const;
-//
-//private:
-//	void createGraphicsPipeline(const VkExtent2D& extent);
-//	void createRenderPass(const VkFormat& depthBufferFormat);
-//	void createFramebuffer(const uint32_t& imagesCount);
-//	void createUBOs();
-//	void createDescriptorSets();
-//
-//	float							 m_lambda;
-//	float							 m_near_offset;
-//	uint32_t						 m_split_count;
-//
-//	uint32_t                         m_width;
-//	uint32_t                         m_height;
-//
-//	std::vector<VkClearValue>		 m_clearValuesCascadedShadowMap;
-//
-//	std::shared_ptr<TextureBase>	 m_texture;
-//
-//	RenderPass                       m_renderPass;
-//
-//	VkDescriptorPool				 m_descriptorPool;
-//
-//
-//	VkCommandPool					 m_commandPool;
-//	std::vector<VkCommandBuffer>	 m_commandBuffers;
-//
-//	std::vector<VkFramebuffer>       m_framebuffers;
-//
-//	VkPipeline                       m_pipeline;
-//	VkDescriptorSetLayout            m_descriptorSetLayout;
-//	VkPipelineLayout                 m_pipelineLayout;
-//
-//	DescriptorTypes::UniformBufferObject::ShadowMap m_basicInfo;
-//
-//	std::unordered_map<uint32_t, VkBuffer>			m_ubosMap;
-//	std::unordered_map<uint32_t, VmaAllocation>		m_uboAllocationsMap;
-//	std::unordered_map<uint32_t, VkDescriptorSet>	m_descriptorSetsMap;
-//};
\ No newline at end of file
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "VulkanRenderer/Descriptor/DescriptorTypes.h"
+#include "VulkanRenderer/Settings/config.h"
+
+#include "VulkanRenderer/RenderPass/RenderPass.h"
+
+#include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/RenderQueue/RenderQueue.h"
+#include "VulkanRenderer/Command/StaticCommandCache.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
+
+class Model;
+
+// Layout must match cascadedShadows.glsl(std140).
+struct ShadowCascades
+{
+    glm::mat4   view;                                       // camera
+    glm::mat4   lightSpace[Config::SHADOW_CASCADE_COUNT];
+    glm::vec4   splitDepths;                                // view space far depth of each cascade
+};
+
+/*
+ * Cascaded shadow map of the directional light:
+ *  - The camera frustum, up to Config::SHADOW_DISTANCE, is split in cascades
+ *    with the practical split scheme(lambda blends logarithmic and uniform
+ *    splits), so the near cascades get most of the resolution.
+ *  - Each cascade is an orthographic projection around the bounding sphere of
+ *    its camera sub-frustum. The sphere doesn't change when the camera turns
+ *    and its center is snapped to the cascade's texels, so the shadows don't
+ *    shimmer when the camera moves. The depth range reaches back to the
+ *    scene's bounds to keep the casters between the light and the cascade.
+ *  - Cascades are the layers of one depth image array, rendered one after the
+ *    other with only the casters overlapping them(GPU culling view or scene
+ *    BVH query per cascade).
+ *  - Static casters are cached: their depth is rendered in a second image
+ *    array only when the cascade moves(camera, light) or the static set
+ *    changes. A model is dynamic while it moved(or was hidden/shown) in the
+ *    last Config::SHADOW_STATIC_FRAMES frames. The sampled cascade is a copy
+ *    of the static one with the dynamic casters drawn on top, and is left
+ *    untouched when neither changed: a static scene costs no draw at all.
+ *    The GPU-driven path can't tell them apart(one culling view for all the
+ *    objects), it re-renders everything while something moves.
+ * Shaders include cascadedShadows.glsl and pick the cascade by view depth.
+ */
+class CascadedShadowMap
+{
+public:
+
+	CascadedShadowMap(
+		const uint32_t resolution,
+		const VkFormat& format,
+		const float lambda,
+		const uint32_t cascadeCount
+	);
+
+	~CascadedShadowMap() {};
+	void destroy();
+
+	// Writes the frame's copy of the cascade UBOs.
+	void updateUBO(const uint32_t frameIndex);
+
+	// Records the cascades that changed, must be recorded outside of a render
+	// pass(GPU culling). Takes the shadow map from DEPTH_STENCIL_ATTACHMENT to
+	// SHADER_READ_ONLY, the layout it's left in after every frame.
+	void draw(uint32_t imageIndex, uint32_t frameIndex);
+
+	// Cascades re-rendered by the last draw().
+	uint32_t getStaticRenderCount() const				{ return m_staticRenderCount; }
+	uint32_t getDynamicRenderCount() const				{ return m_dynamicRenderCount; }
+
+	Image* getImage() const;
+	VkSampler& getSampler() const;
+	// 2D array view, one layer per cascade.
+	const VkImageView& getShadowMapView() const;
+	// ShadowCascades, sampled with the shadow map.
+	const VkBuffer& getCascadesBuffer(const uint32_t frameIndex) const { return m_cascadesUBOs[frameIndex]; }
+	const glm::mat4& getLightSpace(const uint32_t cascade) const { return m_cascades.lightSpace[cascade]; }
+	uint32_t getCascadeCount() const					{ return m_cascadeCount; }
+	// Model matrix of the mesh(CASCADED_SHADOWMAP layout), up to date after updateUBO().
+	const VkDescriptorSet& getMeshDescriptorSet(const uint32_t meshIndex) const { return m_descriptorSetsMap.at(meshIndex); }
+
+	const RenderPass& getRenderPass() const;
+
+private:
+	void createGraphicsPipeline();
+	void createRenderPass(const VkFormat& depthBufferFormat);
+	void createFramebuffers();
+	void createUBOs();
+	void createDescriptorSets();
+	void updateCascades();
+	void updateCasters();
+	void buildRenderQueue(const uint32_t frameIndex, const uint32_t cascade, const std::vector<uint32_t>& meshIndices);
+	void collectStaticCasters(const uint32_t cascade, const bool cullCasters);
+	void collectDynamicCasters(const uint32_t cascade);
+
+	float							 m_lambda;
+	uint32_t						 m_cascadeCount;
+	uint32_t                         m_resolution;
+
+	std::vector<VkClearValue>		 m_clearValues;
+
+	VkImageAspectFlags				 m_aspectMask;
+
+	// Sampled cascades.
+	Image*							 m_image;
+	ImageSampler*					 m_imageSampler;
+
+	// Dynamic casters, loaded over the copied static depth. One framebuffer per cascade(layer).
+	RenderPass                       m_renderPass;
+	std::vector<VkFramebuffer>       m_framebuffers;
+
+	// Static casters, cleared then left as transfer source.
+	Image*							 m_staticImage;
+	RenderPass                       m_staticRenderPass;
+	std::vector<VkFramebuffer>       m_staticFramebuffers;
+
+	struct CasterState
+	{
+		glm::mat4	modelMatrix;
+		bool		isHidden;
+		uint32_t	stillFrames;
+	};
+	std::unordered_map<const Model*, CasterState>	m_casterStates;
+	std::unordered_set<uint32_t>	 m_dynamicMeshes;
+	// Bumped when a model becomes static or dynamic.
+	uint64_t						 m_staticSetVersion = 0;
+
+	// Per cascade
+	std::vector<bool>				 m_isStaticValid;
+	std::vector<glm::mat4>			 m_staticLightSpaces;
+	// The sampled cascade is an exact copy of the static one(no dynamic caster drawn).
+	std::vector<bool>				 m_isOnlyStatic;
+	// Path the static cascades were rendered with.
+	bool							 m_isStaticGPUDriven = false;
+
+	uint32_t						 m_staticRenderCount = 0;
+	uint32_t						 m_dynamicRenderCount = 0;
+
+	// Compatible with both render passes.
+	VkPipeline                       m_pipeline;
+	// Set 0(per mesh) and set 1(per cascade).
+	VkDescriptorSetLayout            m_descriptorSetLayout;
+	DescriptorAllocator              m_descriptorAllocator;
+	VkPipelineLayout                 m_pipelineLayout;
+
+	ShadowCascades					 m_cascades{};
+	// Per frame in flight: the GPU may still read the last frame's.
+	std::vector<VkBuffer>			 m_cascadesUBOs;
+	std::vector<VmaAllocation>		 m_cascadesUBOAllocations;
+
+	// Light space of each cascade(set 1, also the indirect pipeline's UBO),
+	// per frame in flight: frame * m_cascadeCount + cascade.
+	std::vector<VkBuffer>			 m_cascadeUBOs;
+	std::vector<VmaAllocation>		 m_cascadeUBOAllocations;
+	std::vector<VkDescriptorSet>	 m_cascadeDescriptorSets;
+
+	// Model matrix of each mesh(set 0).
+	std::unordered_map<uint32_t, VkBuffer>			m_ubosMap;
+	std::unordered_map<uint32_t, VmaAllocation>		m_uboAllocationsMap;
+	std::unordered_map<uint32_t, VkDescriptorSet>	m_descriptorSetsMap;
+
+	// GPU-driven path(see GPUCulling), one culling view per cascade.
+	VkPipeline                       m_indirectPipeline;
+	VkDescriptorSetLayout            m_indirectDescriptorSetLayout;
+	VkPipelineLayout                 m_indirectPipelineLayout;
+
+	// [frame * cascadeCount + cascade]
+	std::vector<VkDescriptorSet>	 m_indirectDescriptorSets;
+	std::vector<uint32_t>			 m_cullingViews;
+
+	// CPU-driven path
+	RenderQueue						 m_renderQueue;
+	std::vector<uint32_t>			 m_casterMeshIndices;
+	std::vector<uint32_t>			 m_dynamicCasterMeshIndices;
+	std::unique_ptr<StaticCommandCache> m_staticCache;
+};
@@ -2,8 +2,6 @@
 
 #include <vulkan/vulkan.h>
 
-#include "VulkanRenderer/Image/Image.h"
-
 class DepthBuffer
 {
 public:
@@ -15,16 +13,11 @@ public:
     );
     ~DepthBuffer();
 
-    Image* getTexture(){return m_image; }
-    const VkImageView& getImageView()const;
-    const VkImage& getImage()const;
+    // The image itself is a transient image of the scene's render graph.
     const VkFormat& getFormat()const;
 
-    void destroy();
-
 private:
 
-    Image* m_image;
     VkFormat m_format;
 
 };
\ No newline at end of file
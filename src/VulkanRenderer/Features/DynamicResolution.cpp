@@ -0,0 +1,108 @@
+#include "VulkanRenderer/Features/DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Benchmark/TimestampQueries.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+DynamicResolution::DynamicResolution() : m_targetTime(Config::DYNAMIC_RESOLUTION_TARGET_MS)
+{
+    m_isSupported = TimestampQueries::querySupport(m_timestampPeriod);
+
+    m_hasTimestamps.assign(Config::MAX_FRAMES_IN_FLIGHT, false);
+
+    if (!m_isSupported)
+        return;
+
+    // First and last timestamp, per frame.
+    m_queryPool = TimestampQueries::createQueryPool(2 * Config::MAX_FRAMES_IN_FLIGHT, "dynamic resolution");
+}
+
+void DynamicResolution::update(const uint32_t frameIndex, const VkExtent2D& targetExtent)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    if (m_hasTimestamps[frameIndex])
+    {
+        // The fence of the slot was waited on, the results are there: no wait.
+        uint64_t timestamps[2];
+        const VkResult result = vkGetQueryPoolResults(
+            getRendererPointer()->getDevice(),
+            m_queryPool,
+            2 * frameIndex,
+            2,
+            sizeof(timestamps),
+            timestamps,
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT
+        );
+
+        if (result == VK_SUCCESS)
+        {
+            m_gpuTime = TimestampQueries::toMilliseconds(timestamps[1] - timestamps[0], m_timestampPeriod);
+
+            if (m_isEnabled)
+                control(m_gpuTime);
+        }
+
+        m_hasTimestamps[frameIndex] = false;
+    }
+
+    if (!m_isEnabled)
+    {
+        m_scale = 1.0f;
+        m_errors[0] = m_errors[1] = 0.0f;
+    }
+
+    m_renderScale = std::clamp(std::round(m_scale / Config::DYNAMIC_RESOLUTION_STEP) * Config::DYNAMIC_RESOLUTION_STEP, Config::DYNAMIC_RESOLUTION_MIN_SCALE, 1.0f);
+
+    m_renderExtent.width = std::max(1u, (uint32_t)std::lround(targetExtent.width * m_renderScale));
+    m_renderExtent.height = std::max(1u, (uint32_t)std::lround(targetExtent.height * m_renderScale));
+}
+
+void DynamicResolution::control(const double gpuTime)
+{
+    // Positive when there is time left: the scale goes up.
+    const float error = float((m_targetTime - gpuTime) / m_targetTime);
+
+    m_scale += Config::DYNAMIC_RESOLUTION_KP * (error - m_errors[0])
+        + Config::DYNAMIC_RESOLUTION_KI * error
+        + Config::DYNAMIC_RESOLUTION_KD * (error - 2.0f * m_errors[0] + m_errors[1]);
+    m_scale = std::clamp(m_scale, Config::DYNAMIC_RESOLUTION_MIN_SCALE, 1.0f);
+
+    m_errors[1] = m_errors[0];
+    m_errors[0] = error;
+}
+
+void DynamicResolution::beginFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex)
+{
+    if (!m_isSupported)
+        return;
+
+    vkCmdResetQueryPool(commandBuffer, m_queryPool, 2 * frameIndex, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 2 * frameIndex);
+}
+
+void DynamicResolution::endFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex)
+{
+    if (!m_isSupported)
+        return;
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 2 * frameIndex + 1);
+    m_hasTimestamps[frameIndex] = true;
+}
+
+void DynamicResolution::destroy()
+{
+    if (m_queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(getRendererPointer()->getDevice(), m_queryPool, nullptr);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Render scale of the scene passes driven by the GPU time of the frame.
+ * Timestamps around the render graph(beginFrame()/endFrame()) are read back
+ * when the frame slot comes around again(update(), after its fence), and a PID
+ * controller on the error relative to Config::DYNAMIC_RESOLUTION_TARGET_MS
+ * moves the scale between Config::DYNAMIC_RESOLUTION_MIN_SCALE and 1.
+ * The targets keep the swapchain's extent: the scene renders into the top left
+ * getRenderExtent() of them, which the upscale pass stretches over the swapchain.
+ */
+class DynamicResolution
+{
+public:
+    DynamicResolution();
+    ~DynamicResolution() {};
+
+    // Reads the timings of the slot's last frame and picks the render extent of this one.
+    void update(const uint32_t frameIndex, const VkExtent2D& targetExtent);
+
+    // Around the commands of the frame, outside of a render pass.
+    void beginFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex);
+    void endFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex);
+
+    const bool& isEnabled() const                       { return m_isEnabled; }
+    void setEnabled(const bool enabled)                 { m_isEnabled = enabled; }
+    // False when the graphics queue has no timestamps: the scale stays at 1.
+    const bool& isSupported() const                     { return m_isSupported; }
+
+    float& getTargetTime()                              { return m_targetTime; }
+    const float& getScale() const                       { return m_renderScale; }
+    // Milliseconds between the first and last command of the last read frame.
+    const double& getGPUTime() const                    { return m_gpuTime; }
+    const VkExtent2D& getRenderExtent() const           { return m_renderExtent; }
+
+    void destroy();
+
+private:
+    // Incremental(velocity) form: the integral term is the scale itself,
+    // so clamping the scale is all the anti-windup it needs.
+    void control(const double gpuTime);
+
+    bool                    m_isEnabled = false;
+    bool                    m_isSupported = false;
+
+    VkQueryPool             m_queryPool = VK_NULL_HANDLE;
+    // Nanoseconds per tick.
+    float                   m_timestampPeriod = 1.0f;
+    // Timestamps of the slot were written since it was last read.
+    std::vector<bool>       m_hasTimestamps;
+
+    float                   m_targetTime;
+    double                  m_gpuTime = 0.0;
+
+    // Output of the controller and its last two errors.
+    float                   m_scale = 1.0f;
+    float                   m_errors[2] = { 0.0f, 0.0f };
+    // m_scale quantized to Config::DYNAMIC_RESOLUTION_STEP.
+    float                   m_renderScale = 1.0f;
+
+    VkExtent2D              m_renderExtent{};
+};
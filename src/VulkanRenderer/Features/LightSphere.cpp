@@ -8,14 +8,14 @@
 #include "VulkanRenderer/Shader/ShaderManager.h"
 #include "VulkanRenderer/Math/MathUtils.h"
 
-LightSphere::LightSphere(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex)
+LightSphere::LightSphere(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex, const bool isDepthWriteEnabled)
 {
-    createPipeline(renderPass, multisampleBits, subPassIndex);
+    createPipeline(renderPass, multisampleBits, subPassIndex, isDepthWriteEnabled);
     createUBO();
     createDescriptorSet();
 }
 
-void LightSphere::createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex)
+void LightSphere::createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex, const bool isDepthWriteEnabled)
 {
     const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::LIGHT::DESCRIPTORS_INFO;
 
@@ -38,42 +38,6 @@ void LightSphere::createPipeline(const VkRenderPass& renderPass, VkSampleCountFl
         throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-    // -------------------Shader Modules--------------------
-    const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "light"},{shaderType::FRAGMENT,"light"} };
-
-    std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-    std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-    for (uint32_t i = 0; i < shaderInfos.size(); i++)
-    {
-        PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-        PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-    }
-
-
-    // Dynamic states
-    std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-    VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
-
-    // Viewport state info
-    VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-    // Vertex input(attributes)
-    std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::LIGHT::getAttributeDescriptions();
-    VkVertexInputBindingDescription bindingDescription = Attributes::LIGHT::getBindingDescription();
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-    // Input assembly
-    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-    // Rasterizer
-    VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0, VK_FALSE);
-    // Multisampling 
-    VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(multisampleBits, 0);
-    // Color blending(attachment)
-    VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-
-    // Color blending(global)
-    VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-
     // Pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -85,47 +49,30 @@ void LightSphere::createPipeline(const VkRenderPass& renderPass, VkSampleCountFl
     if (status != VK_SUCCESS)
         throw std::runtime_error("Failed to create pipeline layout!");
 
-    // Depth and stencil
-    VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS);
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = shaderInfos.size();
-    pipelineInfo.pStages = shaderStagesInfos.data();
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizationState;
-    pipelineInfo.pMultisampleState = &multisampleState;
-    pipelineInfo.pDepthStencilState = &depthStencilState;
-    pipelineInfo.pColorBlendState = &colorBlendState;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.pTessellationState = nullptr;
-    pipelineInfo.pNext = nullptr;
-    pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = subPassIndex;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = -1;
-
-    status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
-    if (status != VK_SUCCESS)
-        throw std::runtime_error("Failed to create graphics pipeline!");
-
-    for (auto& shaderModule : shaderModules)
-    {
-        ShaderManager::destroyShaderModule(shaderModule);
-    }
+    GraphicsPipelineDesc desc;
+    desc.name = "light sphere";
+    desc.shaders = { {shaderType::VERTEX, "light"}, {shaderType::FRAGMENT, "light"} };
+    desc.vertexBinding = Attributes::LIGHT::getBindingDescription();
+    desc.vertexAttributes = Attributes::LIGHT::getAttributeDescriptions();
+    desc.layout = m_pipelineLayout;
+    desc.renderPass = renderPass;
+    desc.subpass = subPassIndex;
+    desc.sampleCount = multisampleBits;
+    desc.depthWriteEnable = isDepthWriteEnabled ? VK_TRUE : VK_FALSE;
+
+    getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
 }
 
 void LightSphere::createDescriptorSet()
 {
     //-------------------------------  Light DescriptorSet  ----------------------------------
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::LIGHT::DESCRIPTORS_INFO, static_cast<uint32_t>(getRenderResource()->m_lightModels.size()));
+
     for (auto ptr : getRenderResource()->m_lightModels)
     {
         uint32_t meshIndex = ptr->getMeshIndices()[0];
         {
-            DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayout, &m_descriptorSetsMap[meshIndex]);
+            m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSetsMap[meshIndex]);
 
             VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_ubosMap[meshIndex]);
             VkDescriptorImageInfo defaultTex = DescriptorManager::descriptorImageInfo(getRenderResource()->m_defaultTexture.sampler->getSampler(), getRenderResource()->m_defaultTexture.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
@@ -171,7 +118,7 @@ void LightSphere::updateUBO()
         newUBO.model = ptr->getModelMatrix();
 
         newUBO.view = getRenderResource()->m_camera.getViewMatrix();
-        newUBO.proj = getRenderResource()->m_camera.getProjectionMatrix();
+        newUBO.proj = getRenderResource()->m_camera.getJitteredProjectionMatrix();
         newUBO.lightColor = glm::fvec4(1.0f);
 
         void* data;
@@ -183,7 +130,7 @@ void LightSphere::updateUBO()
 
 void LightSphere::draw(VkCommandBuffer& commandBuffer)
 {
-    VkExtent2D extent = getRendererPointer()->getSwapchainInfo().extent;
+    VkExtent2D extent = getRendererPointer()->getRenderExtent();
 
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
 
@@ -225,6 +172,7 @@ void LightSphere::draw(VkCommandBuffer& commandBuffer)
 
 void LightSphere::destroy()
 {
+    m_descriptorAllocator.destroy();
     for (auto& uboInfo : m_ubosMap)
     {
         vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), uboInfo.second, m_uboAllocationsMap[uboInfo.first]);
@@ -4,8 +4,8 @@
 
 
 #include "VulkanRenderer/Features/FeaturesUtils.h"
+#include "VulkanRenderer/Settings/config.h"
 
-#include "VulkanRenderer/Buffer/BufferManager.h"
 #include "VulkanRenderer/Renderer.h"
 
 
@@ -15,18 +15,23 @@ MSAA::MSAA(
     const VkExtent2D& swapchainExtent,
     const VkFormat& swapchainFormat
 ) {
-    m_samplesCount = FeaturesUtils::getMaxUsableSampleCount(getRendererPointer()->getPhysicalDevice());
-
-    m_image = Image::Create2DImage(
-        swapchainExtent,
-        swapchainFormat,
-        VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY,
-        VK_IMAGE_ASPECT_COLOR_BIT,
-        VK_IMAGE_TILING_OPTIMAL,
-        m_samplesCount,
-        1
-    );
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(getRendererPointer()->getPhysicalDevice(), &physicalDeviceProperties);
+
+    m_supportedCounts = (
+        physicalDeviceProperties.limits.framebufferColorSampleCounts &
+        physicalDeviceProperties.limits.framebufferDepthSampleCounts
+        );
+
+    // Highest offered count, up to the device's maximum.
+    const VkSampleCountFlagBits maxSamplesCount = FeaturesUtils::getMaxUsableSampleCount(getRendererPointer()->getPhysicalDevice());
+
+    m_samplesCount = VK_SAMPLE_COUNT_1_BIT;
+    for (const VkSampleCountFlagBits samplesCount : Config::MSAA_SAMPLES_COUNTS)
+    {
+        if (isSupported(samplesCount) && samplesCount <= maxSamplesCount && samplesCount > m_samplesCount)
+            m_samplesCount = samplesCount;
+    }
 }
 
 MSAA::~MSAA() {}
@@ -37,12 +42,13 @@ const VkSampleCountFlagBits& MSAA::getSamplesCount() const
     return m_samplesCount;
 }
 
-void MSAA::destroy()
+bool MSAA::isSupported(const VkSampleCountFlagBits samplesCount) const
 {
-    m_image->destroy();
+    return (m_supportedCounts & samplesCount) != 0;
 }
 
-const VkImageView& MSAA::getImageView() const
+void MSAA::setSamplesCount(const VkSampleCountFlagBits samplesCount)
 {
-    return m_image->getImageView();
-}
\ No newline at end of file
+    if (isSupported(samplesCount))
+        m_samplesCount = samplesCount;
+}
@@ -2,8 +2,12 @@
 
 #include <vulkan/vulkan.h>
 
-#include "VulkanRenderer/Image/Image.h"
-
+/*
+ * Samples count of the scene passes. It starts at the highest count of
+ * Config::MSAA_SAMPLES_COUNTS the device supports and can be changed at
+ * runtime(Renderer::setMSAASamplesCount()): the scene is then rebuilt, its
+ * attachments, framebuffers and pipelines(from the pipeline cache) with it.
+ */
 class MSAA
 {
 
@@ -16,15 +20,16 @@ public:
     );
     ~MSAA();
 
-    Image* getTexture() { return m_image; }
+    // The color target itself is a transient image of the scene's render graph.
     const VkSampleCountFlagBits& getSamplesCount() const;
-    const VkImageView& getImageView() const;
-
-    void destroy();
+    // Color and depth attachments both support it.
+    bool isSupported(const VkSampleCountFlagBits samplesCount) const;
+    // Unsupported counts are ignored.
+    void setSamplesCount(const VkSampleCountFlagBits samplesCount);
 
 private:
 
-    Image*                          m_image;
     VkSampleCountFlagBits           m_samplesCount;
+    VkSampleCountFlags              m_supportedCounts;
 
 };
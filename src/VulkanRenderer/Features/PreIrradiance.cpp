@@ -38,7 +38,8 @@ PrefilteredIrradiance::PrefilteredIrradiance(
 
 void PrefilteredIrradiance::createDescriptorSet()
 {
-    DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayout, &m_descriptorSet);
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::PREFILTER_IRRADIANCE::DESCRIPTORS_INFO, 1);
+    m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSet);
 
     VkDescriptorImageInfo SkyboxCubeMap = DescriptorManager::descriptorImageInfo(getRenderResource()->m_skyboxCubeMap.sampler->getSampler(), getRenderResource()->m_skyboxCubeMap.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
@@ -329,7 +330,7 @@ void PrefilteredIrradiance::createPipeline()
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex = -1;
 
-        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+        status = getRendererPointer()->getPipelineCache().createGraphicsPipeline(pipelineInfo, &m_pipeline, "prefiltered irradiance");
         if (status != VK_SUCCESS)
             throw std::runtime_error("Failed to create graphics pipeline!");
 
@@ -535,6 +536,7 @@ PrefilteredIrradiance::~PrefilteredIrradiance() {}
 
 void PrefilteredIrradiance::destroy()
 {
+    m_descriptorAllocator.destroy();
     vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
     vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
     vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
@@ -9,6 +9,7 @@
 #include "VulkanRenderer/RenderPass/RenderPass.h"
 
 #include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
 
 
 #define M_PI       3.14159265358979323846
@@ -62,6 +63,7 @@ private:
 
     VkPipeline                       m_pipeline;
     VkDescriptorSetLayout            m_descriptorSetLayout;
+    DescriptorAllocator              m_descriptorAllocator;
     VkPipelineLayout                 m_pipelineLayout;
 
     PushBlockIrradiance              m_pushBlock;
@@ -32,7 +32,8 @@ PrefilteredEnvMap::PrefilteredEnvMap( const uint32_t dim)
 
 void PrefilteredEnvMap::createDescriptorSet()
 {
-    DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayout, &m_descriptorSet);
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::PREFILTER_ENV_MAP::DESCRIPTORS_INFO, 1);
+    m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSet);
 
     VkDescriptorImageInfo SkyboxCubeMap = DescriptorManager::descriptorImageInfo(getRenderResource()->m_skyboxCubeMap.sampler->getSampler(), getRenderResource()->m_skyboxCubeMap.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
@@ -322,7 +323,7 @@ void PrefilteredEnvMap::createPipeline()
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
         pipelineInfo.basePipelineIndex = -1;
 
-        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+        status = getRendererPointer()->getPipelineCache().createGraphicsPipeline(pipelineInfo, &m_pipeline, "prefiltered env map");
         if (status != VK_SUCCESS)
             throw std::runtime_error("Failed to create graphics pipeline!");
 
@@ -506,6 +507,7 @@ PrefilteredEnvMap::~PrefilteredEnvMap() {}
 
 void PrefilteredEnvMap::destroy()
 {
+    m_descriptorAllocator.destroy();
     vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
     vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
     vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
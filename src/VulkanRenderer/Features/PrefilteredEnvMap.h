@@ -10,6 +10,7 @@
 
 
 #include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
 
 struct PushBlockPrefilterEnv
 {
@@ -61,6 +62,7 @@ private:
 
     VkPipeline                       m_pipeline;
     VkDescriptorSetLayout            m_descriptorSetLayout;
+    DescriptorAllocator              m_descriptorAllocator;
     VkPipelineLayout                 m_pipelineLayout;
 
     PushBlockPrefilterEnv            m_pushBlock;
@@ -0,0 +1,588 @@
+#include "VulkanRenderer/Features/ShadowAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "VulkanRenderer/Settings/GraphicsPipelineConfig.h"
+#include "VulkanRenderer/Settings/config.h"
+#include "VulkanRenderer/Features/CascadedShadowMap.h"
+#include "VulkanRenderer/Framebuffer/FramebufferManager.h"
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+#include "VulkanRenderer/Model/Attributes.h"
+#include "VulkanRenderer/RenderPass/AttachmentUtils.h"
+
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Pipeline/PipelineManager.h"
+
+#include "VulkanRenderer/Model/ModelManager.h"
+#include "VulkanRenderer/Renderer.h"
+
+
+// Outer cone of calculateSpotLight(cos = 0.953), with some margin for the PCF taps.
+static const float SPOT_SHADOW_FOV = 2.0f * std::acos(0.953f) * 1.1f;
+static const float LOCAL_SHADOW_NEAR = 0.05f;
+
+
+ShadowAtlas::ShadowAtlas(
+    const uint32_t resolution,
+    const VkFormat& format,
+    const std::shared_ptr<CascadedShadowMap>& casterSource
+) : m_resolution(resolution), m_casterSource(casterSource)
+{
+    if (Config::SHADOW_ATLAS_MIN_TILE > Config::SHADOW_ATLAS_MAX_TILE || Config::SHADOW_ATLAS_MAX_TILE > m_resolution)
+        throw std::runtime_error("Failed to create shadow atlas: unsupported tile sizes!");
+
+    // Down to the smallest tile.
+    m_levelCount = 1;
+    for (uint32_t size = m_resolution; size > Config::SHADOW_ATLAS_MIN_TILE; size /= 2)
+        m_levelCount++;
+
+    uint32_t nodeCount = 0;
+    for (uint32_t level = 0, levelNodes = 1; level < m_levelCount; level++, levelNodes *= 4)
+        nodeCount += levelNodes;
+    m_nodes.assign(nodeCount, NodeState::FREE);
+
+    m_clearValues.resize(1);
+    m_clearValues[0].depthStencil.depth = 1.0f;
+    m_clearValues[0].depthStencil.stencil = 0;
+
+    m_image = Image::Create2DImage(
+        VkExtent2D({ m_resolution, m_resolution }),
+        format,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        VK_IMAGE_ASPECT_DEPTH_BIT
+    );
+
+    // The shaders clamp the taps to the tiles.
+    m_imageSampler = new ImageSampler(
+        VK_FILTER_NEAREST,
+        VK_FILTER_NEAREST,
+        VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+        16,
+        VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+        1
+    );
+
+    createRenderPass(format);
+
+    std::vector<VkImageView> attachments = { m_image->getImageView() };
+    FramebufferManager::createFramebuffer(getRendererPointer()->getDevice(), m_renderPass.get(), attachments, m_resolution, m_resolution, 1, &m_framebuffer);
+
+    createGraphicsPipeline();
+
+    createBuffers();
+    createDescriptorSets();
+}
+
+
+void ShadowAtlas::createGraphicsPipeline()
+{
+    //------------------------------ Shadow Atlas Pipeline -----------------------------
+    // Same shader and sets as the cascades(set 0 comes from them).
+    const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::CASCADED_SHADOWMAP::DESCRIPTORS_INFO;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings(descriptorInfo.size());
+    for (uint32_t i = 0; i < descriptorInfo.size(); i++)
+    {
+        bindings[i].binding = descriptorInfo[i].bindingNumber;
+        bindings[i].descriptorType = descriptorInfo[i].descriptorType;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = descriptorInfo[i].shaderStage;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create descriptor set layout!");
+
+    // Set 0: mesh, set 1: tile
+    std::vector<VkDescriptorSetLayout> setLayouts = { m_descriptorSetLayout, m_descriptorSetLayout };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout);
+    if (status != VK_SUCCESS)
+        throw std::runtime_error("Failed to create pipeline layout!");
+
+    GraphicsPipelineDesc desc;
+    desc.name = "shadow atlas";
+    desc.shaders = { {shaderType::VERTEX, "cascadedShadowMap"} };
+    desc.vertexBinding = Attributes::PBR::getBindingDescription();
+    desc.vertexAttributes = Attributes::SHADOWMAP::getAttributeDescriptions();
+    desc.layout = m_pipelineLayout;
+    desc.renderPass = m_renderPass.get();
+    desc.subpass = 0;
+    desc.depthBiasEnable = VK_TRUE;
+    desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+    desc.colorAttachmentCount = 0;
+
+    getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
+}
+
+
+void ShadowAtlas::createBuffers()
+{
+    m_tilesBuffers.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_tilesAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            Config::MAX_LIGHTS * sizeof(int32_t) + Config::SHADOW_ATLAS_MAX_TILES * sizeof(ShadowAtlasTile),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_tilesBuffers[i],
+            &m_tilesAllocations[i]
+        );
+    }
+
+    m_tileUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT * Config::SHADOW_ATLAS_MAX_TILES);
+    m_tileUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT * Config::SHADOW_ATLAS_MAX_TILES);
+    for (uint32_t i = 0; i < m_tileUBOs.size(); i++)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(glm::mat4),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_tileUBOs[i],
+            &m_tileUBOAllocations[i]
+        );
+    }
+}
+
+
+void ShadowAtlas::createDescriptorSets()
+{
+    m_tileDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT * Config::SHADOW_ATLAS_MAX_TILES);
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::CASCADED_SHADOWMAP::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT * Config::SHADOW_ATLAS_MAX_TILES);
+
+    for (uint32_t i = 0; i < m_tileDescriptorSets.size(); i++)
+    {
+        m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_tileDescriptorSets[i]);
+
+        VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_tileUBOs[i]);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(m_tileDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+        };
+        vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+}
+
+
+bool ShadowAtlas::allocateNode(const uint32_t node, const uint32_t level, const uint32_t targetLevel, uint32_t& outNode)
+{
+    if (m_nodes[node] == NodeState::USED)
+        return false;
+
+    if (level == targetLevel)
+    {
+        if (m_nodes[node] != NodeState::FREE)
+            return false;
+
+        m_nodes[node] = NodeState::USED;
+        outNode = node;
+        return true;
+    }
+
+    // The children of a free node are all free.
+    m_nodes[node] = NodeState::SPLIT;
+    for (uint32_t child = 4 * node + 1; child <= 4 * node + 4; child++)
+    {
+        if (allocateNode(child, level + 1, targetLevel, outNode))
+            return true;
+    }
+
+    // Nothing found: merged back if it was split for nothing.
+    if (std::all_of(m_nodes.begin() + (4 * node + 1), m_nodes.begin() + (4 * node + 5), [](const NodeState state) { return state == NodeState::FREE; }))
+        m_nodes[node] = NodeState::FREE;
+
+    return false;
+}
+
+void ShadowAtlas::freeNode(uint32_t node)
+{
+    m_nodes[node] = NodeState::FREE;
+
+    while (node > 0)
+    {
+        const uint32_t parent = (node - 1) / 4;
+        if (!std::all_of(m_nodes.begin() + (4 * parent + 1), m_nodes.begin() + (4 * parent + 5), [](const NodeState state) { return state == NodeState::FREE; }))
+            break;
+
+        m_nodes[parent] = NodeState::FREE;
+        node = parent;
+    }
+}
+
+void ShadowAtlas::getNodeRect(const uint32_t node, uint32_t& outX, uint32_t& outY, uint32_t& outSize) const
+{
+    // Child index(0: top left, 1: top right, 2: bottom left, 3: bottom right) of each level, leaf first.
+    std::vector<uint32_t> path;
+    for (uint32_t current = node; current > 0; current = (current - 1) / 4)
+        path.push_back((current - 1) % 4);
+
+    outX = 0;
+    outY = 0;
+    outSize = m_resolution;
+    for (auto iter = path.rbegin(); iter != path.rend(); ++iter)
+    {
+        outSize /= 2;
+        outX += (*iter & 1) * outSize;
+        outY += (*iter >> 1) * outSize;
+    }
+}
+
+
+bool ShadowAtlas::allocate(const uint32_t light, const uint32_t size, const uint32_t tileCount)
+{
+    uint32_t targetLevel = 0;
+    for (uint32_t levelSize = m_resolution; levelSize > size; levelSize /= 2)
+        targetLevel++;
+
+    Allocation allocation{ size, {}, m_frame };
+    for (uint32_t i = 0; i < tileCount; i++)
+    {
+        uint32_t node;
+        if (!allocateNode(0, 0, targetLevel, node))
+        {
+            // All the tiles or none.
+            for (uint32_t allocated : allocation.nodes)
+                freeNode(allocated);
+            return false;
+        }
+        allocation.nodes.push_back(node);
+    }
+
+    m_allocations[light] = allocation;
+    return true;
+}
+
+void ShadowAtlas::release(const uint32_t light)
+{
+    auto iter = m_allocations.find(light);
+    if (iter == m_allocations.end())
+        return;
+
+    for (uint32_t node : iter->second.nodes)
+        freeNode(node);
+
+    m_allocations.erase(iter);
+}
+
+bool ShadowAtlas::evict()
+{
+    auto oldest = m_allocations.end();
+    for (auto iter = m_allocations.begin(); iter != m_allocations.end(); ++iter)
+    {
+        if (iter->second.lastUsedFrame == m_frame)
+            continue;
+        if (oldest == m_allocations.end() || iter->second.lastUsedFrame < oldest->second.lastUsedFrame)
+            oldest = iter;
+    }
+
+    if (oldest == m_allocations.end())
+        return false;
+
+    release(oldest->first);
+    return true;
+}
+
+
+void ShadowAtlas::update(const VkExtent2D& extent, const uint32_t frameIndex)
+{
+    const std::vector<GPULight>& lights = getRendererPointer()->getClusteredLights()->getLights();
+    const Camera& camera = getRenderResource()->m_camera;
+
+    const Frustum cameraFrustum = BoundingVolumes::extractFrustum(camera.getProjectionMatrix() * camera.getViewMatrix());
+    const glm::fvec3 cameraPos = camera.getCameraPos();
+    const float tanHalfFov = std::tan(glm::radians(static_cast<float>(camera.getCameraFov())) * 0.5f);
+
+    m_frame++;
+
+    // Importance: screen height covered by the influence sphere(pixels).
+    struct Request
+    {
+        uint32_t    light;
+        uint32_t    size;
+        float       importance;
+    };
+    std::vector<Request> requests;
+
+    for (uint32_t i = 0; i < lights.size(); i++)
+    {
+        const LightType type = static_cast<LightType>(lights[i].type);
+        if ((type != LightType::POINT_LIGHT && type != LightType::SPOT_LIGHT) || lights[i].radius <= 0.0f)
+            continue;
+
+        const glm::fvec3 center(lights[i].pos);
+        AxisAlignedBox bounds;
+        bounds.merge(center - glm::fvec3(lights[i].radius));
+        bounds.merge(center + glm::fvec3(lights[i].radius));
+        if (!BoundingVolumes::intersectsFrustum(cameraFrustum, bounds))
+            continue;
+
+        const float distance = glm::length(center - cameraPos);
+        const float importance = (distance > lights[i].radius) ? extent.height * lights[i].radius / (distance * tanHalfFov) : static_cast<float>(extent.height);
+
+        uint32_t size = Config::SHADOW_ATLAS_MIN_TILE;
+        while (size < importance && size < Config::SHADOW_ATLAS_MAX_TILE)
+            size *= 2;
+
+        requests.push_back({ i, size, importance });
+    }
+
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) { return a.importance > b.importance; });
+
+    m_tiles.clear();
+    m_lightFirstTile.assign(lights.size(), -1);
+    m_shadowedLightCount = 0;
+
+    for (const Request& request : requests)
+    {
+        const GPULight& light = lights[request.light];
+        const bool isPointLight = static_cast<LightType>(light.type) == LightType::POINT_LIGHT;
+        const uint32_t tileCount = isPointLight ? 6 : 1;
+
+        if (m_tiles.size() + tileCount > Config::SHADOW_ATLAS_MAX_TILES)
+            continue;
+
+        auto iter = m_allocations.find(request.light);
+        if (iter == m_allocations.end() || iter->second.size != request.size)
+        {
+            release(request.light);
+
+            // Evicts the stale lights first, then makes do with smaller tiles.
+            uint32_t size = request.size;
+            bool isAllocated = false;
+            while (!(isAllocated = allocate(request.light, size, tileCount)))
+            {
+                if (evict())
+                    continue;
+                if (size == Config::SHADOW_ATLAS_MIN_TILE)
+                    break;
+                size /= 2;
+            }
+
+            if (!isAllocated)
+                continue;
+        }
+
+        Allocation& allocation = m_allocations[request.light];
+        allocation.lastUsedFrame = m_frame;
+
+        const glm::fvec3 position(light.pos);
+        m_lightFirstTile[request.light] = static_cast<int32_t>(m_tiles.size());
+
+        // Faces in the order of getCubeFace()(shadowAtlas.glsl).
+        static const glm::fvec3 faceDirections[6] = {
+            { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+            { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+            { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+        };
+        static const glm::fvec3 faceUps[6] = {
+            { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+            { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+            { 0.0f, -1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }
+        };
+
+        for (uint32_t face = 0; face < tileCount; face++)
+        {
+            glm::mat4 view;
+            glm::mat4 proj;
+            if (isPointLight)
+            {
+                view = glm::lookAt(position, position + faceDirections[face], faceUps[face]);
+                proj = glm::perspectiveZO(glm::half_pi<float>(), 1.0f, LOCAL_SHADOW_NEAR, light.radius);
+            }
+            else
+            {
+                const glm::fvec3 direction = glm::normalize(glm::fvec3(light.dir));
+                const glm::fvec3 up = (std::abs(direction.y) > 0.99f) ? glm::fvec3(0.0f, 0.0f, 1.0f) : glm::fvec3(0.0f, 1.0f, 0.0f);
+                view = glm::lookAt(position, position + direction, up);
+                proj = glm::perspectiveZO(SPOT_SHADOW_FOV, 1.0f, LOCAL_SHADOW_NEAR, light.radius);
+            }
+            proj[1][1] *= -1;
+
+            uint32_t x, y, size;
+            getNodeRect(allocation.nodes[face], x, y, size);
+
+            ShadowAtlasTile tile;
+            tile.viewProj = proj * view;
+            tile.rect = glm::vec4(x, y, size, size) / static_cast<float>(m_resolution);
+            m_tiles.push_back(tile);
+        }
+
+        m_shadowedLightCount++;
+    }
+
+    // Lights past Config::MAX_LIGHTS aren't in the buffer either(ClusteredLights).
+    const size_t lightCount = std::min(m_lightFirstTile.size(), static_cast<size_t>(Config::MAX_LIGHTS));
+
+    // The frame's copy: the previous frames may still be reading theirs.
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_tilesAllocations[frameIndex], &data);
+    memcpy(data, m_lightFirstTile.data(), lightCount * sizeof(int32_t));
+    memcpy(static_cast<char*>(data) + Config::MAX_LIGHTS * sizeof(int32_t), m_tiles.data(), m_tiles.size() * sizeof(ShadowAtlasTile));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_tilesAllocations[frameIndex]);
+
+    for (uint32_t i = 0; i < m_tiles.size(); i++)
+    {
+        VmaAllocation& allocation = m_tileUBOAllocations[frameIndex * Config::SHADOW_ATLAS_MAX_TILES + i];
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), allocation, &data);
+        memcpy(data, &m_tiles[i].viewProj, sizeof(glm::mat4));
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), allocation);
+    }
+}
+
+
+void ShadowAtlas::draw(uint32_t imageIndex, uint32_t currentFrame)
+{
+    VkCommandBuffer& commandBuffer = getRendererPointer()->getGraphicsCommandBuffer(currentFrame);
+
+    // Cleared even without tiles: the render pass leaves it ready to be sampled.
+    m_renderPass.begin(m_framebuffer, { m_resolution, m_resolution }, m_clearValues, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+    for (uint32_t i = 0; i < m_tiles.size(); i++)
+    {
+        const glm::vec4 rect = m_tiles[i].rect * static_cast<float>(m_resolution);
+
+        VkViewport viewport{ rect.x, rect.y, rect.z, rect.w, 0.0f, 1.0f };
+        VkRect2D scissor{ { static_cast<int32_t>(rect.x), static_cast<int32_t>(rect.y) }, { static_cast<uint32_t>(rect.z), static_cast<uint32_t>(rect.w) } };
+
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        buildRenderQueue(currentFrame, i);
+        m_renderQueue.record(commandBuffer, getRendererPointer()->getRenderQueueStats());
+    }
+
+    m_renderPass.end(commandBuffer);
+}
+
+
+// The meshes overlapping the tile's frustum(scene BVH).
+void ShadowAtlas::buildRenderQueue(const uint32_t frameIndex, const uint32_t tile)
+{
+    GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+    const BVH& sceneBVH = getRenderResource()->m_sceneBVH;
+
+    m_renderQueue.clear();
+    m_casterMeshIndices.clear();
+
+    if (!sceneBVH.isEmpty())
+        sceneBVH.queryFrustum(BoundingVolumes::extractFrustum(m_tiles[tile].viewProj), m_casterMeshIndices);
+
+    for (uint32_t meshIndex : m_casterMeshIndices)
+    {
+        const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+
+        DrawItem item{};
+        item.pipeline = m_pipeline;
+        item.pipelineLayout = m_pipelineLayout;
+        item.descriptorSet = m_casterSource->getMeshDescriptorSet(meshIndex);
+        item.materialDescriptorSet = m_tileDescriptorSets[frameIndex * Config::SHADOW_ATLAS_MAX_TILES + tile];
+        item.indexCount = meshInfo->meshIndexCount;
+
+        if (gpuCulling->getPooledRange(meshIndex, item.firstIndex, item.vertexOffset))
+        {
+            item.vertexBuffer = gpuCulling->getVertexBuffer();
+            item.indexBuffer = gpuCulling->getIndexBuffer();
+        }
+        else
+        {
+            item.vertexBuffer = *meshInfo->vertexBuffer;
+            item.indexBuffer = *meshInfo->indexBuffer;
+        }
+
+        // Depth only: no need for a front-to-back order.
+        item.key = m_renderQueue.makeKey(0, item.pipeline, item.descriptorSet, item.vertexBuffer, 0.0f, 1.0f);
+        m_renderQueue.push(item);
+    }
+
+    m_renderQueue.sort();
+}
+
+
+void ShadowAtlas::destroy()
+{
+    m_descriptorAllocator.destroy();
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
+
+    m_image->destroy();
+    m_imageSampler->destroy();
+
+    for (uint32_t i = 0; i < m_tilesBuffers.size(); i++)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_tilesBuffers[i], m_tilesAllocations[i]);
+
+    for (uint32_t i = 0; i < m_tileUBOs.size(); i++)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_tileUBOs[i], m_tileUBOAllocations[i]);
+
+    m_renderPass.destroy();
+
+    vkDestroyFramebuffer(getRendererPointer()->getDevice(), m_framebuffer, nullptr);
+}
+
+
+void ShadowAtlas::createRenderPass(const VkFormat& format)
+{
+    // - Attachments
+    // Every tile is re-rendered: cleared and left ready to be sampled.
+    VkAttachmentDescription atlasAttachment{};
+    AttachmentUtils::createAttachmentDescriptionWithStencil(
+        format,
+        VK_SAMPLE_COUNT_1_BIT,
+        VK_ATTACHMENT_LOAD_OP_CLEAR,
+        VK_ATTACHMENT_STORE_OP_STORE,
+        VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        atlasAttachment
+    );
+
+    // Attachment references
+    VkAttachmentReference atlasAttachmentRef{};
+    AttachmentUtils::createAttachmentReference(
+        0,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        atlasAttachmentRef
+    );
+
+    // Subpasses
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.flags = 0;
+    subpass.pDepthStencilAttachment = &atlasAttachmentRef;
+
+    m_renderPass = RenderPass(
+        { atlasAttachment },
+        { subpass },
+        {}
+    );
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "VulkanRenderer/Descriptor/DescriptorTypes.h"
+#include "VulkanRenderer/Settings/config.h"
+
+#include "VulkanRenderer/RenderPass/RenderPass.h"
+
+#include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/RenderQueue/RenderQueue.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
+
+class CascadedShadowMap;
+
+// Layout must match shadowAtlas.glsl(std430).
+struct ShadowAtlasTile
+{
+    glm::mat4   viewProj;
+    glm::vec4   rect;                                       // xy = offset, zw = size(atlas uv)
+};
+
+/*
+ * Shadows of the point and spot lights, packed in one depth texture:
+ *  - Tiles are allocated by a quadtree over the atlas: a tile is a node, a
+ *    free node is split in 4 to get smaller ones and freed siblings merge
+ *    back. Spot lights take a tile, point lights one per cube face.
+ *  - The tile size follows the light's importance, the screen height its
+ *    influence sphere covers, as a power of two between
+ *    Config::SHADOW_ATLAS_MIN_TILE and Config::SHADOW_ATLAS_MAX_TILE. Lights
+ *    outside of the camera frustum get nothing.
+ *  - The most important lights are served first. A light keeps its tiles
+ *    while it asks for the same size, the tiles of the lights not served
+ *    this frame are evicted(least recently used first) when there's no room
+ *    left, then the size is halved. At most Config::SHADOW_ATLAS_MAX_TILES
+ *    tiles are rendered: the memory is fixed whatever the light count.
+ * Casters are drawn with the cascaded shadow map's model matrices. Shaders
+ * include shadowAtlas.glsl, lights without tiles are unshadowed.
+ */
+class ShadowAtlas
+{
+public:
+
+	ShadowAtlas(
+		const uint32_t resolution,
+		const VkFormat& format,
+		const std::shared_ptr<CascadedShadowMap>& casterSource
+	);
+
+	~ShadowAtlas() {};
+	void destroy();
+
+	// After ClusteredLights::update(), the tiles index its lights. Writes the
+	// frame's copy of the buffers.
+	void update(const VkExtent2D& extent, const uint32_t frameIndex);
+
+	// Must be recorded outside of a render pass, leaves the atlas ready to be sampled.
+	void draw(uint32_t imageIndex, uint32_t frameIndex);
+
+	Image* getImage() const									{ return m_image; }
+	VkSampler& getSampler() const							{ return m_imageSampler->getSampler(); }
+	const VkImageView& getImageView() const					{ return m_image->getImageView(); }
+	// First tile of each light then the tiles(shadowAtlas.glsl), per frame in flight.
+	const VkBuffer& getTilesBuffer(const uint32_t frameIndex) const	{ return m_tilesBuffers[frameIndex]; }
+
+	uint32_t getShadowedLightCount() const					{ return m_shadowedLightCount; }
+	uint32_t getTileCount() const							{ return static_cast<uint32_t>(m_tiles.size()); }
+
+private:
+	enum class NodeState : uint8_t
+	{
+		FREE,
+		SPLIT,
+		USED
+	};
+
+	struct Allocation
+	{
+		uint32_t				size;
+		std::vector<uint32_t>	nodes;
+		uint64_t				lastUsedFrame;
+	};
+
+	void createRenderPass(const VkFormat& format);
+	void createGraphicsPipeline();
+	void createBuffers();
+	void createDescriptorSets();
+
+	// Quadtree, node i has its children at 4i+1..4i+4(level + 1). Returns
+	// false when no free node of the target level is left under node.
+	bool allocateNode(const uint32_t node, const uint32_t level, const uint32_t targetLevel, uint32_t& outNode);
+	void freeNode(uint32_t node);
+	// Atlas texels covered by the node.
+	void getNodeRect(const uint32_t node, uint32_t& outX, uint32_t& outY, uint32_t& outSize) const;
+
+	bool allocate(const uint32_t light, const uint32_t size, const uint32_t tileCount);
+	void release(const uint32_t light);
+	// Frees the least recently used allocation not served this frame.
+	bool evict();
+
+	void buildRenderQueue(const uint32_t frameIndex, const uint32_t tile);
+
+	uint32_t						 m_resolution;
+	uint32_t						 m_levelCount;
+	std::vector<NodeState>			 m_nodes;
+
+	// Per light(index in ClusteredLights::getLights()).
+	std::unordered_map<uint32_t, Allocation> m_allocations;
+	uint64_t						 m_frame = 0;
+
+	std::vector<int32_t>			 m_lightFirstTile;
+	std::vector<ShadowAtlasTile>	 m_tiles;
+	uint32_t						 m_shadowedLightCount = 0;
+
+	std::shared_ptr<CascadedShadowMap> m_casterSource;
+
+	Image*							 m_image;
+	ImageSampler*					 m_imageSampler;
+
+	std::vector<VkClearValue>		 m_clearValues;
+	RenderPass                       m_renderPass;
+	VkFramebuffer					 m_framebuffer;
+
+	VkPipeline                       m_pipeline;
+	// Set 0(per mesh) and set 1(per tile), as the cascaded shadow map.
+	VkDescriptorSetLayout            m_descriptorSetLayout;
+	DescriptorAllocator              m_descriptorAllocator;
+	VkPipelineLayout                 m_pipelineLayout;
+
+	// lightFirstTile[Config::MAX_LIGHTS] then the tiles, per frame in flight.
+	std::vector<VkBuffer>			 m_tilesBuffers;
+	std::vector<VmaAllocation>		 m_tilesAllocations;
+
+	// Light space of each tile, per frame in flight(frame * Config::SHADOW_ATLAS_MAX_TILES + tile).
+	std::vector<VkBuffer>			 m_tileUBOs;
+	std::vector<VmaAllocation>		 m_tileUBOAllocations;
+	std::vector<VkDescriptorSet>	 m_tileDescriptorSets;
+
+	RenderQueue						 m_renderQueue;
+	std::vector<uint32_t>			 m_casterMeshIndices;
+};
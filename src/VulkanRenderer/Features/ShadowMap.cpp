@@ -70,6 +70,8 @@ ShadowMap::ShadowMap(
     //Create UBOs && DescriptorSets PerMesh
     createUBOs();
     createDescriptorSets();
+
+    m_staticCache = std::make_unique<StaticCommandCache>();
    
 
     //Create CommandPool
@@ -118,41 +120,6 @@ void ShadowMap::createGraphicsPipeline(const VkExtent2D& extent)
             throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-        // -------------------Shader Modules--------------------
-        const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "shadowMap"} };
-
-        std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-        for (uint32_t i = 0; i < shaderInfos.size(); i++)
-        {
-            PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-            PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-        }
-
-
-        // Dynamic states
-        std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-        VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
-
-        // Viewport state info
-        VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-        // Vertex input(attributes)
-        std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::SHADOWMAP::getAttributeDescriptions();
-        VkVertexInputBindingDescription bindingDescription = Attributes::PBR::getBindingDescription();
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-        // Input assembly
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-        // Rasterizer
-        VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0, VK_TRUE, 4.0f, 1.5f);
-        // Multisampling 
-        VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(VK_SAMPLE_COUNT_1_BIT, 0);
-        // Color blending(attachment)
-        VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-        // Color blending(global)
-        VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-
         // Pipeline layout
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -164,37 +131,49 @@ void ShadowMap::createGraphicsPipeline(const VkExtent2D& extent)
         if (status != VK_SUCCESS)
             throw std::runtime_error("Failed to create pipeline layout!");
 
-        // Depth and stencil
-        VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS_OR_EQUAL);
-
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = shaderInfos.size();
-        pipelineInfo.pStages = shaderStagesInfos.data();
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizationState;
-        pipelineInfo.pMultisampleState = &multisampleState;
-        pipelineInfo.pDepthStencilState = &depthStencilState;
-        pipelineInfo.pColorBlendState = &colorBlendState;
-        pipelineInfo.pDynamicState = &dynamicState;
-        pipelineInfo.pTessellationState = nullptr;
-        pipelineInfo.pNext = nullptr;
-        pipelineInfo.layout = m_pipelineLayout;
-        pipelineInfo.renderPass = m_renderPass.get();
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineInfo.basePipelineIndex = -1;
-
-        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
-        if (status != VK_SUCCESS)
-            throw std::runtime_error("Failed to create graphics pipeline!");
-
-        for (auto& shaderModule : shaderModules)
+        GraphicsPipelineDesc desc;
+        desc.name = "shadow map";
+        desc.shaders = { {shaderType::VERTEX, "shadowMap"} };
+        desc.vertexBinding = Attributes::PBR::getBindingDescription();
+        desc.vertexAttributes = Attributes::SHADOWMAP::getAttributeDescriptions();
+        desc.layout = m_pipelineLayout;
+        desc.renderPass = m_renderPass.get();
+        desc.subpass = 0;
+        desc.depthBiasEnable = VK_TRUE;
+        desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
+
+        //---------------------------- Indirect Shadow Pipeline ----------------------------
+        // Same fixed function states, the model matrices come from the GPUCulling object buffer.
+        const std::vector<DescriptorInfo>& indirectDescriptorInfo = GRAPHICS_PIPELINE::SHADOWMAP_INDIRECT::DESCRIPTORS_INFO;
+
+        std::vector<VkDescriptorSetLayoutBinding> indirectBindings(indirectDescriptorInfo.size());
+        for (uint32_t i = 0; i < indirectDescriptorInfo.size(); i++)
         {
-            ShaderManager::destroyShaderModule(shaderModule);
+            indirectBindings[i].binding = indirectDescriptorInfo[i].bindingNumber;
+            indirectBindings[i].descriptorType = indirectDescriptorInfo[i].descriptorType;
+            indirectBindings[i].descriptorCount = 1;
+            indirectBindings[i].stageFlags = indirectDescriptorInfo[i].shaderStage;
+            indirectBindings[i].pImmutableSamplers = nullptr;
         }
+
+        layoutInfo.bindingCount = static_cast<uint32_t>(indirectBindings.size());
+        layoutInfo.pBindings = indirectBindings.data();
+
+        if (vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &m_indirectDescriptorSetLayout) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+
+        pipelineLayoutInfo.pSetLayouts = &m_indirectDescriptorSetLayout;
+        status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_indirectPipelineLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline layout!");
+
+        desc.name = "shadow map indirect";
+        desc.shaders = { {shaderType::VERTEX, "shadowMapIndirect"} };
+        desc.layout = m_indirectPipelineLayout;
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_indirectPipeline);
     }
 }
 
@@ -203,28 +182,28 @@ ShadowMap::~ShadowMap() {}
 
 
 
-void ShadowMap::updateUBO() 
+void ShadowMap::updateUBO(const uint32_t frameIndex) 
 {
-    for (auto ptr : getRenderResource()->m_normalModels)
-    {
+    // Same light space for every mesh.
+    //glm::mat4 proj = MathUtils::getUpdatedProjMatrix(glm::radians(Config::FOV), 1.0, Config::Z_NEAR_SHADOW, Config::Z_FAR_SHADOW);
+    glm::mat4 proj = glm::ortho(-8.0f, 8.0f, -8.0f, 8.0f, 0.5f, 50.0f);
 
-        for (uint32_t meshIndex : ptr->getMeshIndices())
-        {
-            m_basicInfo.model = ptr->getModelMatrix();
+    proj[1][1] *= -1;
 
-            //glm::mat4 proj = MathUtils::getUpdatedProjMatrix(glm::radians(Config::FOV), 1.0, Config::Z_NEAR_SHADOW, Config::Z_FAR_SHADOW);
-            glm::mat4 proj = glm::ortho(-8.0f, 8.0f, -8.0f, 8.0f, 0.5f, 50.0f);
+    LightInfo& info = getRenderResource()->m_lightsInfo[getRenderResource()->m_directionalLightIndex];
 
-            proj[1][1] *= -1;
+    glm::fvec3 lightDir = glm::normalize(info.m_targetPos - info.pos);
 
-            LightInfo& info = getRenderResource()->m_lightsInfo[getRenderResource()->m_directionalLightIndex];
+    glm::mat4 view = glm::lookAt(info.pos,info.pos + lightDir, glm::fvec3(0.0f, 1.0f, 0.0f));
 
-            glm::fvec3 lightDir = glm::normalize(info.m_targetPos - info.pos);
+    m_basicInfo.lightSpace = proj * view;
 
-            glm::mat4 view = glm::lookAt(info.pos,info.pos + lightDir, glm::fvec3(0.0f, 1.0f, 0.0f));
-
-            m_basicInfo.lightSpace = proj * view;
+    for (auto ptr : getRenderResource()->m_normalModels)
+    {
+        m_basicInfo.model = ptr->getModelMatrix();
 
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
             void* data;
             vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_uboAllocationsMap[meshIndex], &data);
             memcpy(data, &m_basicInfo, sizeof(m_basicInfo));
@@ -232,46 +211,105 @@ void ShadowMap::updateUBO()
         }
     
     }
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_indirectUBOAllocations[frameIndex], &data);
+    memcpy(data, &m_basicInfo.lightSpace, sizeof(glm::mat4));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_indirectUBOAllocations[frameIndex]);
 }
 
 void ShadowMap::draw(uint32_t imageIndex, uint32_t currentFrame)
 {
     VkCommandBuffer& commandBuffer = getRendererPointer()->getGraphicsCommandBuffer(currentFrame);
 
-    //--------------------------------RenderPass-----------------------------
-    m_renderPass.begin(m_framebuffers[imageIndex], VkExtent2D({ m_width,m_height }), m_clearValuesShadowMap, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+    GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+    const bool isGPUDriven = getRendererPointer()->isGPUDrivenEnabled();
+
+    // The culling dispatch can't be recorded inside the render pass.
+    if (isGPUDriven)
+        gpuCulling->cull(commandBuffer, m_cullingView, currentFrame, m_basicInfo.lightSpace);
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+    // Only the CPU-driven path has enough draws to be worth recording in
+    // parallel or caching(the indirect one depends on per frame buffers).
+    const bool isCached = !isGPUDriven && getRendererPointer()->isStaticCachingEnabled();
+    const bool isParallel = !isGPUDriven && !isCached && getRendererPointer()->isParallelRecordingEnabled();
+
+    //--------------------------------RenderPass-----------------------------
+    m_renderPass.begin(m_framebuffers[imageIndex], VkExtent2D({ m_width,m_height }), m_clearValuesShadowMap, commandBuffer, (isParallel || isCached) ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
 
     // Set Dynamic States
     VkViewport viewport{ 0.0f, 0.0f,m_width,m_height, 0.0f, 1.0f };
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
     VkRect2D scissor{ {0,0}, {m_width,m_height} };
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    if (isGPUDriven)
     {
-        for (auto ptr : getRenderResource()->m_normalModels)
-        {
-            for (uint32_t meshIndex : ptr->getMeshIndices())
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_indirectPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_indirectPipelineLayout, 0, 1, &m_indirectDescriptorSets[currentFrame], 0, nullptr);
+
+        gpuCulling->drawIndirect(commandBuffer, m_cullingView, currentFrame);
+    }
+    else if (isCached)
+    {
+        // The shadow pass draws every normal model, hidden or not: only the
+        // targets and the pipeline can invalidate it.
+        uint64_t signature = 0;
+        StaticCommandCache::combine(signature, (uint64_t)m_pipeline);
+        StaticCommandCache::combine(signature, (uint64_t)m_framebuffers[imageIndex]);
+
+        const VkCommandBuffer& secondary = m_staticCache->get(imageIndex, signature, m_renderPass.get(), 0, m_framebuffers[imageIndex],
+            [&](VkCommandBuffer& cachedCommandBuffer)
             {
-                RenderMeshInfo& meshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
-
-                std::vector<VkDeviceSize> offsets = { 0 };
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, meshInfo.ref_mesh->vertexBuffer, offsets.data());
-                vkCmdBindIndexBuffer(commandBuffer, *meshInfo.ref_mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-                const std::vector<VkDescriptorSet> sets = { m_descriptorSetsMap[meshIndex] };
-                vkCmdBindDescriptorSets(
-                    commandBuffer,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    m_pipelineLayout,
-                    0,
-                    sets.size(), sets.data(),
-                    0, {}
-                );
-
-                vkCmdDrawIndexed(commandBuffer, meshInfo.ref_mesh->meshIndexCount, 1, 0, 0, 0);
+                buildRenderQueue();
+
+                vkCmdSetViewport(cachedCommandBuffer, 0, 1, &viewport);
+                vkCmdSetScissor(cachedCommandBuffer, 0, 1, &scissor);
+
+                RenderQueueStats recordStats;
+                m_renderQueue.record(cachedCommandBuffer, recordStats);
             }
+        );
+
+        vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+
+        getRendererPointer()->getRenderQueueStats().cachedDraws += static_cast<uint32_t>(m_renderQueue.getItems().size());
+    }
+    else
+    {
+        buildRenderQueue();
+
+        if (isParallel)
+        {
+            ParallelRecorder* recorder = getRendererPointer()->getParallelRecorder();
+            std::vector<RenderQueueStats> sliceStats(recorder->getSliceCount());
+
+            recorder->record(
+                commandBuffer,
+                currentFrame,
+                m_renderPass.get(),
+                0,
+                m_framebuffers[imageIndex],
+                static_cast<uint32_t>(m_renderQueue.getItems().size()),
+                [&](const VkCommandBuffer& secondary, const uint32_t begin, const uint32_t end, const uint32_t slice)
+                {
+                    vkCmdSetViewport(secondary, 0, 1, &viewport);
+                    vkCmdSetScissor(secondary, 0, 1, &scissor);
+
+                    m_renderQueue.record(secondary, begin, end, sliceStats[slice]);
+                }
+            );
+
+            for (auto& stats : sliceStats)
+                getRendererPointer()->getRenderQueueStats().add(stats);
+        }
+        else
+        {
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+            m_renderQueue.record(commandBuffer, getRendererPointer()->getRenderQueueStats());
         }
     }
     m_renderPass.end(commandBuffer);
@@ -279,6 +317,44 @@ void ShadowMap::draw(uint32_t imageIndex, uint32_t currentFrame)
 
 
 
+void ShadowMap::buildRenderQueue()
+{
+    GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+
+    m_renderQueue.clear();
+
+    for (auto ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+
+            DrawItem item{};
+            item.pipeline = m_pipeline;
+            item.pipelineLayout = m_pipelineLayout;
+            item.descriptorSet = m_descriptorSetsMap[meshIndex];
+            item.indexCount = meshInfo->meshIndexCount;
+
+            if (gpuCulling->getPooledRange(meshIndex, item.firstIndex, item.vertexOffset))
+            {
+                item.vertexBuffer = gpuCulling->getVertexBuffer();
+                item.indexBuffer = gpuCulling->getIndexBuffer();
+            }
+            else
+            {
+                item.vertexBuffer = *meshInfo->vertexBuffer;
+                item.indexBuffer = *meshInfo->indexBuffer;
+            }
+
+            // Depth only: no need for a front-to-back order.
+            item.key = m_renderQueue.makeKey(0, item.pipeline, item.descriptorSet, item.vertexBuffer, 0.0f, 1.0f);
+            m_renderQueue.push(item);
+        }
+    }
+
+    m_renderQueue.sort();
+}
+
 const VkCommandBuffer& ShadowMap::getCommandBuffer(const uint32_t index) const
 {
     return m_commandBuffers[index];
@@ -354,18 +430,34 @@ void ShadowMap::createUBOs()
             );
         }
     }
+
+    m_indirectUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_indirectUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(glm::mat4),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_indirectUBOs[i],
+            &m_indirectUBOAllocations[i]
+        );
+    }
 }
 
 void ShadowMap::createDescriptorSets()
 {
     //------------------------------- DescriptorSets  ----------------------------------
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::SHADOWMAP::DESCRIPTORS_INFO, getRenderResource()->getNormalMeshCount());
+
     for (auto ptr : getRenderResource()->m_normalModels)
     {
         for (uint32_t meshIndex : ptr->getMeshIndices())
         {
             m_descriptorSetsMap[meshIndex];
             {
-                DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayout, &m_descriptorSetsMap[meshIndex]);
+                m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSetsMap[meshIndex]);
 
                 VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_ubosMap[meshIndex]);
        
@@ -377,6 +469,24 @@ void ShadowMap::createDescriptorSets()
         }
     }
 
+    //------------------------ Indirect(GPU-driven) DescriptorSets ---------------------
+    m_cullingView = getRendererPointer()->getGPUCulling()->createView();
+
+    m_indirectDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::SHADOWMAP_INDIRECT::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        m_descriptorAllocator.allocate(m_indirectDescriptorSetLayout, &m_indirectDescriptorSets[i]);
+
+        VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_indirectUBOs[i]);
+        VkDescriptorBufferInfo objectBufferInfo = DescriptorManager::descriptorBufferInfo(getRendererPointer()->getGPUCulling()->getObjectBuffer(i));
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(m_indirectDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+            DescriptorManager::writeDescriptorSet(m_indirectDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &objectBufferInfo),
+        };
+        vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
 }
 
 
@@ -384,10 +494,21 @@ void ShadowMap::createDescriptorSets()
 
 void ShadowMap::destroy()
 {
+    m_descriptorAllocator.destroy();
+    getRendererPointer()->getGPUCulling()->releaseView(m_cullingView);
+
     vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
     vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipeline, nullptr);
     vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayout, nullptr);
 
+    vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_indirectDescriptorSetLayout, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_indirectPipeline, nullptr);
+    vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_indirectPipelineLayout, nullptr);
+    for (uint32_t i = 0; i < m_indirectUBOs.size(); i++)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_indirectUBOs[i], m_indirectUBOAllocations[i]);
+
+    m_staticCache->destroy();
+
     m_image->destroy();
     m_imageSampler->destroy();
 
@@ -12,6 +12,9 @@
 
 
 #include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/RenderQueue/RenderQueue.h"
+#include "VulkanRenderer/Command/StaticCommandCache.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
 
 
 class ShadowMap
@@ -28,10 +31,13 @@ public:
 	~ShadowMap();
 	void destroy();
 
-	void updateUBO();
+	// Writes the frame's copy of the indirect UBO.
+	void updateUBO(const uint32_t frameIndex);
 
 	void draw(uint32_t imageIndex, uint32_t frameIndex);
 
+	uint32_t getCullingView() const { return m_cullingView; }
+
 	Image* getImage() const;
 	VkSampler& getSampler() const;
 	const VkImageView& getShadowMapView() const;
@@ -49,6 +55,7 @@ private:
 	void createFramebuffer(const uint32_t& imagesCount);
 	void createUBOs();
 	void createDescriptorSets();
+	void buildRenderQueue();
 
 	uint32_t                         m_width;
 	uint32_t                         m_height;
@@ -70,6 +77,7 @@ private:
 
 	VkPipeline                       m_pipeline;
 	VkDescriptorSetLayout            m_descriptorSetLayout;
+	DescriptorAllocator              m_descriptorAllocator;
 	VkPipelineLayout                 m_pipelineLayout;
 
 	DescriptorTypes::UniformBufferObject::ShadowMap m_basicInfo;
@@ -77,4 +85,20 @@ private:
 	std::unordered_map<uint32_t, VkBuffer>			m_ubosMap;
 	std::unordered_map<uint32_t, VmaAllocation>		m_uboAllocationsMap;
 	std::unordered_map<uint32_t, VkDescriptorSet>	m_descriptorSetsMap;
+
+	// GPU-driven path(see GPUCulling)
+	VkPipeline                       m_indirectPipeline;
+	VkDescriptorSetLayout            m_indirectDescriptorSetLayout;
+	VkPipelineLayout                 m_indirectPipelineLayout;
+
+	// Light space, per frame in flight.
+	std::vector<VkBuffer>			 m_indirectUBOs;
+	std::vector<VmaAllocation>		 m_indirectUBOAllocations;
+	std::vector<VkDescriptorSet>	 m_indirectDescriptorSets;
+
+	uint32_t						 m_cullingView;
+
+	// CPU-driven path
+	RenderQueue						 m_renderQueue;
+	std::unique_ptr<StaticCommandCache> m_staticCache;
 };
\ No newline at end of file
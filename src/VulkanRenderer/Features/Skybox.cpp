@@ -8,14 +8,14 @@
 #include "VulkanRenderer/Shader/ShaderManager.h"
 #include "VulkanRenderer/Math/MathUtils.h"
 
-SkyBox::SkyBox(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex)
+SkyBox::SkyBox(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex, const bool isDepthWriteEnabled)
 {
-	createPipeline(renderPass, multisampleBits, subPassIndex);
+	createPipeline(renderPass, multisampleBits, subPassIndex, isDepthWriteEnabled);
     createUBO();
     createDescriptorSet();
 }
 
-void SkyBox::createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex)
+void SkyBox::createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex, const bool isDepthWriteEnabled)
 {
     const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::SKYBOX::DESCRIPTORS_INFO;
 
@@ -38,42 +38,6 @@ void SkyBox::createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBit
         throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-    // -------------------Shader Modules--------------------
-    const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "skybox"}, {shaderType::FRAGMENT, "skybox"} };
-
-    std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-    std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-    for (uint32_t i = 0; i < shaderInfos.size(); i++)
-    {
-        PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-        PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-    }
-
-
-    // Dynamic states
-    std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-    VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
- 
-    // Viewport state info
-    VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-    // Vertex input(attributes)
-    std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::SKYBOX::getAttributeDescriptions();
-    VkVertexInputBindingDescription bindingDescription = Attributes::SKYBOX::getBindingDescription();
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-    // Input assembly
-    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-    // Rasterizer
-    VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_FRONT_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0, VK_FALSE);
-    // Multisampling 
-    VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(multisampleBits, 0);
-    // Color blending(attachment)
-    VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-
-    // Color blending(global)
-    VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-
     // Pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -85,37 +49,20 @@ void SkyBox::createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBit
     if (status != VK_SUCCESS)
         throw std::runtime_error("Failed to create pipeline layout!");
 
-    // Depth and stencil
-    VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS_OR_EQUAL);
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = shaderInfos.size();
-    pipelineInfo.pStages = shaderStagesInfos.data();
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizationState;
-    pipelineInfo.pMultisampleState = &multisampleState;
-    pipelineInfo.pDepthStencilState = &depthStencilState;
-    pipelineInfo.pColorBlendState = &colorBlendState;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.pTessellationState = nullptr;
-    pipelineInfo.pNext = nullptr;
-    pipelineInfo.layout = m_pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = subPassIndex;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = -1;
-
-    status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
-    if (status != VK_SUCCESS)
-        throw std::runtime_error("Failed to create graphics pipeline!");
-
-    for (auto& shaderModule : shaderModules)
-    {
-        ShaderManager::destroyShaderModule(shaderModule);
-    }
+    GraphicsPipelineDesc desc;
+    desc.name = "skybox";
+    desc.shaders = { {shaderType::VERTEX, "skybox"}, {shaderType::FRAGMENT, "skybox"} };
+    desc.vertexBinding = Attributes::SKYBOX::getBindingDescription();
+    desc.vertexAttributes = Attributes::SKYBOX::getAttributeDescriptions();
+    desc.layout = m_pipelineLayout;
+    desc.renderPass = renderPass;
+    desc.subpass = subPassIndex;
+    desc.cullMode = VK_CULL_MODE_FRONT_BIT;
+    desc.sampleCount = multisampleBits;
+    desc.depthWriteEnable = isDepthWriteEnabled ? VK_TRUE : VK_FALSE;
+    desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+    getRendererPointer()->getPipelineCompiler().add(desc, &m_pipeline);
 }
 
 void SkyBox::createDescriptorSet()
@@ -123,7 +70,8 @@ void SkyBox::createDescriptorSet()
     auto skyboxModel = getRenderResource()->m_skybox;
     uint32_t meshIndex = skyboxModel->getMeshIndices()[0];
 
-    DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayout, &m_descriptorSet);
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::SKYBOX::DESCRIPTORS_INFO, 1);
+    m_descriptorAllocator.allocate(m_descriptorSetLayout, &m_descriptorSet);
 
     VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_ubo);
     VkDescriptorImageInfo skybox = DescriptorManager::descriptorImageInfo(getRenderResource()->m_skyboxCubeMap.sampler->getSampler(), getRenderResource()->m_skyboxCubeMap.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
@@ -177,7 +125,7 @@ void SkyBox::updateUBO()
 
 void SkyBox::draw(VkCommandBuffer & commandBuffer)
 {
-    VkExtent2D extent = getRendererPointer()->getSwapchainInfo().extent;
+    VkExtent2D extent = getRendererPointer()->getRenderExtent();
 
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
 
@@ -214,6 +162,7 @@ void SkyBox::draw(VkCommandBuffer & commandBuffer)
 
 void SkyBox::destroy()
 {
+    m_descriptorAllocator.destroy();
     vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_ubo, m_uboAllocation);
 
     vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayout, nullptr);
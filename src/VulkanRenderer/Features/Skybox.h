@@ -3,12 +3,14 @@
 #include <vulkan/vulkan.h>
 #include <unordered_map>
 #include <vk_mem_alloc.h>
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
 
 class SkyBox
 {
 public:
 	SkyBox();
-	SkyBox(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex);
+	// isDepthWriteEnabled: false when the subpass reads the depth(read only layout).
+	SkyBox(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex, const bool isDepthWriteEnabled = true);
 
 	~SkyBox() {};
 
@@ -17,13 +19,14 @@ public:
 
 	void destroy();
 private:
-	void createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex);
+	void createPipeline(const VkRenderPass& renderPass, VkSampleCountFlagBits multisampleBits, uint32_t subPassIndex, const bool isDepthWriteEnabled);
 	void createDescriptorSet();
 	void createUBO();
 
 	VkPipeline				m_pipeline;
 	VkPipelineLayout		m_pipelineLayout;
 	VkDescriptorSetLayout	m_descriptorSetLayout;
+	DescriptorAllocator		m_descriptorAllocator;
 
 	VkDescriptorSet			m_descriptporSet;
 
@@ -0,0 +1,492 @@
+#include "VulkanRenderer/Features/TemporalAA.h"
+
+#include <stdexcept>
+#include <cstring>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Settings/Config.h"
+#include "VulkanRenderer/Settings/GraphicsPipelineConfig.h"
+#include "VulkanRenderer/Settings/ComputePipelineConfig.h"
+#include "VulkanRenderer/Buffer/BufferManager.h"
+#include "VulkanRenderer/Command/CommandManager.h"
+#include "VulkanRenderer/Descriptor/DescriptorManager.h"
+#include "VulkanRenderer/Framebuffer/FramebufferManager.h"
+#include "VulkanRenderer/Model/Attributes.h"
+#include "VulkanRenderer/Model/ModelManager.h"
+#include "VulkanRenderer/Pipeline/PipelineManager.h"
+#include "VulkanRenderer/RenderPass/AttachmentUtils.h"
+#include "VulkanRenderer/Image/Image.h"
+#include "VulkanRenderer/RenderResource.h"
+
+#include "VulkanRenderer/Renderer.h"
+
+namespace
+{
+    // Radical inverse of index in base, in [0, 1).
+    float halton(uint32_t index, const uint32_t base)
+    {
+        float fraction = 1.0f;
+        float result = 0.0f;
+        while (index > 0)
+        {
+            fraction /= base;
+            result += fraction * (index % base);
+            index /= base;
+        }
+        return result;
+    }
+
+    VkDescriptorSetLayout createDescriptorSetLayout(const std::vector<DescriptorInfo>& bufferInfos)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings(bufferInfos.size());
+        for (uint32_t i = 0; i < bufferInfos.size(); i++)
+        {
+            bindings[i].binding = bufferInfos[i].bindingNumber;
+            bindings[i].descriptorType = bufferInfos[i].descriptorType;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = bufferInfos[i].shaderStage;
+            bindings[i].pImmutableSamplers = nullptr;
+        }
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        VkDescriptorSetLayout descriptorSetLayout;
+        auto status = vkCreateDescriptorSetLayout(getRendererPointer()->getDevice(), &layoutInfo, nullptr, &descriptorSetLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create descriptor set layout!");
+
+        return descriptorSetLayout;
+    }
+
+    VkPipelineLayout createPipelineLayout(const VkDescriptorSetLayout& descriptorSetLayout, const VkPushConstantRange& pushConstantRange)
+    {
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        VkPipelineLayout pipelineLayout;
+        auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout);
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline layout!");
+
+        return pipelineLayout;
+    }
+
+    // velocity.vert
+    struct VelocityFrameData
+    {
+        glm::mat4   jitteredViewProj;
+        glm::mat4   viewProj;
+        glm::mat4   prevViewProj;
+    };
+
+    struct VelocityPushConstants
+    {
+        glm::mat4   model;
+        glm::mat4   prevModel;
+    };
+}
+
+TemporalAA::TemporalAA()
+{
+    for (auto& ptr : getRenderResource()->m_normalModels)
+    {
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+            m_meshOwners[meshIndex] = ptr.get();
+    }
+
+    m_clearValues.resize(2);
+    m_clearValues[0].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
+    m_clearValues[1].depthStencil = { 1.0f, 0 };
+
+    // Bilinear taps of the scene color and the history, clamped to their edges.
+    m_sampler = new ImageSampler(VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, 0.0f, VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK);
+
+    createRenderPass();
+    createPipelines();
+    createBuffers();
+    createHistory();
+
+    // The history has the swapchain's extent.
+    getRendererPointer()->registerSwapchainCallback([this]() {
+        // Its views are the graph's, recreated with the scene's.
+        releaseFramebuffer();
+        destroyHistory();
+        createHistory();
+        m_hasHistory = false;
+    });
+}
+
+void TemporalAA::createRenderPass()
+{
+    // - Attachments
+    // Motion vectors and their depth, left as attachments for the graph.
+    VkAttachmentDescription velocityAttachment{};
+    AttachmentUtils::createAttachmentDescription(
+        VELOCITY_FORMAT,
+        VK_SAMPLE_COUNT_1_BIT,
+        VK_ATTACHMENT_LOAD_OP_CLEAR,
+        VK_ATTACHMENT_STORE_OP_STORE,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        velocityAttachment
+    );
+
+    VkAttachmentDescription depthAttachment{};
+    AttachmentUtils::createAttachmentDescriptionWithStencil(
+        getRendererPointer()->getDepthImageInfo().depth_image_format,
+        VK_SAMPLE_COUNT_1_BIT,
+        VK_ATTACHMENT_LOAD_OP_CLEAR,
+        // The resolve picks the closest depth of the neighbourhood.
+        VK_ATTACHMENT_STORE_OP_STORE,
+        VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        depthAttachment
+    );
+
+    // - Attachment References
+    VkAttachmentReference velocityAttachmentRef{};
+    AttachmentUtils::createAttachmentReference(0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, velocityAttachmentRef);
+
+    VkAttachmentReference depthAttachmentRef{};
+    AttachmentUtils::createAttachmentReference(1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthAttachmentRef);
+
+    // - Subpasses
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &velocityAttachmentRef;
+    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+    // The graph's barriers order it with the other passes.
+    m_renderPass = RenderPass(
+        { velocityAttachment, depthAttachment },
+        { subpass },
+        {}
+    );
+}
+
+void TemporalAA::createPipelines()
+{
+    //------------------------------ Motion Vectors Pipeline -----------------------------
+    m_velocityDescriptorSetLayout = createDescriptorSetLayout(GRAPHICS_PIPELINE::VELOCITY::DESCRIPTORS_INFO);
+    m_velocityPipelineLayout = createPipelineLayout(m_velocityDescriptorSetLayout, { VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VelocityPushConstants) });
+
+    GraphicsPipelineDesc desc;
+    desc.name = "velocity";
+    desc.shaders = { {shaderType::VERTEX, "velocity"}, {shaderType::FRAGMENT, "velocity"} };
+    desc.vertexBinding = Attributes::PBR::getBindingDescription();
+    desc.vertexAttributes = Attributes::SHADOWMAP::getAttributeDescriptions();
+    desc.layout = m_velocityPipelineLayout;
+    desc.renderPass = m_renderPass.get();
+    desc.subpass = 0;
+
+    getRendererPointer()->getPipelineCompiler().add(desc, &m_velocityPipeline);
+
+    //------------------------------ Resolve Pipeline -----------------------------
+    m_resolveDescriptorSetLayout = createDescriptorSetLayout(COMPUTE_PIPELINE::TEMPORAL_AA::BUFFERS_INFO);
+    m_resolvePipelineLayout = createPipelineLayout(m_resolveDescriptorSetLayout, { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(TemporalAAParams) });
+
+    ComputePipelineDesc resolveDesc;
+    resolveDesc.name = "TAA resolve";
+    resolveDesc.shader = { shaderType::COMPUTE, "taa" };
+    resolveDesc.layout = m_resolvePipelineLayout;
+    getRendererPointer()->getPipelineCompiler().add(resolveDesc, &m_resolvePipeline);
+}
+
+void TemporalAA::createBuffers()
+{
+    m_frameUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_frameUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_frameDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+    getRendererPointer()->getDescriptorAllocator().reserve(GRAPHICS_PIPELINE::VELOCITY::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(VelocityFrameData),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_frameUBOs[i],
+            &m_frameUBOAllocations[i]
+        );
+
+        getRendererPointer()->getDescriptorAllocator().allocate(m_velocityDescriptorSetLayout, &m_frameDescriptorSets[i]);
+
+        VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_frameUBOs[i]);
+
+        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+            DescriptorManager::writeDescriptorSet(m_frameDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+        };
+        vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+}
+
+void TemporalAA::createHistory()
+{
+    const VkExtent2D extent = getRendererPointer()->getSwapchain()->getExtent();
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        m_historyImages[i] = Image::Create2DImage(
+            extent,
+            HISTORY_FORMAT,
+            VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY,
+            VK_IMAGE_ASPECT_COLOR_BIT
+        );
+    }
+
+    // The graph expects the history where the upscale pass of the last frame left it.
+    VkCommandBuffer commandBuffer = CommandManager::cmdBeginSingleTimeCommands(getRendererPointer()->getDevice(), getRendererPointer()->getCommandPool());
+
+    std::vector<VkImageMemoryBarrier> barriers(2);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].srcAccessMask = 0;
+        barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].image = m_historyImages[i]->getImage();
+        barriers[i].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    }
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    CommandManager::cmdEndSingleTimeCommands(getRendererPointer()->getDevice(), getRendererPointer()->getGraphicsQueue(), getRendererPointer()->getCommandPool(), commandBuffer);
+}
+
+void TemporalAA::destroyHistory()
+{
+    for (Image*& image : m_historyImages)
+    {
+        image->destroy();
+        delete image;
+        image = nullptr;
+    }
+}
+
+void TemporalAA::createFramebuffer(const VkImageView& velocityView, const VkImageView& depthView, const VkExtent2D& extent)
+{
+    // The previous frames may still use it.
+    if (m_framebuffer != VK_NULL_HANDLE)
+    {
+        vkDeviceWaitIdle(getRendererPointer()->getDevice());
+        vkDestroyFramebuffer(getRendererPointer()->getDevice(), m_framebuffer, nullptr);
+    }
+
+    std::vector<VkImageView> attachments = { velocityView, depthView };
+    FramebufferManager::createFramebuffer(getRendererPointer()->getDevice(), m_renderPass.get(), attachments, extent.width, extent.height, 1, &m_framebuffer);
+
+    m_framebufferViews[0] = velocityView;
+    m_framebufferViews[1] = depthView;
+}
+
+void TemporalAA::update(const uint32_t frameIndex, const VkExtent2D& renderExtent)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    m_frameCount++;
+    m_renderExtent = renderExtent;
+
+    Camera& camera = getRenderResource()->m_camera;
+
+    if (m_isEnabled)
+    {
+        // Subpixel offset in [-0.5, 0.5] texels of the render extent.
+        const uint32_t sample = (m_frameCount % Config::TAA_JITTER_SAMPLES) + 1;
+        const glm::vec2 offset(halton(sample, 2) - 0.5f, halton(sample, 3) - 0.5f);
+        camera.setJitter(2.0f * offset / glm::vec2(renderExtent.width, renderExtent.height));
+    }
+    else
+    {
+        camera.setJitter(glm::vec2(0.0f));
+        m_hasHistory = false;
+    }
+
+    // The camera's previous view is the one of the last frame(updated once per frame).
+    VelocityFrameData frameData;
+    frameData.jitteredViewProj = camera.getJitteredProjectionMatrix() * camera.getViewMatrix();
+    frameData.viewProj = camera.getProjectionMatrix() * camera.getViewMatrix();
+    frameData.prevViewProj = camera.getProjectionMatrix() * camera.getPrevViewMatrix();
+
+    m_reprojection = frameData.prevViewProj * glm::inverse(frameData.viewProj);
+
+    void* data;
+    vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[frameIndex], &data);
+    memcpy(data, &frameData, sizeof(frameData));
+    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[frameIndex]);
+
+    // Models seen for the first time didn't move.
+    m_prevModelMatrices.swap(m_modelMatrices);
+    for (auto& ptr : getRenderResource()->m_normalModels)
+    {
+        m_modelMatrices[ptr.get()] = ptr->getModelMatrix();
+        if (m_prevModelMatrices.find(ptr.get()) == m_prevModelMatrices.end())
+            m_prevModelMatrices[ptr.get()] = ptr->getModelMatrix();
+    }
+}
+
+void TemporalAA::drawVelocity(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const VkImageView& velocityView, const VkImageView& depthView, const VkExtent2D& extent)
+{
+    if (!m_isEnabled)
+        return;
+
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    if (m_framebuffer == VK_NULL_HANDLE || velocityView != m_framebufferViews[0] || depthView != m_framebufferViews[1])
+        createFramebuffer(velocityView, depthView, extent);
+
+    m_renderPass.begin(m_framebuffer, m_renderExtent, m_clearValues, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+    VkViewport viewport{ 0.0f, 0.0f, (float)m_renderExtent.width, (float)m_renderExtent.height, 0.0f, 1.0f };
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    VkRect2D scissor{ {0,0}, m_renderExtent };
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_velocityPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_velocityPipelineLayout, 0, 1, &m_frameDescriptorSets[frameIndex], 0, nullptr);
+
+    GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+    VkBuffer currentVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer currentIndexBuffer = VK_NULL_HANDLE;
+
+    // Frustum and occlusion culled.
+    for (uint32_t meshIndex : getRenderResource()->getVisibleMeshIndices())
+    {
+        auto iter = m_meshOwners.find(meshIndex);
+        if (iter == m_meshOwners.end() || iter->second->isHidden())
+            continue;
+
+        VelocityPushConstants pushConstants;
+        pushConstants.model = m_modelMatrices[iter->second];
+        pushConstants.prevModel = m_prevModelMatrices[iter->second];
+        vkCmdPushConstants(commandBuffer, m_velocityPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), &pushConstants);
+
+        const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        VkBuffer vertexBuffer = *meshInfo->vertexBuffer;
+        VkBuffer indexBuffer = *meshInfo->indexBuffer;
+        if (gpuCulling->getPooledRange(meshIndex, firstIndex, vertexOffset))
+        {
+            vertexBuffer = gpuCulling->getVertexBuffer();
+            indexBuffer = gpuCulling->getIndexBuffer();
+        }
+
+        if (vertexBuffer != currentVertexBuffer)
+        {
+            const VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+            currentVertexBuffer = vertexBuffer;
+        }
+
+        if (indexBuffer != currentIndexBuffer)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            currentIndexBuffer = indexBuffer;
+        }
+
+        vkCmdDrawIndexed(commandBuffer, meshInfo->meshIndexCount, 1, firstIndex, vertexOffset, 0);
+    }
+
+    m_renderPass.end(commandBuffer);
+}
+
+void TemporalAA::resolve(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const VkImageView& sceneColorView, const VkImageView& velocityView, const VkImageView& depthView)
+{
+    if (!m_isEnabled)
+        return;
+
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    VkDescriptorSet descriptorSet;
+    getRendererPointer()->getFrameDescriptorAllocator(frameIndex).allocate(m_resolveDescriptorSetLayout, &descriptorSet);
+
+    VkDescriptorImageInfo sceneColorInfo = DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), sceneColorView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkDescriptorImageInfo velocityInfo = DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), velocityView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkDescriptorImageInfo depthInfo = DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), depthView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkDescriptorImageInfo historyInfo = DescriptorManager::descriptorImageInfo(m_sampler->getSampler(), getHistory()->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    VkDescriptorImageInfo outputInfo = DescriptorManager::descriptorImageInfo(VK_NULL_HANDLE, getOutput()->getImageView(), VK_IMAGE_LAYOUT_GENERAL);
+
+    std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 0, &sceneColorInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, &velocityInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &depthInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, &historyInfo),
+        DescriptorManager::writeDescriptorSet(descriptorSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 4, &outputInfo),
+    };
+    vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+
+    TemporalAAParams params;
+    params.reprojection = m_reprojection;
+    params.renderSize = glm::vec2(m_renderExtent.width, m_renderExtent.height);
+    params.blend = Config::TAA_BLEND;
+    params.clampGamma = Config::TAA_CLAMP_GAMMA;
+    params.hasHistory = m_hasHistory ? 1 : 0;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_resolvePipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_resolvePipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_resolvePipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+
+    const uint32_t groupSize = COMPUTE_PIPELINE::TEMPORAL_AA::WORKGROUP_SIZE;
+    const VkExtent2D outputExtent = getOutput()->getExtent2D();
+    vkCmdDispatch(commandBuffer, (outputExtent.width + groupSize - 1) / groupSize, (outputExtent.height + groupSize - 1) / groupSize, 1);
+
+    // Next frame's history.
+    m_hasHistory = true;
+}
+
+void TemporalAA::releaseFramebuffer()
+{
+    if (m_framebuffer != VK_NULL_HANDLE)
+        vkDestroyFramebuffer(getRendererPointer()->getDevice(), m_framebuffer, nullptr);
+
+    m_framebuffer = VK_NULL_HANDLE;
+    m_framebufferViews[0] = m_framebufferViews[1] = VK_NULL_HANDLE;
+}
+
+void TemporalAA::destroy()
+{
+    VkDevice device = getRendererPointer()->getDevice();
+
+    for (uint32_t i = 0; i < m_frameUBOs.size(); ++i)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_frameUBOs[i], m_frameUBOAllocations[i]);
+
+    destroyHistory();
+    m_sampler->destroy();
+
+    if (m_framebuffer != VK_NULL_HANDLE)
+        vkDestroyFramebuffer(device, m_framebuffer, nullptr);
+    m_renderPass.destroy();
+
+    vkDestroyDescriptorSetLayout(device, m_velocityDescriptorSetLayout, nullptr);
+    vkDestroyPipeline(device, m_velocityPipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_velocityPipelineLayout, nullptr);
+
+    vkDestroyDescriptorSetLayout(device, m_resolveDescriptorSetLayout, nullptr);
+    vkDestroyPipeline(device, m_resolvePipeline, nullptr);
+    vkDestroyPipelineLayout(device, m_resolvePipelineLayout, nullptr);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+
+#include "VulkanRenderer/RenderPass/RenderPass.h"
+
+class Image;
+class ImageSampler;
+class Model;
+
+// Layout must match taa.comp(push constants, std430).
+struct TemporalAAParams
+{
+    glm::mat4   reprojection;
+    glm::vec2   renderSize;
+    float       blend;
+    float       clampGamma;
+    uint32_t    hasHistory;
+};
+
+/*
+ * Temporal anti-aliasing and upscaling of the scene passes:
+ *  - update() offsets the camera's projection by a subpixel jitter(Halton 2, 3)
+ *    every frame, the scenes render with Camera::getJitteredProjectionMatrix().
+ *  - drawVelocity() rasterizes the visible meshes of m_normalModels again(own
+ *    depth, single sample) writing their screen motion since the previous frame,
+ *    from the camera's previous view and the model matrices of the last frame.
+ *  - resolve()(taa.comp) blends the scene color, at the render extent, into a
+ *    history at the swapchain's extent: the previous history is reprojected and
+ *    clamped to the current neighbourhood. The two history images swap every
+ *    frame, the upscale pass copies the new one to the swapchain.
+ * Light spheres and the skybox have no motion vectors: they are reprojected
+ * with the camera's motion as if they were on the far plane.
+ */
+class TemporalAA
+{
+public:
+    TemporalAA();
+    ~TemporalAA() {};
+
+    // Jitter of this frame's projection and matrices of the motion vectors.
+    void update(const uint32_t frameIndex, const VkExtent2D& renderExtent);
+
+    // Targets of the scene's extent, drawn in its top left render extent.
+    void drawVelocity(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const VkImageView& velocityView, const VkImageView& depthView, const VkExtent2D& extent);
+    // Outside of a render pass, the inputs in SHADER_READ_ONLY and getOutput() in GENERAL.
+    void resolve(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex, const VkImageView& sceneColorView, const VkImageView& velocityView, const VkImageView& depthView);
+
+    const bool& isEnabled() const                   { return m_isEnabled; }
+    void setEnabled(const bool enabled)             { m_isEnabled = enabled; }
+
+    // Written by the last frame, then this frame's target.
+    Image* getHistory()                             { return m_historyImages[(m_frameCount + 1) % 2]; }
+    Image* getOutput()                              { return m_historyImages[m_frameCount % 2]; }
+
+    inline static const VkFormat VELOCITY_FORMAT = VK_FORMAT_R16G16_SFLOAT;
+    inline static const VkFormat HISTORY_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+    // The scene's graph images are gone(scene rebuilt): recreated on the next draw.
+    void releaseFramebuffer();
+
+    void destroy();
+
+private:
+    void createRenderPass();
+    void createPipelines();
+    void createBuffers();
+    void createHistory();
+    void destroyHistory();
+    // For the graph's images, recreated when they change.
+    void createFramebuffer(const VkImageView& velocityView, const VkImageView& depthView, const VkExtent2D& extent);
+
+    bool                            m_isEnabled = false;
+    // The history read this frame was written by the last one.
+    bool                            m_hasHistory = false;
+    uint32_t                        m_frameCount = 0;
+
+    VkExtent2D                      m_renderExtent{};
+    glm::mat4                       m_reprojection = glm::mat4(1.0f);
+
+    // Owner of each mesh of m_normalModels, and the model matrices of this and the last frame.
+    std::unordered_map<uint32_t, Model*>        m_meshOwners;
+    std::unordered_map<Model*, glm::mat4>       m_modelMatrices;
+    std::unordered_map<Model*, glm::mat4>       m_prevModelMatrices;
+
+    // Motion vectors
+    RenderPass                      m_renderPass;
+    std::vector<VkClearValue>       m_clearValues;
+    VkFramebuffer                   m_framebuffer = VK_NULL_HANDLE;
+    VkImageView                     m_framebufferViews[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+
+    VkPipeline                      m_velocityPipeline;
+    VkPipelineLayout                m_velocityPipelineLayout;
+    VkDescriptorSetLayout           m_velocityDescriptorSetLayout;
+
+    // Per frame
+    std::vector<VkBuffer>           m_frameUBOs;
+    std::vector<VmaAllocation>      m_frameUBOAllocations;
+    std::vector<VkDescriptorSet>    m_frameDescriptorSets;
+
+    // Resolve
+    VkPipeline                      m_resolvePipeline;
+    VkPipelineLayout                m_resolvePipelineLayout;
+    VkDescriptorSetLayout           m_resolveDescriptorSetLayout;
+
+    Image*                          m_historyImages[2] = { nullptr, nullptr };
+    ImageSampler*                   m_sampler;
+};
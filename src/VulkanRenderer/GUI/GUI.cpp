@@ -3,6 +3,8 @@
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdio>
+#include <cfloat>
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -76,7 +78,7 @@ GUI::GUI()
     initInfo.Device = getRendererPointer()->getDevice();
     initInfo.QueueFamily = graphicsFamilyIndex;
     initInfo.Queue = graphicsQueue;
-    initInfo.PipelineCache = VK_NULL_HANDLE;
+    initInfo.PipelineCache = getRendererPointer()->getPipelineCache().get();
     initInfo.DescriptorPool = m_descriptorPool;
     initInfo.Allocator = nullptr;
     initInfo.MinImageCount = swapchain->getMinImageCount();
@@ -213,6 +215,14 @@ void GUI::createFrameBuffers()
     }
 }
 
+void GUI::recreateFrameBuffers()
+{
+    for (auto& framebuffer : m_framebuffers)
+        vkDestroyFramebuffer(getRendererPointer()->getDevice(), framebuffer, nullptr);
+
+    createFrameBuffers();
+}
+
 void GUI::createRenderPass()
 {
     // - Attachments
@@ -307,6 +317,13 @@ void GUI::draw(const uint8_t currentFrame, const uint8_t imageIndex)
         ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x,0.0f),ImGuiCond_Always,ImVec2(1.0f, 0.0f));
         createProfilingWindow();
     }
+    {
+        sizeX = float(ImGui::GetIO().DisplaySize.x) * 0.2f;
+        sizeY = float(ImGui::GetIO().DisplaySize.y) * 0.4f;
+        ImGui::SetNextWindowSize(ImVec2(sizeX, sizeY), ImGuiCond_Always);
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x, float(ImGui::GetIO().DisplaySize.y) * 0.2f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+        createGPUProfilerWindow();
+    }
     {
         sizeX = float(ImGui::GetIO().DisplaySize.x) * 0.2f;
         sizeY = float(ImGui::GetIO().DisplaySize.y);
@@ -358,10 +375,268 @@ void GUI::createProfilingWindow()
 
     ImGui::Text(("MSAA: "));
     ImGui::NextColumn();
-    ImGui::Text(std::string(std::to_string(samplesCount) + "x").c_str());
+    // Applied before the next frame(the scene is rebuilt).
+    bool isFirstCount = true;
+    for (const VkSampleCountFlagBits count : Config::MSAA_SAMPLES_COUNTS)
+    {
+        if (!getRendererPointer()->getMSAA()->isSupported(count))
+            continue;
+
+        if (!isFirstCount)
+            ImGui::SameLine();
+        isFirstCount = false;
+
+        if (ImGui::RadioButton((std::to_string(count) + "x").c_str(), samplesCount == count))
+            getRendererPointer()->setMSAASamplesCount(count);
+    }
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("Present mode: "));
+    ImGui::NextColumn();
+    // Applied after the next present(the swapchain is recreated).
+    {
+        const std::vector<std::pair<VkPresentModeKHR, const char*>> presentModes = {
+            { VK_PRESENT_MODE_FIFO_KHR, "FIFO" },
+            { VK_PRESENT_MODE_FIFO_RELAXED_KHR, "FIFO relaxed" },
+            { VK_PRESENT_MODE_MAILBOX_KHR, "Mailbox" },
+            { VK_PRESENT_MODE_IMMEDIATE_KHR, "Immediate" },
+        };
+
+        const std::shared_ptr<Swapchain> swapchain = getRendererPointer()->getSwapchain();
+        bool isFirstMode = true;
+        for (const auto& [presentMode, name] : presentModes)
+        {
+            if (!swapchain->isPresentModeSupported(presentMode))
+                continue;
+
+            if (!isFirstMode)
+                ImGui::SameLine();
+            isFirstMode = false;
+
+            if (ImGui::RadioButton(name, swapchain->getPresentMode() == presentMode))
+                getRendererPointer()->setPresentMode(presentMode);
+        }
+    }
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("Frames in flight: "));
+    ImGui::NextColumn();
+    // Applied before the next frame(the GPU is waited on).
+    {
+        int framesInFlight = static_cast<int>(getRendererPointer()->getFramesInFlight());
+        if (ImGui::SliderInt("##framesInFlight", &framesInFlight, 1, Config::MAX_FRAMES_IN_FLIGHT))
+            getRendererPointer()->setFramesInFlight(static_cast<uint32_t>(framesInFlight));
+    }
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    // Input sampling to GPU completion, submit and present(p50 / p90 / p99).
+    {
+        const LatencyMeter* latencyMeter = getRendererPointer()->getLatencyMeter();
+        const auto percentilesText = [](const LatencyMeter::Percentiles& percentiles) {
+            char text[64];
+            snprintf(text, sizeof(text), "%.2f / %.2f / %.2f", percentiles.p50, percentiles.p90, percentiles.p99);
+            return std::string(text);
+        };
+
+        ImGui::Text(("Latency(ms): "));
+        ImGui::NextColumn();
+        ImGui::Text(latencyMeter->isSupported() ? percentilesText(latencyMeter->getEndToEnd()).c_str() : "No timestamps");
+        ImGui::NextColumn();
+        ImGui::Separator();
+
+        ImGui::Text(("Input to submit(ms): "));
+        ImGui::NextColumn();
+        ImGui::Text(percentilesText(latencyMeter->getSubmit()).c_str());
+        ImGui::NextColumn();
+        ImGui::Separator();
+
+        ImGui::Text(("Input to present(ms): "));
+        ImGui::NextColumn();
+        ImGui::Text(percentilesText(latencyMeter->getPresent()).c_str());
+        ImGui::NextColumn();
+        ImGui::Separator();
+    }
+
+    const BVH& sceneBVH = getRenderResource()->m_sceneBVH;
+
+    ImGui::Text(("BVH build(ms): "));
+    ImGui::NextColumn();
+    ImGui::Text(std::to_string(sceneBVH.getLastBuildTimeMs()).c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("BVH refit(ms): "));
+    ImGui::NextColumn();
+    ImGui::Text(std::to_string(sceneBVH.getLastRefitTimeMs()).c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("Visible meshes: "));
+    ImGui::NextColumn();
+    ImGui::Text((std::to_string(getRenderResource()->getVisibleMeshIndices().size()) + "/" + std::to_string(sceneBVH.getPrimitiveCount())).c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    // Hi-Z pyramid of the scene's depth(read back a few frames late) or software
+    // rasterized occluders, applies to the draws recorded every frame.
+    // Experimental(first phase only, see Culling/OcclusionCulling.h).
+    {
+        OcclusionCulling* occlusionCulling = getRendererPointer()->getOcclusionCulling();
+
+        bool isOcclusionCulling = occlusionCulling->isEnabled();
+        ImGui::Checkbox("Occlusion culling(experimental)", &isOcclusionCulling);
+        occlusionCulling->setEnabled(isOcclusionCulling);
+        ImGui::NextColumn();
+        ImGui::Text((std::to_string(occlusionCulling->getOccludedCount()) + " occluded").c_str());
+        ImGui::NextColumn();
+        ImGui::Separator();
+
+        bool isCPUOcclusion = occlusionCulling->isCPURasterizationEnabled();
+        ImGui::Checkbox("CPU occlusion(software raster)", &isCPUOcclusion);
+        occlusionCulling->setCPURasterizationEnabled(isCPUOcclusion);
+        ImGui::NextColumn();
+        ImGui::NextColumn();
+        ImGui::Separator();
+    }
+
+    // Render scale driven by the GPU time of the frame, the scene is upscaled to the swapchain.
+    {
+        DynamicResolution* dynamicResolution = getRendererPointer()->getDynamicResolution();
+        const VkExtent2D& renderExtent = dynamicResolution->getRenderExtent();
+
+        bool isDynamicResolution = dynamicResolution->isEnabled();
+        ImGui::Checkbox("Dynamic resolution", &isDynamicResolution);
+        dynamicResolution->setEnabled(isDynamicResolution && dynamicResolution->isSupported());
+        ImGui::NextColumn();
+        ImGui::Text("%ux%u (%d%%)", renderExtent.width, renderExtent.height, int(dynamicResolution->getScale() * 100.0f + 0.5f));
+        ImGui::NextColumn();
+        ImGui::Separator();
+
+        ImGui::SliderFloat("GPU target(ms)", &dynamicResolution->getTargetTime(), 1.0f, 50.0f);
+        ImGui::NextColumn();
+        ImGui::Text(dynamicResolution->isSupported() ? (std::to_string(dynamicResolution->getGPUTime()) + " ms").c_str() : "No timestamps");
+        ImGui::NextColumn();
+        ImGui::Separator();
+    }
+
+    // Jittered projection resolved into a swapchain sized history(upscales the render extent too).
+    {
+        TemporalAA* temporalAA = getRendererPointer()->getTemporalAA();
+
+        bool isTemporalAA = temporalAA->isEnabled();
+        ImGui::Checkbox("Temporal AA", &isTemporalAA);
+        temporalAA->setEnabled(isTemporalAA);
+        ImGui::NextColumn();
+        ImGui::NextColumn();
+        ImGui::Separator();
+    }
+
+    const RenderQueueStats& queueStats = getRendererPointer()->getRenderQueueStats();
+
+    ImGui::Text(("Draws: "));
+    ImGui::NextColumn();
+    ImGui::Text(std::to_string(queueStats.draws).c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("Binds(saved): "));
+    ImGui::NextColumn();
+    ImGui::Text((std::to_string(queueStats.bindsIssued) + "(" + std::to_string(queueStats.bindsSaved) + ")").c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    // Forward and SH lighting passes: depth only prepass, then shading with an EQUAL test.
+    bool isDepthPrepass = getRendererPointer()->isDepthPrepassEnabled();
+    ImGui::Checkbox("Depth prepass", &isDepthPrepass);
+    getRendererPointer()->setDepthPrepassEnabled(isDepthPrepass);
+    ImGui::NextColumn();
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    bool isCaching = getRendererPointer()->isStaticCachingEnabled();
+    ImGui::Checkbox("Cached commands", &isCaching);
+    getRendererPointer()->setStaticCachingEnabled(isCaching);
+    ImGui::NextColumn();
+    ImGui::Text((std::to_string(queueStats.cachedDraws) + " draws replayed").c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    bool isParallel = getRendererPointer()->isParallelRecordingEnabled();
+    ImGui::Checkbox("Parallel recording", &isParallel);
+    getRendererPointer()->setParallelRecordingEnabled(isParallel);
+    ImGui::NextColumn();
+    ImGui::Text((std::to_string(getRendererPointer()->getParallelRecorder()->getSliceCount()) + " threads").c_str());
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    bool isGPUDriven = getRendererPointer()->isGPUDrivenEnabled();
+    ImGui::Checkbox("GPU-driven", &isGPUDriven);
+    getRendererPointer()->setGPUDrivenEnabled(isGPUDriven);
+    ImGui::NextColumn();
+    if (isGPUDriven)
+    {
+        GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+
+        uint32_t drawCount = 0;
+        for (uint32_t i = 0; i < gpuCulling->getViewCount(); ++i)
+            drawCount += gpuCulling->getLastDrawCount(i);
+
+        ImGui::Text((std::to_string(drawCount) + "/" + std::to_string(gpuCulling->getObjectCount() * gpuCulling->getActiveViewCount()) + " draws").c_str());
+    }
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("Bindless: "));
+    ImGui::NextColumn();
+    if (const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials())
+        ImGui::Text((std::to_string(bindless->getTextureCount()) + " textures, " + std::to_string(bindless->getSamplerCount()) + " samplers").c_str());
+    else
+        ImGui::Text("Unsupported");
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    // Lights uploaded(stress lights included) and the froxel grid they are binned in,
+    // by clusterLights.comp or by a worker thread.
+    {
+        ClusteredLights* clusteredLights = getRendererPointer()->getClusteredLights();
+
+        bool isCPUBinning = clusteredLights->isCPUBinningEnabled();
+        ImGui::Checkbox("CPU light binning", &isCPUBinning);
+        clusteredLights->setCPUBinningEnabled(isCPUBinning);
+        ImGui::NextColumn();
+        ImGui::Text((std::to_string(clusteredLights->getLightCount()) + " lights, " + std::to_string(clusteredLights->getClusterCount()) + " clusters").c_str());
+    }
+    ImGui::NextColumn();
+    ImGui::Separator();
+
+    ImGui::Text(("Descriptor pools: "));
+    ImGui::NextColumn();
+    ImGui::Text(std::to_string(getRendererPointer()->getDescriptorAllocator().getPoolCount()).c_str());
     ImGui::NextColumn();
     ImGui::Separator();
 
+    // Aliased(what's allocated) and unaliased size of the render graph's attachments.
+    if (const ScenePassBase* scene = getRendererPointer()->getScene())
+    {
+        const RenderGraph& renderGraph = scene->getRenderGraph();
+
+        ImGui::Text(("Transient memory: "));
+        ImGui::NextColumn();
+        ImGui::Text((std::to_string(renderGraph.getTransientMemorySize() / (1024 * 1024)) + " MB(" + std::to_string(renderGraph.getUnaliasedMemorySize() / (1024 * 1024)) + " MB)").c_str());
+        ImGui::NextColumn();
+        ImGui::Separator();
+
+        ImGui::Text(("Render graph: "));
+        ImGui::NextColumn();
+        if (ImGui::Button("Dump"))
+            scene->dumpRenderGraph();
+        ImGui::NextColumn();
+        ImGui::Separator();
+    }
+
     ImGui::End();
 }
 
@@ -400,6 +675,14 @@ void GUI::displayLightModels()
             sliderName = ("###Intensity::" + modelName);
             createSlider(subMenuName, sliderName, 100.0f, 0.0f, intensity);
 
+            if (info.m_lightType == LightType::POINT_LIGHT)
+            {
+                std::vector<uint32_t> influencedMeshes;
+                getRenderResource()->getMeshesInfluencedByLight(info, influencedMeshes);
+                ImGui::Text(("Radius: " + std::to_string(getRenderResource()->getLightInfluenceRadius(info))).c_str());
+                ImGui::Text(("Lit meshes: " + std::to_string(influencedMeshes.size())).c_str());
+            }
+
             ImGui::TreePop();
             ImGui::Separator();
         }
@@ -425,6 +708,70 @@ void GUI::createSlider(const std::string& subMenuName,const std::string& sliceNa
 }
 
 
+void GUI::createGPUProfilerWindow()
+{
+    ImGui::Begin("GPU passes", NULL, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize);
+
+    GPUProfiler* gpuProfiler = getRendererPointer()->getGPUProfiler();
+    if (!gpuProfiler->isSupported())
+    {
+        ImGui::Text("No timestamps");
+        ImGui::End();
+        return;
+    }
+
+    bool isEnabled = gpuProfiler->isEnabled();
+    if (ImGui::Checkbox("Enabled", &isEnabled))
+        gpuProfiler->setEnabled(isEnabled);
+
+    // The frames kept(Config::GPU_PROFILER_HISTORY_FRAMES).
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV"))
+        gpuProfiler->writeCSV(GPU_PROFILE_CSV_FILE);
+    ImGui::SameLine();
+    if (ImGui::Button("Export JSON"))
+        gpuProfiler->writeJSON(GPU_PROFILE_JSON_FILE);
+    ImGui::Separator();
+
+    const std::deque<GPUProfiler::FrameTimes>& frames = gpuProfiler->getFrames();
+    if (frames.empty())
+    {
+        ImGui::End();
+        return;
+    }
+
+    // Read the frames in flight after it was recorded.
+    const GPUProfiler::FrameTimes& lastFrame = frames.back();
+    ImGui::Text(("Frame(ms): " + std::to_string(lastFrame.totalMs)).c_str());
+
+    // Share of the frame, nested scopes indented under their pass.
+    const float barStart = ImGui::GetWindowWidth() * 0.45f;
+    for (auto& pass : lastFrame.passes)
+    {
+        char duration[32];
+        snprintf(duration, sizeof(duration), "%.3f ms", pass.durationMs);
+
+        ImGui::Text((std::string(2 * pass.depth, ' ') + pass.name).c_str());
+        ImGui::SameLine(barStart);
+        ImGui::ProgressBar((lastFrame.totalMs > 0.0) ? float(pass.durationMs / lastFrame.totalMs) : 0.0f, ImVec2(-1.0f, 0.0f), duration);
+    }
+
+    if (ImGui::CollapsingHeader("History(ms)"))
+    {
+        for (size_t i = 0; i < lastFrame.passes.size(); ++i)
+        {
+            const std::string& name = lastFrame.passes[i].name;
+            const std::vector<float> history = gpuProfiler->getHistory(name);
+
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::PlotLines("##history", history.data(), static_cast<int>(history.size()), 0, name.c_str(), 0.0f, FLT_MAX, ImVec2(-1.0f, 40.0f));
+            ImGui::PopID();
+        }
+    }
+
+    ImGui::End();
+}
+
 void GUI::createModelsWindow()
 {
     ImGui::Begin("Models",NULL,ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize);
@@ -432,6 +779,10 @@ void GUI::createModelsWindow()
     ImGui::Text("Objects");
     ImGui::Separator();
 
+    const std::shared_ptr<Model>& pickedModel = getRenderResource()->m_pickedModel;
+    ImGui::Text(("Picked: " + (pickedModel ? pickedModel->getName() : std::string("None"))).c_str());
+    ImGui::Separator();
+
     for (auto ptr : getRenderResource()->m_normalModels)
     {
         const std::string modelName = ptr->getName();
@@ -441,6 +792,10 @@ void GUI::createModelsWindow()
         glm::fvec3 newSize = ptr->getSize();
         bool isHidden = ptr->isHidden();
 
+        // Clicking an object in the viewport expands its node.
+        if (ptr == pickedModel)
+            ImGui::SetNextItemOpen(true, ImGuiCond_Always);
+
         if (ImGui::TreeNode(modelName.c_str()))
         {
             ImGui::Checkbox("Hide", &isHidden);
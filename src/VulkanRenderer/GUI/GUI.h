@@ -24,6 +24,9 @@ public:
 
     const bool isCursorPositionInGUI() const;
 
+    // They have the swapchain's extent.
+    void recreateFrameBuffers();
+
     void destroy();
 
 private:
@@ -34,6 +37,8 @@ private:
     void createModelsWindow();
 
     void createProfilingWindow();
+    // Last frame's GPU time per pass(bars) and its history(graphs).
+    void createGPUProfilerWindow();
 
     void createSlider(const std::string& subMenuName, const std::string& sliceName, const float& maxV, const float& minV, float& value);
     void createTransformationsInfo(glm::vec3& pos,glm::vec3& rot, glm::vec3& size, const std::string& modelName);
@@ -0,0 +1,116 @@
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Arvo's method: the transformed box is the sum of the absolute columns
+ * scaled by the half extent, around the transformed center.
+ */
+AxisAlignedBox BoundingVolumes::transformBox(const AxisAlignedBox& box, const glm::mat4& matrix)
+{
+    if (!box.isValid())
+        return box;
+
+    const glm::fvec3 center = glm::fvec3(matrix * glm::fvec4(box.getCenter(), 1.0f));
+    const glm::fvec3 halfExtent = box.getExtent() * 0.5f;
+
+    glm::fvec3 newHalfExtent(0.0f);
+    for (int i = 0; i < 3; ++i)
+        newHalfExtent += glm::abs(glm::fvec3(matrix[i])) * halfExtent[i];
+
+    AxisAlignedBox result;
+    result.min = center - newHalfExtent;
+    result.max = center + newHalfExtent;
+    return result;
+}
+
+/*
+ * Gribb/Hartmann plane extraction. The near plane uses the [-1,1] depth range,
+ * which is also conservative for projections that output [0,1].
+ */
+Frustum BoundingVolumes::extractFrustum(const glm::mat4& viewProj)
+{
+    const glm::fvec4 row0 = glm::fvec4(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+    const glm::fvec4 row1 = glm::fvec4(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+    const glm::fvec4 row2 = glm::fvec4(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+    const glm::fvec4 row3 = glm::fvec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+    Frustum frustum;
+    frustum.planes[0] = row3 + row0;    // left
+    frustum.planes[1] = row3 - row0;    // right
+    frustum.planes[2] = row3 + row1;    // bottom
+    frustum.planes[3] = row3 - row1;    // top
+    frustum.planes[4] = row3 + row2;    // near
+    frustum.planes[5] = row3 - row2;    // far
+
+    for (auto& plane : frustum.planes)
+        plane /= glm::length(glm::fvec3(plane));
+
+    return frustum;
+}
+
+bool BoundingVolumes::intersectsFrustum(const Frustum& frustum, const AxisAlignedBox& box)
+{
+    for (const auto& plane : frustum.planes)
+    {
+        // Farthest corner along the plane normal.
+        const glm::fvec3 positive(
+            plane.x >= 0.0f ? box.max.x : box.min.x,
+            plane.y >= 0.0f ? box.max.y : box.min.y,
+            plane.z >= 0.0f ? box.max.z : box.min.z
+        );
+
+        if (glm::dot(glm::fvec3(plane), positive) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool BoundingVolumes::intersectsSphere(const BoundingSphere& sphere, const AxisAlignedBox& box)
+{
+    const glm::fvec3 closest = glm::clamp(sphere.center, box.min, box.max);
+    const glm::fvec3 d = closest - sphere.center;
+    return glm::dot(d, d) <= sphere.radius * sphere.radius;
+}
+
+/*
+ * Slab test. tEnter is only written when the ray hits the box before maxT.
+ */
+bool BoundingVolumes::intersectsRay(const Ray& ray, const glm::fvec3& invDirection, const AxisAlignedBox& box, const float maxT, float& tEnter)
+{
+    const glm::fvec3 t0 = (box.min - ray.origin) * invDirection;
+    const glm::fvec3 t1 = (box.max - ray.origin) * invDirection;
+
+    const glm::fvec3 tSmall = glm::min(t0, t1);
+    const glm::fvec3 tBig = glm::max(t0, t1);
+
+    const float tMin = std::max(std::max(tSmall.x, tSmall.y), std::max(tSmall.z, 0.0f));
+    const float tMax = std::min(std::min(tBig.x, tBig.y), std::min(tBig.z, maxT));
+
+    if (tMin > tMax)
+        return false;
+
+    tEnter = tMin;
+    return true;
+}
+
+Ray BoundingVolumes::screenPointToRay(const glm::fvec2& cursorPos, const glm::fvec2& windowSize, const glm::mat4& view, const glm::mat4& proj)
+{
+    // The projection matrices of the renderer already flip Y, so window and
+    // NDC Y axes point the same way.
+    const float ndcX = 2.0f * cursorPos.x / windowSize.x - 1.0f;
+    const float ndcY = 2.0f * cursorPos.y / windowSize.y - 1.0f;
+
+    const glm::mat4 invViewProj = glm::inverse(proj * view);
+
+    glm::fvec4 nearPoint = invViewProj * glm::fvec4(ndcX, ndcY, 0.0f, 1.0f);
+    glm::fvec4 farPoint = invViewProj * glm::fvec4(ndcX, ndcY, 1.0f, 1.0f);
+    nearPoint /= nearPoint.w;
+    farPoint /= farPoint.w;
+
+    Ray ray;
+    ray.origin = glm::fvec3(nearPoint);
+    ray.direction = glm::normalize(glm::fvec3(farPoint - nearPoint));
+    return ray;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+struct AxisAlignedBox
+{
+    glm::fvec3 min = glm::fvec3(std::numeric_limits<float>::max());
+    glm::fvec3 max = glm::fvec3(std::numeric_limits<float>::lowest());
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    glm::fvec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::fvec3 getExtent() const { return max - min; }
+
+    void merge(const glm::fvec3& point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void merge(const AxisAlignedBox& box)
+    {
+        min = glm::min(min, box.min);
+        max = glm::max(max, box.max);
+    }
+
+    // Half of the surface area, which is all the SAH needs.
+    float getHalfArea() const
+    {
+        if (!isValid())
+            return 0.0f;
+        const glm::fvec3 e = getExtent();
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+struct BoundingSphere
+{
+    glm::fvec3 center = glm::fvec3(0.0f);
+    float      radius = 0.0f;
+};
+
+struct Ray
+{
+    glm::fvec3 origin = glm::fvec3(0.0f);
+    glm::fvec3 direction = glm::fvec3(0.0f, 0.0f, -1.0f);
+};
+
+// Planes are stored as (normal, d) with the normal pointing inside.
+struct Frustum
+{
+    std::array<glm::fvec4, 6> planes;
+};
+
+namespace BoundingVolumes
+{
+    AxisAlignedBox transformBox(const AxisAlignedBox& box, const glm::mat4& matrix);
+
+    Frustum extractFrustum(const glm::mat4& viewProj);
+
+    bool intersectsFrustum(const Frustum& frustum, const AxisAlignedBox& box);
+    bool intersectsSphere(const BoundingSphere& sphere, const AxisAlignedBox& box);
+    bool intersectsRay(const Ray& ray, const glm::fvec3& invDirection, const AxisAlignedBox& box, const float maxT, float& tEnter);
+
+    // Builds a world space ray through the given window position(in pixels).
+    Ray screenPointToRay(const glm::fvec2& cursorPos, const glm::fvec2& windowSize, const glm::mat4& view, const glm::mat4& proj);
+};
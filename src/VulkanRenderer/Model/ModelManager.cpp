@@ -88,6 +88,7 @@ StaticMeshData Model::processMesh(aiMesh* mesh, const aiScene* scene)
 
         //Position
         vertex.pos = { mesh->mVertices[i].x,mesh->mVertices[i].y,mesh->mVertices[i].z };
+        mesh_data.m_boundingBox.merge(vertex.pos);
         if (mesh->mNormals != NULL)
             vertex.normal = glm::normalize(glm::fvec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z));
         else
@@ -203,7 +204,7 @@ void Model::upload(const VkCommandPool& commandPool, const VkQueue& graphicsQueu
             commandPool,
             m_meshData[meshIndex].m_vertex_buffer->m_data,
             m_meshData[meshIndex].m_vertex_buffer->m_size,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             meshInfo->vertexBuffer,
             &meshInfo->vertexAllocation
         );
@@ -215,13 +216,25 @@ void Model::upload(const VkCommandPool& commandPool, const VkQueue& graphicsQueu
             commandPool,
             m_meshData[meshIndex].m_index_buffer->m_data,
             m_meshData[meshIndex].m_index_buffer->m_size,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             meshInfo->indexBuffer,
             &meshInfo->indexAllocation
         );
 
         meshInfo->meshVertexCount = m_meshData[meshIndex].m_meshVertexCount;
         meshInfo->meshIndexCount = m_meshData[meshIndex].m_meshIndexCount;
+        meshInfo->boundingBox = m_meshData[meshIndex].m_boundingBox;
+
+        if (m_type == ModelType::NORMAL_PBR)
+        {
+            const MeshVertex* vertices = (const MeshVertex*)(m_meshData[meshIndex].m_vertex_buffer->m_data);
+            meshInfo->positions.resize(meshInfo->meshVertexCount);
+            for (uint32_t v = 0; v < meshInfo->meshVertexCount; v++)
+                meshInfo->positions[v] = vertices[v].pos;
+
+            const uint32_t* indices = (const uint32_t*)(m_meshData[meshIndex].m_index_buffer->m_data);
+            meshInfo->indices.assign(indices, indices + meshInfo->meshIndexCount);
+        }
 
         m_meshData[meshIndex].m_index_buffer.reset();
         m_meshData[meshIndex].m_vertex_buffer.reset();
@@ -245,6 +258,7 @@ void Model::upload(const VkCommandPool& commandPool, const VkQueue& graphicsQueu
             materialInfo->emissiveTexture = loadTexture(m_materialData[meshIndex].info[2].name, std::string(MODEL_DIR) + m_materialData[meshIndex].info[2].folderName, m_materialData[meshIndex].info[2].format);
             materialInfo->AOTexture = loadTexture(m_materialData[meshIndex].info[3].name, std::string(MODEL_DIR) + m_materialData[meshIndex].info[3].folderName, m_materialData[meshIndex].info[3].format);
             materialInfo->normalTexture = loadTexture(m_materialData[meshIndex].info[4].name, std::string(MODEL_DIR) + m_materialData[meshIndex].info[4].folderName, m_materialData[meshIndex].info[4].format);
+            materialInfo->hasNormalMap = (m_materialData[meshIndex].info[4].folderName != "/defaultTextures");
 
             m_materialData[meshIndex].info.clear();
             m_materialData[meshIndex].info.shrink_to_fit();
@@ -78,7 +78,7 @@ public:
 	void setSize(const glm::fvec3& newSize) { m_size = newSize; };
 	void setHideStatus(const bool status) { m_hideStatus = status; };
 
-	const glm::mat4& getModelMatrix() const { return MathUtils::getUpdatedModelMatrix(m_pos, m_rot, m_size); }
+	glm::mat4 getModelMatrix() const { return MathUtils::getUpdatedModelMatrix(m_pos, m_rot, m_size); }
 
 private:
 	void loadModel(const char* pathToModel);
@@ -0,0 +1,121 @@
+#include "VulkanRenderer/Pipeline/PipelineCache.h"
+
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "VulkanRenderer/Renderer.h"
+
+void PipelineCache::init(const std::string& filePath)
+{
+    m_filePath = filePath;
+
+    std::vector<char> data;
+
+    std::ifstream file(m_filePath, std::ios::ate | std::ios::binary);
+    if (file.is_open())
+    {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), data.size());
+        file.close();
+    }
+
+    m_isWarm = isDataValid(data);
+    if (!m_isWarm)
+        data.clear();
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(getRendererPointer()->getDevice(), &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create pipeline cache!");
+
+    std::cout << "Pipeline cache: " << (m_isWarm ? "loaded " + std::to_string(data.size()) + " bytes" : "empty") << std::endl;
+}
+
+bool PipelineCache::isDataValid(const std::vector<char>& data) const
+{
+    if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+        return false;
+
+    VkPipelineCacheHeaderVersionOne header;
+    memcpy(&header, data.data(), sizeof(header));
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(getRendererPointer()->getPhysicalDevice(), &properties);
+
+    // A driver update changes the UUID: the old pipelines are useless.
+    return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+        header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+        header.vendorID == properties.vendorID &&
+        header.deviceID == properties.deviceID &&
+        memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+VkResult PipelineCache::createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& pipelineInfo, VkPipeline* pipeline, const std::string& name)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    VkResult status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), m_pipelineCache, 1, &pipelineInfo, nullptr, pipeline);
+
+    logCreation(name, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+    return status;
+}
+
+VkResult PipelineCache::createComputePipeline(const VkComputePipelineCreateInfo& pipelineInfo, VkPipeline* pipeline, const std::string& name)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    VkResult status = vkCreateComputePipelines(getRendererPointer()->getDevice(), m_pipelineCache, 1, &pipelineInfo, nullptr, pipeline);
+
+    logCreation(name, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+    return status;
+}
+
+void PipelineCache::logCreation(const std::string& name, const double milliseconds)
+{
+    std::lock_guard<std::mutex> lock(m_logMutex);
+
+    m_pipelineCount++;
+    m_creationTime += milliseconds;
+
+    std::cout << "Pipeline " << name << ": " << milliseconds << " ms" << std::endl;
+}
+
+void PipelineCache::save()
+{
+    size_t size = 0;
+    if (vkGetPipelineCacheData(getRendererPointer()->getDevice(), m_pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0)
+        return;
+
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(getRendererPointer()->getDevice(), m_pipelineCache, &size, data.data()) != VK_SUCCESS)
+        return;
+
+    // Not being able to write the cache only costs the next start up.
+    std::ofstream file(m_filePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to write pipeline cache: " << m_filePath << std::endl;
+        return;
+    }
+
+    file.write(data.data(), size);
+    file.close();
+
+    std::cout << "Pipeline cache: " << m_pipelineCount << " pipelines created in " << m_creationTime << " ms, saved " << size << " bytes" << std::endl;
+}
+
+void PipelineCache::destroy()
+{
+    vkDestroyPipelineCache(getRendererPointer()->getDevice(), m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
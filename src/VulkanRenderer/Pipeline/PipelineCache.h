@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+/*
+ * Process wide VkPipelineCache, persisted between runs:
+ *  - init() loads the file written by the last run. Its header(vendor ID,
+ *    device ID and pipelineCacheUUID) is checked against the current device:
+ *    data from another device or driver is discarded and the cache starts empty.
+ *  - Pipelines are created through createGraphicsPipeline()/createComputePipeline(),
+ *    which use the cache and log how long each creation took. They can be
+ *    called from several threads(the cache is internally synchronized).
+ *  - save() writes the cache back, before the device is destroyed.
+ */
+class PipelineCache
+{
+public:
+    PipelineCache() {};
+    ~PipelineCache() {};
+
+    void init(const std::string& filePath);
+
+    VkResult createGraphicsPipeline(const VkGraphicsPipelineCreateInfo& pipelineInfo, VkPipeline* pipeline, const std::string& name);
+    VkResult createComputePipeline(const VkComputePipelineCreateInfo& pipelineInfo, VkPipeline* pipeline, const std::string& name);
+
+    void save();
+    void destroy();
+
+    const VkPipelineCache& get() const          { return m_pipelineCache; }
+    // Whether valid data from a previous run was loaded(warm start).
+    const bool& isWarm() const                  { return m_isWarm; }
+    const uint32_t& getPipelineCount() const    { return m_pipelineCount; }
+    // Milliseconds spent creating pipelines.
+    const double& getCreationTime() const       { return m_creationTime; }
+
+private:
+    bool isDataValid(const std::vector<char>& data) const;
+    void logCreation(const std::string& name, const double milliseconds);
+
+    std::string         m_filePath;
+    VkPipelineCache     m_pipelineCache = VK_NULL_HANDLE;
+    bool                m_isWarm = false;
+
+    std::mutex          m_logMutex;
+    uint32_t            m_pipelineCount = 0;
+    double              m_creationTime = 0.0;
+};
@@ -0,0 +1,183 @@
+#include "VulkanRenderer/Pipeline/PipelineCompiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+#include "VulkanRenderer/Shader/ShaderManager.h"
+#include "VulkanRenderer/Thread/ThreadPool.h"
+#include "VulkanRenderer/Renderer.h"
+
+namespace
+{
+    std::string getShaderKey(const ShaderInfo& shaderInfo)
+    {
+        return std::to_string(shaderInfo.type) + "-" + shaderInfo.fileName;
+    }
+}
+
+void PipelineCompiler::add(const GraphicsPipelineDesc& desc, VkPipeline* pipeline)
+{
+    m_graphicsPipelines.push_back({ desc, pipeline });
+}
+
+void PipelineCompiler::add(const ComputePipelineDesc& desc, VkPipeline* pipeline)
+{
+    m_computePipelines.push_back({ desc, pipeline });
+}
+
+void PipelineCompiler::loadShaderModules()
+{
+    std::vector<const ShaderInfo*> shaderInfos;
+    for (const auto& pipeline : m_graphicsPipelines)
+        for (const ShaderInfo& shaderInfo : pipeline.first.shaders)
+            shaderInfos.push_back(&shaderInfo);
+
+    for (const auto& pipeline : m_computePipelines)
+        shaderInfos.push_back(&pipeline.first.shader);
+
+    for (const ShaderInfo* shaderInfo : shaderInfos)
+    {
+        const std::string key = getShaderKey(*shaderInfo);
+        if (m_shaderModules.find(key) != m_shaderModules.end())
+            continue;
+
+        PipelineManager::createShaderModule(*shaderInfo, m_shaderModules[key]);
+    }
+}
+
+VkResult PipelineCompiler::createGraphicsPipeline(const GraphicsPipelineDesc& desc, VkPipeline* pipeline)
+{
+    // Specialization constants(uint32 each)
+    std::vector<VkSpecializationMapEntry> mapEntries;
+    std::vector<uint32_t> specializationData;
+    for (const auto& constant : desc.specializationConstants)
+    {
+        mapEntries.push_back({ constant.first, static_cast<uint32_t>(specializationData.size() * sizeof(uint32_t)), sizeof(uint32_t) });
+        specializationData.push_back(constant.second);
+    }
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+    specializationInfo.pMapEntries = mapEntries.data();
+    specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+    specializationInfo.pData = specializationData.data();
+
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(desc.shaders.size());
+    for (uint32_t i = 0; i < desc.shaders.size(); i++)
+    {
+        PipelineManager::createShaderStageInfo(m_shaderModules.at(getShaderKey(desc.shaders[i])), desc.shaders[i].type, shaderStagesInfos[i]);
+        shaderStagesInfos[i].pSpecializationInfo = mapEntries.empty() ? nullptr : &specializationInfo;
+    }
+
+    // Dynamic states
+    VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(desc.dynamicStates.data(), static_cast<uint32_t>(desc.dynamicStates.size()));
+    // Viewport state info
+    VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
+    // Vertex input(attributes)
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    if (!desc.vertexAttributes.empty())
+        PipelineManager::createVertexShaderInputInfo(desc.vertexBinding, desc.vertexAttributes, vertexInputInfo);
+    // Input assembly
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(desc.topology, 0, VK_FALSE);
+    // Rasterizer
+    VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(desc.polygonMode, desc.cullMode, desc.frontFace, 0, desc.depthBiasEnable);
+    // Multisampling
+    VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(desc.sampleCount, 0);
+    // Color blending
+    std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates(desc.colorAttachmentCount, PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE));
+    VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(desc.colorAttachmentCount, blendAttachmentStates.data());
+    // Depth and stencil
+    VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(desc.depthTestEnable, desc.depthWriteEnable, desc.depthCompareOp);
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shaderStagesInfos.size());
+    pipelineInfo.pStages = shaderStagesInfos.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssemblyState;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizationState;
+    pipelineInfo.pMultisampleState = &multisampleState;
+    pipelineInfo.pDepthStencilState = &depthStencilState;
+    pipelineInfo.pColorBlendState = &colorBlendState;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.pTessellationState = nullptr;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    return getRendererPointer()->getPipelineCache().createGraphicsPipeline(pipelineInfo, pipeline, desc.name);
+}
+
+VkResult PipelineCompiler::createComputePipeline(const ComputePipelineDesc& desc, VkPipeline* pipeline)
+{
+    VkPipelineShaderStageCreateInfo shaderStageInfo{};
+    PipelineManager::createShaderStageInfo(m_shaderModules.at(getShaderKey(desc.shader)), desc.shader.type, shaderStageInfo);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStageInfo;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.basePipelineHandle = 0;
+    pipelineInfo.basePipelineIndex = 0;
+
+    return getRendererPointer()->getPipelineCache().createComputePipeline(pipelineInfo, pipeline, desc.name);
+}
+
+void PipelineCompiler::compile()
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    const size_t pipelineCount = m_graphicsPipelines.size() + m_computePipelines.size();
+    if (pipelineCount == 0)
+        return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    loadShaderModules();
+
+    // Exceptions can't leave the workers: results are checked once they are done.
+    std::vector<VkResult> results(pipelineCount, VK_SUCCESS);
+    {
+        ThreadPool threadPool(static_cast<uint32_t>(std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), pipelineCount)));
+
+        for (size_t i = 0; i < m_graphicsPipelines.size(); ++i)
+            threadPool.submit([this, i, &results]() {
+                results[i] = createGraphicsPipeline(m_graphicsPipelines[i].first, m_graphicsPipelines[i].second);
+            });
+
+        for (size_t i = 0; i < m_computePipelines.size(); ++i)
+            threadPool.submit([this, i, &results]() {
+                results[m_graphicsPipelines.size() + i] = createComputePipeline(m_computePipelines[i].first, m_computePipelines[i].second);
+            });
+
+        threadPool.wait();
+    }
+
+    for (auto& shaderModule : m_shaderModules)
+        ShaderManager::destroyShaderModule(shaderModule.second);
+
+    m_shaderModules.clear();
+    m_graphicsPipelines.clear();
+    m_computePipelines.clear();
+
+    m_compileTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Pipelines: " << pipelineCount << " compiled in " << m_compileTime << " ms" << std::endl;
+
+    for (const VkResult result : results)
+        if (result != VK_SUCCESS)
+            throw std::runtime_error("Failed to create pipeline!");
+}
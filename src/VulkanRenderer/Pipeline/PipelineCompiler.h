@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanRenderer/Pipeline/PipelineManager.h"
+
+// Everything needed to build a graphics pipeline, owned(no pointers to the caller's stack).
+struct GraphicsPipelineDesc
+{
+    std::string                                     name;
+    std::vector<ShaderInfo>                         shaders;
+
+    // No attributes: no vertex input(full screen passes).
+    VkVertexInputBindingDescription                 vertexBinding{};
+    std::vector<VkVertexInputAttributeDescription>  vertexAttributes;
+
+    VkPipelineLayout                                layout = VK_NULL_HANDLE;
+    VkRenderPass                                    renderPass = VK_NULL_HANDLE;
+    uint32_t                                        subpass = 0;
+
+    VkPrimitiveTopology                             topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode                                   polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags                                 cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace                                     frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    VkBool32                                        depthBiasEnable = VK_FALSE;
+
+    VkSampleCountFlagBits                           sampleCount = VK_SAMPLE_COUNT_1_BIT;
+
+    VkBool32                                        depthTestEnable = VK_TRUE;
+    VkBool32                                        depthWriteEnable = VK_TRUE;
+    VkCompareOp                                     depthCompareOp = VK_COMPARE_OP_LESS;
+
+    // Written with 0xf, no blending.
+    uint32_t                                        colorAttachmentCount = 1;
+
+    std::vector<VkDynamicState>                     dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+    // (constant_id, value) given to every stage, a stage ignores the IDs it doesn't declare.
+    std::vector<std::pair<uint32_t, uint32_t>>      specializationConstants;
+};
+
+struct ComputePipelineDesc
+{
+    std::string                                     name;
+    ShaderInfo                                      shader{ shaderType::COMPUTE, "" };
+    VkPipelineLayout                                layout = VK_NULL_HANDLE;
+};
+
+/*
+ * Builds the pipelines of the passes in one go, in parallel:
+ *  - Passes describe their pipelines with add() while they are constructed,
+ *    the target VkPipeline is written by compile(), so it must stay at the
+ *    same address until then and not be used before.
+ *  - compile() loads each shader once(a shader used by several pipelines is
+ *    read and turned into a module a single time), creates every pipeline on
+ *    worker threads through the PipelineCache and frees the modules.
+ * Passes that use their pipeline right away(IBL precomputations) keep
+ * creating it directly.
+ */
+class PipelineCompiler
+{
+public:
+    PipelineCompiler() {};
+    ~PipelineCompiler() {};
+
+    void add(const GraphicsPipelineDesc& desc, VkPipeline* pipeline);
+    void add(const ComputePipelineDesc& desc, VkPipeline* pipeline);
+
+    // Throws if a pipeline fails, once all of them are done.
+    void compile();
+
+    // Milliseconds spent by the last compile().
+    const double& getCompileTime() const { return m_compileTime; }
+
+private:
+    void loadShaderModules();
+    VkResult createGraphicsPipeline(const GraphicsPipelineDesc& desc, VkPipeline* pipeline);
+    VkResult createComputePipeline(const ComputePipelineDesc& desc, VkPipeline* pipeline);
+
+    std::vector<std::pair<GraphicsPipelineDesc, VkPipeline*>>   m_graphicsPipelines;
+    std::vector<std::pair<ComputePipelineDesc, VkPipeline*>>    m_computePipelines;
+
+    // "vert-name" -> module, only during compile().
+    std::map<std::string, VkShaderModule>                       m_shaderModules;
+
+    double                                                      m_compileTime = 0.0;
+};
@@ -0,0 +1,74 @@
+#include "VulkanRenderer/Pipeline/ShaderVariants.h"
+
+#include <tuple>
+
+#include "VulkanRenderer/Renderer.h"
+
+bool ShaderVariantKey::operator<(const ShaderVariantKey& other) const
+{
+    return std::tie(shCoefNum, pcfRange, hasNormalMap, sampleCount) <
+        std::tie(other.shCoefNum, other.pcfRange, other.hasNormalMap, other.sampleCount);
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> ShaderVariantKey::getSpecializationConstants() const
+{
+    return {
+        { SpecializationConstantID::SH_COEF_NUM, shCoefNum },
+        { SpecializationConstantID::PCF_RANGE, pcfRange },
+        { SpecializationConstantID::HAS_NORMAL_MAP, hasNormalMap }
+    };
+}
+
+std::string ShaderVariantKey::getName() const
+{
+    return "SH" + std::to_string(shCoefNum) +
+        " PCF" + std::to_string(pcfRange) +
+        " N" + std::to_string(hasNormalMap) +
+        " S" + std::to_string(sampleCount);
+}
+
+void PipelineVariants::init(const GraphicsPipelineDesc& desc)
+{
+    m_desc = desc;
+}
+
+GraphicsPipelineDesc PipelineVariants::getDesc(const ShaderVariantKey& key) const
+{
+    GraphicsPipelineDesc desc = m_desc;
+    desc.name = m_desc.name + " (" + key.getName() + ")";
+    desc.sampleCount = key.sampleCount;
+    desc.specializationConstants = key.getSpecializationConstants();
+
+    return desc;
+}
+
+void PipelineVariants::prepare(const ShaderVariantKey& key)
+{
+    if (m_pipelines.find(key) != m_pipelines.end())
+        return;
+
+    getRendererPointer()->getPipelineCompiler().add(getDesc(key), &(m_pipelines[key] = VK_NULL_HANDLE));
+}
+
+const VkPipeline& PipelineVariants::get(const ShaderVariantKey& key)
+{
+    auto iter = m_pipelines.find(key);
+    if (iter != m_pipelines.end())
+        return iter->second;
+
+    VkPipeline& pipeline = (m_pipelines[key] = VK_NULL_HANDLE);
+
+    PipelineCompiler compiler;
+    compiler.add(getDesc(key), &pipeline);
+    compiler.compile();
+
+    return pipeline;
+}
+
+void PipelineVariants::destroy()
+{
+    for (auto& pipeline : m_pipelines)
+        vkDestroyPipeline(getRendererPointer()->getDevice(), pipeline.second, nullptr);
+
+    m_pipelines.clear();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanRenderer/Settings/config.h"
+#include "VulkanRenderer/Pipeline/PipelineCompiler.h"
+
+// constant_id of the specialization constants declared by the shaders.
+namespace SpecializationConstantID
+{
+    enum : uint32_t
+    {
+        SH_COEF_NUM     = 1,
+        PCF_RANGE       = 2,
+        HAS_NORMAL_MAP  = 3
+    };
+}
+
+// What makes two pipelines of a pass differ: the specialization constants
+// and the sample count(MSAA is pipeline state, not a shader constant).
+struct ShaderVariantKey
+{
+    uint32_t                shCoefNum = Config::SH_COEF_NUM;
+    uint32_t                pcfRange = Config::PCF_RANGE;
+    uint32_t                hasNormalMap = 1;
+    VkSampleCountFlagBits   sampleCount = VK_SAMPLE_COUNT_1_BIT;
+
+    bool operator<(const ShaderVariantKey& other) const;
+
+    std::vector<std::pair<uint32_t, uint32_t>> getSpecializationConstants() const;
+    // "SH25 PCF1 N1 S4"
+    std::string getName() const;
+};
+
+/*
+ * Pipelines of one pass, one per variant key, built from a single description:
+ *  - prepare() queues a variant in the renderer's PipelineCompiler, it is
+ *    created with the other startup pipelines.
+ *  - get() returns a variant, creating it on the spot(through the pipeline
+ *    cache) the first time a key that wasn't prepared is asked for.
+ */
+class PipelineVariants
+{
+public:
+    PipelineVariants() {};
+    ~PipelineVariants() {};
+
+    // desc.sampleCount and desc.specializationConstants are set per variant.
+    void init(const GraphicsPipelineDesc& desc);
+
+    void prepare(const ShaderVariantKey& key);
+    const VkPipeline& get(const ShaderVariantKey& key);
+
+    void destroy();
+
+    size_t getCount() const { return m_pipelines.size(); }
+
+private:
+    GraphicsPipelineDesc getDesc(const ShaderVariantKey& key) const;
+
+    GraphicsPipelineDesc                    m_desc;
+
+    // Nodes don't move: compile() can write the pipelines queued by prepare().
+    std::map<ShaderVariantKey, VkPipeline>  m_pipelines;
+};
@@ -11,6 +11,8 @@
 
 #include <glm/glm.hpp>
 
+#include "VulkanRenderer/Math/BoundingVolumes.h"
+
 template<typename T>
 inline void hash_combine(std::uint32_t& seed, const T& v)
 {
@@ -114,6 +116,9 @@ struct StaticMeshData
 
     uint32_t            m_meshVertexCount;
     uint32_t            m_meshIndexCount;
+
+    // Object space bounds of the vertices.
+    AxisAlignedBox      m_boundingBox;
 };
 
 struct MeshVertex
@@ -152,14 +157,10 @@ struct SwapChainDesc
 
 struct DepthImageDesc
 {
-    VkImage*        depth_image = VK_NULL_HANDLE;
-    VkImageView*    depth_image_view = VK_NULL_HANDLE;
     VkFormat        depth_image_format;
 };
 
 struct MSAADesc
 {
-    VkImage*                msaa_image = VK_NULL_HANDLE;
-    VkImageView*            msaa_image_view = VK_NULL_HANDLE;
     VkSampleCountFlagBits   msaa_sampleCount;
 };
\ No newline at end of file
@@ -0,0 +1,634 @@
+#include "VulkanRenderer/RenderGraph/RenderGraph.h"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "VulkanRenderer/Renderer.h"
+
+namespace
+{
+    struct AccessInfo
+    {
+        VkPipelineStageFlags    stage;
+        VkAccessFlags           readAccess;
+        VkAccessFlags           writeAccess;
+        VkImageLayout           layout;
+        VkImageUsageFlags       usage;
+        bool                    isAttachment;
+        const char*             name;
+    };
+
+    const AccessInfo& getAccessInfo(const RenderGraphAccess access)
+    {
+        static const AccessInfo ACCESS_INFOS[] = {
+            // COLOR_ATTACHMENT
+            { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+              VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true, "color attachment" },
+            // DEPTH_ATTACHMENT
+            { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true, "depth attachment" },
+            // INPUT_ATTACHMENT
+            { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT, 0,
+              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT, true, "input attachment" },
+            // SAMPLED
+            { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0,
+              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false, "sampled" },
+            // COMPUTE_SAMPLED
+            { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0,
+              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false, "compute sampled" },
+            // STORAGE
+            { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+              VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false, "storage" },
+            // TRANSFER_SRC
+            { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0,
+              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false, "transfer src" },
+            // TRANSFER_DST
+            { VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, false, "transfer dst" },
+        };
+
+        return ACCESS_INFOS[static_cast<uint32_t>(access)];
+    }
+
+    const char* getLayoutName(const VkImageLayout layout)
+    {
+        switch (layout)
+        {
+        case VK_IMAGE_LAYOUT_UNDEFINED:                         return "UNDEFINED";
+        case VK_IMAGE_LAYOUT_GENERAL:                           return "GENERAL";
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:          return "COLOR_ATTACHMENT";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:  return "DEPTH_STENCIL_ATTACHMENT";
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:   return "DEPTH_STENCIL_READ_ONLY";
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:          return "SHADER_READ_ONLY";
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:              return "TRANSFER_SRC";
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:              return "TRANSFER_DST";
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:                   return "PRESENT_SRC";
+        default:                                                return "OTHER";
+        }
+    }
+
+    bool hasStencil(const VkFormat format)
+    {
+        return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT;
+    }
+
+    // Where an image was left: what the next access has to wait for.
+    struct ImageState
+    {
+        VkImageLayout           layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags    stage = 0;
+        VkAccessFlags           writeAccess = 0;
+        bool                    isUsed = false;
+    };
+}
+
+//---------------------------------- PassBuilder ----------------------------------
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph* graph, const uint32_t passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+void RenderGraph::PassBuilder::read(const Resource resource, const RenderGraphAccess access)
+{
+    m_graph->m_passes[m_passIndex].accesses.push_back({ resource, access, false, VK_IMAGE_LAYOUT_UNDEFINED });
+}
+
+void RenderGraph::PassBuilder::write(const Resource resource, const RenderGraphAccess access, const VkImageLayout layoutAfter)
+{
+    m_graph->m_passes[m_passIndex].accesses.push_back({ resource, access, true, layoutAfter });
+}
+
+void RenderGraph::PassBuilder::setSideEffect()
+{
+    m_graph->m_passes[m_passIndex].hasSideEffect = true;
+}
+
+//---------------------------------- Declaration ----------------------------------
+
+RenderGraph::Resource RenderGraph::createImage(const std::string& name, const RenderGraphImageDesc& desc)
+{
+    ImageResource image;
+    image.name = name;
+    image.desc = desc;
+
+    m_images.push_back(image);
+    return static_cast<Resource>(m_images.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::importImage(
+    const std::string& name,
+    const VkImageAspectFlags aspect,
+    const VkImageLayout initialLayout,
+    const VkImageLayout finalLayout,
+    const VkPipelineStageFlags initialStage
+) {
+    ImageResource image;
+    image.name = name;
+    image.isImported = true;
+    image.desc.aspect = aspect;
+    image.initialLayout = initialLayout;
+    image.finalLayout = finalLayout;
+    image.initialStage = initialStage;
+
+    m_images.push_back(image);
+    return static_cast<Resource>(m_images.size() - 1);
+}
+
+void RenderGraph::setImportedImage(const Resource resource, const VkImage image, const VkImageView imageView)
+{
+    m_images[resource].image = image;
+    m_images[resource].imageView = imageView;
+}
+
+void RenderGraph::setImageDesc(const Resource resource, const RenderGraphImageDesc& desc)
+{
+    m_images[resource].desc = desc;
+}
+
+void RenderGraph::resize(const VkExtent2D& extent)
+{
+    for (ImageResource& image : m_images)
+    {
+        if (!image.isImported)
+            image.desc.extent = extent;
+    }
+}
+
+void RenderGraph::addPass(const std::string& name, const std::function<void(PassBuilder& builder)>& setup, const ExecuteFunc& execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = execute;
+    m_passes.push_back(pass);
+
+    PassBuilder builder(this, static_cast<uint32_t>(m_passes.size() - 1));
+    setup(builder);
+}
+
+const VkImage& RenderGraph::getImage(const Resource resource) const
+{
+    return m_images[resource].image;
+}
+
+const VkImageView& RenderGraph::getImageView(const Resource resource) const
+{
+    return m_images[resource].imageView;
+}
+
+uint32_t RenderGraph::getCulledPassCount() const
+{
+    return static_cast<uint32_t>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.isCulled; }));
+}
+
+//----------------------------------- Compile -------------------------------------
+
+void RenderGraph::compile()
+{
+    cullPasses();
+    computeLifetimes();
+    createTransientImages();
+    computeBarriers();
+}
+
+void RenderGraph::cullPasses()
+{
+    // Walked backwards: a pass is needed when it writes an imported image or
+    // something a needed pass uses.
+    std::vector<bool> isNeeded(m_images.size(), false);
+
+    for (int32_t i = static_cast<int32_t>(m_passes.size()) - 1; i >= 0; --i)
+    {
+        Pass& pass = m_passes[i];
+
+        bool isLive = pass.hasSideEffect;
+        for (const Access& access : pass.accesses)
+            if (access.isWrite && (m_images[access.resource].isImported || isNeeded[access.resource]))
+                isLive = true;
+
+        pass.isCulled = !isLive;
+        if (pass.isCulled)
+            continue;
+
+        // Writes too: an earlier writer may provide what this one loads.
+        for (const Access& access : pass.accesses)
+            isNeeded[access.resource] = true;
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (ImageResource& image : m_images)
+    {
+        image.usage = 0;
+        image.firstPass = UINT32_MAX;
+        image.lastPass = 0;
+    }
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (m_passes[i].isCulled)
+            continue;
+
+        for (const Access& access : m_passes[i].accesses)
+        {
+            ImageResource& image = m_images[access.resource];
+            image.usage |= getAccessInfo(access.access).usage;
+            image.firstPass = std::min(image.firstPass, i);
+            image.lastPass = std::max(image.lastPass, i);
+        }
+    }
+
+    // Attachments that don't outlive their pass never need to reach memory.
+    for (ImageResource& image : m_images)
+    {
+        const VkImageUsageFlags attachmentUsages = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+        if (!image.isImported && image.firstPass == image.lastPass && (image.usage & ~attachmentUsages) == 0)
+            image.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+    }
+}
+
+void RenderGraph::createTransientImages()
+{
+    const VkDevice& device = getRendererPointer()->getDevice();
+
+    std::vector<Resource> transients;
+    std::vector<VkMemoryRequirements> requirements(m_images.size());
+
+    for (Resource i = 0; i < m_images.size(); ++i)
+    {
+        ImageResource& image = m_images[i];
+        if (image.isImported || image.firstPass == UINT32_MAX)
+            continue;
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { image.desc.extent.width, image.desc.extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = image.desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = image.usage;
+        imageInfo.samples = image.desc.sampleCount;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &image.image) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create render graph image!");
+
+        vkGetImageMemoryRequirements(device, image.image, &requirements[i]);
+        transients.push_back(i);
+    }
+
+    // Biggest first: the smaller images fit in the blocks they leave.
+    std::sort(transients.begin(), transients.end(), [&](const Resource a, const Resource b) { return requirements[a].size > requirements[b].size; });
+
+    m_unaliasedMemorySize = 0;
+    for (const Resource i : transients)
+    {
+        ImageResource& image = m_images[i];
+        const bool isLazy = (image.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+
+        m_unaliasedMemorySize += requirements[i].size;
+
+        for (uint32_t blockIndex = 0; blockIndex < m_memoryBlocks.size() && image.memoryBlock < 0; ++blockIndex)
+        {
+            MemoryBlock& block = m_memoryBlocks[blockIndex];
+
+            const ImageResource& first = m_images[block.images[0]];
+            if (((first.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0) != isLazy)
+                continue;
+            if ((block.requirements.memoryTypeBits & requirements[i].memoryTypeBits) == 0)
+                continue;
+
+            const bool overlaps = std::any_of(block.images.begin(), block.images.end(), [&](const Resource other) {
+                return m_images[other].firstPass <= image.lastPass && image.firstPass <= m_images[other].lastPass;
+            });
+            if (overlaps)
+                continue;
+
+            block.requirements.size = std::max(block.requirements.size, requirements[i].size);
+            block.requirements.alignment = std::max(block.requirements.alignment, requirements[i].alignment);
+            block.requirements.memoryTypeBits &= requirements[i].memoryTypeBits;
+            block.images.push_back(i);
+            image.memoryBlock = static_cast<int32_t>(blockIndex);
+        }
+
+        if (image.memoryBlock < 0)
+        {
+            MemoryBlock block;
+            block.requirements = requirements[i];
+            block.images.push_back(i);
+            m_memoryBlocks.push_back(block);
+            image.memoryBlock = static_cast<int32_t>(m_memoryBlocks.size() - 1);
+        }
+    }
+
+    m_transientMemorySize = 0;
+    for (MemoryBlock& block : m_memoryBlocks)
+    {
+        const bool isLazy = (m_images[block.images[0]].usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = isLazy ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_GPU_ONLY;
+
+        VkResult status = vmaAllocateMemory(getRendererPointer()->getVmaAllocator(), &block.requirements, &allocInfo, &block.allocation, nullptr);
+        // Desktop GPUs have no lazily allocated memory.
+        if (status != VK_SUCCESS && isLazy)
+        {
+            allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            status = vmaAllocateMemory(getRendererPointer()->getVmaAllocator(), &block.requirements, &allocInfo, &block.allocation, nullptr);
+        }
+        if (status != VK_SUCCESS)
+            throw std::runtime_error("Failed to allocate render graph memory!");
+
+        m_transientMemorySize += block.requirements.size;
+
+        for (const Resource i : block.images)
+        {
+            ImageResource& image = m_images[i];
+
+            if (vmaBindImageMemory(getRendererPointer()->getVmaAllocator(), block.allocation, image.image) != VK_SUCCESS)
+                throw std::runtime_error("Failed to bind render graph image memory!");
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = image.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = image.desc.format;
+            viewInfo.subresourceRange = { image.desc.aspect, 0, 1, 0, 1 };
+
+            if (vkCreateImageView(device, &viewInfo, nullptr, &image.imageView) != VK_SUCCESS)
+                throw std::runtime_error("Failed to create render graph image view!");
+        }
+    }
+}
+
+void RenderGraph::computeBarriers()
+{
+    std::vector<ImageState> states(m_images.size());
+
+    // Imported images start where their owner leaves them. Transient ones are
+    // discarded(UNDEFINED) but still wait for the last use of their memory:
+    // the previous frame, or the image aliased before them.
+    std::vector<ImageState> blockStates(m_memoryBlocks.size());
+    for (uint32_t blockIndex = 0; blockIndex < m_memoryBlocks.size(); ++blockIndex)
+    {
+        Resource last = m_memoryBlocks[blockIndex].images[0];
+        for (const Resource i : m_memoryBlocks[blockIndex].images)
+            if (m_images[i].lastPass > m_images[last].lastPass)
+                last = i;
+
+        for (const Access& access : m_passes[m_images[last].lastPass].accesses)
+        {
+            if (access.resource != last)
+                continue;
+
+            blockStates[blockIndex].stage |= getAccessInfo(access.access).stage;
+            if (access.isWrite)
+                blockStates[blockIndex].writeAccess |= getAccessInfo(access.access).writeAccess;
+        }
+    }
+
+    for (Resource i = 0; i < m_images.size(); ++i)
+    {
+        if (m_images[i].isImported)
+        {
+            states[i].layout = m_images[i].initialLayout;
+            states[i].stage = m_images[i].initialStage;
+        }
+    }
+
+    for (Pass& pass : m_passes)
+    {
+        pass.barriers.clear();
+        if (pass.isCulled)
+            continue;
+
+        // Accesses of the same image in one pass(written then read as an input
+        // attachment in the next subpass) are merged: the layout is the one of
+        // the first access, the render pass handles the rest.
+        std::vector<Resource> resources;
+        for (const Access& access : pass.accesses)
+            if (std::find(resources.begin(), resources.end(), access.resource) == resources.end())
+                resources.push_back(access.resource);
+
+        for (const Resource resource : resources)
+        {
+            ImageResource& image = m_images[resource];
+            ImageState& state = states[resource];
+
+            if (!state.isUsed && !image.isImported && image.memoryBlock >= 0)
+                state = blockStates[image.memoryBlock];
+
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkImageLayout layoutAfter = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags stage = 0;
+            VkAccessFlags readAccess = 0;
+            VkAccessFlags writeAccess = 0;
+
+            for (const Access& access : pass.accesses)
+            {
+                if (access.resource != resource)
+                    continue;
+
+                const AccessInfo& info = getAccessInfo(access.access);
+                if (layout == VK_IMAGE_LAYOUT_UNDEFINED)
+                    layout = info.layout;
+                if (access.isWrite && layoutAfter == VK_IMAGE_LAYOUT_UNDEFINED)
+                    layoutAfter = (access.layoutAfter != VK_IMAGE_LAYOUT_UNDEFINED) ? access.layoutAfter : info.layout;
+
+                stage |= info.stage;
+                readAccess |= info.readAccess;
+                if (access.isWrite)
+                    writeAccess |= info.writeAccess;
+            }
+
+            // Read after read in the same layout needs nothing.
+            if (state.layout != layout || state.writeAccess != 0 || writeAccess != 0)
+            {
+                Barrier barrier;
+                barrier.resource = resource;
+                barrier.oldLayout = image.isImported || state.isUsed ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+                barrier.newLayout = layout;
+                barrier.srcStage = state.stage ? state.stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                barrier.dstStage = stage;
+                barrier.srcAccess = state.writeAccess;
+                barrier.dstAccess = readAccess | writeAccess;
+                pass.barriers.push_back(barrier);
+            }
+
+            state.isUsed = true;
+            state.layout = (layoutAfter != VK_IMAGE_LAYOUT_UNDEFINED) ? layoutAfter : layout;
+            state.stage = stage;
+            state.writeAccess = writeAccess;
+        }
+    }
+
+    m_finalBarriers.clear();
+    for (Resource i = 0; i < m_images.size(); ++i)
+    {
+        const ImageResource& image = m_images[i];
+        if (!image.isImported || image.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || image.finalLayout == states[i].layout)
+            continue;
+
+        Barrier barrier;
+        barrier.resource = i;
+        barrier.oldLayout = states[i].layout;
+        barrier.newLayout = image.finalLayout;
+        barrier.srcStage = states[i].stage ? states[i].stage : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        barrier.dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        barrier.srcAccess = states[i].writeAccess;
+        barrier.dstAccess = 0;
+        m_finalBarriers.push_back(barrier);
+    }
+}
+
+//----------------------------------- Execute -------------------------------------
+
+namespace
+{
+    template<typename Barrier, typename Image>
+    void recordBarriers(VkCommandBuffer& commandBuffer, const std::vector<Barrier>& barriers, const std::vector<Image>& images)
+    {
+        if (barriers.empty())
+            return;
+
+        VkPipelineStageFlags srcStage = 0;
+        VkPipelineStageFlags dstStage = 0;
+        std::vector<VkImageMemoryBarrier> imageBarriers;
+
+        for (const Barrier& barrier : barriers)
+        {
+            const Image& image = images[barrier.resource];
+
+            VkImageMemoryBarrier imageBarrier{};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarrier.oldLayout = barrier.oldLayout;
+            imageBarrier.newLayout = barrier.newLayout;
+            imageBarrier.srcAccessMask = barrier.srcAccess;
+            imageBarrier.dstAccessMask = barrier.dstAccess;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = image.image;
+            imageBarrier.subresourceRange = { image.desc.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+            if ((image.desc.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) && hasStencil(image.desc.format))
+                imageBarrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+
+            imageBarriers.push_back(imageBarrier);
+
+            srcStage |= barrier.srcStage;
+            dstStage |= barrier.dstStage;
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+    }
+}
+
+void RenderGraph::execute(VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame)
+{
+    for (Pass& pass : m_passes)
+    {
+        if (pass.isCulled)
+            continue;
+
+        recordBarriers(commandBuffer, pass.barriers, m_images);
+
+        GPUProfiler::Scope scope(commandBuffer, currentFrame, pass.name);
+        pass.execute(commandBuffer, imageIndex, currentFrame);
+    }
+
+    recordBarriers(commandBuffer, m_finalBarriers, m_images);
+}
+
+void RenderGraph::destroy()
+{
+    for (ImageResource& image : m_images)
+    {
+        if (image.isImported)
+            continue;
+
+        vkDestroyImageView(getRendererPointer()->getDevice(), image.imageView, nullptr);
+        vkDestroyImage(getRendererPointer()->getDevice(), image.image, nullptr);
+        image.imageView = VK_NULL_HANDLE;
+        image.image = VK_NULL_HANDLE;
+        image.memoryBlock = -1;
+    }
+
+    for (MemoryBlock& block : m_memoryBlocks)
+        vmaFreeMemory(getRendererPointer()->getVmaAllocator(), block.allocation);
+
+    m_memoryBlocks.clear();
+    m_transientMemorySize = 0;
+    m_unaliasedMemorySize = 0;
+}
+
+//------------------------------------ Dumps --------------------------------------
+
+std::string RenderGraph::dumpText() const
+{
+    std::ostringstream out;
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        const Pass& pass = m_passes[i];
+        out << "Pass " << i << " \"" << pass.name << "\"" << (pass.isCulled ? " (culled)" : "") << (pass.hasSideEffect ? " (side effect)" : "") << "\n";
+
+        for (const Barrier& barrier : pass.barriers)
+            out << "    barrier " << m_images[barrier.resource].name << ": " << getLayoutName(barrier.oldLayout) << " -> " << getLayoutName(barrier.newLayout) << "\n";
+
+        for (const Access& access : pass.accesses)
+            out << "    " << (access.isWrite ? "write " : "read  ") << m_images[access.resource].name << " (" << getAccessInfo(access.access).name << ")\n";
+    }
+
+    for (const Barrier& barrier : m_finalBarriers)
+        out << "Final barrier " << m_images[barrier.resource].name << ": " << getLayoutName(barrier.oldLayout) << " -> " << getLayoutName(barrier.newLayout) << "\n";
+
+    for (const ImageResource& image : m_images)
+    {
+        out << "Image \"" << image.name << "\"";
+        if (image.isImported)
+            out << " imported";
+        else if (image.firstPass == UINT32_MAX)
+            out << " unused";
+        else
+            out << " " << image.desc.extent.width << "x" << image.desc.extent.height << " x" << image.desc.sampleCount
+                << ", passes " << image.firstPass << "-" << image.lastPass << ", block " << image.memoryBlock
+                << ((image.usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) ? ", transient attachment" : "");
+        out << "\n";
+    }
+
+    out << "Transient memory: " << m_transientMemorySize / (1024 * 1024) << " MB in " << m_memoryBlocks.size() << " blocks("
+        << m_unaliasedMemorySize / (1024 * 1024) << " MB without aliasing)\n";
+
+    return out.str();
+}
+
+std::string RenderGraph::dumpDot() const
+{
+    std::ostringstream out;
+
+    out << "digraph RenderGraph {\n";
+    out << "    rankdir=LR;\n";
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+        out << "    pass" << i << " [label=\"" << m_passes[i].name << "\", shape=box, style=filled, fillcolor=" << (m_passes[i].isCulled ? "gray" : "orange") << "];\n";
+
+    for (uint32_t i = 0; i < m_images.size(); ++i)
+        out << "    image" << i << " [label=\"" << m_images[i].name << "\", shape=ellipse" << (m_images[i].isImported ? ", style=dashed" : "") << "];\n";
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i)
+    {
+        for (const Access& access : m_passes[i].accesses)
+        {
+            if (access.isWrite)
+                out << "    pass" << i << " -> image" << access.resource;
+            else
+                out << "    image" << access.resource << " -> pass" << i;
+            out << " [label=\"" << getAccessInfo(access.access).name << "\"];\n";
+        }
+    }
+
+    out << "}\n";
+    return out.str();
+}
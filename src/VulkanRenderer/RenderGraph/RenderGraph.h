@@ -0,0 +1,193 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+// How a pass uses an image, the graph derives stages, access masks, layouts
+// and usage flags from it.
+enum class RenderGraphAccess
+{
+    COLOR_ATTACHMENT,
+    DEPTH_ATTACHMENT,
+    INPUT_ATTACHMENT,
+    SAMPLED,
+    COMPUTE_SAMPLED,
+    STORAGE,
+    TRANSFER_SRC,
+    TRANSFER_DST
+};
+
+struct RenderGraphImageDesc
+{
+    VkExtent2D              extent{};
+    VkFormat                format = VK_FORMAT_UNDEFINED;
+    VkImageAspectFlags      aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    VkSampleCountFlagBits   sampleCount = VK_SAMPLE_COUNT_1_BIT;
+};
+
+/*
+ * Frame graph of a scene: passes declare the images they read and write,
+ * compile() works out the rest once:
+ *  - Passes that don't contribute to an imported image(swapchain, shadow
+ *    map...) and have no side effects are culled.
+ *  - Transient images are created with the usage flags their accesses need.
+ *    Images whose lifetimes(first to last pass using them) don't overlap
+ *    share memory: each memory block is allocated with VMA once and bound to
+ *    every image aliasing it. Images only used as attachments are transient
+ *    attachments and prefer lazily allocated memory.
+ *  - The barriers(layout transitions, execution and memory dependencies,
+ *    including the ones between aliased images) before each pass.
+ * execute() records the barriers and the passes, each pass in a GPU profiler
+ * scope under its name. Passes that use a render pass
+ * leave their attachments in the layout of the access unless they declare
+ * another one(e.g. PRESENT_SRC for the last pass drawing to the swapchain).
+ */
+class RenderGraph
+{
+public:
+    using Resource = uint32_t;
+    using ExecuteFunc = std::function<void(VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame)>;
+
+    class PassBuilder
+    {
+    public:
+        void read(const Resource resource, const RenderGraphAccess access);
+        // layoutAfter: layout the pass leaves the image in(render pass finalLayout),
+        // VK_IMAGE_LAYOUT_UNDEFINED for the one of the access.
+        void write(const Resource resource, const RenderGraphAccess access, const VkImageLayout layoutAfter = VK_IMAGE_LAYOUT_UNDEFINED);
+        // Never culled(writes buffers or something else the graph doesn't see).
+        void setSideEffect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph* graph, const uint32_t passIndex);
+
+        RenderGraph*    m_graph;
+        uint32_t        m_passIndex;
+    };
+
+    RenderGraph() {};
+    ~RenderGraph() {};
+
+    // Created, aliased and destroyed by the graph.
+    Resource createImage(const std::string& name, const RenderGraphImageDesc& desc);
+    // Owned by someone else. The image is set per frame with setImportedImage()
+    // when it changes(swapchain). finalLayout: layout it's left in after the
+    // frame, VK_IMAGE_LAYOUT_UNDEFINED to leave it as the last pass did.
+    // initialStage: stage the image is available at(the acquire semaphore
+    // wait stage for the swapchain).
+    Resource importImage(
+        const std::string& name,
+        const VkImageAspectFlags aspect,
+        const VkImageLayout initialLayout,
+        const VkImageLayout finalLayout,
+        const VkPipelineStageFlags initialStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
+    );
+    void setImportedImage(const Resource resource, const VkImage image, const VkImageView imageView);
+
+    void addPass(const std::string& name, const std::function<void(PassBuilder& builder)>& setup, const ExecuteFunc& execute);
+
+    void compile();
+    void execute(VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame);
+
+    // Frees the transient images, passes and resources are kept: compile()
+    // can be called again(e.g. after a resize with new descs).
+    void destroy();
+    void setImageDesc(const Resource resource, const RenderGraphImageDesc& desc);
+    // Extent of every transient image(the scenes' all have the swapchain's),
+    // between destroy() and compile().
+    void resize(const VkExtent2D& extent);
+
+    const VkImage& getImage(const Resource resource) const;
+    const VkImageView& getImageView(const Resource resource) const;
+
+    // Bytes of the transient images with and without aliasing.
+    VkDeviceSize getTransientMemorySize() const     { return m_transientMemorySize; }
+    VkDeviceSize getUnaliasedMemorySize() const     { return m_unaliasedMemorySize; }
+    uint32_t getCulledPassCount() const;
+
+    // Passes in order(culled ones marked), their accesses and barriers.
+    std::string dumpText() const;
+    // Graphviz: passes are boxes, images ellipses, edges are reads/writes.
+    std::string dumpDot() const;
+
+private:
+    struct Access
+    {
+        Resource            resource;
+        RenderGraphAccess   access;
+        bool                isWrite;
+        VkImageLayout       layoutAfter;
+    };
+
+    struct Barrier
+    {
+        Resource                resource;
+        VkImageLayout           oldLayout;
+        VkImageLayout           newLayout;
+        VkPipelineStageFlags    srcStage;
+        VkPipelineStageFlags    dstStage;
+        VkAccessFlags           srcAccess;
+        VkAccessFlags           dstAccess;
+    };
+
+    struct Pass
+    {
+        std::string             name;
+        std::vector<Access>     accesses;
+        ExecuteFunc             execute;
+        bool                    hasSideEffect = false;
+        bool                    isCulled = false;
+        std::vector<Barrier>    barriers;
+    };
+
+    struct ImageResource
+    {
+        std::string             name;
+        bool                    isImported = false;
+        RenderGraphImageDesc    desc;
+
+        VkImage                 image = VK_NULL_HANDLE;
+        VkImageView             imageView = VK_NULL_HANDLE;
+
+        // Imported
+        VkImageLayout           initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout           finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags    initialStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+        // Transient, set by compile()
+        VkImageUsageFlags       usage = 0;
+        uint32_t                firstPass = UINT32_MAX;
+        uint32_t                lastPass = 0;
+        int32_t                 memoryBlock = -1;
+    };
+
+    // Memory shared by transient images with disjoint lifetimes.
+    struct MemoryBlock
+    {
+        VkMemoryRequirements    requirements{};
+        std::vector<Resource>   images;
+        VmaAllocation           allocation = VK_NULL_HANDLE;
+    };
+
+    friend class PassBuilder;
+
+    void cullPasses();
+    void computeLifetimes();
+    void createTransientImages();
+    void computeBarriers();
+
+    std::vector<Pass>           m_passes;
+    std::vector<ImageResource>  m_images;
+    std::vector<MemoryBlock>    m_memoryBlocks;
+
+    // Barriers recorded after the last pass(imported images' final layouts).
+    std::vector<Barrier>        m_finalBarriers;
+
+    VkDeviceSize                m_transientMemorySize = 0;
+    VkDeviceSize                m_unaliasedMemorySize = 0;
+};
@@ -0,0 +1,186 @@
+#include "VulkanRenderer/RenderQueue/RenderQueue.h"
+
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace
+{
+    constexpr uint32_t PASS_BITS = 4;
+    constexpr uint32_t PIPELINE_BITS = 8;
+    constexpr uint32_t DEPTH_BITS = 8;
+    constexpr uint32_t MATERIAL_BITS = 24;
+    constexpr uint32_t GEOMETRY_BITS = 20;
+
+    constexpr uint32_t GEOMETRY_SHIFT = 0;
+    constexpr uint32_t MATERIAL_SHIFT = GEOMETRY_SHIFT + GEOMETRY_BITS;
+    constexpr uint32_t DEPTH_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+    constexpr uint32_t PIPELINE_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr uint32_t PASS_SHIFT = PIPELINE_SHIFT + PIPELINE_BITS;
+
+    static_assert(PASS_SHIFT + PASS_BITS == 64, "Sort key fields must fill 64 bits.");
+
+    constexpr uint64_t mask(const uint32_t bits) { return (uint64_t(1) << bits) - 1; }
+}
+
+void RenderQueue::clear()
+{
+    m_items.clear();
+}
+
+uint32_t RenderQueue::getId(std::unordered_map<uint64_t, uint32_t>& ids, const uint64_t handle, const uint32_t bits)
+{
+    auto iter = ids.find(handle);
+    if (iter != ids.end())
+        return iter->second;
+
+    // Ids wrap when a field runs out of bits, which only affects the ordering:
+    // record() compares the real handles.
+    const uint32_t id = static_cast<uint32_t>(ids.size() & mask(bits));
+    ids[handle] = id;
+    return id;
+}
+
+uint64_t RenderQueue::makeKey(
+    const uint32_t pass,
+    const VkPipeline& pipeline,
+    const VkDescriptorSet& material,
+    const VkBuffer& geometry,
+    const float viewDepth,
+    const float farPlane
+) {
+    // log distribution: more buckets close to the camera.
+    const float normalizedDepth = std::log2(1.0f + std::max(viewDepth, 0.0f)) / std::log2(1.0f + farPlane);
+    const uint64_t depthBucket = static_cast<uint64_t>(std::min(normalizedDepth, 1.0f) * mask(DEPTH_BITS));
+
+    return
+        ((uint64_t(pass) & mask(PASS_BITS)) << PASS_SHIFT) |
+        (uint64_t(getId(m_pipelineIds, (uint64_t)pipeline, PIPELINE_BITS)) << PIPELINE_SHIFT) |
+        (depthBucket << DEPTH_SHIFT) |
+        (uint64_t(getId(m_materialIds, (uint64_t)material, MATERIAL_BITS)) << MATERIAL_SHIFT) |
+        (uint64_t(getId(m_geometryIds, (uint64_t)geometry, GEOMETRY_BITS)) << GEOMETRY_SHIFT);
+}
+
+/*
+ * LSD radix sort, 8 bits per pass. Passes where every key has the same digit
+ * are skipped, so with few pipelines/passes it usually needs 4-5 passes.
+ * Stable, so equal keys keep their submission order.
+ */
+void RenderQueue::radixSort(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch)
+{
+    scratch.resize(items.size());
+
+    for (uint32_t shift = 0; shift < 64; shift += 8)
+    {
+        std::array<uint32_t, 256> counts{};
+        for (const DrawItem& item : items)
+            counts[(item.key >> shift) & 0xff]++;
+
+        if (counts[(items.empty() ? 0 : (items[0].key >> shift) & 0xff)] == items.size())
+            continue;
+
+        uint32_t offset = 0;
+        for (uint32_t& count : counts)
+        {
+            const uint32_t current = count;
+            count = offset;
+            offset += current;
+        }
+
+        for (const DrawItem& item : items)
+            scratch[counts[(item.key >> shift) & 0xff]++] = item;
+
+        items.swap(scratch);
+    }
+}
+
+void RenderQueue::sort()
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    radixSort(m_items, m_scratch);
+}
+
+void RenderQueue::record(const VkCommandBuffer& commandBuffer, RenderQueueStats& stats) const
+{
+    record(commandBuffer, 0, static_cast<uint32_t>(m_items.size()), stats);
+}
+
+void RenderQueue::record(const VkCommandBuffer& commandBuffer, const uint32_t begin, const uint32_t end, RenderQueueStats& stats) const
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    VkPipeline currentPipeline = VK_NULL_HANDLE;
+    VkDescriptorSet currentDescriptorSet = VK_NULL_HANDLE;
+    VkDescriptorSet currentMaterialDescriptorSet = VK_NULL_HANDLE;
+    VkBuffer currentVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer currentIndexBuffer = VK_NULL_HANDLE;
+
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const DrawItem& item = m_items[i];
+
+        if (item.pipeline != currentPipeline)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, item.pipeline);
+            currentPipeline = item.pipeline;
+            // Sets bound with another layout may be disturbed.
+            currentDescriptorSet = VK_NULL_HANDLE;
+            currentMaterialDescriptorSet = VK_NULL_HANDLE;
+            stats.bindsIssued++;
+        }
+        else
+            stats.bindsSaved++;
+
+        if (item.descriptorSet != currentDescriptorSet)
+        {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, item.pipelineLayout, 0, 1, &item.descriptorSet, 0, nullptr);
+            currentDescriptorSet = item.descriptorSet;
+            stats.bindsIssued++;
+        }
+        else
+            stats.bindsSaved++;
+
+        if (item.materialDescriptorSet != VK_NULL_HANDLE)
+        {
+            if (item.materialDescriptorSet != currentMaterialDescriptorSet)
+            {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, item.pipelineLayout, 1, 1, &item.materialDescriptorSet, 0, nullptr);
+                currentMaterialDescriptorSet = item.materialDescriptorSet;
+                stats.bindsIssued++;
+            }
+            else
+                stats.bindsSaved++;
+        }
+
+        if (item.vertexBuffer != currentVertexBuffer)
+        {
+            const VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &item.vertexBuffer, &offset);
+            currentVertexBuffer = item.vertexBuffer;
+            stats.bindsIssued++;
+        }
+        else
+            stats.bindsSaved++;
+
+        if (item.indexBuffer != currentIndexBuffer)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, item.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            currentIndexBuffer = item.indexBuffer;
+            stats.bindsIssued++;
+        }
+        else
+            stats.bindsSaved++;
+
+        vkCmdDrawIndexed(commandBuffer, item.indexCount, 1, item.firstIndex, item.vertexOffset, item.firstInstance);
+        stats.draws++;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+struct RenderQueueStats
+{
+    uint32_t    draws = 0;
+    uint32_t    bindsIssued = 0;
+    uint32_t    bindsSaved = 0;
+    // Draws replayed from cached command buffers(not recorded this frame).
+    uint32_t    cachedDraws = 0;
+
+    void reset() { draws = 0; bindsIssued = 0; bindsSaved = 0; cachedDraws = 0; }
+
+    void add(const RenderQueueStats& other)
+    {
+        draws += other.draws;
+        bindsIssued += other.bindsIssued;
+        bindsSaved += other.bindsSaved;
+        cachedDraws += other.cachedDraws;
+    }
+};
+
+struct DrawItem
+{
+    uint64_t            key;
+
+    VkPipeline          pipeline;
+    VkPipelineLayout    pipelineLayout;
+    VkDescriptorSet     descriptorSet;
+    // Set 1: bindless material textures or ScenePassBase::getFrameDescriptorSet()
+    // (VK_NULL_HANDLE when the pipeline has none).
+    VkDescriptorSet     materialDescriptorSet;
+
+    VkBuffer            vertexBuffer;
+    VkBuffer            indexBuffer;
+    uint32_t            indexCount;
+    uint32_t            firstIndex;
+    int32_t             vertexOffset;
+    // Object index for the shaders reading the object buffer.
+    uint32_t            firstInstance;
+};
+
+/*
+ * Per pass list of draws, sorted by a 64 bit key before being recorded:
+ *
+ *   | pass(4) | pipeline(8) | depth(8) | material(24) | geometry(20) |
+ *
+ * Materials(descriptor sets) are per mesh in this renderer(unless bindless),
+ * so a depth bucket placed after them would never reorder anything. It goes
+ * right after the pipeline instead, coarse(log distributed) so that draws
+ * sharing state still end up next to each other inside a bucket. Opaque draws
+ * are therefore roughly front-to-back, which helps early-Z.
+ *
+ * record() only binds what changed since the previous draw.
+ */
+class RenderQueue
+{
+public:
+    RenderQueue() {};
+    ~RenderQueue() {};
+
+    void clear();
+
+    // Handles are turned into small ids, stable for the queue's lifetime.
+    uint64_t makeKey(
+        const uint32_t pass,
+        const VkPipeline& pipeline,
+        const VkDescriptorSet& material,
+        const VkBuffer& geometry,
+        const float viewDepth,
+        const float farPlane
+    );
+
+    void push(const DrawItem& item) { m_items.push_back(item); }
+    void sort();
+    void record(const VkCommandBuffer& commandBuffer, RenderQueueStats& stats) const;
+    // Records the sorted items [begin, end), the command buffer starts with no state bound.
+    void record(const VkCommandBuffer& commandBuffer, const uint32_t begin, const uint32_t end, RenderQueueStats& stats) const;
+
+    const std::vector<DrawItem>& getItems() const { return m_items; }
+
+    static void radixSort(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch);
+
+private:
+    uint32_t getId(std::unordered_map<uint64_t, uint32_t>& ids, const uint64_t handle, const uint32_t bits);
+
+    std::vector<DrawItem>                   m_items;
+    std::vector<DrawItem>                   m_scratch;
+
+    std::unordered_map<uint64_t, uint32_t>  m_pipelineIds;
+    std::unordered_map<uint64_t, uint32_t>  m_materialIds;
+    std::unordered_map<uint64_t, uint32_t>  m_geometryIds;
+};
@@ -2,6 +2,11 @@
 
 #include <thread>
 #include <vector>
+#include <cmath>
+
+#ifdef RELEASE_MODE_ON
+#include <tracy/Tracy.hpp>
+#endif
 
 #include "RenderResource.h"
 #include "VulkanRenderer/Renderer.h"
@@ -83,6 +88,177 @@ void RenderResource::updateIBLResource(Texture brdfLUT, Texture irradiance, Text
 }
 
 
+void RenderResource::loadSHBRDFlut()
+{
+    if (m_SHBRDFlut.image != nullptr)
+        return;
+
+    std::string TextureName = "SH_BRDF_LUT.png";
+    TextureToLoadInfo info = { TextureName,"/defaultTextures",VK_FORMAT_R8G8B8A8_SRGB,4 };
+
+    m_SHBRDFlut = loadTexture(TextureName, std::string(MODEL_DIR) + info.folderName, info.format);
+}
+
+
+AxisAlignedBox RenderResource::getMeshWorldBounds(const uint32_t meshIndex, const glm::mat4& modelMatrix)
+{
+    return BoundingVolumes::transformBox(m_meshInfoMap[meshIndex].ref_mesh->boundingBox, modelMatrix);
+}
+
+/*
+ * Rebuilds the BVH when the set of visible objects changed(or refits degraded
+ * it too much), otherwise only refits the meshes whose transform changed.
+ */
+void RenderResource::updateSceneBVH()
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    bool membershipChanged = false;
+    size_t meshesCount = 0;
+    for (auto& ptr : m_normalModels)
+    {
+        if (ptr->isHidden())
+            continue;
+
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            meshesCount++;
+            if (m_bvhMeshMatrices.find(meshIndex) == m_bvhMeshMatrices.end())
+                membershipChanged = true;
+        }
+    }
+    membershipChanged |= (meshesCount != m_bvhMeshMatrices.size());
+
+    if (membershipChanged || m_sceneBVH.needsRebuild())
+    {
+        m_bvhMeshMatrices.clear();
+        m_bvhMeshOwners.clear();
+
+        std::vector<BVHPrimitive> primitives;
+        primitives.reserve(meshesCount);
+        for (auto& ptr : m_normalModels)
+        {
+            if (ptr->isHidden())
+                continue;
+
+            const glm::mat4 modelMatrix = ptr->getModelMatrix();
+            for (uint32_t meshIndex : ptr->getMeshIndices())
+            {
+                primitives.push_back({ meshIndex, getMeshWorldBounds(meshIndex, modelMatrix) });
+                m_bvhMeshMatrices[meshIndex] = modelMatrix;
+                m_bvhMeshOwners[meshIndex] = ptr;
+            }
+        }
+        m_sceneBVH.build(primitives);
+        return;
+    }
+
+    for (auto& ptr : m_normalModels)
+    {
+        if (ptr->isHidden())
+            continue;
+
+        const glm::mat4 modelMatrix = ptr->getModelMatrix();
+        for (uint32_t meshIndex : ptr->getMeshIndices())
+        {
+            glm::mat4& cachedMatrix = m_bvhMeshMatrices[meshIndex];
+            if (cachedMatrix == modelMatrix)
+                continue;
+
+            cachedMatrix = modelMatrix;
+            m_sceneBVH.updatePrimitive(meshIndex, getMeshWorldBounds(meshIndex, modelMatrix));
+        }
+    }
+    m_sceneBVH.refit();
+}
+
+void RenderResource::cullScene(const glm::mat4& viewProj)
+{
+#ifdef RELEASE_MODE_ON
+    ZoneScoped;
+#endif
+
+    m_visibleMeshIndices.clear();
+    m_visibleMeshes.clear();
+
+    m_isCullingActive = !m_sceneBVH.isEmpty();
+    if (!m_isCullingActive)
+        return;
+
+    m_sceneBVH.queryFrustum(BoundingVolumes::extractFrustum(viewProj), m_visibleMeshIndices);
+    m_visibleMeshes.insert(m_visibleMeshIndices.begin(), m_visibleMeshIndices.end());
+}
+
+void RenderResource::setVisibleMeshIndices(const std::vector<uint32_t>& meshIndices)
+{
+    if (!m_isCullingActive)
+        return;
+
+    m_visibleMeshIndices = meshIndices;
+    m_visibleMeshes.clear();
+    m_visibleMeshes.insert(m_visibleMeshIndices.begin(), m_visibleMeshIndices.end());
+}
+
+bool RenderResource::isMeshVisible(const uint32_t meshIndex) const
+{
+    if (!m_isCullingActive)
+        return true;
+
+    return m_visibleMeshes.find(meshIndex) != m_visibleMeshes.end();
+}
+
+uint32_t RenderResource::getNormalMeshCount() const
+{
+    uint32_t count = 0;
+    for (const auto& model : m_normalModels)
+        count += static_cast<uint32_t>(model->getMeshIndices().size());
+
+    return count;
+}
+
+std::shared_ptr<Model> RenderResource::pickModel(const Ray& ray)
+{
+    uint32_t meshIndex;
+    float t;
+    if (m_sceneBVH.queryRay(ray, meshIndex, t))
+        m_pickedModel = m_bvhMeshOwners[meshIndex];
+    else
+        m_pickedModel = nullptr;
+
+    return m_pickedModel;
+}
+
+/*
+ * Distance at which intensity * attenuation(d) drops below the cutoff, with
+ * attenuation(d) = 1 / (c + l*d + q*d^2).
+ */
+float RenderResource::getLightInfluenceRadius(const LightInfo& light) const
+{
+    const float c = Config::LIGHT_ATTENUATION_CONSTANT;
+    const float l = Config::LIGHT_ATTENUATION_LINEAR;
+    const float q = Config::LIGHT_ATTENUATION_QUADRATIC;
+
+    const float k = light.m_intensity * glm::max(light.m_color.r, glm::max(light.m_color.g, light.m_color.b)) / Config::LIGHT_INFLUENCE_CUTOFF;
+    if (k <= c)
+        return 0.0f;
+
+    return (-l + std::sqrt(l * l + 4.0f * q * (k - c))) / (2.0f * q);
+}
+
+void RenderResource::getMeshesInfluencedByLight(const LightInfo& light, std::vector<uint32_t>& outMeshIndices) const
+{
+    if (light.m_lightType == LightType::DIRECTIONAL_LIGHT)
+    {
+        for (auto& meshOwner : m_bvhMeshOwners)
+            outMeshIndices.push_back(meshOwner.first);
+        return;
+    }
+
+    m_sceneBVH.querySphere({ light.pos, getLightInfluenceRadius(light) }, outMeshIndices);
+}
+
 
 void RenderResource::destroy()
 {
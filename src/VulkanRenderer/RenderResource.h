@@ -6,6 +6,7 @@
 #include <array>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "VulkanRenderer/Model/ModelManager.h"
 
@@ -19,6 +20,7 @@
 #include "VulkanRenderer/Features/PrefilteredEnvMap.h"
 
 #include "VulkanRenderer/Camera/Camera.h"
+#include "VulkanRenderer/Culling/BVH.h"
 
 struct IBLResource
 {
@@ -33,27 +35,6 @@ struct UniformBuffer
     VmaAllocation   uboAllocation;
 };
 
-struct MeshPerframeStorageLight
-{
-    glm::vec4   position;
-    glm::vec4   dir;
-    glm::vec4   color;
-    float       attenuation;
-    float       intensity;
-    int         type;
-};
-
-struct MeshPerframeStorageBufferObject
-{
-    glm::mat4                   proj;
-    glm::mat4                   view;
-    glm::mat4                   lightSpace;
-    glm::vec4                   cameraPos;
-    int                         lightsCount;
-    MeshPerframeStorageLight    sceneLights[10];
-};
-
-
 struct MeshInfo
 {
     VkBuffer*           vertexBuffer = new VkBuffer;
@@ -63,6 +44,13 @@ struct MeshInfo
 
     uint32_t            meshVertexCount;
     uint32_t            meshIndexCount;
+
+    AxisAlignedBox      boundingBox;
+
+    // CPU copy of the triangles(normal models only), the occluders of the
+    // software occlusion culling.
+    std::vector<glm::fvec3> positions;
+    std::vector<uint32_t>   indices;
 };
 
 struct MaterialInfo
@@ -73,7 +61,9 @@ struct MaterialInfo
     Texture emissiveTexture;
     Texture AOTexture;
     Texture normalTexture;
-    
+
+    // False when normalTexture is the default one(no normal mapping needed).
+    bool    hasNormalMap = true;
 };
 
 // nodes
@@ -125,6 +115,22 @@ public:
     void uploadModels(const VkQueue& graphicsQueue, const VkCommandPool& commandPool);
 
     void RenderResource::updateIBLResource(Texture brdfLUT, Texture irradiance, Texture env);
+    // Once, the SH passes of the next scene rebuilds share it.
+    void loadSHBRDFlut();
+
+    // Scene BVH
+    void updateSceneBVH();
+    void cullScene(const glm::mat4& viewProj);
+    bool isMeshVisible(const uint32_t meshIndex) const;
+    const std::vector<uint32_t>& getVisibleMeshIndices() const { return m_visibleMeshIndices; }
+    // Narrows the visible set of the last cullScene()(occlusion culling).
+    void setVisibleMeshIndices(const std::vector<uint32_t>& meshIndices);
+    std::shared_ptr<Model> pickModel(const Ray& ray);
+    float getLightInfluenceRadius(const LightInfo& light) const;
+    void getMeshesInfluencedByLight(const LightInfo& light, std::vector<uint32_t>& outMeshIndices) const;
+
+    // Meshes of m_normalModels(one descriptor set each in the per mesh passes).
+    uint32_t getNormalMeshCount() const;
 
     void destroy();
 
@@ -162,4 +168,19 @@ public:
     //SH
     Texture                     			            m_SHBRDFlut;
     glm::vec3                                           m_coefficient[Config::SH_COEF_NUM];
+
+    // Scene BVH(over the meshes of m_normalModels)
+    BVH                                                 m_sceneBVH;
+    std::shared_ptr<Model>                              m_pickedModel;
+
+private:
+    AxisAlignedBox getMeshWorldBounds(const uint32_t meshIndex, const glm::mat4& modelMatrix);
+
+    // meshIndex -> model matrix used for the last build/refit
+    std::unordered_map<uint32_t, glm::mat4>             m_bvhMeshMatrices;
+    std::unordered_map<uint32_t, std::shared_ptr<Model>> m_bvhMeshOwners;
+
+    std::vector<uint32_t>                               m_visibleMeshIndices;
+    std::unordered_set<uint32_t>                        m_visibleMeshes;
+    bool                                                m_isCullingActive = false;
 };
\ No newline at end of file
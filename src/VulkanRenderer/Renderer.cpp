@@ -9,6 +9,7 @@
 #include <chrono>
 #include <thread>
 #include <array>
+#include <functional>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -76,16 +77,28 @@ void Renderer::run()
     initVulkan();
 
     // -------------------------------Main Pass-----------------------------------
-    //m_scene = std::make_unique<DeferredRenderPass>();
-    //m_scene = std::make_unique<ForwardPBRPass>();
-    m_scene = std::make_unique<SHLightingPass>();
+    // Kept to rebuild the scene(MSAA samples count changes).
+    //m_createScene = []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<DeferredRenderPass>(); };
+    //m_createScene = []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<ForwardPBRPass>(); };
+    m_createScene = []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<SHLightingPass>(); };
+    m_scene = m_createScene();
+    // Its framebuffers and graph images have the swapchain's extent, the rest is kept.
+    registerSwapchainCallback([this]() { m_scene->recreateSwapchainResources(); });
     // ---------------------------------------------------------------------------
 
+    // Pipelines of GPUCulling, ClusteredLights and of the passes.
+    m_pipelineCompiler.compile();
+
     doComputations();
 
     g_RenderResource->m_camera = Camera(glm::fvec3(3.0f, 2.0f, -0.3f), glm::fvec3(0.0f, 0.0f, -1.0f), glm::fvec3(0.0f, 1.0f, 0.0f));
+    g_RenderResource->m_camera.setAspect((double)m_swapchain->getExtent().width / m_swapchain->getExtent().height);
+    g_InputManager->registerMouseButtonCallbackFunc(std::bind(&Renderer::processPicking4MouseButtonCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 
-    mainLoop();
+    if (m_benchmarkFrames > 0)
+        runBenchmark();
+    else
+        mainLoop();
     cleanup();
 }
 
@@ -154,6 +167,8 @@ void Renderer::initVulkan()
 
     createVMAAllocator(m_vkInstance->get(), m_device->getPhysicalDevice(), m_device->getLogicalDevice(), m_vmaAllocator);
 
+    m_pipelineCache.init(PIPELINE_CACHE_FILE);
+
     m_swapchain = std::make_unique<Swapchain>(m_device->getPhysicalDevice(), m_device->getLogicalDevice(), m_window, m_device->getSupportedProperties());
 
 
@@ -175,13 +190,9 @@ void Renderer::initVulkan()
     }
 
     //------------------------------Descriptor Pools----------------------------
-    std::vector<VkDescriptorPoolSize> poolSizes = {
-        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,static_cast<uint32_t>(m_modelsToLoadInfo.size()) * Config::MAX_FRAMES_IN_FLIGHT * 100 },
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(m_modelsToLoadInfo.size()) * Config::MAX_FRAMES_IN_FLIGHT * 100 },
-        {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 10},
-        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2}
-    };
-    DescriptorManager::createDescriptorPool(poolSizes, &m_descriptorPool);
+    // Passes reserve exactly what they allocate(DescriptorAllocator::reserve()),
+    // the pools are created on demand.
+    m_frameDescriptorAllocators.resize(Config::MAX_FRAMES_IN_FLIGHT);
 
 
     // -------------------------------Global Model Resources------------------------------
@@ -189,12 +200,36 @@ void Renderer::initVulkan()
     g_RenderResource->loadModels(m_modelsToLoadInfo);
     g_RenderResource->uploadModels(m_qfHandles.graphicsQueue, m_commandPoolForGraphics);
 
+    m_gpuCulling = std::make_unique<GPUCulling>();
+    m_clusteredLights = std::make_unique<ClusteredLights>();
+    m_occlusionCulling = std::make_unique<OcclusionCulling>();
+    m_dynamicResolution = std::make_unique<DynamicResolution>();
+    m_latencyMeter = std::make_unique<LatencyMeter>();
+    m_gpuProfiler = std::make_unique<GPUProfiler>();
+
+    // Every per frame resource is created for Config::MAX_FRAMES_IN_FLIGHT slots.
+    if (!m_framesInFlightCounts.empty())
+        setFramesInFlight(m_framesInFlightCounts.front());
+    m_framesInFlight = m_requestedFramesInFlight;
+
+    if (m_device->isDescriptorIndexingSupported())
+        m_bindlessMaterials = std::make_unique<BindlessMaterials>();
+
+    // The main thread records the primary command buffer and waits for the workers.
+    m_parallelRecorder = std::make_unique<ParallelRecorder>(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+
 
     // -------------------------------Main Features------------------------------
     m_msaa = MSAA(m_swapchain->getExtent(), m_swapchain->getImageFormat());
+    if (!m_msaaSamplesCounts.empty())
+        m_msaa.setSamplesCount(m_msaaSamplesCounts.front());
+    m_requestedMSAASamplesCount = m_msaa.getSamplesCount();
 
     m_depthBuffer = DepthBuffer(m_swapchain->getExtent(), m_msaa.getSamplesCount());
 
+    // Its velocity pass uses the depth format.
+    m_temporalAA = std::make_unique<TemporalAA>();
+
     
     createSyncObjects();
 }
@@ -212,19 +247,66 @@ void Renderer::drawFrame(uint8_t& currentFrame)
    //    - 5 param. -> timeOut.
     vkWaitForFences(m_device->getLogicalDevice(), 1, &m_inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
 
-    // After waiting, we need to manually reset the fence.
+    //--------------------Acquires an image from the swapchain------------------
+    uint32_t imageIndex;
+    const VkResult acquireResult = m_swapchain->acquireNextImage(m_imageAvailableSemaphores[currentFrame], imageIndex);
+    // Nothing is submitted: the fence stays signaled for the next try.
+    if (acquireResult == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        recreateSwapchain();
+        return;
+    }
+    if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR)
+        throw std::runtime_error("Failed to acquire a swapchain image!");
+
+    // After waiting, we need to manually reset the fence(once work is submitted for it).
     vkResetFences(m_device->getLogicalDevice(), 1, &m_inFlightFences[currentFrame]);
 
-    //--------------------Acquires an image from the swapchain------------------
-    const uint32_t imageIndex = m_swapchain->getNextImageIndex(m_imageAvailableSemaphores[currentFrame]);
+    // This slot's last frame is done(fence above).
+    m_latencyMeter->beginFrame(currentFrame, m_inputTime);
 
+    const auto recordStart = std::chrono::high_resolution_clock::now();
     {
+        //------------------------Scene BVH & frustum culling-----------------------
+        const Camera& camera = g_RenderResource->m_camera;
+        g_RenderResource->updateSceneBVH();
+        const glm::mat4 viewProj = camera.getProjectionMatrix() * camera.getViewMatrix();
+        g_RenderResource->cullScene(viewProj);
+
+        // The visibility written by this frame slot's last submission is ready(fence above).
+        std::vector<uint32_t> unoccludedMeshIndices;
+        m_occlusionCulling->cull(viewProj, currentFrame, g_RenderResource->getVisibleMeshIndices(), unoccludedMeshIndices);
+        g_RenderResource->setVisibleMeshIndices(unoccludedMeshIndices);
+
+        // The secondaries of this frame are no longer in use(fence above).
+        m_parallelRecorder->beginFrame(currentFrame);
+
+        // Same for the transient descriptor sets of this frame.
+        m_frameDescriptorAllocators[currentFrame].reset();
+
+        // The object buffer of this frame is no longer in use(fence above).
+        // Bindless passes read their model matrices from it too, the Hi-Z test its bounds.
+        if (m_isGPUDrivenEnabled || m_bindlessMaterials || m_occlusionCulling->isGPUTestEnabled())
+            m_gpuCulling->updateObjects(currentFrame);
+
+        m_renderQueueStats.reset();
+
+        // GPU time of this slot's last frame(fence above) sets the render extent.
+        m_dynamicResolution->update(currentFrame, m_swapchain->getExtent());
+
+        // Pass timings of this slot's last frame(fence above).
+        m_gpuProfiler->update(currentFrame);
+
+        // Jitter and motion matrices, before the scenes read the camera.
+        m_temporalAA->update(currentFrame, getRenderExtent());
+
         //------------------------Updates uniform buffer----------------------------
-        m_scene->updateUBO(m_swapchain->getExtent(), currentFrame);
+        m_scene->updateUBO(getRenderExtent(), currentFrame);
 
         //---------------------Records all the command buffer-----------------------   
         m_scene->draw(imageIndex, currentFrame);
     }
+    m_recordTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count();
 
     //----------------------Submits the command buffer -------------------------
     std::vector<VkCommandBuffer> commandBuffersToSubmit = {m_commandBuffersForGraphics[currentFrame]};
@@ -241,12 +323,43 @@ void Renderer::drawFrame(uint8_t& currentFrame)
         signalSemaphores,
         m_inFlightFences[currentFrame]
     );
+    m_latencyMeter->markSubmit(currentFrame);
 
     //-------------------Presentation of the swapchain image--------------------
-    m_swapchain->presentImage(imageIndex, signalSemaphores, m_qfHandles.presentQueue);
+    const VkResult presentResult = m_swapchain->presentImage(imageIndex, signalSemaphores, m_qfHandles.presentQueue);
+    m_latencyMeter->markPresent(currentFrame);
 
     // Updates the frame
-    currentFrame = (currentFrame + 1) % Config::MAX_FRAMES_IN_FLIGHT;
+    currentFrame = (currentFrame + 1) % m_framesInFlight;
+
+    if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || m_window->isResized() ||
+        m_swapchain->getRequestedPresentMode() != m_swapchain->getPresentMode())
+        recreateSwapchain();
+    else if (presentResult != VK_SUCCESS)
+        throw std::runtime_error("Failed to present the swapchain image!");
+}
+
+void Renderer::recreateSwapchain()
+{
+    // Rendering pauses while minimized.
+    while (m_window->isMinimized() && !m_window->isWindowClosed())
+        m_window->waitEvents();
+
+    if (m_window->isWindowClosed())
+        return;
+
+    // The frames in flight still use the old images.
+    vkDeviceWaitIdle(m_device->getLogicalDevice());
+
+    m_device->updateSupportedProperties(m_window->getSurface());
+    m_swapchain->recreate(m_device->getSupportedProperties());
+    m_window->resetResized();
+
+    const VkExtent2D& extent = m_swapchain->getExtent();
+    g_RenderResource->m_camera.setAspect((double)extent.width / extent.height);
+
+    for (auto& callback : m_swapchainCallbacks)
+        callback();
 }
 
 
@@ -270,7 +383,7 @@ void Renderer::calculateFrames(double& lastTime, int& framesCounter)
 void Renderer::mainLoop()
 {
     // Tells us in which frame we are,
-    // between 1 <= frame <= MAX_FRAMES_IN_FLIGHT
+    // between 0 <= frame < m_framesInFlight
 
     uint8_t currentFrame = 0;
 
@@ -284,12 +397,193 @@ void Renderer::mainLoop()
         g_RenderResource->m_camera.update(m_mpf);
 
         m_window->pollEvents();
+        m_inputTime = m_latencyMeter->now();
+
+        // Nothing to present to while minimized.
+        if (m_window->isMinimized())
+        {
+            m_window->waitEvents();
+            continue;
+        }
+
+        // Requested by the GUI during the last frame.
+        if (m_requestedMSAASamplesCount != m_msaa.getSamplesCount() && m_msaa.isSupported(m_requestedMSAASamplesCount))
+        {
+            m_msaa.setSamplesCount(m_requestedMSAASamplesCount);
+            rebuildScene();
+        }
+
+        if (m_requestedFramesInFlight != m_framesInFlight)
+            applyFramesInFlight(m_requestedFramesInFlight, currentFrame);
        
         drawFrame(currentFrame);
     }
     vkDeviceWaitIdle(m_device->getLogicalDevice());
 }
 
+void Renderer::applyFramesInFlight(const uint32_t framesInFlight, uint8_t& currentFrame)
+{
+    // Slots past the new count may still be in use.
+    vkDeviceWaitIdle(m_device->getLogicalDevice());
+
+    m_framesInFlight = framesInFlight;
+    m_requestedFramesInFlight = framesInFlight;
+    currentFrame = 0;
+
+    // The latencies depend on the frames in flight, the GPU is idle for the calibration.
+    m_latencyMeter->reset();
+    m_latencyMeter->calibrate();
+}
+
+void Renderer::rebuildScene()
+{
+    // The frames in flight still use it.
+    vkDeviceWaitIdle(m_device->getLogicalDevice());
+    m_scene->destroy();
+    m_temporalAA->releaseFramebuffer();
+
+    m_scene = m_createScene();
+    // Pipelines already built with these settings come from the pipeline cache.
+    m_pipelineCompiler.compile();
+}
+
+/*
+ * Renders the scene with each pass(and its settings) in turn, the camera
+ * doesn't move: Config::BENCHMARK_WARMUP_FRAMES frames, then m_benchmarkFrames
+ * measured ones. Each pass runs once per MSAA samples count of
+ * m_msaaSamplesCounts(the device's unsupported ones are skipped) and per
+ * frames in flight of m_framesInFlightCounts, with its end to end latency.
+ * The results are printed and written to BENCHMARK_CSV_FILE.
+ */
+void Renderer::runBenchmark()
+{
+    struct BenchmarkRun
+    {
+        std::string                                     name;
+        std::function<std::unique_ptr<ScenePassBase>()> createScene;
+        bool                                            isDepthPrepassEnabled;
+        bool                                            isCPUBinningEnabled;
+        // Measured with each MSAA samples count(the deferred pass has none).
+        bool                                            isMultisampled;
+    };
+
+    const std::vector<BenchmarkRun> runs = {
+        { "forward clustered(GPU binning)", []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<ForwardPBRPass>(); }, true, false, true },
+        { "forward clustered(GPU binning, no depth prepass)", []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<ForwardPBRPass>(); }, false, false, true },
+        { "forward clustered(CPU binning)", []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<ForwardPBRPass>(); }, true, true, true },
+        { "deferred clustered(GPU binning)", []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<DeferredRenderPass>(); }, false, false, false },
+        // Overdrawn fragments skip the SH shading with the prepass.
+        { "SH lighting(depth prepass)", []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<SHLightingPass>(); }, true, false, true },
+        { "SH lighting(no depth prepass)", []() -> std::unique_ptr<ScenePassBase> { return std::make_unique<SHLightingPass>(); }, false, false, true },
+    };
+
+    std::vector<VkSampleCountFlagBits> samplesCounts = m_msaaSamplesCounts;
+    if (samplesCounts.empty())
+        samplesCounts.push_back(m_msaa.getSamplesCount());
+
+    std::vector<uint32_t> framesInFlightCounts = m_framesInFlightCounts;
+    if (framesInFlightCounts.empty())
+        framesInFlightCounts.push_back(m_framesInFlight);
+
+    uint8_t currentFrame = 0;
+
+    double lastTime = glfwGetTime();
+    int framesCounter = 0;
+
+    for (auto& run : runs)
+    {
+        for (const VkSampleCountFlagBits samplesCount : samplesCounts)
+        {
+            if (m_window->isWindowClosed())
+                break;
+
+            if (!m_msaa.isSupported(samplesCount) || (!run.isMultisampled && samplesCount != samplesCounts.front()))
+                continue;
+
+            m_isDepthPrepassEnabled = run.isDepthPrepassEnabled;
+            m_clusteredLights->setCPUBinningEnabled(run.isCPUBinningEnabled);
+            m_msaa.setSamplesCount(samplesCount);
+            m_requestedMSAASamplesCount = samplesCount;
+
+            m_createScene = run.createScene;
+            rebuildScene();
+
+            for (const uint32_t framesInFlight : framesInFlightCounts)
+            {
+                if (m_window->isWindowClosed())
+                    break;
+
+                applyFramesInFlight(std::clamp(framesInFlight, 1u, (uint32_t)Config::MAX_FRAMES_IN_FLIGHT), currentFrame);
+
+                std::string name = run.isMultisampled ? run.name + "(" + std::to_string(samplesCount) + "x MSAA)" : run.name;
+                if (framesInFlightCounts.size() > 1)
+                    name += "(" + std::to_string(m_framesInFlight) + " in flight)";
+                std::cout << "Benchmark: " << name << "\n";
+                m_benchmark.beginRun(name);
+
+                for (uint32_t frame = 0; frame < Config::BENCHMARK_WARMUP_FRAMES + m_benchmarkFrames; ++frame)
+                {
+                    if (m_window->isWindowClosed())
+                        break;
+
+                    const auto frameStart = std::chrono::high_resolution_clock::now();
+
+                    calculateFrames(lastTime, framesCounter);
+                    m_window->pollEvents();
+                    m_inputTime = m_latencyMeter->now();
+
+                    const uint64_t latencyFrames = m_latencyMeter->getFrameCount();
+                    drawFrame(currentFrame);
+
+                    const double frameTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+                    if (frame >= Config::BENCHMARK_WARMUP_FRAMES)
+                    {
+                        m_benchmark.addFrame(frameTime, m_recordTime);
+
+                        // A slot's frame is collected when the slot is used again.
+                        if (m_latencyMeter->isSupported() && m_latencyMeter->getFrameCount() != latencyFrames)
+                            m_benchmark.addLatency(m_latencyMeter->getLastEndToEnd());
+                    }
+                }
+            }
+        }
+    }
+    vkDeviceWaitIdle(m_device->getLogicalDevice());
+
+    m_benchmark.print();
+    m_benchmark.writeCSV(BENCHMARK_CSV_FILE);
+}
+
+/*
+ * Left click picks the closest object under the cursor(unless the GUI is the
+ * one being clicked).
+ */
+void Renderer::processPicking4MouseButtonCallback(int vButton, int vAction, int vMods)
+{
+    if (vButton != GLFW_MOUSE_BUTTON_LEFT || vAction != GLFW_PRESS)
+        return;
+
+    if (m_scene && m_scene->getGUI() && m_scene->getGUI()->isCursorPositionInGUI())
+        return;
+
+    int width, height;
+    glfwGetWindowSize(m_window->get(), &width, &height);
+    if (width == 0 || height == 0)
+        return;
+
+    const std::array<GLdouble, 2>& cursorPos = g_InputManager->getCursorPos();
+    const Camera& camera = g_RenderResource->m_camera;
+
+    const Ray ray = BoundingVolumes::screenPointToRay(
+        glm::fvec2(cursorPos[0], cursorPos[1]),
+        glm::fvec2(width, height),
+        camera.getViewMatrix(),
+        camera.getProjectionMatrix()
+    );
+
+    g_RenderResource->pickModel(ray);
+}
+
 void Renderer::doComputations()
 {
     //std::vector<Computation> computations = { m_scene->getComputation() };
@@ -369,20 +663,44 @@ void Renderer::cleanup()
     ZoneScoped;
 #endif
     g_RenderResource->destroy();
-    // MSAA
-    m_msaa.destroy();
-
-    // DepthBuffer
-    m_depthBuffer.destroy();
-
     // Swapchain
     m_swapchain->destroy();
 
     // Scenes
     m_scene->destroy();
+
+    // Bindless materials
+    if (m_bindlessMaterials)
+        m_bindlessMaterials->destroy();
+
+    // GPU Culling
+    m_gpuCulling->destroy();
+
+    // Clustered lights
+    m_clusteredLights->destroy();
+
+    // Occlusion culling
+    m_occlusionCulling->destroy();
+
+    // Dynamic resolution
+    m_dynamicResolution->destroy();
+
+    // Temporal AA
+    m_temporalAA->destroy();
+
+    // Latency meter
+    m_latencyMeter->destroy();
+
+    // GPU profiler
+    m_gpuProfiler->destroy();
+
+    // Parallel recording
+    m_parallelRecorder->destroy();
    
-    // Descriptor Pool
-    vkDestroyDescriptorPool(getRendererPointer()->getDevice(), m_descriptorPool, nullptr);
+    // Descriptor Pools
+    m_descriptorAllocator.destroy();
+    for (auto& allocator : m_frameDescriptorAllocators)
+        allocator.destroy();
 
     // Sync objects
     destroySyncObjects();
@@ -394,6 +712,10 @@ void Renderer::cleanup()
     vkDestroyCommandPool(getRendererPointer()->getDevice(), m_commandPoolForGraphics, nullptr);
     vkDestroyCommandPool(getRendererPointer()->getDevice(), m_commandPoolForCompute, nullptr);
 
+    // Pipeline Cache
+    m_pipelineCache.save();
+    m_pipelineCache.destroy();
+
     //VM Allocator
     vmaDestroyAllocator(m_vmaAllocator);
 
@@ -542,8 +864,6 @@ DepthImageDesc Renderer::getDepthImageInfo()
 {
     DepthImageDesc desc;
     desc.depth_image_format = m_depthBuffer.getFormat();
-    desc.depth_image_view = &m_depthBuffer.getTexture()->getImageView();
-    desc.depth_image = &m_depthBuffer.getTexture()->getImage();
     return desc;
 }
 
@@ -551,7 +871,5 @@ MSAADesc Renderer::getMSAAInfo()
 {
     MSAADesc desc;
     desc.msaa_sampleCount = m_msaa.getSamplesCount();
-    desc.msaa_image_view = &m_msaa.getTexture()->getImageView();
-    desc.msaa_image = &m_msaa.getTexture()->getImage();
     return desc;
 }
\ No newline at end of file
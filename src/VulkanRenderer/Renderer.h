@@ -2,12 +2,15 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <functional>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
 #include <vk_mem_alloc.h>
 
+#include "VulkanRenderer/Settings/config.h"
 #include "VulkanRenderer/Window/Window.h"
 #include "VulkanRenderer/GUI/GUI.h"
 #include "VulkanRenderer/Queue/QueueFamilyIndices.h"
@@ -15,8 +18,22 @@
 #include "VulkanRenderer/Swapchain/Swapchain.h"
 #include "VulkanRenderer/Computation/Computation.h"
 #include "VulkanRenderer/Features/DepthBuffer.h"
+#include "VulkanRenderer/Features/DynamicResolution.h"
+#include "VulkanRenderer/Features/TemporalAA.h"
 #include "VulkanRenderer/RenderPass/RenderPass.h"
 #include "VulkanRenderer/Device/Device.h"
+#include "VulkanRenderer/Culling/GPUCulling.h"
+#include "VulkanRenderer/Culling/ClusteredLights.h"
+#include "VulkanRenderer/Culling/OcclusionCulling.h"
+#include "VulkanRenderer/Descriptor/BindlessMaterials.h"
+#include "VulkanRenderer/Descriptor/DescriptorAllocator.h"
+#include "VulkanRenderer/Pipeline/PipelineCache.h"
+#include "VulkanRenderer/Pipeline/PipelineCompiler.h"
+#include "VulkanRenderer/RenderQueue/RenderQueue.h"
+#include "VulkanRenderer/Command/ParallelRecorder.h"
+#include "VulkanRenderer/Benchmark/FrameBenchmark.h"
+#include "VulkanRenderer/Benchmark/LatencyMeter.h"
+#include "VulkanRenderer/Benchmark/GPUProfiler.h"
 
 #include "VulkanRenderer/Camera/Camera.h"
 #include "VulkanRenderer/Features/ShadowMap.h"
@@ -56,6 +73,15 @@ public:
 
 	void run();
 
+	// Non zero: run() renders the scene with each pass in turn, measuring
+	// this many frames per pass, prints the results and returns.
+	void setBenchmarkFrames(const uint32_t frames)			{ m_benchmarkFrames = frames; }
+	// MSAA samples counts the benchmark measures each pass with(the current one
+	// when empty), the first one is also the startup count.
+	void setMSAASamplesCounts(const std::vector<VkSampleCountFlagBits>& samplesCounts) { m_msaaSamplesCounts = samplesCounts; }
+	// Same for the frames in flight(1 to Config::MAX_FRAMES_IN_FLIGHT).
+	void setFramesInFlightCounts(const std::vector<uint32_t>& framesInFlight) { m_framesInFlightCounts = framesInFlight; }
+
 	void addObjectPBR(const std::string& name, const std::string& folderName,const std::string& fileName,const glm::fvec3& pos = glm::fvec3(0.0f),const glm::fvec3& rot = glm::fvec3(0.0f),const glm::fvec3& size = glm::fvec3(1.0f));
 
 	void addSkybox(const std::string& fileName, const std::string& textureFolderName);
@@ -68,19 +94,73 @@ public:
 	const std::shared_ptr<Window>	getWindow()const		{ return m_window; }
 	const std::shared_ptr<Swapchain> getSwapchain() const	{ return m_swapchain; }
 	const MSAA* getMSAA() const								{ return &m_msaa; }
+	// Rebuilds the scene with it before the next frame.
+	void setMSAASamplesCount(const VkSampleCountFlagBits samplesCount) { m_requestedMSAASamplesCount = samplesCount; }
+	// The swapchain is recreated with it after the next present.
+	void setPresentMode(const VkPresentModeKHR presentMode)	{ m_swapchain->setPresentMode(presentMode); }
+	// Frame slots in use, out of the Config::MAX_FRAMES_IN_FLIGHT created.
+	const uint32_t& getFramesInFlight() const				{ return m_framesInFlight; }
+	// Applied before the next frame(the GPU is waited on), clamped to 1..Config::MAX_FRAMES_IN_FLIGHT.
+	void setFramesInFlight(const uint32_t framesInFlight)	{ m_requestedFramesInFlight = std::clamp(framesInFlight, 1u, (uint32_t)Config::MAX_FRAMES_IN_FLIGHT); }
+	// Called after the swapchain is recreated(GPU idle), in registration order:
+	// swapchain sized resources and framebuffers of the swapchain images.
+	void registerSwapchainCallback(const std::function<void()>& callback) { m_swapchainCallbacks.push_back(callback); }
 	const DepthBuffer* getDepthBuffer() const				{ return &m_depthBuffer; }
+	const ScenePassBase* getScene() const					{ return m_scene.get(); }
 	virtual VkDevice getDevice()							{ return m_device->getLogicalDevice();};
 	virtual VkPhysicalDevice getPhysicalDevice()			{ return m_device->getPhysicalDevice();};
 	virtual VmaAllocator& getVmaAllocator()					{ return m_vmaAllocator;};
 	virtual VkQueue& getGraphicsQueue()						{ return m_qfHandles.graphicsQueue;};
 	virtual QueueFamilyIndices& getQueueFamilyIndices()		{ return m_qfIndices; }
 	virtual VkCommandPool getCommandPool()					{ return m_commandPoolForGraphics;};
-	virtual VkDescriptorPool& getDescriptorPool()			{ return m_descriptorPool; }
+	PipelineCache& getPipelineCache()						{ return m_pipelineCache; }
+	// Pipelines added while the passes are built, compiled together(in parallel) afterwards.
+	PipelineCompiler& getPipelineCompiler()					{ return m_pipelineCompiler; }
+	DescriptorAllocator& getDescriptorAllocator()			{ return m_descriptorAllocator; }
+	// Reset when the frame's fence is signaled: sets allocated from it live one frame.
+	DescriptorAllocator& getFrameDescriptorAllocator(uint32_t frame) { return m_frameDescriptorAllocators[frame]; }
 	
 	
 	const double& getMicroSecondPerFrame() const			{ return m_mpf; }
+	RenderQueueStats& getRenderQueueStats()					{ return m_renderQueueStats; }
 	const std::string& getDeviceName() const				{ return m_device->getDeviceName(); }
 	const uint32_t& getApiVersion()const					{ return m_device->getApiVersion(); }
+	bool isDeviceExtensionEnabled(const char* extension) const { return m_device->isExtensionEnabled(extension); }
+
+	GPUCulling* getGPUCulling()								{ return m_gpuCulling.get(); }
+	const bool& isGPUDrivenEnabled() const					{ return m_isGPUDrivenEnabled; }
+	void setGPUDrivenEnabled(const bool enabled)			{ m_isGPUDrivenEnabled = enabled; }
+
+	ClusteredLights* getClusteredLights()					{ return m_clusteredLights.get(); }
+
+	// Removes the occluded meshes from the frustum culling's visible set.
+	OcclusionCulling* getOcclusionCulling()					{ return m_occlusionCulling.get(); }
+
+	DynamicResolution* getDynamicResolution()				{ return m_dynamicResolution.get(); }
+	// Scene passes render at this extent, in the top left of their swapchain sized targets.
+	const VkExtent2D& getRenderExtent() const				{ return m_dynamicResolution->getRenderExtent(); }
+
+	// Jitters the camera and resolves the scene color into a swapchain sized history.
+	TemporalAA* getTemporalAA()								{ return m_temporalAA.get(); }
+
+	// Input to submit, GPU completion and present of the frames.
+	LatencyMeter* getLatencyMeter()							{ return m_latencyMeter.get(); }
+	// GPU time of the render graph's passes.
+	GPUProfiler* getGPUProfiler()							{ return m_gpuProfiler.get(); }
+
+	// Forward and SH lighting: depth only subpass before the shading one.
+	const bool& isDepthPrepassEnabled() const				{ return m_isDepthPrepassEnabled; }
+	void setDepthPrepassEnabled(const bool enabled)			{ m_isDepthPrepassEnabled = enabled; }
+
+	// nullptr when the device lacks descriptor indexing(passes keep their per mesh sets).
+	BindlessMaterials* getBindlessMaterials()				{ return m_bindlessMaterials.get(); }
+
+	ParallelRecorder* getParallelRecorder()					{ return m_parallelRecorder.get(); }
+	const bool& isParallelRecordingEnabled() const			{ return m_isParallelRecordingEnabled; }
+	void setParallelRecordingEnabled(const bool enabled)	{ m_isParallelRecordingEnabled = enabled; }
+
+	const bool& isStaticCachingEnabled() const				{ return m_isStaticCachingEnabled; }
+	void setStaticCachingEnabled(const bool enabled)		{ m_isStaticCachingEnabled = enabled; }
 
 	VkCommandBuffer& getGraphicsCommandBuffer(uint32_t index) { return m_commandBuffersForGraphics[index]; }
 	VkCommandBuffer& getComputeCommandBuffer(uint32_t index) { return m_commandBuffersForCompute[index]; }
@@ -95,10 +175,19 @@ private:
 
 	void initVulkan();
 	void mainLoop();
+	void runBenchmark();
+	// Waits for the GPU and recreates the scene(attachments, framebuffers, pipelines).
+	void rebuildScene();
+	// Resized, out of date or new present mode. Waits while the window is minimized.
+	void recreateSwapchain();
+	// Waits for the GPU and restarts from the first frame slot with this many in flight.
+	void applyFramesInFlight(const uint32_t framesInFlight, uint8_t& currentFrame);
 	void cleanup();
 
 	void drawFrame(uint8_t& currentFrame);
 
+	void processPicking4MouseButtonCallback(int vButton, int vAction, int vMods);
+
 	void createSyncObjects();
 	void destroySyncObjects();
 
@@ -115,13 +204,18 @@ private:
 	VmaAllocator						m_vmaAllocator;
 
 	std::shared_ptr<Swapchain>          m_swapchain;
+	std::vector<std::function<void()>>	m_swapchainCallbacks;
 	
 	//std::unique_ptr<DeferredRenderPass>			m_scene;
 	std::unique_ptr<ScenePassBase>			m_scene;
 	//std::unique_ptr<SHLightingPass>			m_scene;
+	std::function<std::unique_ptr<ScenePassBase>()>	m_createScene;
 
-	//std::vector<VkCommandPool>			m_commandPools = {}; ///<Array of command pools so that each thread in the thread pool has its own pool
-	//std::vector<VkCommandBuffer>		m_commandBuffers = {}; ///<the main command buffers for recording draw commands
+	// Worker threads, each with its own command pool per frame(secondary command buffers).
+	std::unique_ptr<ParallelRecorder>	m_parallelRecorder;
+	bool								m_isParallelRecordingEnabled = true;
+	// Replays the draws recorded in StaticCommandCache(s) instead of recording them.
+	bool								m_isStaticCachingEnabled = true;
 
 	std::vector<VkSemaphore>            m_imageAvailableSemaphores;
 	std::vector<VkSemaphore>            m_renderFinishedSemaphores;
@@ -136,15 +230,48 @@ private:
 	std::vector<VkCommandBuffer>		m_commandBuffersForGraphics;
 	std::vector<VkCommandBuffer>		m_commandBuffersForCompute;
 
-	VkDescriptorPool                    m_descriptorPool;
+	// Every pipeline is created through it, saved to disk at shutdown.
+	PipelineCache                       m_pipelineCache;
+	PipelineCompiler                    m_pipelineCompiler;
+
+	// Sets living as long as the passes.
+	DescriptorAllocator                 m_descriptorAllocator;
+	// Transient sets, one allocator per frame in flight.
+	std::vector<DescriptorAllocator>    m_frameDescriptorAllocators;
 
 
 	bool								m_isMouseInMotion;
 
+	std::unique_ptr<GPUCulling>			m_gpuCulling;
+	bool								m_isGPUDrivenEnabled = true;
+
+	std::unique_ptr<ClusteredLights>	m_clusteredLights;
+	std::unique_ptr<OcclusionCulling>	m_occlusionCulling;
+	std::unique_ptr<DynamicResolution>	m_dynamicResolution;
+	std::unique_ptr<TemporalAA>			m_temporalAA;
+	std::unique_ptr<LatencyMeter>		m_latencyMeter;
+	std::unique_ptr<GPUProfiler>		m_gpuProfiler;
+	// When the events of the frame being drawn were polled(LatencyMeter::now()).
+	double								m_inputTime = 0.0;
+	bool								m_isDepthPrepassEnabled = true;
+
+	std::unique_ptr<BindlessMaterials>	m_bindlessMaterials;
+
 
 	// milliseconds per frame
 	double												m_mpf;
+	// milliseconds spent updating and recording the last frame
+	double												m_recordTime = 0.0;
+
+	uint32_t											m_benchmarkFrames = 0;
+	FrameBenchmark										m_benchmark;
+	RenderQueueStats									m_renderQueueStats;
 	//---------------------------Features--------------------------------------
 	DepthBuffer											m_depthBuffer;
 	MSAA												m_msaa;
+	VkSampleCountFlagBits								m_requestedMSAASamplesCount = VK_SAMPLE_COUNT_1_BIT;
+	std::vector<VkSampleCountFlagBits>					m_msaaSamplesCounts;
+	uint32_t											m_framesInFlight = Config::FRAMES_IN_FLIGHT;
+	uint32_t											m_requestedFramesInFlight = Config::FRAMES_IN_FLIGHT;
+	std::vector<uint32_t>								m_framesInFlightCounts;
 };
\ No newline at end of file
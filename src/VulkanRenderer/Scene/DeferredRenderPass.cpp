@@ -1,30 +1,42 @@
 #include "VulkanRenderer/Scene/DeferredRenderPass.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "VulkanRenderer/Renderer.h"
 #include "VulkanRenderer/Math/MathUtils.h"
+#include "VulkanRenderer/Pipeline/ShaderVariants.h"
+#include "VulkanRenderer/Features/FeaturesUtils.h"
 
 
 DeferredRenderPass::DeferredRenderPass()
 {
     m_extent = getRendererPointer()->getSwapchainInfo().extent;
     // Clear Color
-    m_clearValues.resize(8);
+    m_clearValues.resize(ATTACHMENT_NUM + 1);
     m_clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
     m_clearValues[1].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
     m_clearValues[2].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
     m_clearValues[3].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
     m_clearValues[4].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
-    m_clearValues[5].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
-    m_clearValues[6].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
-    m_clearValues[7].color = { 1.0f, 0.0f };
+    m_clearValues[5].depthStencil = { 1.0f, 0 };
+
+    m_gBufferFormats.assign(std::begin(G_BUFFER_FORMATS), std::end(G_BUFFER_FORMATS));
+    m_gBufferFormats[normal] = FeaturesUtils::findSupportedFormat(
+        getRendererPointer()->getPhysicalDevice(),
+        { VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16_SFLOAT },
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT
+    );
 
     createRenderPass();
 
     //Secondary Features
     createSecondaryFeatures();
 
+    // The framebuffers and the composition set use the graph's attachments.
+    createRenderGraph();
+
     createPipelines();
     
     createUBOs();
@@ -43,36 +55,10 @@ void DeferredRenderPass::createRenderPass()
     VkFormat depthBufferFormat = getRendererPointer()->getDepthImageInfo().depth_image_format;
     VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
 
-    VkExtent2D extent = getRendererPointer()->getSwapchainInfo().extent;
-    std::vector<ColorAttachmentInfo> colorAttachmentInfos =
-    {
-        {"position",            extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT},
-        {"normal",              extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT},
-        {"albedo",              extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT},
-        {"metallicRoughness",   extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT},
-        {"emissive",            extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT},
-        {"ao",                  extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT},
-
-    };
-    createColorAttachments(colorAttachmentInfos);
-
-    m_depthAttacment = Image::Create2DImage(
-        getRendererPointer()->getSwapchainInfo().extent,
-        getRendererPointer()->getDepthBuffer()->getFormat(),
-        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT ,
-        VMA_MEMORY_USAGE_GPU_ONLY,
-        VK_IMAGE_ASPECT_DEPTH_BIT,
-        VK_IMAGE_TILING_OPTIMAL,
-        VK_SAMPLE_COUNT_1_BIT
-    );
-
-
-
-
     // - Attachments
-    std::array<VkAttachmentDescription, 8> attachments{};
+    std::array<VkAttachmentDescription, ATTACHMENT_NUM + 1> attachments{};
 
-    // ɫ
+    // Scene color, the upscale pass copies it to the swapchain.
     attachments[0].format = format;
     attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
     attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
@@ -82,132 +68,56 @@ void DeferredRenderPass::createRenderPass()
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-    // G-Buffer 
-    // Position
-    attachments[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[1].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    // Normals
-    attachments[2].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[2].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    // Albedo
-    attachments[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    attachments[3].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[3].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[3].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[3].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[3].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[3].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[3].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // Metallic & roughness
-    attachments[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    attachments[4].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[4].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[4].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[4].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[4].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[4].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[4].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    // Emissive
-    attachments[5].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    attachments[5].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[5].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[5].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[5].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[5].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[5].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[5].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    // AO
-    attachments[6].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    attachments[6].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[6].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[6].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[6].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[6].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[6].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[6].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // Depth attachment
-    attachments[7].format = depthBufferFormat;
-    attachments[7].samples = VK_SAMPLE_COUNT_1_BIT;
-    attachments[7].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachments[7].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[7].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    attachments[7].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    attachments[7].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachments[7].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-
-    // ͨ
+    // Compact G-Buffer: never leaves the render pass(transient attachments), but
+    // the depth, reduced to the Hi-Z pyramid of the occlusion culling.
+    for (uint32_t i = 0; i < ATTACHMENT_NUM; ++i)
+    {
+        attachments[i + 1].format = (i == depth) ? depthBufferFormat : m_gBufferFormats[i];
+        attachments[i + 1].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[i + 1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[i + 1].storeOp = (i == depth) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[i + 1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[i + 1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[i + 1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[i + 1].finalLayout = (i == depth) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    // Subpasses
     std::array<VkSubpassDescription, 2> subpassDescriptions{};
-    // һͨ: дG-Buffer
+
+    // First subpass: fills the G-Buffer
     // ----------------------------------------------------------------------------------------
-    std::vector<VkAttachmentReference> colorReferences(7);
-    colorReferences[0] = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    colorReferences[1] = { 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    colorReferences[2] = { 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    colorReferences[3] = { 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    colorReferences[4] = { 4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    colorReferences[5] = { 5, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    colorReferences[6] = { 6, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-    VkAttachmentReference depthReference = { 7, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+    std::vector<VkAttachmentReference> colorReferences(depth);
+    for (uint32_t i = 0; i < depth; ++i)
+        colorReferences[i] = { i + 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    VkAttachmentReference depthReference = { depth + 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
 
     subpassDescriptions[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpassDescriptions[0].colorAttachmentCount = colorReferences.size();
+    subpassDescriptions[0].colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
     subpassDescriptions[0].pColorAttachments = colorReferences.data();
     subpassDescriptions[0].pDepthStencilAttachment = &depthReference;
 
-    //// ڶͨ: ʹG-Buffer
-    //// ----------------------------------------------------------------------------------------
-
+    // Second subpass: composition, reads the G-Buffer(and the depth) as input attachments
+    // ----------------------------------------------------------------------------------------
     VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
 
-    VkAttachmentReference inputReferences[6];
-    inputReferences[0] = { 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-    inputReferences[1] = { 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-    inputReferences[2] = { 3, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-    inputReferences[3] = { 4, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-    inputReferences[4] = { 5, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-    inputReferences[5] = { 6, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    // The depth is read and still tested(skybox, light spheres): read only.
+    VkAttachmentReference readOnlyDepthReference = { depth + 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
 
-    uint32_t preserveAttachmentIndex = 1;
+    std::vector<VkAttachmentReference> inputReferences(ATTACHMENT_NUM);
+    for (uint32_t i = 0; i < depth; ++i)
+        inputReferences[i] = { i + 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    inputReferences[depth] = readOnlyDepthReference;
 
     subpassDescriptions[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpassDescriptions[1].colorAttachmentCount = 1;
     subpassDescriptions[1].pColorAttachments = &colorReference;
-    subpassDescriptions[1].pDepthStencilAttachment = &depthReference;
-    //ʹõһɫΪ븽
-    subpassDescriptions[1].inputAttachmentCount = 6;
-    subpassDescriptions[1].pInputAttachments = inputReferences;
-
-    //// ͨ: ǰ͸
-    //    // ----------------------------------------------------------------------------------------
-    //colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    subpassDescriptions[1].pDepthStencilAttachment = &readOnlyDepthReference;
+    subpassDescriptions[1].inputAttachmentCount = static_cast<uint32_t>(inputReferences.size());
+    subpassDescriptions[1].pInputAttachments = inputReferences.data();
 
-    //inputReferences[0] = { 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
 
-    //subpassDescriptions[2].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    //subpassDescriptions[2].colorAttachmentCount = 1;
-    //subpassDescriptions[2].pColorAttachments = &colorReference;
-    //subpassDescriptions[2].pDepthStencilAttachment = &depthReference;
-    //// ʹõһɫ / ȸΪ븽
-    //subpassDescriptions[2].inputAttachmentCount = 1;
-    //subpassDescriptions[2].pInputAttachments = inputReferences;
-
-
-    // ͨתϵ
+    // Subpass dependencies
     std::array<VkSubpassDependency, 3> dependencies;
 
     dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
@@ -218,17 +128,16 @@ void DeferredRenderPass::createRenderPass()
     dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
     dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
-    // This dependency transitions the input attachment from color attachment to shader read
-        //ϵ븽ɫתɫȡ
+    // G-Buffer and depth written by the first subpass, read by the composition.
     dependencies[1].srcSubpass = 0;
     dependencies[1].dstSubpass = 1;
-    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
     dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
-    dependencies[2].srcSubpass = 0;
+    dependencies[2].srcSubpass = 1;
     dependencies[2].dstSubpass = VK_SUBPASS_EXTERNAL;
     dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependencies[2].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
@@ -236,45 +145,12 @@ void DeferredRenderPass::createRenderPass()
     dependencies[2].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
     dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
-    //// This dependency transitions the input attachment from color attachment to shader read
-    ////ϵ븽ɫתɫȡ
-    //dependencies[1].srcSubpass = 0;
-    //dependencies[1].dstSubpass = 1;
-    //dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    //dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    //dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    //dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    //dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    //dependencies[2].srcSubpass = 1;
-    //dependencies[2].dstSubpass = 2;
-    //dependencies[2].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    //dependencies[2].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    //dependencies[2].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    //dependencies[2].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    //dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    //dependencies[3].srcSubpass = 0;
-    //dependencies[3].dstSubpass = VK_SUBPASS_EXTERNAL;
-    //dependencies[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    //dependencies[3].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-    //dependencies[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    //dependencies[3].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-    //dependencies[3].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-    VkRenderPassCreateInfo renderPassInfo = {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-    renderPassInfo.pAttachments = attachments.data();
-    renderPassInfo.subpassCount = static_cast<uint32_t>(subpassDescriptions.size());
-    renderPassInfo.pSubpasses = subpassDescriptions.data();
-    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
-    renderPassInfo.pDependencies = dependencies.data();
-
     m_renderPass = RenderPass(
-        { attachments[0], attachments[1], attachments[2],attachments[3],attachments[4],attachments[5] ,attachments[6] ,attachments[7] },
-        { subpassDescriptions[0],subpassDescriptions[1]},
-        { dependencies[0],dependencies[1],dependencies[2]}
+        std::vector<VkAttachmentDescription>(attachments.begin(), attachments.end()),
+        { subpassDescriptions[0], subpassDescriptions[1] },
+        { dependencies[0], dependencies[1], dependencies[2] }
+    );
+}
     );
 }
 
@@ -288,15 +164,12 @@ void DeferredRenderPass::createSwapchainFramebuffers()
         m_swapchain_framebuffers[i] = new VkFramebuffer;
 
         std::vector<VkImageView> attachments = {
-            *getRendererPointer()->getSwapchainInfo().imageViews[i],
-            m_colorAttachments[0]->getImageView(),
-            m_colorAttachments[1]->getImageView(),
-            m_colorAttachments[2]->getImageView(),
-            m_colorAttachments[3]->getImageView(),
-            m_colorAttachments[4]->getImageView(),
-            m_colorAttachments[5]->getImageView(),
-            m_depthAttacment->getImageView()
-     
+            m_renderGraph.getImageView(m_sceneColorResource),
+            m_renderGraph.getImageView(m_gBufferResources[albedo]),
+            m_renderGraph.getImageView(m_gBufferResources[normal]),
+            m_renderGraph.getImageView(m_gBufferResources[material]),
+            m_renderGraph.getImageView(m_gBufferResources[emissive]),
+            m_renderGraph.getImageView(m_gBufferResources[depth])
         };
 
         FramebufferManager::createFramebuffer(
@@ -312,22 +185,155 @@ void DeferredRenderPass::createSwapchainFramebuffers()
 }
 
 
+void DeferredRenderPass::createRenderGraph()
+{
+    const VkFormat depthBufferFormat = getRendererPointer()->getDepthImageInfo().depth_image_format;
+
+    importSwapchain();
+    // Sampled by the previous frame's composition.
+    m_shadowMapResource = m_renderGraph.importImage("shadow map", VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    m_renderGraph.setImportedImage(m_shadowMapResource, m_shadowMap->getImage()->getImage(), m_shadowMap->getShadowMapView());
+    // Cleared every frame.
+    m_shadowAtlasResource = m_renderGraph.importImage("shadow atlas", VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    m_renderGraph.setImportedImage(m_shadowAtlasResource, m_shadowAtlas->getImage()->getImage(), m_shadowAtlas->getImageView());
+
+    const std::vector<std::string> gBufferNames = { "albedo", "normal", "material", "emissive" };
+
+    m_gBufferResources.resize(ATTACHMENT_NUM);
+    for (uint32_t i = 0; i < gBufferNames.size(); ++i)
+        m_gBufferResources[i] = m_renderGraph.createImage(gBufferNames[i], { m_extent, m_gBufferFormats[i], VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT });
+    m_gBufferResources[depth] = m_renderGraph.createImage("depth", { m_extent, depthBufferFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_SAMPLE_COUNT_1_BIT });
+    m_sceneColorResource = m_renderGraph.createImage("scene color", { m_extent, getRendererPointer()->getSwapchainInfo().image_format, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT });
+
+    m_renderGraph.addPass("shadow map",
+        [&](RenderGraph::PassBuilder& builder) {
+            // Cascades not re-rendered keep last frame's depth, all are left ready to be sampled.
+            builder.write(m_shadowMapResource, RenderGraphAccess::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            // GPU culling writes the indirect draw buffers.
+            builder.setSideEffect();
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_shadowMap->draw(imageIndex, currentFrame);
+        }
+    );
+
+    m_renderGraph.addPass("shadow atlas",
+        [&](RenderGraph::PassBuilder& builder) {
+            // The render pass leaves it ready to be sampled.
+            builder.write(m_shadowAtlasResource, RenderGraphAccess::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_shadowAtlas->draw(imageIndex, currentFrame);
+        }
+    );
+
+    m_renderGraph.addPass("light clustering",
+        [&](RenderGraph::PassBuilder& builder) {
+            // Writes the per cluster light lists(buffers).
+            builder.setSideEffect();
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            getRendererPointer()->getClusteredLights()->build(commandBuffer, currentFrame);
+        }
+    );
+
+    // Both subpasses: the G-Buffer is written by the first and read by the second.
+    m_renderGraph.addPass("deferred",
+        [&](RenderGraph::PassBuilder& builder) {
+            for (uint32_t i = 0; i < depth; ++i)
+            {
+                builder.write(m_gBufferResources[i], RenderGraphAccess::COLOR_ATTACHMENT);
+                builder.read(m_gBufferResources[i], RenderGraphAccess::INPUT_ATTACHMENT);
+            }
+            // Position reconstruction
+            builder.write(m_gBufferResources[depth], RenderGraphAccess::DEPTH_ATTACHMENT);
+            builder.read(m_gBufferResources[depth], RenderGraphAccess::INPUT_ATTACHMENT);
+            builder.read(m_shadowMapResource, RenderGraphAccess::SAMPLED);
+            builder.read(m_shadowAtlasResource, RenderGraphAccess::SAMPLED);
+            builder.write(m_sceneColorResource, RenderGraphAccess::COLOR_ATTACHMENT);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            // Only the render extent is drawn(dynamic resolution).
+            const VkExtent2D& renderExtent = getRendererPointer()->getRenderExtent();
+
+            cullIndirect(commandBuffer, currentFrame);
+
+            // The G-Buffer subpass may only execute secondaries: its timestamps are outside of it.
+            GPUProfiler* gpuProfiler = getRendererPointer()->getGPUProfiler();
+            const int32_t gBufferScope = gpuProfiler->beginScope(commandBuffer, currentFrame, "G-Buffer");
+
+            m_renderPass.begin(*m_swapchain_framebuffers[imageIndex], renderExtent, m_clearValues, commandBuffer, getSubpassContents());
+
+            // G-Buffer
+            drawPipeline(commandBuffer, currentFrame, imageIndex, 0, m_pipelines[scene_gbuffer], m_pipelineLayouts[scene_gbuffer], getRenderResource()->m_normalModels);
+
+            // Composition
+            vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+            gpuProfiler->endScope(commandBuffer, currentFrame, gBufferScope);
+
+            // The G-Buffer draws may have set them in secondaries. The UVs of the
+            // full screen triangle then span the render extent.
+            VkViewport viewport{ 0.0f, 0.0f, (float)renderExtent.width, (float)renderExtent.height, 0.0f, 1.0f };
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            VkRect2D scissor{ {0,0}, renderExtent };
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+            {
+                GPUProfiler::Scope scope(commandBuffer, currentFrame, "composition");
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[composition]);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayouts[composition], 0, 1, &m_compositionDescriptorSets[currentFrame].get(), 0, NULL);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayouts[composition], 1, 1, &getRendererPointer()->getClusteredLights()->getDescriptorSet(currentFrame), 0, NULL);
+                vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+            }
+            {
+                GPUProfiler::Scope scope(commandBuffer, currentFrame, "light spheres");
+                m_lightSphere->draw(commandBuffer);
+            }
+            {
+                GPUProfiler::Scope scope(commandBuffer, currentFrame, "skybox");
+                m_skyBox->draw(commandBuffer);
+            }
+
+            m_renderPass.end(commandBuffer);
+        }
+    );
+
+    addOcclusionPass(m_gBufferResources[depth], VK_SAMPLE_COUNT_1_BIT);
+    addUpscalePass(m_sceneColorResource, addTemporalAAPasses(m_sceneColorResource));
+
+    m_renderGraph.addPass("GUI",
+        [&](RenderGraph::PassBuilder& builder) {
+            // The GUI render pass presents.
+            builder.write(m_swapchainResource, RenderGraphAccess::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_GUI->draw(currentFrame, imageIndex);
+        }
+    );
+
+    compileRenderGraph();
+}
+
 void DeferredRenderPass::createSecondaryFeatures()
 {
     //ShadowMap
-    const VkExtent2D swapChainExtent = getRendererPointer()->getSwapchainInfo().extent;
-    const VkExtent2D shadowExtent = { 2 * swapChainExtent.height, 2 * swapChainExtent.width };
+    m_shadowMap = std::make_shared<CascadedShadowMap>(
+        Config::SHADOW_CASCADE_RESOLUTION,
+        getRendererPointer()->getDepthImageInfo().depth_image_format,
+        Config::SHADOW_CASCADE_LAMBDA,
+        Config::SHADOW_CASCADE_COUNT
+        );
 
-    m_shadowMap = std::make_shared<ShadowMap>(
-        shadowExtent,
-        getRendererPointer()->getSwapchainInfo().imageViews.size(),
+    m_shadowAtlas = std::make_shared<ShadowAtlas>(
+        Config::SHADOW_ATLAS_RESOLUTION,
         getRendererPointer()->getDepthImageInfo().depth_image_format,
-        Config::MAX_FRAMES_IN_FLIGHT
+        m_shadowMap
         );
 
     uint32_t finalPassIndex = 1;
-    m_skyBox = std::make_shared<SkyBox>(m_renderPass.get(), VK_SAMPLE_COUNT_1_BIT, finalPassIndex);
-    m_lightSphere = std::make_shared<LightSphere>(m_renderPass.get(), VK_SAMPLE_COUNT_1_BIT, finalPassIndex);
+    // The composition subpass reads the depth: no depth writes.
+    m_skyBox = std::make_shared<SkyBox>(m_renderPass.get(), VK_SAMPLE_COUNT_1_BIT, finalPassIndex, false);
+    m_lightSphere = std::make_shared<LightSphere>(m_renderPass.get(), VK_SAMPLE_COUNT_1_BIT, finalPassIndex, false);
 
     //GUI
     m_GUI = std::make_unique<GUI>();
@@ -350,9 +356,12 @@ void DeferredRenderPass::createPipelines()
     m_descriptorSetLayouts.resize(PIPELINE_NUM);
     m_pipelineLayouts.resize(PIPELINE_NUM);
 
+    // Bindless variant of the G-Buffer pipeline when the device supports it.
+    const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials();
+
     //-------------------------------- Pipeline OffScreen --------------------------------------
     {
-        const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::DEFERRED_OFF::DESCRIPTORS_INFO;
+        const std::vector<DescriptorInfo>& descriptorInfo = bindless ? GRAPHICS_PIPELINE::DEFERRED_OFF_BINDLESS::DESCRIPTORS_INFO : GRAPHICS_PIPELINE::DEFERRED_OFF::DESCRIPTORS_INFO;
 
         std::vector<VkDescriptorSetLayoutBinding> bindings(descriptorInfo.size());
         for (uint32_t i = 0; i < descriptorInfo.size(); i++)
@@ -373,97 +382,36 @@ void DeferredRenderPass::createPipelines()
             throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-        // -------------------Shader Modules--------------------
-        const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "deferred_off"}, {shaderType::FRAGMENT, "deferred_off"} };
-
-        std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-        for (uint32_t i = 0; i < shaderInfos.size(); i++)
-        {
-            PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-            PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-        }
-
-
-        // Dynamic states
-        std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-        VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
-        // Viewport
-        VkViewport viewport{};
-        PipelineManager::createViewport(viewport, m_extent);
-        // Scissor
-        VkRect2D scissor{};
-        PipelineManager::createScissor(scissor, m_extent);
-        // Viewport state info
-        VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-        // Vertex input(attributes)
-        std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::DEFERRED_OFF::getAttributeDescriptions();
-        VkVertexInputBindingDescription bindingDescription = Attributes::DEFERRED_OFF::getBindingDescription();
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-        // Input assembly
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-        // Rasterizer
-        VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0);
-        // Multisampling 
-        VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(VK_SAMPLE_COUNT_1_BIT, 0);
-        // Color blending(attachment)
-        std::array<VkPipelineColorBlendAttachmentState, 7> blendAttachmentStates = {
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE),
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE),
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE),
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE),
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE),
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE),
-                PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE)
-        };
-        // Color blending(global)
-        VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(blendAttachmentStates.size(), blendAttachmentStates.data());
-
         // Pipeline layout
+        std::vector<VkDescriptorSetLayout> setLayouts = { m_descriptorSetLayouts[scene_gbuffer] };
+        if (bindless)
+            setLayouts.push_back(bindless->getDescriptorSetLayout());
+
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayouts[scene_gbuffer];
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
         pipelineLayoutInfo.pushConstantRangeCount = 0;
         pipelineLayoutInfo.pPushConstantRanges = nullptr;
         auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[scene_gbuffer]);
         if (status != VK_SUCCESS)
             throw std::runtime_error("Failed to create pipeline layout!");
 
-        // Depth and stencil
-        VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS_OR_EQUAL);
-
-
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = shaderInfos.size();
-        pipelineInfo.pStages = shaderStagesInfos.data();
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizationState;
-        pipelineInfo.pMultisampleState = &multisampleState;
-        pipelineInfo.pDepthStencilState = &depthStencilState;
-        pipelineInfo.pColorBlendState = &colorBlendState;
-        pipelineInfo.pDynamicState = &dynamicState;
-        pipelineInfo.pTessellationState = nullptr;
-        pipelineInfo.pNext = nullptr;
-        pipelineInfo.layout = m_pipelineLayouts[scene_gbuffer];
-        pipelineInfo.renderPass = m_renderPass.get();
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineInfo.basePipelineIndex = -1;
-
-        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[scene_gbuffer]);
-        if (status != VK_SUCCESS)
-            throw std::runtime_error("Failed to create graphics pipeline!");
-
-        for (auto& shaderModule : shaderModules)
-        {
-            ShaderManager::destroyShaderModule(shaderModule);
-        }
+        const std::string shaderName = bindless ? "deferred_off_bindless" : "deferred_off";
+
+        GraphicsPipelineDesc desc;
+        desc.name = "deferred offscreen";
+        desc.shaders = { {shaderType::VERTEX, shaderName}, {shaderType::FRAGMENT, shaderName} };
+        desc.vertexBinding = Attributes::DEFERRED_OFF::getBindingDescription();
+        desc.vertexAttributes = Attributes::DEFERRED_OFF::getAttributeDescriptions();
+        desc.layout = m_pipelineLayouts[scene_gbuffer];
+        desc.renderPass = m_renderPass.get();
+        desc.subpass = 0;
+        desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        // G-buffer attachments
+        desc.colorAttachmentCount = depth;
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_pipelines[scene_gbuffer]);
     }
 
     //-------------------------------- Pipeline OffScreen --------------------------------------
@@ -489,66 +437,31 @@ void DeferredRenderPass::createPipelines()
             throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-        // -------------------Shader Modules--------------------
-        const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "deferred_on"}, {shaderType::FRAGMENT, "deferred_on"} };
-
-        std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-        for (uint32_t i = 0; i < shaderInfos.size(); i++)
-        {
-            PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-            PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-        }
+        // Set 1: clustered lights
+        const std::vector<VkDescriptorSetLayout> setLayouts = {
+            m_descriptorSetLayouts[composition],
+            getRendererPointer()->getClusteredLights()->getDescriptorSetLayout()
+        };
 
-        // -Vertex input(attributes)
-        // Gets the binding and descriptions of the triangle's vertices and vertex attributes(one array containing both).
-        VkPipelineVertexInputStateCreateInfo emptyInputState{};
-        emptyInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-
-        // Pipeline
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-        VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0);
-        VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-        VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-        VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_FALSE, VK_COMPARE_OP_LESS_OR_EQUAL);
-        VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-        VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(VK_SAMPLE_COUNT_1_BIT, 0);
-        std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-        VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
-        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = PipelineManager::pipelineLayoutCreateInfo(&m_descriptorSetLayouts[composition]);
+        VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = PipelineManager::pipelineLayoutCreateInfo(setLayouts.data(), static_cast<uint32_t>(setLayouts.size()));
         vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutCreateInfo, nullptr, &m_pipelineLayouts[composition]);
 
-
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = shaderInfos.size();
-        pipelineInfo.pStages = shaderStagesInfos.data();
-
-        // Reference to all the structures describing the fixed-function stage
-        pipelineInfo.pVertexInputState = &emptyInputState;
-        pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizationState;
-        pipelineInfo.pMultisampleState = &multisampleState;
-        pipelineInfo.pDepthStencilState = &depthStencilState;
-        pipelineInfo.pColorBlendState = &colorBlendState;
-        pipelineInfo.pDynamicState = &dynamicState;
-        pipelineInfo.layout = m_pipelineLayouts[composition];
-        pipelineInfo.renderPass = m_renderPass.get();
-        pipelineInfo.subpass = 1;       // Important!!
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineInfo.basePipelineIndex = -1;
-
-        auto status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[composition]);
-
-        if (status != VK_SUCCESS)
-            throw std::runtime_error("Failed to create graphics pipeline!");
-
-        for (auto& shaderModule : shaderModules)
-        {
-            ShaderManager::destroyShaderModule(shaderModule);
-        }
+        // Full screen triangle: no vertex input.
+        GraphicsPipelineDesc desc;
+        desc.name = "deferred composition";
+        desc.shaders = { {shaderType::VERTEX, "deferred_on"}, {shaderType::FRAGMENT, "deferred_on"} };
+        desc.layout = m_pipelineLayouts[composition];
+        desc.renderPass = m_renderPass.get();
+        desc.subpass = 1;       // Important!!
+        desc.cullMode = VK_CULL_MODE_NONE;
+        desc.depthWriteEnable = VK_FALSE;
+        desc.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+        // The PCF kernel is unrolled.
+        ShaderVariantKey variantKey;
+        desc.specializationConstants = variantKey.getSpecializationConstants();
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_pipelines[composition]);
     }
 }
 
@@ -557,27 +470,42 @@ void DeferredRenderPass::updateUBO(
     const VkExtent2D& extent,
     const uint32_t& currentFrame
 ) {
-    m_shadowMap->updateUBO();
-    const glm::mat4 lightSpace = m_shadowMap->getLightSpace();
+    m_shadowMap->updateUBO(currentFrame);
 
     m_lightSphere->updateUBO();
     m_skyBox->updateUBO();
 
     // DeferredRenderPass
-    for (auto ptr : getRenderResource()->m_normalModels)
+    // Bindless: the model matrices come from the object buffer, view/proj are per frame.
+    if (!m_bindlessDescriptorSets.empty())
+    {
+        DescriptorTypes::UniformBufferObject::MVP  uboData1;
+        uboData1.model = glm::mat4(1.0f);
+        uboData1.view = getRenderResource()->m_camera.getViewMatrix();
+        uboData1.proj = getRenderResource()->m_camera.getJitteredProjectionMatrix();
+
+        void* data;
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame], &data);
+        memcpy(data, &uboData1, sizeof(uboData1));
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame]);
+    }
+    else
     {
-        for (uint32_t meshIndex : ptr->getMeshIndices())
+        for (auto ptr : getRenderResource()->m_normalModels)
         {
-            // update normal UBO 
-            DescriptorTypes::UniformBufferObject::MVP  uboData1;
-            uboData1.model = ptr->getModelMatrix();
-            uboData1.view = getRenderResource()->m_camera.getViewMatrix();
-            uboData1.proj = getRenderResource()->m_camera.getProjectionMatrix();
-    
-            void* data;
-            vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][0], &data);
-            memcpy(data, &uboData1, sizeof(uboData1));
-            vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][0]);
+            for (uint32_t meshIndex : ptr->getMeshIndices())
+            {
+                // update normal UBO 
+                DescriptorTypes::UniformBufferObject::MVP  uboData1;
+                uboData1.model = ptr->getModelMatrix();
+                uboData1.view = getRenderResource()->m_camera.getViewMatrix();
+                uboData1.proj = getRenderResource()->m_camera.getJitteredProjectionMatrix();
+
+                void* data;
+                vmaMapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 0), &data);
+                memcpy(data, &uboData1, sizeof(uboData1));
+                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 0));
+            }
         }
     }
 
@@ -586,36 +514,18 @@ void DeferredRenderPass::updateUBO(
     {
         DescriptorTypes::UniformBufferObject::Deferred uboData;
         uboData.cameraPos = glm::vec4(getRenderResource()->m_camera.getCameraPos(), 1.0f);
-        uboData.lightsCount = getRenderResource()->m_lightsInfo.size();
-        uboData.lightSpace = lightSpace;
+        uboData.invViewProj = glm::inverse(getRenderResource()->m_camera.getJitteredProjectionMatrix() * getRenderResource()->m_camera.getViewMatrix());
 
         void* data;
-        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_compositionUBOAllocation[0], &data);
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_compositionUBOAllocation[currentFrame], &data);
         memcpy(data, &uboData, sizeof(uboData) );
-        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_compositionUBOAllocation[0]);
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_compositionUBOAllocation[currentFrame]);
     }
-    
 
-    // Light Infos
-    {
-        DescriptorTypes::UniformBufferObject::LightInfo uboData[Config::LIGHTS_COUNT];
 
-        for (uint32_t i = 0; i < getRenderResource()->m_lightsInfo.size(); i++)
-        {
-            LightInfo info = getRenderResource()->m_lightsInfo[i];
-            uboData[i].pos = glm::vec4(info.pos, 1.0f);
-            uboData[i].color = glm::vec4(info.m_color, 1.0f);
-            uboData[i].dir = glm::vec4(info.m_targetPos - info.pos, 1.0f);
-            uboData[i].radius = 200.0f;
-            uboData[i].intensity = info.m_intensity;
-            uboData[i].type = (int)info.m_lightType;
-        }
-
-        void* data;
-        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_compositionUBOAllocation[1], &data);
-        memcpy(data, &uboData, sizeof(uboData[0]) * 10);
-        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_compositionUBOAllocation[1]);
-    }
+    // Lights
+    getRendererPointer()->getClusteredLights()->update(extent, currentFrame);
+    m_shadowAtlas->update(extent, currentFrame);
 }
 
 void DeferredRenderPass::draw(uint32_t imageIndex, uint32_t currentFrame)
@@ -627,141 +537,173 @@ void DeferredRenderPass::draw(uint32_t imageIndex, uint32_t currentFrame)
     // Specifies some details about the usage of this specific command buffer.
     CommandManager::cmdBeginCommandBuffer(commandBuffer, (VkCommandBufferUsageFlagBits)0);
 
-    ////ShadowMap
-    m_shadowMap->draw(imageIndex, currentFrame);
-
-    //--------------------------------RenderPass-----------------------------
-    VkExtent2D extent = getRendererPointer()->getSwapchainInfo().extent;
-    m_renderPass.begin(*m_swapchain_framebuffers[imageIndex], extent, m_clearValues, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
-
-    // һͨ
-    // ָG-Buffer
-    {
-        drawPipeline(commandBuffer, m_pipelines[scene_gbuffer], m_pipelineLayouts[scene_gbuffer], getRenderResource()->m_normalModels);
-    }
-
-    // ڶͨ
-    // ͨʹڵһͨG-BufferΪպϳɵ븽
-    {
-        vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[composition]);
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayouts[composition], 0, 1, &m_compositionDescriptorSet.get(), 0, NULL);
-        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-    
-        m_lightSphere->draw(commandBuffer);
-        m_skyBox->draw(commandBuffer);
-    }
-
-    m_renderPass.end(commandBuffer);
-
-    //GUI
-    m_GUI->draw(currentFrame, imageIndex);
+    //--------------------------------RenderGraph----------------------------
+    executeRenderGraph(commandBuffer, imageIndex, currentFrame);
 
     vkEndCommandBuffer(commandBuffer);
 }
 
 void DeferredRenderPass::createUBOs()
 {
-    for (auto ptr : getRenderResource()->m_normalModels)
+    if (getRendererPointer()->getBindlessMaterials())
     {
-        std::vector<size_t> uboSizeInfos = {
-               sizeof(DescriptorTypes::UniformBufferObject::MVP)
-        };
-        createUniformBuffer(ptr, uboSizeInfos);
+        m_frameUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT);
+        m_frameUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+        for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            BufferManager::bufferCreateBuffer(
+                getRendererPointer()->getVmaAllocator(),
+                sizeof(DescriptorTypes::UniformBufferObject::MVP),
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU,
+                &m_frameUBOs[i],
+                &m_frameUBOAllocations[i]
+            );
+        }
+    }
+    else
+    {
+        for (auto ptr : getRenderResource()->m_normalModels)
+        {
+            std::vector<size_t> uboSizeInfos = {
+                   sizeof(DescriptorTypes::UniformBufferObject::MVP)
+            };
+            createUniformBuffer(ptr, uboSizeInfos);
+        }
     }
 
 
 
     // --------------------  onscreen pass -------------------------
 
-    std::vector<size_t> uboSizeInfo = { 
-        sizeof(DescriptorTypes::UniformBufferObject::Deferred),
-        sizeof(DescriptorTypes::UniformBufferObject::LightInfo) * 10
-    };
-   
-    m_compositionUBO.resize(uboSizeInfo.size());
-    m_compositionUBOAllocation.resize(uboSizeInfo.size());
+    // Per frame in flight, as the G-Buffer's.
+    m_compositionUBO.resize(Config::MAX_FRAMES_IN_FLIGHT);
+    m_compositionUBOAllocation.resize(Config::MAX_FRAMES_IN_FLIGHT);
 
     //Normal
-    BufferManager::bufferCreateBuffer(
-        getRendererPointer()->getVmaAllocator(),
-        uboSizeInfo[0],
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_CPU_TO_GPU,
-        &m_compositionUBO[0],
-        &m_compositionUBOAllocation[0]
-    );
-
-    //Lights
-    BufferManager::bufferCreateBuffer(
-        getRendererPointer()->getVmaAllocator(),
-        uboSizeInfo[1],
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_CPU_TO_GPU,
-        &m_compositionUBO[1],
-        &m_compositionUBOAllocation[1]
-    );
+    for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
+    {
+        BufferManager::bufferCreateBuffer(
+            getRendererPointer()->getVmaAllocator(),
+            sizeof(DescriptorTypes::UniformBufferObject::Deferred),
+            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU,
+            &m_compositionUBO[frame],
+            &m_compositionUBOAllocation[frame]
+        );
+    }
 
 }
 
 void DeferredRenderPass::createDescriptorSets()
 {
-    for (auto ptr : getRenderResource()->m_normalModels)
+    //-------Pass offscreen(bindless) -----------
+    if (const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials())
     {
-        for (uint32_t meshIndex : ptr->getMeshIndices())
-        {
-            //-------Pass offscreen -----------
-            {
-                DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayouts[scene_gbuffer], &m_meshesDescriptorSetMap[meshIndex].get());
-
-                RenderMeshInfo& renderMeshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
+        m_bindlessDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+        m_cullingView = getRendererPointer()->getGPUCulling()->createView();
+        m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::DEFERRED_OFF_BINDLESS::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
 
-                std::vector<DescriptorSet::DescriptorSetWriteData> data{
-                  { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_meshesUBOMap[meshIndex][0], 0, VK_WHOLE_SIZE},
-
-                  { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->colorTexture.sampler->getSampler(),                 renderMeshInfo.ref_material->colorTexture.image->getImageView(),                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                  { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->metallic_RoughnessTexture.sampler->getSampler(),    renderMeshInfo.ref_material->metallic_RoughnessTexture.image->getImageView(),   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                  { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->emissiveTexture.sampler->getSampler(),              renderMeshInfo.ref_material->emissiveTexture.image->getImageView(),             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                  { 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->AOTexture.sampler->getSampler(),                    renderMeshInfo.ref_material->AOTexture.image->getImageView(),                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                  { 5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->normalTexture.sampler->getSampler(),                renderMeshInfo.ref_material->normalTexture.image->getImageView(),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                };
+        for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            m_descriptorAllocator.allocate(m_descriptorSetLayouts[scene_gbuffer], &m_bindlessDescriptorSets[i]);
+
+            VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_frameUBOs[i]);
+            VkDescriptorBufferInfo objectBufferInfo = DescriptorManager::descriptorBufferInfo(getRendererPointer()->getGPUCulling()->getObjectBuffer(i));
+            VkDescriptorBufferInfo materialBufferInfo = DescriptorManager::descriptorBufferInfo(bindless->getMaterialBuffer());
+
+            std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, &objectBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2, &materialBufferInfo),
+            };
+            vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+        }
+    }
+    else
+    {
+        // Per frame in flight: the UBOs are.
+        m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::DEFERRED_OFF::DESCRIPTORS_INFO, getRenderResource()->getNormalMeshCount() * Config::MAX_FRAMES_IN_FLIGHT);
 
-                m_meshesDescriptorSetMap[meshIndex].UpdateBindingData(data);
+        for (auto ptr : getRenderResource()->m_normalModels)
+        {
+            for (uint32_t meshIndex : ptr->getMeshIndices())
+            {
+                //-------Pass offscreen -----------
+                for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
+                {
+                    DescriptorSet& descriptorSet = m_meshesFrameDescriptorSetMap[meshIndex][frame];
+                    m_descriptorAllocator.allocate(m_descriptorSetLayouts[scene_gbuffer], &descriptorSet.get());
+
+                    RenderMeshInfo& renderMeshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
+
+                    std::vector<DescriptorSet::DescriptorSetWriteData> data{
+                      { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, getMeshUBO(meshIndex, frame, 0), 0, VK_WHOLE_SIZE},
+
+                      { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->colorTexture.sampler->getSampler(),                 renderMeshInfo.ref_material->colorTexture.image->getImageView(),                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                      { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->metallic_RoughnessTexture.sampler->getSampler(),    renderMeshInfo.ref_material->metallic_RoughnessTexture.image->getImageView(),   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                      { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->emissiveTexture.sampler->getSampler(),              renderMeshInfo.ref_material->emissiveTexture.image->getImageView(),             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                      { 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->AOTexture.sampler->getSampler(),                    renderMeshInfo.ref_material->AOTexture.image->getImageView(),                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                      { 5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->normalTexture.sampler->getSampler(),                renderMeshInfo.ref_material->normalTexture.image->getImageView(),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                    };
+
+                    descriptorSet.UpdateBindingData(data);
+                }
             }
         }
     }
 
     //-------Pass onscreen -----------
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::DEFERRED_ON::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
     {
-        DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayouts[composition], &m_compositionDescriptorSet.get());
+        m_descriptorAllocator.allocate(m_descriptorSetLayouts[composition], &m_compositionDescriptorSets[frame].get());
 
 
         std::vector<DescriptorSet::DescriptorSetWriteData> data{
-                 { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_compositionUBO[0], 0, VK_WHOLE_SIZE},
-                 { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_compositionUBO[1], 0, VK_WHOLE_SIZE},
+                 { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_compositionUBO[frame], 0, VK_WHOLE_SIZE},
 
-                 { 2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_colorAttachments[0]->getImageView(),  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
-                 { 3, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_colorAttachments[1]->getImageView(),  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                 { 4, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_colorAttachments[2]->getImageView(),  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                 { 5, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_colorAttachments[3]->getImageView(),  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                 { 6, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_colorAttachments[4]->getImageView(),  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                 { 7, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_colorAttachments[5]->getImageView(),  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.irradiance.sampler->getSampler(),             getRenderResource()->m_IBLResource.irradiance.image->getImageView(),            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.brdfLUT.sampler->getSampler(),                getRenderResource()->m_IBLResource.brdfLUT.image->getImageView(),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.prefiltered_Env.sampler->getSampler(),        getRenderResource()->m_IBLResource.prefiltered_Env.image->getImageView(),       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
 
-                 { 8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.irradiance.sampler->getSampler(),             getRenderResource()->m_IBLResource.irradiance.image->getImageView(),            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                 { 9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.brdfLUT.sampler->getSampler(),                getRenderResource()->m_IBLResource.brdfLUT.image->getImageView(),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
-                 { 10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.prefiltered_Env.sampler->getSampler(),        getRenderResource()->m_IBLResource.prefiltered_Env.image->getImageView(),       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_shadowMap->getSampler(),                                                       m_shadowMap->getShadowMapView(),                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 11,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_shadowMap->getCascadesBuffer(frame), 0, VK_WHOLE_SIZE},
 
-                 { 11,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_shadowMap->getSampler(),                                                       m_shadowMap->getImage()->getImageView(),                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+                 { 12,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_shadowAtlas->getSampler(),                                                     m_shadowAtlas->getImageView(),                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 13,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_shadowAtlas->getTilesBuffer(frame), 0, VK_WHOLE_SIZE}
         };
-        m_compositionDescriptorSet.UpdateBindingData(data);
+        m_compositionDescriptorSets[frame].UpdateBindingData(data);
 
     }
+    updateAttachmentDescriptorSets();
+}
+
+void DeferredRenderPass::updateAttachmentDescriptorSets()
+{
+    for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
+    {
+        std::vector<DescriptorSet::DescriptorSetWriteData> data{
+                 { 2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_renderGraph.getImageView(m_gBufferResources[albedo]),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 3, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_renderGraph.getImageView(m_gBufferResources[normal]),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 4, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_renderGraph.getImageView(m_gBufferResources[material]),             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 5, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_renderGraph.getImageView(m_gBufferResources[emissive]),             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                 { 6, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, m_renderGraph.getImageView(m_gBufferResources[depth]),                VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL }
+        };
+        m_compositionDescriptorSets[frame].UpdateBindingData(data);
+    }
 }
 
 
 void DeferredRenderPass::destroy()
 {
+    destroyStaticCaches();
+    m_descriptorAllocator.destroy();
+
+    if (!m_bindlessDescriptorSets.empty())
+        getRendererPointer()->getGPUCulling()->releaseView(m_cullingView);
+
     for (auto& framebuffer : m_swapchain_framebuffers)
         vkDestroyFramebuffer(getRendererPointer()->getDevice(), *framebuffer, nullptr);
 
@@ -773,15 +715,13 @@ void DeferredRenderPass::destroy()
         }
     }
 
+    for (uint32_t i = 0; i < m_frameUBOs.size(); ++i)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_frameUBOs[i], m_frameUBOAllocations[i]);
+
     for(int i = 0 ; i < m_compositionUBO.size(); i++)
         vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(),m_compositionUBO[i], m_compositionUBOAllocation[i]);
 
 
-    for (auto attachment : m_colorAttachments)
-        attachment->destroy();
-
-    m_depthAttacment->destroy();
-
     m_BRDFlut.image->destroy();
     m_BRDFlut.sampler->destroy();
 
@@ -791,6 +731,7 @@ void DeferredRenderPass::destroy()
     // ImGui
     m_GUI->destroy();
     m_shadowMap->destroy();
+    m_shadowAtlas->destroy();
     m_skyBox->destroy();
     m_lightSphere->destroy();
 
@@ -803,4 +744,5 @@ void DeferredRenderPass::destroy()
     }
   
     m_renderPass.destroy();
+    m_renderGraph.destroy();
 }
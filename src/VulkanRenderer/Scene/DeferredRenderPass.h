@@ -1,6 +1,7 @@
 #pragma once
 
-#include "VulkanRenderer/Features/ShadowMap.h"
+#include "VulkanRenderer/Features/CascadedShadowMap.h"
+#include "VulkanRenderer/Features/ShadowAtlas.h"
 
 #include "VulkanRenderer/Scene/ScenePassBase.h"
 
@@ -14,18 +15,28 @@ public:
 		PIPELINE_NUM
 	};
 
+	// G-Buffer, the position is rebuilt from the depth.
 	enum AttachmentEnum
 	{
-		position = 0,
+		albedo = 0,
 		normal,
-		albedo,
-		metallic_roughness,
+		// Metallic, roughness, AO
+		material,
 		emissive,
-		ao,
 		depth,
 		ATTACHMENT_NUM
 	};
 
+	// Per color AttachmentEnum: 16 bytes per pixel instead of 96. Preferred
+	// formats, see m_gBufferFormats.
+	inline static const VkFormat G_BUFFER_FORMATS[depth] = {
+		VK_FORMAT_R8G8B8A8_SRGB,
+		// Octahedral
+		VK_FORMAT_R16G16_SNORM,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_FORMAT_R8G8B8A8_SRGB
+	};
+
 	DeferredRenderPass();
 
 	~DeferredRenderPass();
@@ -35,7 +46,8 @@ public:
 	virtual void draw(uint32_t imageIndex, uint32_t frameIndex) override;
 
 
-	const std::shared_ptr<ShadowMap> getShadowMap() const { return m_shadowMap; }
+	const std::shared_ptr<CascadedShadowMap> getShadowMap() const { return m_shadowMap; }
+	const std::shared_ptr<ShadowAtlas> getShadowAtlas() const { return m_shadowAtlas; }
 
 	virtual void destroy() override;
 
@@ -49,11 +61,18 @@ private:
 
 	virtual void createUBOs() override;
 	virtual void createDescriptorSets() override;
+	// G-Buffer input attachments of the composition sets.
+	virtual void updateAttachmentDescriptorSets() override;
 
+	// Shadow cascades, shadow atlas, light clustering, G-Buffer and composition(G-Buffer is transient),
+	// Hi-Z occlusion, motion vectors and TAA, upscale to the swapchain then GUI.
+	void createRenderGraph();
 
 
-	//Shadow Map
-	std::shared_ptr<ShadowMap>				m_shadowMap;
+	// Cascaded shadow map of the directional light
+	std::shared_ptr<CascadedShadowMap>		m_shadowMap;
+	// Point and spot light shadows
+	std::shared_ptr<ShadowAtlas>			m_shadowAtlas;
 
 	std::shared_ptr<LightSphere>			m_lightSphere;
 
@@ -65,5 +84,20 @@ private:
 	// composition
 	std::vector <VkBuffer>					m_compositionUBO;
 	std::vector <VmaAllocation>				m_compositionUBOAllocation;
-	DescriptorSet							m_compositionDescriptorSet;
+	// Per frame in flight: the shadow buffers are.
+	std::array<DescriptorSet, Config::MAX_FRAMES_IN_FLIGHT>	m_compositionDescriptorSets;
+
+	// Bindless G-Buffer: view/proj UBO, per frame.
+	std::vector<VkBuffer>					m_frameUBOs;
+	std::vector<VmaAllocation>				m_frameUBOAllocations;
+
+	RenderGraph::Resource					m_shadowMapResource;
+	RenderGraph::Resource					m_shadowAtlasResource;
+	// Per color AttachmentEnum: G_BUFFER_FORMATS, the normal falls back to
+	// R16G16_SFLOAT where R16G16_SNORM can't be a color attachment(optional).
+	std::vector<VkFormat>					m_gBufferFormats;
+	// Per AttachmentEnum.
+	std::vector<RenderGraph::Resource>		m_gBufferResources;
+	// Composited color, in the top left render extent.
+	RenderGraph::Resource					m_sceneColorResource;
 };
\ No newline at end of file
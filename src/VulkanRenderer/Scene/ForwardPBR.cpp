@@ -1,10 +1,12 @@
 #include "VulkanRenderer/Scene/ForwardPBR.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "VulkanRenderer/Renderer.h"
 
 #include "VulkanRenderer/Math/MathUtils.h"
+#include "VulkanRenderer/Pipeline/ShaderVariants.h"
 
 ForwardPBRPass::ForwardPBRPass() 
 {
@@ -25,6 +27,8 @@ ForwardPBRPass::ForwardPBRPass()
 
     initComputations();
 
+    // The framebuffers use the graph's attachments.
+    createRenderGraph();
     createSwapchainFramebuffers();
 }
 
@@ -35,7 +39,7 @@ void ForwardPBRPass::initComputations()
         sizeof(float),
         2 * sizeof(float) * Config::BRDF_HEIGHT * Config::BRDF_WIDTH,
         getRendererPointer()->getQueueFamilyIndices(),
-        getRendererPointer()->getDescriptorPool(),
+        m_descriptorAllocator,
         COMPUTE_PIPELINE::BRDF::BUFFERS_INFO
     );
 }
@@ -48,6 +52,8 @@ void ForwardPBRPass::createRenderPass()
     VkFormat format = getRendererPointer()->getSwapchainInfo().image_format;
     VkFormat depthBufferFormat = getRendererPointer()->getDepthImageInfo().depth_image_format;
     VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
+    // Without MSAA the color attachment is the scene color itself(no resolve).
+    const bool isMultisampled = msaaSamplesCount != VK_SAMPLE_COUNT_1_BIT;
 
     // - Attachments
     
@@ -57,7 +63,8 @@ void ForwardPBRPass::createRenderPass()
         format,
         msaaSamplesCount,
         VK_ATTACHMENT_LOAD_OP_CLEAR,
-        VK_ATTACHMENT_STORE_OP_STORE,
+        // Only the resolved image is used after the pass.
+        isMultisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
         VK_IMAGE_LAYOUT_UNDEFINED,
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         colorAttachment
@@ -70,8 +77,8 @@ void ForwardPBRPass::createRenderPass()
         depthBufferFormat,
         msaaSamplesCount,
         VK_ATTACHMENT_LOAD_OP_CLEAR,
-        // We don't care about storing the depth data, because it will not be used after drawing has finished.
-        VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        // Reduced to the Hi-Z pyramid of the occlusion culling.
+        VK_ATTACHMENT_STORE_OP_STORE,
         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         VK_ATTACHMENT_STORE_OP_DONT_CARE,
         // Just like the color buffer, we don't care about the previous depth contents.
@@ -91,8 +98,7 @@ void ForwardPBRPass::createRenderPass()
         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         VK_ATTACHMENT_STORE_OP_DONT_CARE,
         VK_IMAGE_LAYOUT_UNDEFINED,
-        // Here is not 'VK_IMAGE_LAYOUT_PRESENT_SRC_KHR'
-        // because the GUI will be the last and the one to present.
+        // Scene color, the upscale pass copies it to the swapchain.
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         colorResolveAttachment
     );
@@ -111,12 +117,18 @@ void ForwardPBRPass::createRenderPass()
 
 
     // - Subpasses
+    // Depth prepass(empty when disabled), fills the depth the shading is tested against.
+    VkSubpassDescription depthSubPassDescript{};
+    depthSubPassDescript.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    depthSubPassDescript.colorAttachmentCount = 0;
+    depthSubPassDescript.pDepthStencilAttachment = &depthAttachmentRef;
+
     VkSubpassDescription subPassDescript{};
     SubPassUtils::createSubPassDescription(
         VK_PIPELINE_BIND_POINT_GRAPHICS,
         &colorAttachmentRef,
         &depthAttachmentRef,
-        &colorResolveAttachmentRef,
+        isMultisampled ? &colorResolveAttachmentRef : nullptr,
         subPassDescript
     );
 
@@ -138,12 +150,29 @@ void ForwardPBRPass::createRenderPass()
         dependency
     );
 
+    // Depth written by the prepass, tested(and written without prepass) by the shading.
+    VkSubpassDependency prepassDependency{};
+    SubPassUtils::createSubPassDependency(
+        0,
+        (VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT),
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        1,
+        (VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT),
+        (VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT),
+        VK_DEPENDENCY_BY_REGION_BIT,
+        prepassDependency
+    );
+
+
 
+    std::vector<VkAttachmentDescription> attachments = { colorAttachment, depthAttachment };
+    if (isMultisampled)
+        attachments.push_back(colorResolveAttachment);
 
     m_renderPass = RenderPass(
-        { colorAttachment, depthAttachment, colorResolveAttachment },
-        { subPassDescript },
-        { dependency }
+        attachments,
+        { depthSubPassDescript, subPassDescript },
+        { dependency, prepassDependency }
     );
 }
 
@@ -157,10 +186,12 @@ void ForwardPBRPass::createSwapchainFramebuffers()
         m_swapchain_framebuffers[i] = new VkFramebuffer;
 
         std::vector<VkImageView> attachments = {
-            *getRendererPointer()->getMSAAInfo().msaa_image_view,
-            *getRendererPointer()->getDepthImageInfo().depth_image_view,
-            *getRendererPointer()->getSwapchainInfo().imageViews[i]
+            m_renderGraph.getImageView(m_colorResource),
+            m_renderGraph.getImageView(m_depthResource)
         };
+        // Resolve attachment
+        if (m_colorResource != m_sceneColorResource)
+            attachments.push_back(m_renderGraph.getImageView(m_sceneColorResource));
 
         FramebufferManager::createFramebuffer(
             getRendererPointer()->getDevice(),
@@ -174,20 +205,131 @@ void ForwardPBRPass::createSwapchainFramebuffers()
     }
 }
 
+void ForwardPBRPass::createRenderGraph()
+{
+    const VkFormat format = getRendererPointer()->getSwapchainInfo().image_format;
+    const VkFormat depthBufferFormat = getRendererPointer()->getDepthImageInfo().depth_image_format;
+    const VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
+
+    importSwapchain();
+    // Sampled by the previous frame's forward pass.
+    m_shadowMapResource = m_renderGraph.importImage("shadow map", VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    m_renderGraph.setImportedImage(m_shadowMapResource, m_shadowMap->getImage()->getImage(), m_shadowMap->getShadowMapView());
+    // Cleared every frame.
+    m_shadowAtlasResource = m_renderGraph.importImage("shadow atlas", VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    m_renderGraph.setImportedImage(m_shadowAtlasResource, m_shadowAtlas->getImage()->getImage(), m_shadowAtlas->getImageView());
+
+    m_sceneColorResource = m_renderGraph.createImage("scene color", { m_extent, format, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT });
+    // 1x: the pass draws in the scene color directly.
+    m_colorResource = (msaaSamplesCount != VK_SAMPLE_COUNT_1_BIT) ? m_renderGraph.createImage("msaa color", { m_extent, format, VK_IMAGE_ASPECT_COLOR_BIT, msaaSamplesCount }) : m_sceneColorResource;
+    m_depthResource = m_renderGraph.createImage("depth", { m_extent, depthBufferFormat, VK_IMAGE_ASPECT_DEPTH_BIT, msaaSamplesCount });
+
+    m_renderGraph.addPass("shadow map",
+        [&](RenderGraph::PassBuilder& builder) {
+            // Cascades not re-rendered keep last frame's depth, all are left ready to be sampled.
+            builder.write(m_shadowMapResource, RenderGraphAccess::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            // GPU culling writes the indirect draw buffers.
+            builder.setSideEffect();
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_shadowMap->draw(imageIndex, currentFrame);
+        }
+    );
+
+    m_renderGraph.addPass("shadow atlas",
+        [&](RenderGraph::PassBuilder& builder) {
+            // The render pass leaves it ready to be sampled.
+            builder.write(m_shadowAtlasResource, RenderGraphAccess::DEPTH_ATTACHMENT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_shadowAtlas->draw(imageIndex, currentFrame);
+        }
+    );
+
+    m_renderGraph.addPass("light clustering",
+        [&](RenderGraph::PassBuilder& builder) {
+            // Writes the per cluster light lists(buffers).
+            builder.setSideEffect();
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            getRendererPointer()->getClusteredLights()->build(commandBuffer, currentFrame);
+        }
+    );
+
+    m_renderGraph.addPass("forward PBR",
+        [&](RenderGraph::PassBuilder& builder) {
+            builder.read(m_shadowMapResource, RenderGraphAccess::SAMPLED);
+            builder.read(m_shadowAtlasResource, RenderGraphAccess::SAMPLED);
+            builder.write(m_colorResource, RenderGraphAccess::COLOR_ATTACHMENT);
+            builder.write(m_depthResource, RenderGraphAccess::DEPTH_ATTACHMENT);
+            // Resolve attachment
+            if (m_colorResource != m_sceneColorResource)
+                builder.write(m_sceneColorResource, RenderGraphAccess::COLOR_ATTACHMENT);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            // Read by both subpasses' indirect draws.
+            cullIndirect(commandBuffer, currentFrame);
+
+            // Only the render extent is drawn(dynamic resolution).
+            m_renderPass.begin(*m_swapchain_framebuffers[imageIndex], getRendererPointer()->getRenderExtent(), m_clearValues, commandBuffer, getSubpassContents());
+
+            // Depth prepass: every covered pixel is then shaded once(EQUAL test).
+            const bool isDepthPrepassEnabled = getRendererPointer()->isDepthPrepassEnabled();
+            if (isDepthPrepassEnabled)
+                drawPipeline(commandBuffer, currentFrame, imageIndex, 0, m_depthPrepassPipeline, m_pipelineLayouts[PipelineIndex::main_pipeline], getRenderResource()->m_normalModels);
+
+            vkCmdNextSubpass(commandBuffer, getSubpassContents());
+
+            const VkPipeline& pipeline = isDepthPrepassEnabled ? m_prepassedPipeline : m_pipelines[PipelineIndex::main_pipeline];
+            drawPipeline(commandBuffer, currentFrame, imageIndex, 1, pipeline, m_pipelineLayouts[PipelineIndex::main_pipeline], getRenderResource()->m_normalModels);
+
+            drawInline(commandBuffer, currentFrame, imageIndex, 1, [&](VkCommandBuffer& cb) {
+                {
+                    GPUProfiler::Scope scope(cb, currentFrame, "light spheres");
+                    m_lightSphere->draw(cb);
+                }
+                GPUProfiler::Scope scope(cb, currentFrame, "skybox");
+                m_skyBox->draw(cb);
+            });
+
+            m_renderPass.end(commandBuffer);
+        }
+    );
+
+    addOcclusionPass(m_depthResource, msaaSamplesCount);
+    addUpscalePass(m_sceneColorResource, addTemporalAAPasses(m_sceneColorResource));
+
+    m_renderGraph.addPass("GUI",
+        [&](RenderGraph::PassBuilder& builder) {
+            // The GUI render pass presents.
+            builder.write(m_swapchainResource, RenderGraphAccess::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_GUI->draw(currentFrame, imageIndex);
+        }
+    );
+
+    compileRenderGraph();
+}
+
 void ForwardPBRPass::createSecondaryFeatures()
 {
     //ShadowMap
-    const VkExtent2D swapChainExtent = getRendererPointer()->getSwapchainInfo().extent;
-    const VkExtent2D shadowExtent = { 2 * swapChainExtent.height, 2 * swapChainExtent.width };
+    m_shadowMap = std::make_shared<CascadedShadowMap>(
+        Config::SHADOW_CASCADE_RESOLUTION,
+        getRendererPointer()->getDepthImageInfo().depth_image_format,
+        Config::SHADOW_CASCADE_LAMBDA,
+        Config::SHADOW_CASCADE_COUNT
+        );
 
-    m_shadowMap = std::make_shared<ShadowMap>(
-        shadowExtent,
-        getRendererPointer()->getSwapchainInfo().imageViews.size(),
+    m_shadowAtlas = std::make_shared<ShadowAtlas>(
+        Config::SHADOW_ATLAS_RESOLUTION,
         getRendererPointer()->getDepthImageInfo().depth_image_format,
-        Config::MAX_FRAMES_IN_FLIGHT
+        m_shadowMap
         );
 
-    uint32_t subPassIndex = 0;
+    // Shading subpass, after the depth prepass.
+    uint32_t subPassIndex = 1;
     m_skyBox = std::make_shared<SkyBox>(m_renderPass.get(), getRendererPointer()->getMSAAInfo().msaa_sampleCount, subPassIndex);
     m_lightSphere = std::make_shared<LightSphere>(m_renderPass.get(), getRendererPointer()->getMSAAInfo().msaa_sampleCount, subPassIndex);
     
@@ -215,9 +357,13 @@ void ForwardPBRPass::createPipelines()
 
     VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
 
+    // Bindless variant when the device supports it: one set 0 per frame plus the
+    // material textures(set 1), instead of one set per mesh.
+    const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials();
+
     //-------------------------------- PBR Pipeline --------------------------------------
     {
-        const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::PBR::DESCRIPTORS_INFO;
+        const std::vector<DescriptorInfo>& descriptorInfo = bindless ? GRAPHICS_PIPELINE::PBR_BINDLESS::DESCRIPTORS_INFO : GRAPHICS_PIPELINE::PBR::DESCRIPTORS_INFO;
 
         std::vector<VkDescriptorSetLayoutBinding> bindings(descriptorInfo.size());
         for (uint32_t i = 0; i < descriptorInfo.size(); i++)
@@ -238,88 +384,59 @@ void ForwardPBRPass::createPipelines()
             throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-        // -------------------Shader Modules--------------------
-        const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "scene"}, {shaderType::FRAGMENT, "scene"} };
-
-        std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-        for (uint32_t i = 0; i < shaderInfos.size(); i++)
-        {
-            PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-            PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-        }
-
+        // Pipeline layout, set 1: clustered lights(set 2 when bindless)
+        std::vector<VkDescriptorSetLayout> setLayouts = { m_descriptorSetLayouts[PipelineIndex::main_pipeline] };
+        if (bindless)
+            setLayouts.push_back(bindless->getDescriptorSetLayout());
+        setLayouts.push_back(getRendererPointer()->getClusteredLights()->getDescriptorSetLayout());
 
-        // Dynamic states
-        std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-        VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
-        // Viewport
-        VkViewport viewport{};
-        PipelineManager::createViewport(viewport, m_extent);
-        // Scissor
-        VkRect2D scissor{};
-        PipelineManager::createScissor(scissor, m_extent);
-        // Viewport state info
-        VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-        // Vertex input(attributes)
-        std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::PBR::getAttributeDescriptions();
-        VkVertexInputBindingDescription bindingDescription = Attributes::PBR::getBindingDescription();
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-        // Input assembly
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-        // Rasterizer
-        VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0, VK_FALSE);
-        // Multisampling 
-        VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(msaaSamplesCount, 0);
-        // Color blending(attachment)
-        VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-        // Color blending(global)
-        VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-
-        // Pipeline layout
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayouts[PipelineIndex::main_pipeline];
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
         pipelineLayoutInfo.pushConstantRangeCount = 0;
         pipelineLayoutInfo.pPushConstantRanges = nullptr;
         auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[PipelineIndex::main_pipeline]);
         if (status != VK_SUCCESS)
             throw std::runtime_error("Failed to create pipeline layout!");
 
-        // Depth and stencil
-        VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS);
-
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = shaderInfos.size();
-        pipelineInfo.pStages = shaderStagesInfos.data();
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizationState;
-        pipelineInfo.pMultisampleState = &multisampleState;
-        pipelineInfo.pDepthStencilState = &depthStencilState;
-        pipelineInfo.pColorBlendState = &colorBlendState;
-        pipelineInfo.pDynamicState = &dynamicState;
-        pipelineInfo.pTessellationState = nullptr;
-        pipelineInfo.pNext = nullptr;
-        pipelineInfo.layout = m_pipelineLayouts[PipelineIndex::main_pipeline];
-        pipelineInfo.renderPass = m_renderPass.get();
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineInfo.basePipelineIndex = -1;
-
-        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[PipelineIndex::main_pipeline]);
-        if (status != VK_SUCCESS)
-            throw std::runtime_error("Failed to create graphics pipeline!");
-
-        for (auto& shaderModule : shaderModules)
-        {
-            ShaderManager::destroyShaderModule(shaderModule);
-        }
+        const std::string shaderName = bindless ? "sceneBindless" : "scene";
+
+        GraphicsPipelineDesc desc;
+        desc.name = "forward PBR";
+        desc.shaders = { {shaderType::VERTEX, shaderName}, {shaderType::FRAGMENT, shaderName} };
+        desc.vertexBinding = Attributes::PBR::getBindingDescription();
+        desc.vertexAttributes = Attributes::PBR::getAttributeDescriptions();
+        desc.layout = m_pipelineLayouts[PipelineIndex::main_pipeline];
+        desc.renderPass = m_renderPass.get();
+        desc.subpass = 1;
+        desc.sampleCount = msaaSamplesCount;
+
+        // The PCF kernel is unrolled.
+        ShaderVariantKey variantKey;
+        desc.specializationConstants = variantKey.getSpecializationConstants();
+
+        getRendererPointer()->getPipelineCompiler().add(desc, &m_pipelines[PipelineIndex::main_pipeline]);
+
+        // Shading after the depth prepass: the depth is final, only the visible
+        // fragments pass.
+        GraphicsPipelineDesc prepassedDesc = desc;
+        prepassedDesc.name = "forward PBR(after depth prepass)";
+        prepassedDesc.depthWriteEnable = VK_FALSE;
+        prepassedDesc.depthCompareOp = VK_COMPARE_OP_EQUAL;
+
+        getRendererPointer()->getPipelineCompiler().add(prepassedDesc, &m_prepassedPipeline);
+
+        // Depth prepass: same layout and sets, position only, no fragment shader.
+        GraphicsPipelineDesc prepassDesc = desc;
+        prepassDesc.name = "forward depth prepass";
+        prepassDesc.shaders = { {shaderType::VERTEX, bindless ? "depthPrepassBindless" : "depthPrepass"} };
+        prepassDesc.vertexAttributes = { Attributes::PBR::getAttributeDescriptions()[0] };
+        prepassDesc.subpass = 0;
+        prepassDesc.colorAttachmentCount = 0;
+        prepassDesc.specializationConstants.clear();
+
+        getRendererPointer()->getPipelineCompiler().add(prepassDesc, &m_depthPrepassPipeline);
     }
 }
 
@@ -328,67 +445,74 @@ void ForwardPBRPass::updateUBO(
     const VkExtent2D& extent,
     const uint32_t& currentFrame
 ) {
-    m_shadowMap->updateUBO();
+    m_shadowMap->updateUBO(currentFrame);
     m_lightSphere->updateUBO();
     m_skyBox->updateUBO();
 
-    const glm::mat4 lightSpace1 = m_shadowMap->getLightSpace();
+    // Unused by scene.vert, the shading picks a cascade(cascadedShadows.glsl).
+    const glm::mat4 lightSpace1 = m_shadowMap->getLightSpace(0);
 
     UBOinfo uboInfo = {
         getRenderResource()->m_camera.getCameraPos(),
         getRenderResource()->m_camera.getViewMatrix(),
-        getRenderResource()->m_camera.getProjectionMatrix(),
+        getRenderResource()->m_camera.getJitteredProjectionMatrix(),
         lightSpace1,
         getRenderResource()->m_lightsInfo.size(),
         extent
     };
 
-    // ForwardPBRPass
-
-    for (auto ptr : getRenderResource()->m_normalModels)
+    // Bindless: the model matrices come from the object buffer, the rest is per frame.
+    if (!m_bindlessDescriptorSets.empty())
     {
-        for (uint32_t meshIndex : ptr->getMeshIndices())
+        DescriptorTypes::UniformBufferObject::NormalPBR  uboData1;
+        uboData1.model = glm::mat4(1.0f);
+        uboData1.view = uboInfo.view;
+        uboData1.proj = uboInfo.proj;
+        uboData1.lightSpace = uboInfo.lightSpace;
+
+        uboData1.cameraPos = glm::vec4(uboInfo.cameraPos, 1.0f);
+        uboData1.lightsCount = uboInfo.lightsCount;
+
+        void* data;
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame], &data);
+        memcpy(data, &uboData1, sizeof(uboData1));
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame]);
+    }
+    else
+    {
+        // Per mesh(model matrix).
+        for (auto ptr : getRenderResource()->m_normalModels)
         {
-            // update normal UBO 
+            for (uint32_t meshIndex : ptr->getMeshIndices())
             {
-                DescriptorTypes::UniformBufferObject::NormalPBR  uboData1;
-                uboData1.model = ptr->getModelMatrix();
-                uboData1.view = uboInfo.view;
-                uboData1.proj = uboInfo.proj;
-                uboData1.lightSpace = uboInfo.lightSpace;
-
-                uboData1.cameraPos = glm::vec4(uboInfo.cameraPos, 1.0f);
-                uboData1.lightsCount = uboInfo.lightsCount;
-
-                void* data;
-                vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][0], &data);
-                memcpy(data, &uboData1, sizeof(uboData1));
-                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][0]);
-            }
-
-
-            // update lights UBO
-            {
-                DescriptorTypes::UniformBufferObject::LightInfo uboData2[Config::LIGHTS_COUNT];
-
-                for (uint32_t i = 0; i < getRenderResource()->m_lightsInfo.size(); i++)
+                // update normal UBO 
                 {
-                    LightInfo info = getRenderResource()->m_lightsInfo[i];
-                    uboData2[i].pos = glm::vec4(info.pos, 1.0f);
-                    uboData2[i].color = glm::vec4(info.m_color, 1.0f);
-                    uboData2[i].dir = glm::vec4(info.m_targetPos - info.pos, 1.0f);
-                    uboData2[i].intensity = info.m_intensity;
-                    uboData2[i].type = (int)info.m_lightType;
+                    DescriptorTypes::UniformBufferObject::NormalPBR  uboData1;
+                    uboData1.model = ptr->getModelMatrix();
+                    uboData1.view = uboInfo.view;
+                    uboData1.proj = uboInfo.proj;
+                    uboData1.lightSpace = uboInfo.lightSpace;
+
+                    uboData1.cameraPos = glm::vec4(uboInfo.cameraPos, 1.0f);
+                    uboData1.lightsCount = uboInfo.lightsCount;
+
+                    void* data;
+                    vmaMapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 0), &data);
+                    memcpy(data, &uboData1, sizeof(uboData1));
+                    vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 0));
                 }
-
-                void* data;
-                vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][1], &data);
-                memcpy(data, &uboData2, sizeof(uboData2[0]) * 10);
-                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][1]);
             }
-
         }
     }
+
+    // Lights
+    getRendererPointer()->getClusteredLights()->update(extent, currentFrame);
+    m_shadowAtlas->update(extent, currentFrame);
+}
+
+VkDescriptorSet ForwardPBRPass::getFrameDescriptorSet(const uint32_t currentFrame)
+{
+    return getRendererPointer()->getClusteredLights()->getDescriptorSet(currentFrame);
 }
 
 void ForwardPBRPass::draw(uint32_t imageIndex, uint32_t currentFrame)
@@ -400,35 +524,38 @@ void ForwardPBRPass::draw(uint32_t imageIndex, uint32_t currentFrame)
     // Specifies some details about the usage of this specific command buffer.
     CommandManager::cmdBeginCommandBuffer(commandBuffer, (VkCommandBufferUsageFlagBits)0);
 
-    //ShadowMap
-    m_shadowMap->draw(imageIndex, currentFrame);
-
-    //--------------------------------RenderPass-----------------------------
-    VkExtent2D extent = getRendererPointer()->getSwapchainInfo().extent;
-    m_renderPass.begin(*m_swapchain_framebuffers[imageIndex],extent , m_clearValues, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
-    
-    drawPipeline(commandBuffer, m_pipelines[PipelineIndex::main_pipeline], m_pipelineLayouts[PipelineIndex::main_pipeline], getRenderResource()->m_normalModels);
-
-
-    m_lightSphere->draw(commandBuffer);
-    m_skyBox->draw(commandBuffer);
-    
-    m_renderPass.end(commandBuffer);
-
-    //GUI
-    m_GUI->draw(currentFrame, imageIndex);
+    //--------------------------------RenderGraph----------------------------
+    executeRenderGraph(commandBuffer, imageIndex, currentFrame);
 
     vkEndCommandBuffer(commandBuffer);
 }
 
 void ForwardPBRPass::createUBOs()
 {
+    if (getRendererPointer()->getBindlessMaterials())
+    {
+        m_frameUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT);
+        m_frameUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+        for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            BufferManager::bufferCreateBuffer(
+                getRendererPointer()->getVmaAllocator(),
+                sizeof(DescriptorTypes::UniformBufferObject::NormalPBR),
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU,
+                &m_frameUBOs[i],
+                &m_frameUBOAllocations[i]
+            );
+        }
+        return;
+    }
+
     //Normal models
     for (auto ptr : getRenderResource()->m_normalModels)
     {
         std::vector<size_t> uboSizeInfos = {
-               sizeof(DescriptorTypes::UniformBufferObject::NormalPBR),         
-               sizeof(DescriptorTypes::UniformBufferObject::LightInfo) * 10     
+               sizeof(DescriptorTypes::UniformBufferObject::NormalPBR)
         };
         createUniformBuffer(ptr, uboSizeInfos);
     }
@@ -436,19 +563,64 @@ void ForwardPBRPass::createUBOs()
 
 void ForwardPBRPass::createDescriptorSets()
 {
+    //-----------------------------  Bindless DescriptorSets  -------------------------------
+    if (const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials())
+    {
+        m_bindlessDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+        m_cullingView = getRendererPointer()->getGPUCulling()->createView();
+        m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::PBR_BINDLESS::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+
+        const IBLResource& ibl = getRenderResource()->m_IBLResource;
+
+        for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            m_descriptorAllocator.allocate(m_descriptorSetLayouts[PipelineIndex::main_pipeline], &m_bindlessDescriptorSets[i]);
+
+            VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_frameUBOs[i]);
+            VkDescriptorBufferInfo objectBufferInfo = DescriptorManager::descriptorBufferInfo(getRendererPointer()->getGPUCulling()->getObjectBuffer(i));
+            VkDescriptorBufferInfo materialBufferInfo = DescriptorManager::descriptorBufferInfo(bindless->getMaterialBuffer());
+            VkDescriptorImageInfo irradianceInfo = DescriptorManager::descriptorImageInfo(ibl.irradiance.sampler->getSampler(), ibl.irradiance.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            VkDescriptorImageInfo brdfLUTInfo = DescriptorManager::descriptorImageInfo(ibl.brdfLUT.sampler->getSampler(), ibl.brdfLUT.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            VkDescriptorImageInfo prefilteredEnvInfo = DescriptorManager::descriptorImageInfo(ibl.prefiltered_Env.sampler->getSampler(), ibl.prefiltered_Env.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            VkDescriptorImageInfo shadowMapInfo = DescriptorManager::descriptorImageInfo(m_shadowMap->getSampler(), m_shadowMap->getShadowMapView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            VkDescriptorBufferInfo cascadesInfo = DescriptorManager::descriptorBufferInfo(m_shadowMap->getCascadesBuffer(i));
+            VkDescriptorImageInfo shadowAtlasInfo = DescriptorManager::descriptorImageInfo(m_shadowAtlas->getSampler(), m_shadowAtlas->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            VkDescriptorBufferInfo tilesInfo = DescriptorManager::descriptorBufferInfo(m_shadowAtlas->getTilesBuffer(i));
+
+            std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &objectBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4, &materialBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 7, &irradianceInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 8, &brdfLUTInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 9, &prefilteredEnvInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 10, &shadowMapInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 11, &cascadesInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 12, &shadowAtlasInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 13, &tilesInfo),
+            };
+            vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+        }
+        return;
+    }
+
     //-------------------------------  PBR DescriptorSet  ----------------------------------
+    // Per frame in flight: the UBOs and the shadow buffers are.
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::PBR::DESCRIPTORS_INFO, getRenderResource()->getNormalMeshCount() * Config::MAX_FRAMES_IN_FLIGHT);
+
     for (auto ptr : getRenderResource()->m_normalModels)
     {
         for (uint32_t meshIndex : ptr->getMeshIndices())
         {
+            for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
             {
-                DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayouts[PipelineIndex::main_pipeline], &m_meshesDescriptorSetMap[meshIndex].get());
+                DescriptorSet& descriptorSet = m_meshesFrameDescriptorSetMap[meshIndex][frame];
+                m_descriptorAllocator.allocate(m_descriptorSetLayouts[PipelineIndex::main_pipeline], &descriptorSet.get());
 
                 RenderMeshInfo& renderMeshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
 
                 std::vector<DescriptorSet::DescriptorSetWriteData> data{
-                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_meshesUBOMap[meshIndex][0], 0, VK_WHOLE_SIZE},
-                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_meshesUBOMap[meshIndex][1], 0, VK_WHOLE_SIZE},
+                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, getMeshUBO(meshIndex, frame, 0), 0, VK_WHOLE_SIZE},
 
                     { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->colorTexture.sampler->getSampler(),                 renderMeshInfo.ref_material->colorTexture.image->getImageView(),                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
                     { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->metallic_RoughnessTexture.sampler->getSampler(),    renderMeshInfo.ref_material->metallic_RoughnessTexture.image->getImageView(),   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
@@ -460,10 +632,14 @@ void ForwardPBRPass::createDescriptorSets()
                     { 8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.brdfLUT.sampler->getSampler(),                getRenderResource()->m_IBLResource.brdfLUT.image->getImageView(),               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
                     { 9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_IBLResource.prefiltered_Env.sampler->getSampler(),        getRenderResource()->m_IBLResource.prefiltered_Env.image->getImageView(),       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
 
-                    { 10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_shadowMap->getSampler(),                                                       m_shadowMap->getImage()->getImageView(),                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
+                    { 10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_shadowMap->getSampler(),                                                       m_shadowMap->getShadowMapView(),                                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                    { 11,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_shadowMap->getCascadesBuffer(frame), 0, VK_WHOLE_SIZE},
+
+                    { 12,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_shadowAtlas->getSampler(),                                                     m_shadowAtlas->getImageView(),                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+                    { 13,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_shadowAtlas->getTilesBuffer(frame), 0, VK_WHOLE_SIZE}
                 };
                
-                m_meshesDescriptorSetMap[meshIndex].UpdateBindingData(data);
+                descriptorSet.UpdateBindingData(data);
             }
         }
     }
@@ -473,6 +649,12 @@ void ForwardPBRPass::createDescriptorSets()
 
 void ForwardPBRPass::destroy()
 {
+    destroyStaticCaches();
+    m_descriptorAllocator.destroy();
+
+    if (!m_bindlessDescriptorSets.empty())
+        getRendererPointer()->getGPUCulling()->releaseView(m_cullingView);
+
     for (auto& framebuffer : m_swapchain_framebuffers)
         vkDestroyFramebuffer(getRendererPointer()->getDevice(), *framebuffer, nullptr);
 
@@ -484,9 +666,13 @@ void ForwardPBRPass::destroy()
         }
     }
 
+    for (uint32_t i = 0; i < m_frameUBOs.size(); ++i)
+        vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_frameUBOs[i], m_frameUBOAllocations[i]);
+
     // ImGui
     m_GUI->destroy();
     m_shadowMap->destroy();
+    m_shadowAtlas->destroy();
     m_skyBox->destroy();
     m_lightSphere->destroy();
 
@@ -496,8 +682,11 @@ void ForwardPBRPass::destroy()
         vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipelines[i], nullptr);
         vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayouts[i], nullptr);
     }
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_depthPrepassPipeline, nullptr);
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_prepassedPipeline, nullptr);
 
     m_renderPass.destroy();
+    m_renderGraph.destroy();
 
     // IBL
     m_BRDFcomp.destroy();
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "VulkanRenderer/Features/ShadowMap.h"
+#include "VulkanRenderer/Features/CascadedShadowMap.h"
+#include "VulkanRenderer/Features/ShadowAtlas.h"
 
 #include "VulkanRenderer/Scene/ScenePassBase.h"
 
@@ -25,7 +26,8 @@ public:
 	virtual void draw(uint32_t imageIndex, uint32_t frameIndex) override;
 
 	const Computation& getComputation() const;
-	const std::shared_ptr<ShadowMap> getShadowMap() const { return m_shadowMap; }
+	const std::shared_ptr<CascadedShadowMap> getShadowMap() const { return m_shadowMap; }
+	const std::shared_ptr<ShadowAtlas> getShadowAtlas() const { return m_shadowAtlas; }
 
 	virtual void destroy() override;
 
@@ -46,13 +48,27 @@ private:
 	
 	void loadBRDFlut();
 
+	// Shadow cascades, shadow atlas, light clustering, forward pass(MSAA color is transient),
+	// Hi-Z occlusion, motion vectors and TAA, upscale to the swapchain then GUI.
+	// The forward pass has an optional depth prepass subpass before the shading one.
+	void createRenderGraph();
+
+	// Clustered lights of the frame.
+	virtual VkDescriptorSet getFrameDescriptorSet(const uint32_t currentFrame) override;
+
 	
 
-	//Shadow Map
-	std::shared_ptr<ShadowMap>				m_shadowMap;
+	// Cascaded shadow map of the directional light
+	std::shared_ptr<CascadedShadowMap>		m_shadowMap;
+	// Point and spot light shadows
+	std::shared_ptr<ShadowAtlas>			m_shadowAtlas;
 
 	std::shared_ptr<LightSphere>			m_lightSphere;
 
+	// Depth prepass(subpass 0) and the main pipeline testing against it(EQUAL).
+	VkPipeline								m_depthPrepassPipeline;
+	VkPipeline								m_prepassedPipeline;
+
 	// IBL
 	Computation								m_BRDFcomp;
 
@@ -60,4 +76,14 @@ private:
 	std::shared_ptr<PrefilteredEnvMap>		m_prefilteredEnvMap;
 	std::shared_ptr<PrefilteredIrradiance>	m_prefilteredIrradiance;
 
+	// Bindless: scene UBO, per frame.
+	std::vector<VkBuffer>					m_frameUBOs;
+	std::vector<VmaAllocation>				m_frameUBOAllocations;
+
+	RenderGraph::Resource					m_shadowMapResource;
+	RenderGraph::Resource					m_shadowAtlasResource;
+	RenderGraph::Resource					m_colorResource;
+	RenderGraph::Resource					m_depthResource;
+	// Resolved color, in the top left render extent.
+	RenderGraph::Resource					m_sceneColorResource;
 };
\ No newline at end of file
@@ -1,22 +1,28 @@
 #include "ScenePassBase.h"
 
+#include <fstream>
+#include <iostream>
+
 #include "VulkanRenderer/Renderer.h"
+#include "VulkanRenderer/Image/Image.h"
 #include "VulkanRenderer/Buffer/BufferManager.h"
 
 
 void ScenePassBase::createUniformBuffer(const std::shared_ptr<Model> modelPtr, std::vector<size_t>& uboSizeInfos)
 {
+    const uint32_t uboCount = static_cast<uint32_t>(uboSizeInfos.size());
+
     for (uint32_t meshIndex : modelPtr->getMeshIndices())
     {
-        // create UBO PerMesh
-        m_meshesUBOMap[meshIndex].resize(uboSizeInfos.size());
-        m_meshesUBOAllocationMap[meshIndex].resize(uboSizeInfos.size());
+        // create UBO PerMesh, per frame in flight(see getMeshUBO())
+        m_meshesUBOMap[meshIndex].resize(uboCount * Config::MAX_FRAMES_IN_FLIGHT);
+        m_meshesUBOAllocationMap[meshIndex].resize(uboCount * Config::MAX_FRAMES_IN_FLIGHT);
 
-        for (uint32_t i = 0; i < uboSizeInfos.size(); ++i)
+        for (uint32_t i = 0; i < m_meshesUBOMap[meshIndex].size(); ++i)
         {
             BufferManager::bufferCreateBuffer(
                 getRendererPointer()->getVmaAllocator(),
-                uboSizeInfos[i],
+                uboSizeInfos[i % uboCount],
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
                 VMA_MEMORY_USAGE_CPU_TO_GPU,
                 &m_meshesUBOMap[meshIndex][i],
@@ -26,61 +32,482 @@ void ScenePassBase::createUniformBuffer(const std::shared_ptr<Model> modelPtr, s
     }
 }
 
-void ScenePassBase::drawPipeline(const VkCommandBuffer& commandBuffer, const VkPipeline& pipeline, const VkPipelineLayout& pipelineLayout, std::vector<std::shared_ptr<Model>> models)
+const VkBuffer& ScenePassBase::getMeshUBO(const uint32_t meshIndex, const uint32_t currentFrame, const uint32_t uboIndex)
 {
+    std::vector<VkBuffer>& ubos = m_meshesUBOMap[meshIndex];
+    return ubos[currentFrame * (ubos.size() / Config::MAX_FRAMES_IN_FLIGHT) + uboIndex];
+}
 
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+const VmaAllocation& ScenePassBase::getMeshUBOAllocation(const uint32_t meshIndex, const uint32_t currentFrame, const uint32_t uboIndex)
+{
+    std::vector<VmaAllocation>& allocations = m_meshesUBOAllocationMap[meshIndex];
+    return allocations[currentFrame * (allocations.size() / Config::MAX_FRAMES_IN_FLIGHT) + uboIndex];
+}
 
-    // Set Dynamic States
-    VkViewport viewport{ 0.0f, 0.0f, m_extent.width,m_extent.height, 0.0f, 1.0f };
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+VkSubpassContents ScenePassBase::getSubpassContents() const
+{
+    return (getRendererPointer()->isParallelRecordingEnabled() || getRendererPointer()->isStaticCachingEnabled()) ?
+        VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+}
 
-    VkRect2D scissor{ {0,0}, {m_extent.width,m_extent.height} };
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+void ScenePassBase::buildRenderQueue(const uint32_t currentFrame, const VkPipeline& pipeline, const VkPipelineLayout& pipelineLayout, const std::vector<std::shared_ptr<Model>>& models, const bool useVisibility)
+{
+    const Camera& camera = getRenderResource()->m_camera;
+    const glm::mat4 view = camera.getViewMatrix();
+    const GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+    const bool isBindless = !m_bindlessDescriptorSets.empty();
+
+    m_renderQueue.clear();
 
     for (auto& ptr : models)
     {
         if (ptr->isHidden() == false)
         {
+            const glm::mat4 modelView = view * ptr->getModelMatrix();
+
             for (uint32_t meshIndex : ptr->getMeshIndices())
             {
-                RenderMeshInfo& renderMeshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
-
-                std::vector<VkDeviceSize> offsets = { 0 };
-                vkCmdBindVertexBuffers(commandBuffer, 0, 1, renderMeshInfo.ref_mesh->vertexBuffer, offsets.data());
-                vkCmdBindIndexBuffer(commandBuffer, *renderMeshInfo.ref_mesh->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-                const std::vector<VkDescriptorSet> sets = { getMeshDescriptorSet(meshIndex) };
-                vkCmdBindDescriptorSets(
-                    commandBuffer,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    pipelineLayout,
-                    0,
-                    sets.size(), sets.data(),
-                    0, {}
-                );
-
-                vkCmdDrawIndexed(commandBuffer, renderMeshInfo.ref_mesh->meshIndexCount, 1, 0, 0, 0);
+                if (useVisibility && !getRenderResource()->isMeshVisible(meshIndex))
+                    continue;
+
+                const MeshInfo* meshInfo = getRenderResource()->m_meshInfoMap[meshIndex].ref_mesh;
+
+                DrawItem item{};
+                item.pipeline = getMeshPipeline(meshIndex, pipeline);
+                item.pipelineLayout = pipelineLayout;
+                item.indexCount = meshInfo->meshIndexCount;
+
+                if (isBindless)
+                {
+                    // Same sets for every draw, the material is found with the object index.
+                    if (!gpuCulling->getObjectIndex(meshIndex, item.firstInstance))
+                        continue;
+
+                    item.descriptorSet = m_bindlessDescriptorSets[currentFrame];
+                    item.materialDescriptorSet = getRendererPointer()->getBindlessMaterials()->getDescriptorSet();
+                }
+                else
+                {
+                    item.descriptorSet = getMeshDescriptorSet(meshIndex, currentFrame);
+                    item.materialDescriptorSet = getFrameDescriptorSet(currentFrame);
+                }
+
+                // Pooled meshes share a single vertex/index buffer.
+                if (gpuCulling->getPooledRange(meshIndex, item.firstIndex, item.vertexOffset))
+                {
+                    item.vertexBuffer = gpuCulling->getVertexBuffer();
+                    item.indexBuffer = gpuCulling->getIndexBuffer();
+                }
+                else
+                {
+                    item.vertexBuffer = *meshInfo->vertexBuffer;
+                    item.indexBuffer = *meshInfo->indexBuffer;
+                    item.firstIndex = 0;
+                    item.vertexOffset = 0;
+                }
+
+                // View space looks down -z.
+                const float viewDepth = -(modelView * glm::vec4(meshInfo->boundingBox.getCenter(), 1.0f)).z;
+
+                item.key = m_renderQueue.makeKey(0, item.pipeline, item.descriptorSet, item.vertexBuffer, viewDepth, Config::Z_FAR);
+                m_renderQueue.push(item);
             }
         }
     }
+
+    m_renderQueue.sort();
+}
+
+bool ScenePassBase::isDrawIndirect() const
+{
+    return !m_bindlessDescriptorSets.empty() && getRendererPointer()->isGPUDrivenEnabled();
+}
+
+void ScenePassBase::cullIndirect(const VkCommandBuffer& commandBuffer, const uint32_t currentFrame)
+{
+    if (!isDrawIndirect())
+        return;
+
+    // Same frustum as the CPU culling(RenderResource::cullScene()).
+    const Camera& camera = getRenderResource()->m_camera;
+    getRendererPointer()->getGPUCulling()->cull(commandBuffer, m_cullingView, currentFrame, camera.getProjectionMatrix() * camera.getViewMatrix());
 }
 
-void ScenePassBase::createColorAttachments(std::vector<ColorAttachmentInfo> infos)
+void ScenePassBase::bindFrameDescriptorSet(const VkCommandBuffer& commandBuffer, const uint32_t currentFrame, const VkPipelineLayout& pipelineLayout)
 {
-    m_colorAttachments.resize(infos.size());
+    if (m_bindlessDescriptorSets.empty())
+        return;
+
+    // Compatible with the layout of every draw of the pass: it stays bound.
+    const VkDescriptorSet frameDescriptorSet = getFrameDescriptorSet(currentFrame);
+    if (frameDescriptorSet != VK_NULL_HANDLE)
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 2, 1, &frameDescriptorSet, 0, nullptr);
+}
+
+void ScenePassBase::recordIndirect(const VkCommandBuffer& commandBuffer, const uint32_t currentFrame, const VkPipeline& pipeline, const VkPipelineLayout& pipelineLayout)
+{
+    const VkDescriptorSet materialDescriptorSet = getRendererPointer()->getBindlessMaterials()->getDescriptorSet();
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_bindlessDescriptorSets[currentFrame], 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &materialDescriptorSet, 0, nullptr);
+    bindFrameDescriptorSet(commandBuffer, currentFrame, pipelineLayout);
+
+    getRendererPointer()->getGPUCulling()->drawIndirect(commandBuffer, m_cullingView, currentFrame);
+}
 
-    for (int i = 0; i < m_colorAttachments.size(); ++i)
+void ScenePassBase::drawPipeline(
+    const VkCommandBuffer& commandBuffer,
+    const uint32_t currentFrame,
+    const uint32_t imageIndex,
+    const uint32_t subpass,
+    const VkPipeline& pipeline,
+    const VkPipelineLayout& pipelineLayout,
+    std::vector<std::shared_ptr<Model>> models
+) {
+    const VkFramebuffer& framebuffer = *m_swapchain_framebuffers[imageIndex];
+
+    // Set Dynamic States, the scene covers the render extent of the targets(dynamic resolution).
+    const VkExtent2D& renderExtent = getRendererPointer()->getRenderExtent();
+    VkViewport viewport{ 0.0f, 0.0f, renderExtent.width,renderExtent.height, 0.0f, 1.0f };
+    VkRect2D scissor{ {0,0}, {renderExtent.width,renderExtent.height} };
+
+    const auto recordIndirectFunc = [&](VkCommandBuffer& cb) {
+        vkCmdSetViewport(cb, 0, 1, &viewport);
+        vkCmdSetScissor(cb, 0, 1, &scissor);
+
+        recordIndirect(cb, currentFrame, pipeline, pipelineLayout);
+    };
+
+    // GPU-driven: the objects culled by cullIndirect(), in one draw. The per
+    // material pipelines(getMeshPipeline()) can't be told apart, every object
+    // uses the given one.
+    if (isDrawIndirect() && !getRendererPointer()->isStaticCachingEnabled())
     {
-        m_colorAttachments[i] = Image::Create2DImage(
-            infos[i].extent,
-            infos[i].format,
-            VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY,
-            VK_IMAGE_ASPECT_COLOR_BIT,
-            VK_IMAGE_TILING_OPTIMAL,
-            infos[i].sampleCount
+        drawInline(commandBuffer, currentFrame, imageIndex, subpass, recordIndirectFunc);
+        return;
+    }
+
+    // One entry per image and frame in flight: the draws bind per frame sets.
+    const uint32_t slot = imageIndex * Config::MAX_FRAMES_IN_FLIGHT + currentFrame;
+
+    // Cached GPU-driven draw: the commands, count and culling view buffers are
+    // per frame and refilled by cullIndirect() every frame, so the recorded
+    // draw stays culled without re-recording(only the buffers the GPU culling
+    // objects were created with are part of the signature).
+    if (isDrawIndirect())
+    {
+        const GPUCulling* gpuCulling = getRendererPointer()->getGPUCulling();
+
+        uint64_t signature = 0;
+        StaticCommandCache::combine(signature, (uint64_t)pipeline);
+        StaticCommandCache::combine(signature, (uint64_t)framebuffer);
+        StaticCommandCache::combine(signature, (uint64_t(renderExtent.width) << 32) | renderExtent.height);
+        StaticCommandCache::combine(signature, (uint64_t)getRendererPointer()->getBindlessMaterials()->getDescriptorSet());
+        StaticCommandCache::combine(signature, m_cullingView);
+        StaticCommandCache::combine(signature, gpuCulling->getObjectCount());
+        StaticCommandCache::combine(signature, (uint64_t)gpuCulling->getIndexBuffer());
+
+        std::unique_ptr<StaticCommandCache>& cache = m_staticCaches[subpass];
+        if (!cache)
+            cache = std::make_unique<StaticCommandCache>();
+
+        const VkCommandBuffer& secondary = cache->get(slot, signature, m_renderPass.get(), subpass, framebuffer, recordIndirectFunc);
+
+        vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+        return;
+    }
+
+    if (getRendererPointer()->isStaticCachingEnabled())
+    {
+        // Everything the recorded commands depend on, per frame data(UBOs)
+        // excluded. The CPU frustum culling result isn't part of it: cached
+        // lists hold every non hidden mesh and rely on clipping instead(the
+        // GPU-driven path above keeps its culling).
+        uint64_t signature = 0;
+        StaticCommandCache::combine(signature, (uint64_t)pipeline);
+        StaticCommandCache::combine(signature, (uint64_t)framebuffer);
+        StaticCommandCache::combine(signature, (uint64_t(renderExtent.width) << 32) | renderExtent.height);
+        for (auto& ptr : models)
+        {
+            StaticCommandCache::combine(signature, ptr->isHidden() ? 1 : 0);
+            for (uint32_t meshIndex : ptr->getMeshIndices())
+                StaticCommandCache::combine(signature, meshIndex);
+        }
+
+        std::unique_ptr<StaticCommandCache>& cache = m_staticCaches[subpass];
+        if (!cache)
+            cache = std::make_unique<StaticCommandCache>();
+
+        const VkCommandBuffer& secondary = cache->get(slot, signature, m_renderPass.get(), subpass, framebuffer,
+            [&](VkCommandBuffer& cachedCommandBuffer)
+            {
+                buildRenderQueue(currentFrame, pipeline, pipelineLayout, models, false);
+
+                vkCmdSetViewport(cachedCommandBuffer, 0, 1, &viewport);
+                vkCmdSetScissor(cachedCommandBuffer, 0, 1, &scissor);
+                bindFrameDescriptorSet(cachedCommandBuffer, currentFrame, pipelineLayout);
+
+                RenderQueueStats recordStats;
+                m_renderQueue.record(cachedCommandBuffer, recordStats);
+                m_cachedDrawCounts[subpass] = recordStats.draws;
+            }
         );
+
+        vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+
+        getRendererPointer()->getRenderQueueStats().cachedDraws += m_cachedDrawCounts[subpass];
+        return;
     }
 
+    buildRenderQueue(currentFrame, pipeline, pipelineLayout, models, true);
+
+    if (getRendererPointer()->isParallelRecordingEnabled())
+    {
+        ParallelRecorder* recorder = getRendererPointer()->getParallelRecorder();
+        std::vector<RenderQueueStats> sliceStats(recorder->getSliceCount());
+
+        recorder->record(
+            commandBuffer,
+            currentFrame,
+            m_renderPass.get(),
+            subpass,
+            framebuffer,
+            static_cast<uint32_t>(m_renderQueue.getItems().size()),
+            [&](const VkCommandBuffer& secondary, const uint32_t begin, const uint32_t end, const uint32_t slice)
+            {
+                // Dynamic states aren't inherited by secondary command buffers.
+                vkCmdSetViewport(secondary, 0, 1, &viewport);
+                vkCmdSetScissor(secondary, 0, 1, &scissor);
+                bindFrameDescriptorSet(secondary, currentFrame, pipelineLayout);
+
+                m_renderQueue.record(secondary, begin, end, sliceStats[slice]);
+            }
+        );
+
+        for (auto& stats : sliceStats)
+            getRendererPointer()->getRenderQueueStats().add(stats);
+    }
+    else
+    {
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        bindFrameDescriptorSet(commandBuffer, currentFrame, pipelineLayout);
+
+        m_renderQueue.record(commandBuffer, getRendererPointer()->getRenderQueueStats());
+    }
+}
+
+void ScenePassBase::drawInline(
+    const VkCommandBuffer& commandBuffer,
+    const uint32_t currentFrame,
+    const uint32_t imageIndex,
+    const uint32_t subpass,
+    const std::function<void(VkCommandBuffer& commandBuffer)>& drawFunc
+) {
+    if (getSubpassContents() == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+    {
+        getRendererPointer()->getParallelRecorder()->recordInline(commandBuffer, currentFrame, m_renderPass.get(), subpass, *m_swapchain_framebuffers[imageIndex], drawFunc);
+    }
+    else
+    {
+        VkCommandBuffer primary = commandBuffer;
+        drawFunc(primary);
+    }
+}
+
+void ScenePassBase::destroyStaticCaches()
+{
+    for (auto& cache : m_staticCaches)
+        cache.second->destroy();
+    m_staticCaches.clear();
+}
+
+void ScenePassBase::recreateSwapchainResources()
+{
+    // Recorded with the old framebuffers.
+    destroyStaticCaches();
+
+    for (auto& framebuffer : m_swapchain_framebuffers)
+    {
+        vkDestroyFramebuffer(getRendererPointer()->getDevice(), *framebuffer, nullptr);
+        delete framebuffer;
+    }
+    m_swapchain_framebuffers.clear();
+
+    m_extent = getRendererPointer()->getSwapchainInfo().extent;
+
+    m_renderGraph.destroy();
+    m_renderGraph.resize(m_extent);
+    m_renderGraph.compile();
+
+    createSwapchainFramebuffers();
+    updateAttachmentDescriptorSets();
+
+    m_GUI->recreateFrameBuffers();
+}
+
+void ScenePassBase::importSwapchain()
+{
+    // Available once the acquire semaphore, waited at the color output stage, is signaled.
+    m_swapchainResource = m_renderGraph.importImage(
+        "swapchain",
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+    );
+}
+
+void ScenePassBase::addOcclusionPass(const RenderGraph::Resource depthResource, const VkSampleCountFlagBits sampleCount)
+{
+    m_renderGraph.addPass("Hi-Z occlusion",
+        [depthResource](RenderGraph::PassBuilder& builder) {
+            builder.read(depthResource, RenderGraphAccess::COMPUTE_SAMPLED);
+            // Writes the visibility read back by the next frames(buffers).
+            builder.setSideEffect();
+        },
+        [this, depthResource, sampleCount](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            getRendererPointer()->getOcclusionCulling()->build(commandBuffer, currentFrame, m_renderGraph.getImageView(depthResource), m_extent, getRendererPointer()->getRenderExtent(), sampleCount);
+        }
+    );
+}
+
+RenderGraph::Resource ScenePassBase::addTemporalAAPasses(const RenderGraph::Resource sceneColorResource)
+{
+    m_velocityResource = m_renderGraph.createImage("velocity", { m_extent, TemporalAA::VELOCITY_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT });
+    m_velocityDepthResource = m_renderGraph.createImage("velocity depth", { m_extent, getRendererPointer()->getDepthImageInfo().depth_image_format, VK_IMAGE_ASPECT_DEPTH_BIT, VK_SAMPLE_COUNT_1_BIT });
+
+    // Left by the last frame's upscale pass.
+    m_taaHistoryResource = m_renderGraph.importImage(
+        "TAA history",
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_PIPELINE_STAGE_TRANSFER_BIT
+    );
+    m_taaOutputResource = m_renderGraph.importImage(
+        "TAA output",
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+    );
+
+    m_renderGraph.addPass("velocity",
+        [this](RenderGraph::PassBuilder& builder) {
+            builder.write(m_velocityResource, RenderGraphAccess::COLOR_ATTACHMENT);
+            builder.write(m_velocityDepthResource, RenderGraphAccess::DEPTH_ATTACHMENT);
+        },
+        [this](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            getRendererPointer()->getTemporalAA()->drawVelocity(
+                commandBuffer,
+                currentFrame,
+                m_renderGraph.getImageView(m_velocityResource),
+                m_renderGraph.getImageView(m_velocityDepthResource),
+                m_extent
+            );
+        }
+    );
+
+    m_renderGraph.addPass("TAA",
+        [this, sceneColorResource](RenderGraph::PassBuilder& builder) {
+            builder.read(sceneColorResource, RenderGraphAccess::COMPUTE_SAMPLED);
+            builder.read(m_velocityResource, RenderGraphAccess::COMPUTE_SAMPLED);
+            builder.read(m_velocityDepthResource, RenderGraphAccess::COMPUTE_SAMPLED);
+            builder.read(m_taaHistoryResource, RenderGraphAccess::COMPUTE_SAMPLED);
+            builder.write(m_taaOutputResource, RenderGraphAccess::STORAGE);
+        },
+        [this, sceneColorResource](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            getRendererPointer()->getTemporalAA()->resolve(
+                commandBuffer,
+                currentFrame,
+                m_renderGraph.getImageView(sceneColorResource),
+                m_renderGraph.getImageView(m_velocityResource),
+                m_renderGraph.getImageView(m_velocityDepthResource)
+            );
+        }
+    );
+
+    return m_taaOutputResource;
+}
+
+void ScenePassBase::addUpscalePass(const RenderGraph::Resource sceneColorResource, const RenderGraph::Resource temporalResource)
+{
+    // Linear filtering of the blit needs the format to support it.
+    VkFormatProperties formatProperties;
+    vkGetPhysicalDeviceFormatProperties(getRendererPointer()->getPhysicalDevice(), getRendererPointer()->getSwapchainInfo().image_format, &formatProperties);
+    const VkFilter filter = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+    m_renderGraph.addPass("upscale",
+        [this, sceneColorResource, temporalResource](RenderGraph::PassBuilder& builder) {
+            builder.read(sceneColorResource, RenderGraphAccess::TRANSFER_SRC);
+            // Also the next frame's history.
+            builder.read(temporalResource, RenderGraphAccess::TRANSFER_SRC);
+            builder.write(m_swapchainResource, RenderGraphAccess::TRANSFER_DST);
+        },
+        [this, sceneColorResource, temporalResource, filter](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            const VkExtent2D swapchainExtent = getRendererPointer()->getSwapchain()->getExtent();
+
+            // The TAA already upscaled it.
+            const bool isTemporal = getRendererPointer()->getTemporalAA()->isEnabled();
+            const RenderGraph::Resource source = isTemporal ? temporalResource : sceneColorResource;
+            const VkExtent2D renderExtent = isTemporal ? swapchainExtent : getRendererPointer()->getRenderExtent();
+
+            VkImageBlit blit{};
+            blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            blit.srcOffsets[1] = { (int32_t)renderExtent.width, (int32_t)renderExtent.height, 1 };
+            blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            blit.dstOffsets[1] = { (int32_t)swapchainExtent.width, (int32_t)swapchainExtent.height, 1 };
+
+            vkCmdBlitImage(
+                commandBuffer,
+                m_renderGraph.getImage(source), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                m_renderGraph.getImage(m_swapchainResource), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1, &blit,
+                filter
+            );
+        }
+    );
+}
+
+void ScenePassBase::compileRenderGraph()
+{
+    m_renderGraph.compile();
+
+    if (Config::RENDER_GRAPH_DUMP_ON_COMPILE)
+        dumpRenderGraph();
+}
+
+void ScenePassBase::dumpRenderGraph() const
+{
+    std::cout << m_renderGraph.dumpText();
+
+    std::ofstream file(RENDER_GRAPH_DOT_FILE, std::ios::trunc);
+    if (file.is_open())
+        file << m_renderGraph.dumpDot();
+}
+
+void ScenePassBase::executeRenderGraph(VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame)
+{
+    const std::shared_ptr<Swapchain> swapchain = getRendererPointer()->getSwapchain();
+    m_renderGraph.setImportedImage(m_swapchainResource, swapchain->getImage(imageIndex), swapchain->getImageView(imageIndex));
+
+    TemporalAA* temporalAA = getRendererPointer()->getTemporalAA();
+    m_renderGraph.setImportedImage(m_taaHistoryResource, temporalAA->getHistory()->getImage(), temporalAA->getHistory()->getImageView());
+    m_renderGraph.setImportedImage(m_taaOutputResource, temporalAA->getOutput()->getImage(), temporalAA->getOutput()->getImageView());
+
+    // GPU time of the frame, driving the render extent.
+    DynamicResolution* dynamicResolution = getRendererPointer()->getDynamicResolution();
+    dynamicResolution->beginFrame(commandBuffer, currentFrame);
+
+    // Every pass is a scope(RenderGraph::execute()).
+    getRendererPointer()->getGPUProfiler()->beginFrame(commandBuffer, currentFrame);
+
+    m_renderGraph.execute(commandBuffer, imageIndex, currentFrame);
+
+    dynamicResolution->endFrame(commandBuffer, currentFrame);
+
+    // GPU completion of the frame, for its input latency.
+    getRendererPointer()->getLatencyMeter()->writeTimestamp(commandBuffer, currentFrame);
 }
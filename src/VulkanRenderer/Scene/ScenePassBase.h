@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <functional>
+
 #include <vulkan/vulkan.h>
 #include <VMa/vk_mem_alloc.h>
 
@@ -30,14 +33,9 @@
 #include "VulkanRenderer/Features/ShadowMap.h"
 #include "VulkanRenderer/Features/Skybox.h"
 #include "VulkanRenderer/Features/LightSphere.h"
-
-struct ColorAttachmentInfo
-{
-	std::string				name;
-	VkExtent2D				extent;
-	VkFormat				format;
-	VkSampleCountFlagBits	sampleCount;
-};
+#include "VulkanRenderer/RenderQueue/RenderQueue.h"
+#include "VulkanRenderer/Command/StaticCommandCache.h"
+#include "VulkanRenderer/RenderGraph/RenderGraph.h"
 
 
 class ScenePassBase
@@ -55,19 +53,27 @@ public:
 	
 	const VkFramebuffer& getSwapchainFramebuffer(uint32_t index) const { return *m_swapchain_framebuffers[index]; }
 
+	const GUI* getGUI() const { return m_GUI.get(); }
+
+	const RenderGraph& getRenderGraph() const { return m_renderGraph; }
+	// Its passes and barriers to stdout, its Graphviz graph to RENDER_GRAPH_DOT_FILE.
+	void dumpRenderGraph() const;
 
-	const VkDescriptorSet& getMeshDescriptorSet(uint32_t meshIndex) 
+
+	VkDescriptorSet getMeshDescriptorSet(uint32_t meshIndex, uint32_t currentFrame) 
 	{
-		auto iter = m_meshesDescriptorSetMap.find(meshIndex);
-		if (iter != m_meshesDescriptorSetMap.end())
-		{
-			return iter->second.get();
-		}
+		auto iter = m_meshesFrameDescriptorSetMap.find(meshIndex);
+		if (iter != m_meshesFrameDescriptorSetMap.end())
+			return iter->second[currentFrame].get();
 		else
-			return VkDescriptorSet();
+			return VK_NULL_HANDLE;
 
 	}
 
+	// After a swapchain resize: recreates the graph's images and the framebuffers
+	// using them, the rest of the scene(pipelines, buffers, sets) is kept.
+	void recreateSwapchainResources();
+
 	virtual void destroy() = 0;
 
 private:
@@ -83,10 +89,62 @@ private:
 
 protected:
 
+	// One set of uboSizeInfos UBOs per mesh and frame in flight: a frame writes
+	// its own while the previous ones may still be read.
 	void createUniformBuffer(const std::shared_ptr<Model> modelPtr, std::vector<size_t>& uboSizeInfos);
-	void drawPipeline(const VkCommandBuffer& commandBuffer, const VkPipeline& pipeline, const VkPipelineLayout& pipelineLayout, std::vector<std::shared_ptr<Model>> models);
-
-	void createColorAttachments(std::vector<ColorAttachmentInfo> infos);
+	const VkBuffer& getMeshUBO(const uint32_t meshIndex, const uint32_t currentFrame, const uint32_t uboIndex);
+	const VmaAllocation& getMeshUBOAllocation(const uint32_t meshIndex, const uint32_t currentFrame, const uint32_t uboIndex);
+	// Contents to begin the subpasses using drawPipeline/drawInline with.
+	VkSubpassContents getSubpassContents() const;
+
+	void drawPipeline(
+		const VkCommandBuffer& commandBuffer,
+		const uint32_t currentFrame,
+		const uint32_t imageIndex,
+		const uint32_t subpass,
+		const VkPipeline& pipeline,
+		const VkPipelineLayout& pipelineLayout,
+		std::vector<std::shared_ptr<Model>> models
+	);
+	// Draws recorded on the main thread(in a secondary when the subpass uses them).
+	void drawInline(
+		const VkCommandBuffer& commandBuffer,
+		const uint32_t currentFrame,
+		const uint32_t imageIndex,
+		const uint32_t subpass,
+		const std::function<void(VkCommandBuffer& commandBuffer)>& drawFunc
+	);
+	void destroyStaticCaches();
+	// Bindless passes draw the objects of m_cullingView with a single multi draw
+	// indirect when the renderer is GPU-driven(same pipeline for every object).
+	bool isDrawIndirect() const;
+	// Records the GPU culling of m_cullingView against the camera, outside of the
+	// render pass. Nothing when drawPipeline() doesn't draw indirectly.
+	void cullIndirect(const VkCommandBuffer& commandBuffer, const uint32_t currentFrame);
+	// Pipeline drawPipeline uses for a mesh, passes with per material variants override it.
+	virtual VkPipeline getMeshPipeline(const uint32_t meshIndex, const VkPipeline& pipeline) { return pipeline; }
+	// Rewrites the sets reading the graph's images(input attachments...), after
+	// they're recreated.
+	virtual void updateAttachmentDescriptorSets() {}
+	// Set 1 of the draws that aren't bindless(e.g. the clustered lights), set 2 of the
+	// bindless ones(set 1 is the material textures), VK_NULL_HANDLE for none.
+	virtual VkDescriptorSet getFrameDescriptorSet(const uint32_t currentFrame) { return VK_NULL_HANDLE; }
+
+	// Imports the swapchain into m_renderGraph, it's presented after the frame.
+	void importSwapchain();
+	// Hi-Z pyramid and occlusion test(OcclusionCulling::build()) from the depth
+	// of the scene pass, which must store it.
+	void addOcclusionPass(const RenderGraph::Resource depthResource, const VkSampleCountFlagBits sampleCount);
+	// Motion vectors and TemporalAA::resolve() of the scene's color(single
+	// sample), returns the swapchain sized output.
+	RenderGraph::Resource addTemporalAAPasses(const RenderGraph::Resource sceneColorResource);
+	// Copies the temporal output(TAA on), or stretches the render extent of the
+	// scene's color, over the swapchain before the GUI draws on it.
+	void addUpscalePass(const RenderGraph::Resource sceneColorResource, const RenderGraph::Resource temporalResource);
+	// Compiles m_renderGraph, dumps it when Config::RENDER_GRAPH_DUMP_ON_COMPILE.
+	void compileRenderGraph();
+	// Records m_renderGraph drawing to the swapchain image imageIndex.
+	void executeRenderGraph(VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame);
 
 	std::vector<VkFramebuffer*>			m_swapchain_framebuffers;
 
@@ -107,12 +165,41 @@ protected:
 
 
 
-	std::vector<Image*>							m_colorAttachments;
-	Image*										m_depthAttacment;
+	// Passes of the frame and the attachments they use.
+	RenderGraph									m_renderGraph;
+	RenderGraph::Resource						m_swapchainResource;
+	RenderGraph::Resource						m_velocityResource;
+	RenderGraph::Resource						m_velocityDepthResource;
+	// TemporalAA's history images, swapped every frame.
+	RenderGraph::Resource						m_taaHistoryResource;
+	RenderGraph::Resource						m_taaOutputResource;
 
 	std::unordered_map<uint32_t, std::vector<VkBuffer>>			m_meshesUBOMap;
 	std::unordered_map<uint32_t, std::vector<VmaAllocation>>	m_meshesUBOAllocationMap;
-	std::unordered_map<uint32_t, DescriptorSet>					m_meshesDescriptorSetMap;
+	// Per mesh sets, one per frame in flight(per frame UBOs, shadow cascades...).
+	std::unordered_map<uint32_t, std::array<DescriptorSet, Config::MAX_FRAMES_IN_FLIGHT>>	m_meshesFrameDescriptorSetMap;
+
+	RenderQueue													m_renderQueue;
+
+	// Sets of the scene, destroyed with it(the renderer's allocator is for the
+	// features living as long as it).
+	DescriptorAllocator											m_descriptorAllocator;
+
+	// Set 0 of the bindless pipeline, per frame(the object buffer is per frame).
+	// Empty when the pass draws with the per mesh sets.
+	std::vector<VkDescriptorSet>								m_bindlessDescriptorSets;
+	// GPU culling view(camera frustum) of the bindless passes.
+	uint32_t													m_cullingView = 0;
+
+	// Recorded drawPipeline commands, per subpass.
+	std::unordered_map<uint32_t, std::unique_ptr<StaticCommandCache>>	m_staticCaches;
+	std::unordered_map<uint32_t, uint32_t>								m_cachedDrawCounts;
+
+private:
+	void buildRenderQueue(const uint32_t currentFrame, const VkPipeline& pipeline, const VkPipelineLayout& pipelineLayout, const std::vector<std::shared_ptr<Model>>& models, const bool useVisibility);
+	// Binds getFrameDescriptorSet() in set 2 of the bindless draws, the render queue binds the others.
+	void bindFrameDescriptorSet(const VkCommandBuffer& commandBuffer, const uint32_t currentFrame, const VkPipelineLayout& pipelineLayout);
+	void recordIndirect(const VkCommandBuffer& commandBuffer, const uint32_t currentFrame, const VkPipeline& pipeline, const VkPipelineLayout& pipelineLayout);
 
 
 };
\ No newline at end of file
@@ -22,7 +22,8 @@ SHLightingPass::SHLightingPass()
     createUBOs();
     createDescriptorSets();
 
-
+    // The framebuffers use the graph's attachments.
+    createRenderGraph();
     createSwapchainFramebuffers();
 }
 
@@ -34,6 +35,8 @@ void SHLightingPass::createRenderPass()
     VkFormat format = getRendererPointer()->getSwapchainInfo().image_format;
     VkFormat depthBufferFormat = getRendererPointer()->getDepthImageInfo().depth_image_format;
     VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
+    // Without MSAA the color attachment is the scene color itself(no resolve).
+    const bool isMultisampled = msaaSamplesCount != VK_SAMPLE_COUNT_1_BIT;
 
     // - Attachments
 
@@ -43,7 +46,8 @@ void SHLightingPass::createRenderPass()
         format,
         msaaSamplesCount,
         VK_ATTACHMENT_LOAD_OP_CLEAR,
-        VK_ATTACHMENT_STORE_OP_STORE,
+        // Only the resolved image is used after the pass.
+        isMultisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
         VK_IMAGE_LAYOUT_UNDEFINED,
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         colorAttachment
@@ -56,8 +60,8 @@ void SHLightingPass::createRenderPass()
         depthBufferFormat,
         msaaSamplesCount,
         VK_ATTACHMENT_LOAD_OP_CLEAR,
-        // We don't care about storing the depth data, because it will not be used after drawing has finished.
-        VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        // Reduced to the Hi-Z pyramid of the occlusion culling.
+        VK_ATTACHMENT_STORE_OP_STORE,
         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         VK_ATTACHMENT_STORE_OP_DONT_CARE,
         // Just like the color buffer, we don't care about the previous depth contents.
@@ -77,8 +81,7 @@ void SHLightingPass::createRenderPass()
         VK_ATTACHMENT_LOAD_OP_DONT_CARE,
         VK_ATTACHMENT_STORE_OP_DONT_CARE,
         VK_IMAGE_LAYOUT_UNDEFINED,
-        // Here is not 'VK_IMAGE_LAYOUT_PRESENT_SRC_KHR'
-        // because the GUI will be the last and the one to present.
+        // Scene color, the upscale pass copies it to the swapchain.
         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         colorResolveAttachment
     );
@@ -97,12 +100,18 @@ void SHLightingPass::createRenderPass()
 
 
     // - Subpasses
+    // Depth prepass(empty when disabled), fills the depth the shading is tested against.
+    VkSubpassDescription depthSubPassDescript{};
+    depthSubPassDescript.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    depthSubPassDescript.colorAttachmentCount = 0;
+    depthSubPassDescript.pDepthStencilAttachment = &depthAttachmentRef;
+
     VkSubpassDescription subPassDescript{};
     SubPassUtils::createSubPassDescription(
         VK_PIPELINE_BIND_POINT_GRAPHICS,
         &colorAttachmentRef,
         &depthAttachmentRef,
-        &colorResolveAttachmentRef,
+        isMultisampled ? &colorResolveAttachmentRef : nullptr,
         subPassDescript
     );
 
@@ -124,12 +133,29 @@ void SHLightingPass::createRenderPass()
         dependency
     );
 
+    // Depth written by the prepass, tested(and written without prepass) by the shading.
+    VkSubpassDependency prepassDependency{};
+    SubPassUtils::createSubPassDependency(
+        0,
+        (VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT),
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+        1,
+        (VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT),
+        (VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT),
+        VK_DEPENDENCY_BY_REGION_BIT,
+        prepassDependency
+    );
+
 
 
+    std::vector<VkAttachmentDescription> attachments = { colorAttachment, depthAttachment };
+    if (isMultisampled)
+        attachments.push_back(colorResolveAttachment);
+
     m_renderPass = RenderPass(
-        { colorAttachment, depthAttachment, colorResolveAttachment },
-        { subPassDescript },
-        { dependency }
+        attachments,
+        { depthSubPassDescript, subPassDescript },
+        { dependency, prepassDependency }
     );
 }
 
@@ -143,10 +169,12 @@ void SHLightingPass::createSwapchainFramebuffers()
         m_swapchain_framebuffers[i] = new VkFramebuffer;
 
         std::vector<VkImageView> attachments = {
-            *getRendererPointer()->getMSAAInfo().msaa_image_view,
-            *getRendererPointer()->getDepthImageInfo().depth_image_view,
-            *getRendererPointer()->getSwapchainInfo().imageViews[i]
+            m_renderGraph.getImageView(m_colorResource),
+            m_renderGraph.getImageView(m_depthResource)
         };
+        // Resolve attachment
+        if (m_colorResource != m_sceneColorResource)
+            attachments.push_back(m_renderGraph.getImageView(m_sceneColorResource));
 
         FramebufferManager::createFramebuffer(
             getRendererPointer()->getDevice(),
@@ -160,18 +188,81 @@ void SHLightingPass::createSwapchainFramebuffers()
     }
 }
 
+void SHLightingPass::createRenderGraph()
+{
+    const VkFormat format = getRendererPointer()->getSwapchainInfo().image_format;
+    const VkFormat depthBufferFormat = getRendererPointer()->getDepthImageInfo().depth_image_format;
+    const VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
+
+    importSwapchain();
+    m_sceneColorResource = m_renderGraph.createImage("scene color", { m_extent, format, VK_IMAGE_ASPECT_COLOR_BIT, VK_SAMPLE_COUNT_1_BIT });
+    // 1x: the pass draws in the scene color directly.
+    m_colorResource = (msaaSamplesCount != VK_SAMPLE_COUNT_1_BIT) ? m_renderGraph.createImage("msaa color", { m_extent, format, VK_IMAGE_ASPECT_COLOR_BIT, msaaSamplesCount }) : m_sceneColorResource;
+    m_depthResource = m_renderGraph.createImage("depth", { m_extent, depthBufferFormat, VK_IMAGE_ASPECT_DEPTH_BIT, msaaSamplesCount });
+
+    m_renderGraph.addPass("SH lighting",
+        [&](RenderGraph::PassBuilder& builder) {
+            builder.write(m_colorResource, RenderGraphAccess::COLOR_ATTACHMENT);
+            builder.write(m_depthResource, RenderGraphAccess::DEPTH_ATTACHMENT);
+            // Resolve attachment
+            if (m_colorResource != m_sceneColorResource)
+                builder.write(m_sceneColorResource, RenderGraphAccess::COLOR_ATTACHMENT);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            // Read by both subpasses' indirect draws.
+            cullIndirect(commandBuffer, currentFrame);
+
+            // Only the render extent is drawn(dynamic resolution).
+            m_renderPass.begin(*m_swapchain_framebuffers[imageIndex], getRendererPointer()->getRenderExtent(), m_clearValues, commandBuffer, getSubpassContents());
+
+            // Depth prepass: every covered pixel is then shaded once(EQUAL test).
+            const bool isDepthPrepassEnabled = getRendererPointer()->isDepthPrepassEnabled();
+            if (isDepthPrepassEnabled)
+                drawPipeline(commandBuffer, currentFrame, imageIndex, 0, m_depthPrepassPipeline, m_pipelineLayouts[PipelineIndex::main_pipeline], getRenderResource()->m_normalModels);
+
+            vkCmdNextSubpass(commandBuffer, getSubpassContents());
+
+            PipelineVariants& variants = isDepthPrepassEnabled ? m_prepassedVariants : m_variants;
+            drawPipeline(commandBuffer, currentFrame, imageIndex, 1, variants.get(m_variantKey), m_pipelineLayouts[PipelineIndex::main_pipeline], getRenderResource()->m_normalModels);
+
+            drawInline(commandBuffer, currentFrame, imageIndex, 1, [&](VkCommandBuffer& cb) {
+                GPUProfiler::Scope scope(cb, currentFrame, "skybox");
+                m_skyBox->draw(cb);
+            });
+
+            m_renderPass.end(commandBuffer);
+        }
+    );
+
+    addOcclusionPass(m_depthResource, msaaSamplesCount);
+    addUpscalePass(m_sceneColorResource, addTemporalAAPasses(m_sceneColorResource));
+
+    m_renderGraph.addPass("GUI",
+        [&](RenderGraph::PassBuilder& builder) {
+            // The GUI render pass presents.
+            builder.write(m_swapchainResource, RenderGraphAccess::COLOR_ATTACHMENT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        },
+        [&](VkCommandBuffer& commandBuffer, const uint32_t imageIndex, const uint32_t currentFrame) {
+            m_GUI->draw(currentFrame, imageIndex);
+        }
+    );
+
+    compileRenderGraph();
+}
+
 void SHLightingPass::createSecondaryFeatures()
 {
    
 
-    uint32_t subPassIndex = 0;
+    // Shading subpass, after the depth prepass.
+    uint32_t subPassIndex = 1;
     m_skyBox = std::make_shared<SkyBox>(m_renderPass.get(), getRendererPointer()->getMSAAInfo().msaa_sampleCount, subPassIndex);
 
     //GUI
     m_GUI = std::make_unique<GUI>();
 
-    // IBL
-    loadSHBRDFlut();
+    // IBL(loaded by the first scene)
+    getRenderResource()->loadSHBRDFlut();
     
 }
 
@@ -184,9 +275,13 @@ void SHLightingPass::createPipelines()
 
     VkSampleCountFlagBits msaaSamplesCount = getRendererPointer()->getMSAAInfo().msaa_sampleCount;
 
+    // Bindless variant when the device supports it: one set 0 per frame plus the
+    // material textures(set 1), instead of one set per mesh.
+    const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials();
+
     //-------------------------------- PBR Pipeline --------------------------------------
     {
-        const std::vector<DescriptorInfo>& descriptorInfo = GRAPHICS_PIPELINE::SH_LIGHTING::DESCRIPTORS_INFO;
+        const std::vector<DescriptorInfo>& descriptorInfo = bindless ? GRAPHICS_PIPELINE::SH_LIGHTING_BINDLESS::DESCRIPTORS_INFO : GRAPHICS_PIPELINE::SH_LIGHTING::DESCRIPTORS_INFO;
 
         std::vector<VkDescriptorSetLayoutBinding> bindings(descriptorInfo.size());
         for (uint32_t i = 0; i < descriptorInfo.size(); i++)
@@ -207,88 +302,65 @@ void SHLightingPass::createPipelines()
             throw std::runtime_error("Failed to create descriptor set layout!");
 
 
-        // -------------------Shader Modules--------------------
-        const std::vector<ShaderInfo>& shaderInfos = { {shaderType::VERTEX, "shLighting"}, {shaderType::FRAGMENT, "shLighting"} };
-
-        std::vector<VkShaderModule> shaderModules(shaderInfos.size());
-        std::vector<VkPipelineShaderStageCreateInfo> shaderStagesInfos(shaderInfos.size());
-        for (uint32_t i = 0; i < shaderInfos.size(); i++)
-        {
-            PipelineManager::createShaderModule(shaderInfos[i], shaderModules[i]);
-            PipelineManager::createShaderStageInfo(shaderModules[i], shaderInfos[i].type, shaderStagesInfos[i]);
-        }
-
-
-        // Dynamic states
-        std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-        VkPipelineDynamicStateCreateInfo dynamicState = PipelineManager::pipelineDynamicStateCreateInfo(dynamicStateEnables.data(), dynamicStateEnables.size());
-
-        // Viewport
-        VkViewport viewport{};
-        PipelineManager::createViewport(viewport, m_extent);
-        // Scissor
-        VkRect2D scissor{};
-        PipelineManager::createScissor(scissor, m_extent);
-        // Viewport state info
-        VkPipelineViewportStateCreateInfo viewportState = PipelineManager::pipelineViewportStateCreateInfo(1, 1, 0);
-        // Vertex input(attributes)
-        std::vector<VkVertexInputAttributeDescription> attribDescription = Attributes::PBR::getAttributeDescriptions();
-        VkVertexInputBindingDescription bindingDescription = Attributes::PBR::getBindingDescription();
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        PipelineManager::createVertexShaderInputInfo(bindingDescription, attribDescription, vertexInputInfo);
-        // Input assembly
-        VkPipelineInputAssemblyStateCreateInfo inputAssemblyState = PipelineManager::pipelineInputAssemblyStateCreateInfo(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, 0, VK_FALSE);
-        // Rasterizer
-        VkPipelineRasterizationStateCreateInfo rasterizationState = PipelineManager::pipelineRasterizationStateCreateInfo(VK_POLYGON_MODE_FILL, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, 0, VK_FALSE);
-        // Multisampling 
-        VkPipelineMultisampleStateCreateInfo multisampleState = PipelineManager::pipelineMultisampleStateCreateInfo(msaaSamplesCount, 0);
-        // Color blending(attachment)
-        VkPipelineColorBlendAttachmentState blendAttachmentState = PipelineManager::pipelineColorBlendAttachmentState(0xf, VK_FALSE);
-        // Color blending(global)
-        VkPipelineColorBlendStateCreateInfo colorBlendState = PipelineManager::pipelineColorBlendStateCreateInfo(1, &blendAttachmentState);
-
         // Pipeline layout
+        std::vector<VkDescriptorSetLayout> setLayouts = { m_descriptorSetLayouts[PipelineIndex::main_pipeline] };
+        if (bindless)
+            setLayouts.push_back(bindless->getDescriptorSetLayout());
+
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 1;
-        pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayouts[PipelineIndex::main_pipeline];
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
         pipelineLayoutInfo.pushConstantRangeCount = 0;
         pipelineLayoutInfo.pPushConstantRanges = nullptr;
         auto status = vkCreatePipelineLayout(getRendererPointer()->getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayouts[PipelineIndex::main_pipeline]);
         if (status != VK_SUCCESS)
             throw std::runtime_error("Failed to create pipeline layout!");
 
-        // Depth and stencil
-        VkPipelineDepthStencilStateCreateInfo depthStencilState = PipelineManager::pipelineDepthStencilStateCreateInfo(VK_TRUE, VK_TRUE, VK_COMPARE_OP_LESS);
-
-        VkGraphicsPipelineCreateInfo pipelineInfo{};
-        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = shaderInfos.size();
-        pipelineInfo.pStages = shaderStagesInfos.data();
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssemblyState;
-        pipelineInfo.pViewportState = &viewportState;
-        pipelineInfo.pRasterizationState = &rasterizationState;
-        pipelineInfo.pMultisampleState = &multisampleState;
-        pipelineInfo.pDepthStencilState = &depthStencilState;
-        pipelineInfo.pColorBlendState = &colorBlendState;
-        pipelineInfo.pDynamicState = &dynamicState;
-        pipelineInfo.pTessellationState = nullptr;
-        pipelineInfo.pNext = nullptr;
-        pipelineInfo.layout = m_pipelineLayouts[PipelineIndex::main_pipeline];
-        pipelineInfo.renderPass = m_renderPass.get();
-        pipelineInfo.subpass = 0;
-        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineInfo.basePipelineIndex = -1;
-
-        status = vkCreateGraphicsPipelines(getRendererPointer()->getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[PipelineIndex::main_pipeline]);
-        if (status != VK_SUCCESS)
-            throw std::runtime_error("Failed to create graphics pipeline!");
-
-        for (auto& shaderModule : shaderModules)
-        {
-            ShaderManager::destroyShaderModule(shaderModule);
-        }
+        const std::string shaderName = bindless ? "shLightingBindless" : "shLighting";
+
+        GraphicsPipelineDesc desc;
+        desc.name = "SH lighting";
+        desc.shaders = { {shaderType::VERTEX, shaderName}, {shaderType::FRAGMENT, shaderName} };
+        desc.vertexBinding = Attributes::PBR::getBindingDescription();
+        desc.vertexAttributes = Attributes::PBR::getAttributeDescriptions();
+        desc.layout = m_pipelineLayouts[PipelineIndex::main_pipeline];
+        desc.renderPass = m_renderPass.get();
+        desc.subpass = 1;
+
+        m_variants.init(desc);
+
+        // Shading after the depth prepass: the depth is final, only the visible
+        // fragments pass.
+        GraphicsPipelineDesc prepassedDesc = desc;
+        prepassedDesc.name = "SH lighting(after depth prepass)";
+        prepassedDesc.depthWriteEnable = VK_FALSE;
+        prepassedDesc.depthCompareOp = VK_COMPARE_OP_EQUAL;
+
+        m_prepassedVariants.init(prepassedDesc);
+
+        m_variantKey.sampleCount = msaaSamplesCount;
+        m_variantKey.hasNormalMap = 1;
+
+        // Both normal map variants are used by most scenes, build them with the others.
+        ShaderVariantKey noNormalMapKey = m_variantKey;
+        noNormalMapKey.hasNormalMap = 0;
+
+        m_variants.prepare(m_variantKey);
+        m_variants.prepare(noNormalMapKey);
+        m_prepassedVariants.prepare(m_variantKey);
+        m_prepassedVariants.prepare(noNormalMapKey);
+
+        // Depth prepass: same layout and sets, position only, no fragment shader.
+        GraphicsPipelineDesc prepassDesc = desc;
+        prepassDesc.name = "SH depth prepass";
+        prepassDesc.shaders = { {shaderType::VERTEX, bindless ? "depthPrepassBindless" : "depthPrepass"} };
+        prepassDesc.vertexAttributes = { Attributes::PBR::getAttributeDescriptions()[0] };
+        prepassDesc.subpass = 0;
+        prepassDesc.sampleCount = msaaSamplesCount;
+        prepassDesc.colorAttachmentCount = 0;
+
+        getRendererPointer()->getPipelineCompiler().add(prepassDesc, &m_depthPrepassPipeline);
     }
 }
 
@@ -302,12 +374,43 @@ void SHLightingPass::updateUBO(
     UBOinfo uboInfo = {
         getRenderResource()->m_camera.getCameraPos(),
         getRenderResource()->m_camera.getViewMatrix(),
-        getRenderResource()->m_camera.getProjectionMatrix(),
+        getRenderResource()->m_camera.getJitteredProjectionMatrix(),
         glm::mat4(1.0f),
         getRenderResource()->m_lightsInfo.size(),
         extent
     };
 
+    glm::vec4 coefficentData[Config::SH_COEF_NUM];
+
+    for (uint32_t i = 0; i < Config::SH_COEF_NUM; i++)
+    {
+        coefficentData[i] = glm::vec4(getRenderResource()->m_coefficient[i], 1.0f);
+    }
+
+    // Bindless: the model matrices come from the object buffer, the rest is per frame.
+    if (!m_bindlessDescriptorSets.empty())
+    {
+        DescriptorTypes::UniformBufferObject::NormalPBR  uboData1;
+        uboData1.model = glm::mat4(1.0f);
+        uboData1.view = uboInfo.view;
+        uboData1.proj = uboInfo.proj;
+        uboData1.lightSpace = uboInfo.lightSpace;
+
+        uboData1.cameraPos = glm::vec4(uboInfo.cameraPos, 1.0f);
+        uboData1.lightsCount = uboInfo.lightsCount;
+
+        void* data;
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame][0], &data);
+        memcpy(data, &uboData1, sizeof(uboData1));
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame][0]);
+
+        vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame][1], &data);
+        memcpy(data, &coefficentData, sizeof(coefficentData[0]) * Config::SH_COEF_NUM);
+        vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_frameUBOAllocations[currentFrame][1]);
+
+        return;
+    }
+
     // SHLightingPass
 
     for (auto ptr : getRenderResource()->m_normalModels)
@@ -326,24 +429,17 @@ void SHLightingPass::updateUBO(
                 uboData1.lightsCount = uboInfo.lightsCount;
 
                 void* data;
-                vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][0], &data);
+                vmaMapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 0), &data);
                 memcpy(data, &uboData1, sizeof(uboData1));
-                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][0]);
+                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 0));
             }
 
             // SH UBOs
             {
-                glm::vec4 coefficentData[Config::SH_COEF_NUM];
-
-                for (uint32_t i = 0; i < Config::SH_COEF_NUM; i++)
-                {
-                    coefficentData[i] = glm::vec4(getRenderResource()->m_coefficient[i], 1.0f);
-                }
-
                 void* data;
-                vmaMapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][1], &data);
+                vmaMapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 1), &data);
                 memcpy(data, &coefficentData, sizeof(coefficentData[0]) * Config::SH_COEF_NUM);
-                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), m_meshesUBOAllocationMap[meshIndex][1]);
+                vmaUnmapMemory(getRendererPointer()->getVmaAllocator(), getMeshUBOAllocation(meshIndex, currentFrame, 1));
             }
         }
     }
@@ -360,24 +456,57 @@ void SHLightingPass::draw(uint32_t imageIndex, uint32_t currentFrame)
 
 
 
-    //--------------------------------RenderPass-----------------------------
-    VkExtent2D extent = getRendererPointer()->getSwapchainInfo().extent;
-    m_renderPass.begin(*m_swapchain_framebuffers[imageIndex], extent, m_clearValues, commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
-
-    drawPipeline(commandBuffer, m_pipelines[PipelineIndex::main_pipeline], m_pipelineLayouts[PipelineIndex::main_pipeline], getRenderResource()->m_normalModels);
+    //--------------------------------RenderGraph----------------------------
+    executeRenderGraph(commandBuffer, imageIndex, currentFrame);
 
-    m_skyBox->draw(commandBuffer);
+    vkEndCommandBuffer(commandBuffer);
+}
 
-    m_renderPass.end(commandBuffer);
+VkPipeline SHLightingPass::getMeshPipeline(const uint32_t meshIndex, const VkPipeline& pipeline)
+{
+    const MaterialInfo* material = getRenderResource()->m_meshInfoMap[meshIndex].ref_material;
+    if (pipeline == m_depthPrepassPipeline || material == nullptr || material->hasNormalMap)
+        return pipeline;
 
-    //GUI
-    m_GUI->draw(currentFrame, imageIndex);
+    ShaderVariantKey key = m_variantKey;
+    key.hasNormalMap = 0;
 
-    vkEndCommandBuffer(commandBuffer);
+    PipelineVariants& variants = getRendererPointer()->isDepthPrepassEnabled() ? m_prepassedVariants : m_variants;
+    return variants.get(key);
 }
 
 void SHLightingPass::createUBOs()
 {
+    if (getRendererPointer()->getBindlessMaterials())
+    {
+        std::vector<size_t> uboSizeInfos = {
+               sizeof(DescriptorTypes::UniformBufferObject::NormalPBR),
+               sizeof(glm::vec4) * Config::SH_COEF_NUM
+        };
+
+        m_frameUBOs.resize(Config::MAX_FRAMES_IN_FLIGHT);
+        m_frameUBOAllocations.resize(Config::MAX_FRAMES_IN_FLIGHT);
+
+        for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; ++frame)
+        {
+            m_frameUBOs[frame].resize(uboSizeInfos.size());
+            m_frameUBOAllocations[frame].resize(uboSizeInfos.size());
+
+            for (uint32_t i = 0; i < uboSizeInfos.size(); ++i)
+            {
+                BufferManager::bufferCreateBuffer(
+                    getRendererPointer()->getVmaAllocator(),
+                    uboSizeInfos[i],
+                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                    VMA_MEMORY_USAGE_CPU_TO_GPU,
+                    &m_frameUBOs[frame][i],
+                    &m_frameUBOAllocations[frame][i]
+                );
+            }
+        }
+        return;
+    }
+
     //Normal models
     for (auto ptr : getRenderResource()->m_normalModels)
     {
@@ -391,19 +520,53 @@ void SHLightingPass::createUBOs()
 
 void SHLightingPass::createDescriptorSets()
 {
+    //-----------------------------  Bindless DescriptorSets  -------------------------------
+    if (const BindlessMaterials* bindless = getRendererPointer()->getBindlessMaterials())
+    {
+        m_bindlessDescriptorSets.resize(Config::MAX_FRAMES_IN_FLIGHT);
+        m_cullingView = getRendererPointer()->getGPUCulling()->createView();
+        m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::SH_LIGHTING_BINDLESS::DESCRIPTORS_INFO, Config::MAX_FRAMES_IN_FLIGHT);
+
+        for (uint32_t i = 0; i < Config::MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            m_descriptorAllocator.allocate(m_descriptorSetLayouts[PipelineIndex::main_pipeline], &m_bindlessDescriptorSets[i]);
+
+            VkDescriptorBufferInfo uniformBufferInfo = DescriptorManager::descriptorBufferInfo(m_frameUBOs[i][0]);
+            VkDescriptorBufferInfo coefficientBufferInfo = DescriptorManager::descriptorBufferInfo(m_frameUBOs[i][1]);
+            VkDescriptorImageInfo SHBRDFlutInfo = DescriptorManager::descriptorImageInfo(getRenderResource()->m_SHBRDFlut.sampler->getSampler(), getRenderResource()->m_SHBRDFlut.image->getImageView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            VkDescriptorBufferInfo objectBufferInfo = DescriptorManager::descriptorBufferInfo(getRendererPointer()->getGPUCulling()->getObjectBuffer(i));
+            VkDescriptorBufferInfo materialBufferInfo = DescriptorManager::descriptorBufferInfo(bindless->getMaterialBuffer());
+
+            std::vector<VkWriteDescriptorSet> writeDescriptorSets = {
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, &uniformBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, &coefficientBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, &SHBRDFlutInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3, &objectBufferInfo),
+                DescriptorManager::writeDescriptorSet(m_bindlessDescriptorSets[i], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4, &materialBufferInfo),
+            };
+            vkUpdateDescriptorSets(getRendererPointer()->getDevice(), static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+        }
+        return;
+    }
+
     //-------------------------------  PBR DescriptorSet  ----------------------------------
+    // Per frame in flight: the UBOs are.
+    m_descriptorAllocator.reserve(GRAPHICS_PIPELINE::SH_LIGHTING::DESCRIPTORS_INFO, getRenderResource()->getNormalMeshCount() * Config::MAX_FRAMES_IN_FLIGHT);
+
     for (auto ptr : getRenderResource()->m_normalModels)
     {
         for (uint32_t meshIndex : ptr->getMeshIndices())
         {
+            for (uint32_t frame = 0; frame < Config::MAX_FRAMES_IN_FLIGHT; frame++)
             {
-                DescriptorManager::allocDescriptorSet(getRendererPointer()->getDescriptorPool(), m_descriptorSetLayouts[PipelineIndex::main_pipeline], &m_meshesDescriptorSetMap[meshIndex].get());
+                DescriptorSet& descriptorSet = m_meshesFrameDescriptorSetMap[meshIndex][frame];
+                m_descriptorAllocator.allocate(m_descriptorSetLayouts[PipelineIndex::main_pipeline], &descriptorSet.get());
 
                 RenderMeshInfo& renderMeshInfo = getRenderResource()->m_meshInfoMap[meshIndex];
 
                 std::vector<DescriptorSet::DescriptorSetWriteData> data{
-                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_meshesUBOMap[meshIndex][0], 0, VK_WHOLE_SIZE},
-                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_meshesUBOMap[meshIndex][1], 0, VK_WHOLE_SIZE},
+                    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, getMeshUBO(meshIndex, frame, 0), 0, VK_WHOLE_SIZE},
+                    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, getMeshUBO(meshIndex, frame, 1), 0, VK_WHOLE_SIZE},
 
                     { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->colorTexture.sampler->getSampler(),                 renderMeshInfo.ref_material->colorTexture.image->getImageView(),                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
                     { 3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, renderMeshInfo.ref_material->metallic_RoughnessTexture.sampler->getSampler(),    renderMeshInfo.ref_material->metallic_RoughnessTexture.image->getImageView(),   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
@@ -414,7 +577,7 @@ void SHLightingPass::createDescriptorSets()
                     { 7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, getRenderResource()->m_SHBRDFlut.sampler->getSampler(),                          getRenderResource()->m_SHBRDFlut.image->getImageView(),                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
                 };
 
-                m_meshesDescriptorSetMap[meshIndex].UpdateBindingData(data);
+                descriptorSet.UpdateBindingData(data);
             }
         }
     }
@@ -423,6 +586,12 @@ void SHLightingPass::createDescriptorSets()
 
 void SHLightingPass::destroy()
 {
+    destroyStaticCaches();
+    m_descriptorAllocator.destroy();
+
+    if (!m_bindlessDescriptorSets.empty())
+        getRendererPointer()->getGPUCulling()->releaseView(m_cullingView);
+
     for (auto& framebuffer : m_swapchain_framebuffers)
         vkDestroyFramebuffer(getRendererPointer()->getDevice(), *framebuffer, nullptr);
 
@@ -434,23 +603,23 @@ void SHLightingPass::destroy()
         }
     }
 
+    for (uint32_t frame = 0; frame < m_frameUBOs.size(); ++frame)
+    {
+        for (uint32_t i = 0; i < m_frameUBOs[frame].size(); ++i)
+            vmaDestroyBuffer(getRendererPointer()->getVmaAllocator(), m_frameUBOs[frame][i], m_frameUBOAllocations[frame][i]);
+    }
+
     // ImGui
     m_GUI->destroy();
     m_skyBox->destroy();
 
     vkDestroyDescriptorSetLayout(getRendererPointer()->getDevice(), m_descriptorSetLayouts[PipelineIndex::main_pipeline], nullptr);
-    vkDestroyPipeline(getRendererPointer()->getDevice(), m_pipelines[PipelineIndex::main_pipeline], nullptr);
+    m_variants.destroy();
+    m_prepassedVariants.destroy();
+    vkDestroyPipeline(getRendererPointer()->getDevice(), m_depthPrepassPipeline, nullptr);
     vkDestroyPipelineLayout(getRendererPointer()->getDevice(), m_pipelineLayouts[PipelineIndex::main_pipeline], nullptr);
 
     m_renderPass.destroy();
+    m_renderGraph.destroy();
 }
 
-
-
-void SHLightingPass::loadSHBRDFlut()
-{
-    std::string TextureName = "SH_BRDF_LUT.png";
-    TextureToLoadInfo info = { TextureName,"/defaultTextures",VK_FORMAT_R8G8B8A8_SRGB,4 };
-
-    getRenderResource()->m_SHBRDFlut = loadTexture(TextureName, std::string(MODEL_DIR) + info.folderName, info.format);
-}
@@ -1,5 +1,6 @@
 #pragma once
 #include "VulkanRenderer/Scene/ScenePassBase.h"
+#include "VulkanRenderer/Pipeline/ShaderVariants.h"
 
 
 class SHLightingPass : public ScenePassBase
@@ -32,9 +33,28 @@ private:
 	virtual void createUBOs() override;
 	virtual void createDescriptorSets() override;
 
-	void loadSHBRDFlut();
+	// SH lighting pass(MSAA color is transient), Hi-Z occlusion, motion vectors and TAA, upscale to the swapchain then GUI.
+	// The SH lighting pass has an optional depth prepass subpass before the shading one.
+	void createRenderGraph();
 
-	std::shared_ptr<SkyBox>					m_skyBox;
-	//GUI
-	std::unique_ptr<GUI>					m_GUI;
+	// Materials without a normal map use the variant that skips normal mapping,
+	// in the set matching the depth prepass setting.
+	virtual VkPipeline getMeshPipeline(const uint32_t meshIndex, const VkPipeline& pipeline) override;
+
+	// Bindless: scene UBO and SH coefficients, per frame.
+	std::vector<std::vector<VkBuffer>>		m_frameUBOs;
+	std::vector<std::vector<VmaAllocation>>	m_frameUBOAllocations;
+
+	// Main pipeline, per variant(key of the pass plus hasNormalMap).
+	PipelineVariants						m_variants;
+	ShaderVariantKey						m_variantKey;
+
+	// Depth prepass(subpass 0) and the main pipeline variants testing against it(EQUAL).
+	VkPipeline								m_depthPrepassPipeline;
+	PipelineVariants						m_prepassedVariants;
+
+	RenderGraph::Resource					m_colorResource;
+	RenderGraph::Resource					m_depthResource;
+	// Resolved color, in the top left render extent.
+	RenderGraph::Resource					m_sceneColorResource;
 };
\ No newline at end of file
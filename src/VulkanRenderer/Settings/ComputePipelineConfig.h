@@ -16,4 +16,68 @@ namespace COMPUTE_PIPELINE
 			{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)}
 		};
 	};
+
+	namespace CULLING
+	{
+		inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+			{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)}
+		};
+
+		inline const uint32_t WORKGROUP_SIZE = 64;
+	};
+
+	namespace LIGHT_CLUSTERING
+	{
+		// Also set 1 of the passes shading with the clusters.
+		inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+			{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
+			{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
+			{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)}
+		};
+
+		inline const uint32_t WORKGROUP_SIZE = 64;
+	};
+
+	// One level of the Hi-Z pyramid from the previous one(or the depth buffer).
+	namespace HIZ_BUILD
+	{
+		inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+			{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)}
+		};
+
+		// Square workgroups(8x8 texels).
+		inline const uint32_t WORKGROUP_SIZE = 8;
+	};
+
+	namespace HIZ_CULLING
+	{
+		inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+			{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)}
+		};
+
+		inline const uint32_t WORKGROUP_SIZE = 64;
+	};
+
+	// Scene color, velocity, depth and history into the new history.
+	namespace TEMPORAL_AA
+	{
+		inline const std::vector<DescriptorInfo> BUFFERS_INFO = {
+			{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)},
+			{4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, (VkShaderStageFlagBits)(VK_SHADER_STAGE_COMPUTE_BIT)}
+		};
+
+		// Square workgroups(8x8 texels).
+		inline const uint32_t WORKGROUP_SIZE = 8;
+	};
 };
\ No newline at end of file
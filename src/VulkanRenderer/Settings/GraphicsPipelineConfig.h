@@ -13,7 +13,7 @@ namespace GRAPHICS_PIPELINE
     {
         inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
             {0,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
-            {1,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            // Lights: set 1(COMPUTE_PIPELINE::LIGHT_CLUSTERING)
 
             {2,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {3,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
@@ -28,7 +28,37 @@ namespace GRAPHICS_PIPELINE
             // Prefiltered env. map (IMPORTANT: Always leave it positioned before the shadowMap)
             {9,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             // Shadow Map (IMPORTANT: Always leave it as the last sampler)
-            {10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
+            {10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            // Shadow cascades
+            {11,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            // Shadow atlas and its tiles
+            {12,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {13,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
+        };
+    };
+
+    // Set 0 of the bindless forward pipeline, material textures are in set 1(BindlessMaterials),
+    // lights in set 2.
+    namespace PBR_BINDLESS
+    {
+        inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
+            {0,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
+
+            // Objects
+            {3,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT)},
+            // Materials
+            {4,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+
+            // IBL
+            {7,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {8,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {9,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+
+            // Shadow cascades, shadow atlas and its tiles
+            {10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {11,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {12,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {13,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
         };
     };
 
@@ -77,6 +107,31 @@ namespace GRAPHICS_PIPELINE
         inline const uint32_t SAMPLERS_COUNT = 0;
     };
 
+    namespace SHADOWMAP_INDIRECT
+    {
+        inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
+            { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT) },
+            { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT) }
+        };
+    };
+
+    //////////////////////////Cascaded ShadowMap////////////////////////////////
+    // Same layout for set 0(per mesh model matrix) and set 1(per cascade light space).
+    namespace CASCADED_SHADOWMAP
+    {
+        inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
+            { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT) }
+        };
+    };
+
+    // Motion vectors(TemporalAA): jittered, current and previous view-projections.
+    namespace VELOCITY
+    {
+        inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
+            { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT) }
+        };
+    };
+
     //////////////////////////Prefiltered_Irradiance///////////////////////////////
     namespace PREFILTER_IRRADIANCE
     {
@@ -114,29 +169,43 @@ namespace GRAPHICS_PIPELINE
         };
     };
 
+    // Set 0 of the bindless G-Buffer pipeline, material textures are in set 1(BindlessMaterials).
+    namespace DEFERRED_OFF_BINDLESS
+    {
+        inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
+            {0,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
+
+            // Objects
+            {1,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT)},
+            // Materials
+            {2,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
+        };
+    };
+
     namespace DEFERRED_ON
     {
         inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
             //Normal Infos
             {0,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
-            // Lights infos
-            {1,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            // Lights: set 1(COMPUTE_PIPELINE::LIGHT_CLUSTERING)
 
-            // Attachment 
+            // Attachment: albedo, normal, material, emissive, depth
             {2,VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {3,VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {4,VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {5,VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {6,VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
-            {7,VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
 
             //IBL
+            {7,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {8,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             {9,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
-            {10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
             
             //Shadow
-            {11,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
+            {10,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {11,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {12,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {13,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
 
         };
     }
@@ -158,6 +227,23 @@ namespace GRAPHICS_PIPELINE
         };
     };
 
+    // Set 0 of the bindless SH pipeline, material textures are in set 1(BindlessMaterials).
+    namespace SH_LIGHTING_BINDLESS
+    {
+        inline const std::vector<DescriptorInfo> DESCRIPTORS_INFO = {
+            {0,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)},
+            {1,VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+
+            // SH_BRDF
+            {2,VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)},
+
+            // Objects
+            {3,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_VERTEX_BIT)},
+            // Materials
+            {4,VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,(VkShaderStageFlagBits)(VK_SHADER_STAGE_FRAGMENT_BIT)}
+        };
+    };
+
 };
 
 
@@ -12,8 +12,25 @@ namespace Config
 
 	inline const char* WINDOW_TITLE = "Hello Vulkan";
 
+	// Startup present mode(FIFO when unsupported), it can be changed at runtime.
+	// MAILBOX/IMMEDIATE lower the input latency, IMMEDIATE and FIFO_RELAXED may tear.
+	inline const VkPresentModeKHR PRESENT_MODE = VK_PRESENT_MODE_MAILBOX_KHR;
+
 	// Graphic's settings
-	inline const int MAX_FRAMES_IN_FLIGHT = 2;
+	// Per frame resources are created for MAX_FRAMES_IN_FLIGHT slots, the renderer
+	// uses the first FRAMES_IN_FLIGHT of them(1 to MAX, GUI, --frames-in-flight).
+	// Fewer frames in flight lower the input latency, more hide CPU/GPU stalls.
+	inline const int MAX_FRAMES_IN_FLIGHT = 4;
+	inline const int FRAMES_IN_FLIGHT = 2;
+	// Latency meter(Benchmark/LatencyMeter.h): frames its percentiles are taken over.
+	inline const uint32_t LATENCY_HISTORY_FRAMES = 512;
+	// GPU profiler(Benchmark/GPUProfiler.h): timestamp scopes per frame at most,
+	// and frames kept for the graphs and the exports.
+	inline const uint32_t GPU_PROFILER_MAX_SCOPES = 64;
+	inline const uint32_t GPU_PROFILER_HISTORY_FRAMES = 240;
+	// Dumps the render graph(stdout and RENDER_GRAPH_DOT_FILE) every time a scene
+	// compiles it, otherwise only from the GUI.
+	inline const bool RENDER_GRAPH_DUMP_ON_COMPILE = false;
 
 	//Camera settings
 	inline const float FOV = 60.0f;
@@ -24,9 +41,64 @@ namespace Config
 	//LIGHT Camera settings
 	inline const float Z_NEAR_SHADOW = 1.0f;
 	inline const float Z_FAR_SHADOW = 100.0f;
+	// PCF kernel: (2 * range + 1)^2 taps.
+	inline const uint32_t PCF_RANGE = 1;
+	// Cascaded shadow map(Features/CascadedShadowMap.h), the count must match
+	// cascadedShadows.glsl(at most 4). Lambda blends the logarithmic(1) and uniform(0) splits.
+	inline const uint32_t SHADOW_CASCADE_COUNT = 4;
+	inline const uint32_t SHADOW_CASCADE_RESOLUTION = 2048;
+	inline const float SHADOW_CASCADE_LAMBDA = 0.8f;
+	// Past it(view depth) nothing is shadowed.
+	inline const float SHADOW_DISTANCE = 60.0f;
+	// Frames a caster must stay still before its depth is cached with the static casters.
+	inline const uint32_t SHADOW_STATIC_FRAMES = 30;
+	// Shadow atlas of the point and spot lights(Features/ShadowAtlas.h): tiles are
+	// powers of two between the min and max size, point lights take 6 of them.
+	inline const uint32_t SHADOW_ATLAS_RESOLUTION = 4096;
+	inline const uint32_t SHADOW_ATLAS_MIN_TILE = 128;
+	inline const uint32_t SHADOW_ATLAS_MAX_TILE = 1024;
+	// Tiles rendered per frame at most.
+	inline const uint32_t SHADOW_ATLAS_MAX_TILES = 64;
+
+	// Clustered lighting(Culling/ClusteredLights.h): screen tiles times
+	// exponential depth slices between the camera near and far.
+	inline const uint32_t CLUSTER_GRID_X = 16;
+	inline const uint32_t CLUSTER_GRID_Y = 9;
+	inline const uint32_t CLUSTER_GRID_Z = 24;
+	inline const uint32_t MAX_LIGHTS = 4096;
+	// Lights past it are dropped from the cluster.
+	inline const uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+	// Extra point lights scattered over the scene, to stress the clustered path.
+	inline const uint32_t STRESS_TEST_LIGHTS = 0;
+
+	// Occlusion culling(Culling/OcclusionCulling.h): width of the software
+	// rasterized depth buffer, its height keeps the screen's aspect(powers of two).
+	inline const uint32_t SOFTWARE_OCCLUSION_WIDTH = 256;
+
+	// Dynamic resolution(Features/DynamicResolution.h): GPU time of the frame the
+	// render scale is driven to, in milliseconds. The scale, applied to both axes,
+	// moves by steps so the recorded draws aren't invalidated every frame.
+	inline const float DYNAMIC_RESOLUTION_TARGET_MS = 16.0f;
+	inline const float DYNAMIC_RESOLUTION_MIN_SCALE = 0.5f;
+	inline const float DYNAMIC_RESOLUTION_STEP = 0.05f;
+	// PID gains, on the error relative to the target.
+	inline const float DYNAMIC_RESOLUTION_KP = 0.05f;
+	inline const float DYNAMIC_RESOLUTION_KI = 0.02f;
+	inline const float DYNAMIC_RESOLUTION_KD = 0.01f;
 
-	// Scene
-	inline const uint32_t LIGHTS_COUNT = 10;
+	// Temporal anti-aliasing(Features/TemporalAA.h): length of the Halton(2, 3)
+	// jitter sequence, weight of the current frame in the history and how far
+	// from the neighbourhood's mean(in standard deviations) the history may be.
+	inline const uint32_t TAA_JITTER_SAMPLES = 8;
+	inline const float TAA_BLEND = 0.1f;
+	inline const float TAA_CLAMP_GAMMA = 1.25f;
+
+	// Light attenuation, the shaders get it with the clusters' params(ClusterParams).
+	inline const float LIGHT_ATTENUATION_CONSTANT = 1.0f;
+	inline const float LIGHT_ATTENUATION_LINEAR = 0.09f;
+	inline const float LIGHT_ATTENUATION_QUADRATIC = 0.032f;
+	// Radiance below which a light no longer influences a surface.
+	inline const float LIGHT_INFLUENCE_CUTOFF = 0.05f;
 
 	// BRDF
 	inline const uint32_t BRDF_WIDTH = 256;
@@ -42,4 +114,16 @@ namespace Config
 
 	//SH
 	inline const uint32_t SH_COEF_NUM = 25;
+
+	// Bindless material textures(clamped to the device limits).
+	inline const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+	inline const uint32_t MAX_BINDLESS_SAMPLERS = 64;
+
+	// MSAA samples counts offered at runtime(GUI, --msaa), the ones the device
+	// doesn't support are skipped. The scenes start with the highest.
+	inline const std::vector<VkSampleCountFlagBits> MSAA_SAMPLES_COUNTS = { VK_SAMPLE_COUNT_1_BIT, VK_SAMPLE_COUNT_2_BIT, VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_8_BIT };
+
+	// Benchmark mode(--benchmark): frames rendered before measuring, then measured per run.
+	inline const uint32_t BENCHMARK_WARMUP_FRAMES = 100;
+	inline const uint32_t BENCHMARK_FRAMES = 1000;
 }
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include "VulkanRenderer/Features/DepthBuffer.h"
 #include "VulkanRenderer/Framebuffer/FramebufferManager.h"
 
+#include "VulkanRenderer/Settings/config.h"
+
 #include "VulkanRenderer/Renderer.h"
 
 Swapchain::Swapchain() {}
@@ -23,14 +25,43 @@ Swapchain::Swapchain(
 	const VkDevice& logicalDevice,
 	const std::shared_ptr<Window>& window,
 	const SwapchainSupportedProperties& supportedProperties )
-	: m_logicalDevice(logicalDevice)
+	: m_physicalDevice(physicalDevice), m_logicalDevice(logicalDevice), m_window(window), m_requestedPresentMode(Config::PRESENT_MODE)
+{
+	create(supportedProperties, VK_NULL_HANDLE);
+}
+
+void Swapchain::recreate(const SwapchainSupportedProperties& supportedProperties)
+{
+	for (auto& imageView : m_imageViews)
+	{
+		vkDestroyImageView(m_logicalDevice, *imageView, nullptr);
+		delete imageView;
+	}
+	m_imageViews.clear();
+
+	const VkSwapchainKHR oldSwapchain = m_swapchain;
+	create(supportedProperties, oldSwapchain);
+	vkDestroySwapchainKHR(m_logicalDevice, oldSwapchain, nullptr);
+}
+
+void Swapchain::create(const SwapchainSupportedProperties& supportedProperties, const VkSwapchainKHR& oldSwapchain)
 {
+	const VkPhysicalDevice& physicalDevice = m_physicalDevice;
+	const VkDevice& logicalDevice = m_logicalDevice;
+	const std::shared_ptr<Window>& window = m_window;
+
+	m_supportedPresentModes = supportedProperties.presentModes;
+
 	VkSurfaceFormatKHR surfaceFormat;
 	VkPresentModeKHR presentMode;
 	VkExtent2D extent;
 
 	chooseBestSettings(window, supportedProperties, surfaceFormat, presentMode, extent);
 
+	m_presentMode = presentMode;
+	// FIFO when the requested one is unsupported: the request follows, or the
+	// renderer would recreate the swapchain after every present.
+	m_requestedPresentMode = presentMode;
 	m_imageFormat = surfaceFormat.format;
 	m_extent = extent;
 	m_viewport = VkViewport{ 0.0f, 0.0f, (float)m_extent.width, (float)m_extent.height, 0.0f, 1.0f };
@@ -58,8 +89,9 @@ Swapchain::Swapchain(
 	createInfo.imageColorSpace = surfaceFormat.colorSpace;
 	createInfo.imageExtent = extent;
 	createInfo.imageArrayLayers = 1;
+	// Transfer destination of the upscale pass.
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
-		VK_IMAGE_USAGE_STORAGE_BIT; //need for copying to host
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT; //need for copying to host
 
 	QueueFamilyIndices indices;
 	indices.getIndicesOfRequiredQueueFamilies(physicalDevice,window->getSurface());
@@ -98,8 +130,7 @@ Swapchain::Swapchain(
 	// Configures the old swapchain when the actual one becomes invaled or
 	// unoptimized while the app is running(for example because the window was
 	// resized).
-	// For now we'll assume that we'll only ever create one swapchain.
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	createInfo.oldSwapchain = oldSwapchain;
 
 
 	if (vkCreateSwapchainKHR(logicalDevice,&createInfo,nullptr,&m_swapchain) != VK_SUCCESS)
@@ -146,11 +177,9 @@ void Swapchain::createAllImageViews()
 }
 
 
-const uint32_t Swapchain::getNextImageIndex(const VkSemaphore& semaphore) const
+VkResult Swapchain::acquireNextImage(const VkSemaphore& semaphore, uint32_t& imageIndex) const
 {
-	uint32_t imageIndex;
-
-	vkAcquireNextImageKHR(
+	return vkAcquireNextImageKHR(
 		m_logicalDevice,
 		m_swapchain,
 		UINT64_MAX,
@@ -160,8 +189,17 @@ const uint32_t Swapchain::getNextImageIndex(const VkSemaphore& semaphore) const
 		VK_NULL_HANDLE,
 		&imageIndex
 	);
+}
 
-	return imageIndex;
+void Swapchain::setPresentMode(const VkPresentModeKHR presentMode)
+{
+	if (isPresentModeSupported(presentMode))
+		m_requestedPresentMode = presentMode;
+}
+
+bool Swapchain::isPresentModeSupported(const VkPresentModeKHR presentMode) const
+{
+	return std::find(m_supportedPresentModes.begin(), m_supportedPresentModes.end(), presentMode) != m_supportedPresentModes.end();
 }
 
 const VkImageView& Swapchain::getImageView(const uint32_t index) const {
@@ -198,7 +236,7 @@ VkPresentModeKHR Swapchain::chooseBestPresentMode(const std::vector<VkPresentMod
 {
 	for (const auto& availablePresentMode : availablePresentModes)
 	{
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+		if (availablePresentMode == m_requestedPresentMode)
 			return availablePresentMode;
 	}
 	return VK_PRESENT_MODE_FIFO_KHR;
@@ -247,7 +285,7 @@ const VkSwapchainKHR& Swapchain::get() const
 }
 
 
-void Swapchain::presentImage(const uint32_t imageIndex,const std::vector<VkSemaphore> signalSemaphores,const VkQueue& presentQueue) 
+VkResult Swapchain::presentImage(const uint32_t imageIndex,const std::vector<VkSemaphore> signalSemaphores,const VkQueue& presentQueue) 
 {
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -266,7 +304,7 @@ void Swapchain::presentImage(const uint32_t imageIndex,const std::vector<VkSemap
 	// Optional
 	presentInfo.pResults = nullptr;
 
-	vkQueuePresentKHR(presentQueue, &presentInfo);
+	return vkQueuePresentKHR(presentQueue, &presentInfo);
 }
 
 const bool Swapchain::existsMaxNumberOfSupportedImages(const VkSurfaceCapabilitiesKHR& capabilities) const
@@ -37,11 +37,23 @@ public:
 	);
 	~Swapchain();
 
-	void presentImage(const uint32_t imageIndex, const std::vector<VkSemaphore> signalSemaphores, const VkQueue& presentQueue);
+	// Window resized or present mode changed(the GPU must be idle). The old
+	// swapchain is handed to the new one, then destroyed.
+	void recreate(const SwapchainSupportedProperties& supportedProperties);
+
+	// VK_ERROR_OUT_OF_DATE_KHR/VK_SUBOPTIMAL_KHR: the swapchain must be recreated.
+	VkResult presentImage(const uint32_t imageIndex, const std::vector<VkSemaphore> signalSemaphores, const VkQueue& presentQueue);
 
 	void destroy();
 
-	const uint32_t getNextImageIndex(const VkSemaphore& semaphore) const;
+	// VK_ERROR_OUT_OF_DATE_KHR: no image was acquired, the semaphore isn't signaled.
+	VkResult acquireNextImage(const VkSemaphore& semaphore, uint32_t& imageIndex) const;
+
+	// Used from the next recreate(), unsupported modes are ignored.
+	void setPresentMode(const VkPresentModeKHR presentMode);
+	bool isPresentModeSupported(const VkPresentModeKHR presentMode) const;
+	const VkPresentModeKHR& getPresentMode() const				{ return m_presentMode; }
+	const VkPresentModeKHR& getRequestedPresentMode() const		{ return m_requestedPresentMode; }
 
 	const VkExtent2D& getExtent() const;
 	const VkFormat& getImageFormat() const;
@@ -54,8 +66,11 @@ public:
 	const uint32_t getMinImageCount() const;
 
 	const VkImageView& getImageView(const uint32_t index) const;
+	const VkImage& getImage(const uint32_t index) const		{ return m_images[index]; }
 
 private:
+	void create(const SwapchainSupportedProperties& supportedProperties, const VkSwapchainKHR& oldSwapchain);
+
 	void chooseBestSettings(const std::shared_ptr<Window>& window,const SwapchainSupportedProperties& supportedProperties,
 			VkSurfaceFormatKHR& surfaceFormat,VkPresentModeKHR& presentMode,VkExtent2D& extent);
 
@@ -63,6 +78,7 @@ private:
 
 	VkSurfaceFormatKHR chooseBestSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 
+	// The requested mode, FIFO(always supported) when it isn't.
 	VkPresentModeKHR chooseBestPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 
 	VkExtent2D chooseBestExtent(const VkSurfaceCapabilitiesKHR& capabilities, const std::shared_ptr<Window>& window);
@@ -71,7 +87,9 @@ private:
 
 
 private:
+	VkPhysicalDevice           m_physicalDevice;
 	VkDevice                   m_logicalDevice;
+	std::shared_ptr<Window>    m_window;
 
 	VkSwapchainKHR             m_swapchain;
 	VkFormat                   m_imageFormat;
@@ -83,4 +101,8 @@ private:
 
 	// Used for the creation of the Imgui instance.
 	uint32_t                   m_minImageCount;
+
+	VkPresentModeKHR           m_presentMode;
+	VkPresentModeKHR           m_requestedPresentMode;
+	std::vector<VkPresentModeKHR> m_supportedPresentModes;
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "VulkanRenderer/Thread/ThreadPool.h"
+
+ThreadPool::ThreadPool(const uint32_t threadCount)
+{
+    for (uint32_t i = 0; i < threadCount; ++i)
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopping = true;
+    }
+    m_jobAvailable.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push(std::move(job));
+        m_pendingJobs++;
+    }
+    m_jobAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobsDone.wait(lock, [this]() { return m_pendingJobs == 0; });
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobAvailable.wait(lock, [this]() { return m_isStopping || !m_jobs.empty(); });
+
+            if (m_isStopping && m_jobs.empty())
+                return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingJobs--;
+        }
+        m_jobsDone.notify_all();
+    }
+}
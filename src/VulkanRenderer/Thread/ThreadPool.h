@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*
+ * Fixed set of worker threads consuming a FIFO of jobs.
+ * wait() blocks the caller until every submitted job has finished.
+ */
+class ThreadPool
+{
+public:
+    ThreadPool(const uint32_t threadCount);
+    ~ThreadPool();
+
+    void submit(std::function<void()> job);
+    void wait();
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread>            m_workers;
+    std::queue<std::function<void()>>   m_jobs;
+
+    std::mutex                          m_mutex;
+    std::condition_variable             m_jobAvailable;
+    std::condition_variable             m_jobsDone;
+
+    uint32_t                            m_pendingJobs = 0;
+    bool                                m_isStopping = false;
+};
@@ -28,7 +28,8 @@ VKinstance::VKinstance(const std::string& appName)
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // 1.2: vkGetPhysicalDeviceFeatures2 and the buffer device address features.
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     // This data is not optional and tells the Vulkan driver which global
     // extensions and validation layers we want to use.
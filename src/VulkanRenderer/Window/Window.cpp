@@ -14,7 +14,8 @@ Window::Window(
     // Since GLFW automatically creates an OpenGL context,
     // we need to not create it.
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+    // The swapchain is recreated on resizes.
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
     // ----------------------------------------------------------------
     // Paramet. #1 -> Width.
@@ -30,6 +31,14 @@ Window::Window(
         nullptr,
         nullptr
     );
+
+    glfwSetWindowUserPointer(m_window, this);
+    glfwSetFramebufferSizeCallback(m_window, framebufferResizeCallback);
+}
+
+void Window::framebufferResizeCallback(GLFWwindow* window, int width, int height)
+{
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->m_isResized = true;
 }
 
 const VkSurfaceKHR Window::getSurface() const
@@ -68,6 +77,18 @@ void Window::pollEvents()
     glfwPollEvents();
 }
 
+void Window::waitEvents()
+{
+    glfwWaitEvents();
+}
+
+bool Window::isMinimized() const
+{
+    int width, height;
+    getResolutionInPixels(width, height);
+    return width == 0 || height == 0;
+}
+
 void Window::destroySurface(const VkInstance& instance)
 {
     vkDestroySurfaceKHR(instance, m_surface, nullptr);
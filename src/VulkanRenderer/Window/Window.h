@@ -20,9 +20,16 @@ public:
 	void destroySurface(const VkInstance& instance);
 
 	bool isWindowClosed() const;
+	// Zero sized framebuffer: nothing can be presented.
+	bool isMinimized() const;
+	// The framebuffer was resized since the last resetResized().
+	bool isResized() const				{ return m_isResized; }
+	void resetResized()					{ m_isResized = false; }
 	bool isAllowedToModifyTheResolution(const VkSurfaceCapabilitiesKHR& capabilities) const;
 
 	void pollEvents();
+	// Blocks until an event arrives(while minimized).
+	void waitEvents();
 
 	GLFWwindow* get();
 
@@ -30,6 +37,9 @@ private:
 
 	// ImGui needs to access to non-const GLFWwindow.
 	friend class GUI;
+	static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+
 	GLFWwindow* m_window;
 	VkSurfaceKHR m_surface;
+	bool m_isResized = false;
 };
\ No newline at end of file
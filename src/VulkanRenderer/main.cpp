@@ -2,8 +2,12 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <sstream>
+#include <vector>
 
 #include "VulkanRenderer/Renderer.h"
+#include "VulkanRenderer/Settings/config.h"
 
 /* Commands:
 *
@@ -46,14 +50,59 @@
 *        position,
 *        size
 *     );
+*
+* Arguments:
+*
+*   - --benchmark [frames]: renders the scene with the forward, deferred and SH
+*     lighting passes in turn, with and without depth prepass(frames measured
+*     per pass, Config::BENCHMARK_FRAMES by default) and prints the frame times.
+*   - --msaa <samples>[,<samples>...]: MSAA samples counts(1, 2, 4, 8) the
+*     benchmark measures each pass with, the first one is used at startup.
+*   - --frames-in-flight <count>[,<count>...]: frames in flight(1 to
+*     Config::MAX_FRAMES_IN_FLIGHT) the benchmark measures each pass with, the
+*     first one is used at startup.
 */
 
-int main()
+int main(int argc, char** argv)
 {
     Renderer  app;
 
     try
     {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::string(argv[i]) == "--benchmark")
+            {
+                uint32_t frames = Config::BENCHMARK_FRAMES;
+                if (i + 1 < argc && *argv[i + 1] != '\0' && std::string(argv[i + 1]).find_first_not_of("0123456789") == std::string::npos)
+                    frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+
+                app.setBenchmarkFrames(frames);
+            }
+            else if (std::string(argv[i]) == "--msaa" && i + 1 < argc)
+            {
+                std::vector<VkSampleCountFlagBits> samplesCounts;
+
+                std::stringstream list(argv[++i]);
+                std::string count;
+                while (std::getline(list, count, ','))
+                    samplesCounts.push_back(static_cast<VkSampleCountFlagBits>(std::stoul(count)));
+
+                app.setMSAASamplesCounts(samplesCounts);
+            }
+            else if (std::string(argv[i]) == "--frames-in-flight" && i + 1 < argc)
+            {
+                std::vector<uint32_t> framesInFlight;
+
+                std::stringstream list(argv[++i]);
+                std::string count;
+                while (std::getline(list, count, ','))
+                    framesInFlight.push_back(static_cast<uint32_t>(std::stoul(count)));
+
+                app.setFramesInFlightCounts(framesInFlight);
+            }
+        }
+
         // SCENE 1
         //{
         //    app.addSkybox("sky.hdr", "DaySky");
@@ -0,0 +1,145 @@
+#include <cstdio>
+#include <vector>
+
+#include "VulkanRenderer/Culling/GPUCulling.h"
+
+// Checks GPUCulling::cullReference(the CPU version of cull.comp) against
+// hand-built boxes and frustums.
+
+namespace
+{
+    int failures = 0;
+
+    void check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    GPUObjectData makeObject(const glm::vec3& min, const glm::vec3& max, const uint32_t objectIndex, const bool enabled = true)
+    {
+        GPUObjectData object{};
+        object.model = glm::mat4(1.0f);
+        object.boundsMin = glm::vec4(min, enabled ? 1.0f : 0.0f);
+        object.boundsMax = glm::vec4(max, 0.0f);
+        object.firstIndex = objectIndex * 36;
+        object.indexCount = 36;
+        object.vertexOffset = static_cast<int32_t>(objectIndex * 24);
+        object.objectIndex = objectIndex;
+        return object;
+    }
+
+    // [-1, 1] cube, normals pointing inside.
+    Frustum makeUnitFrustum()
+    {
+        Frustum frustum;
+        frustum.planes = {
+            glm::vec4( 1.0f,  0.0f,  0.0f, 1.0f),
+            glm::vec4(-1.0f,  0.0f,  0.0f, 1.0f),
+            glm::vec4( 0.0f,  1.0f,  0.0f, 1.0f),
+            glm::vec4( 0.0f, -1.0f,  0.0f, 1.0f),
+            glm::vec4( 0.0f,  0.0f,  1.0f, 1.0f),
+            glm::vec4( 0.0f,  0.0f, -1.0f, 1.0f)
+        };
+        return frustum;
+    }
+
+    // Looks down -z from the origin, 90 degrees wide, near 1 and far 10.
+    Frustum makePerspectiveFrustum()
+    {
+        const float s = 0.70710678f;
+        Frustum frustum;
+        frustum.planes = {
+            glm::vec4( s,    0.0f, -s,    0.0f),
+            glm::vec4(-s,    0.0f, -s,    0.0f),
+            glm::vec4( 0.0f, s,    -s,    0.0f),
+            glm::vec4( 0.0f, -s,   -s,    0.0f),
+            glm::vec4( 0.0f, 0.0f, -1.0f, -1.0f),
+            glm::vec4( 0.0f, 0.0f,  1.0f, 10.0f)
+        };
+        return frustum;
+    }
+
+    void testUnitFrustum()
+    {
+        const std::vector<GPUObjectData> objects = {
+            makeObject(glm::vec3(-0.5f), glm::vec3(0.5f), 0),                                  // inside
+            makeObject(glm::vec3(2.0f, -0.5f, -0.5f), glm::vec3(3.0f, 0.5f, 0.5f), 1),         // outside(+x)
+            makeObject(glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(1.5f, 0.5f, 0.5f), 2),         // straddling +x
+            makeObject(glm::vec3(-0.5f), glm::vec3(0.5f), 3, false),                           // disabled
+            makeObject(glm::vec3(-3.0f, -3.0f, -3.0f), glm::vec3(3.0f, 3.0f, 3.0f), 4),        // containing the frustum
+            makeObject(glm::vec3(1.0f, -0.5f, -0.5f), glm::vec3(2.0f, 0.5f, 0.5f), 5),         // touching +x
+            makeObject(glm::vec3(-0.5f, -0.5f, -4.0f), glm::vec3(0.5f, 0.5f, -2.0f), 6)        // outside(-z)
+        };
+
+        std::vector<VkDrawIndexedIndirectCommand> commands;
+        const uint32_t drawCount = GPUCulling::cullReference(objects, makeUnitFrustum(), commands);
+
+        check(drawCount == 4, "unit frustum: draw count");
+        check(commands.size() == drawCount, "unit frustum: command count");
+        if (commands.size() != 4)
+            return;
+
+        const uint32_t expected[] = { 0, 2, 4, 5 };
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            const GPUObjectData& object = objects[expected[i]];
+            check(commands[i].firstInstance == object.objectIndex, "unit frustum: object index");
+            check(commands[i].indexCount == object.indexCount, "unit frustum: index count");
+            check(commands[i].instanceCount == 1, "unit frustum: instance count");
+            check(commands[i].firstIndex == object.firstIndex, "unit frustum: first index");
+            check(commands[i].vertexOffset == object.vertexOffset, "unit frustum: vertex offset");
+        }
+    }
+
+    void testPerspectiveFrustum()
+    {
+        const std::vector<GPUObjectData> objects = {
+            makeObject(glm::vec3(-0.5f, -0.5f, -5.0f), glm::vec3(0.5f, 0.5f, -4.0f), 0),       // inside
+            makeObject(glm::vec3(-0.5f, -0.5f, 1.0f), glm::vec3(0.5f, 0.5f, 2.0f), 1),         // behind the camera
+            makeObject(glm::vec3(-0.5f, -0.5f, -12.0f), glm::vec3(0.5f, 0.5f, -11.0f), 2),     // past the far plane
+            makeObject(glm::vec3(-0.5f, -0.5f, -10.5f), glm::vec3(0.5f, 0.5f, -9.5f), 3),      // straddling the far plane
+            makeObject(glm::vec3(6.0f, -0.5f, -5.0f), glm::vec3(7.0f, 0.5f, -4.0f), 4),        // right of the frustum
+            makeObject(glm::vec3(3.0f, -0.5f, -5.0f), glm::vec3(6.0f, 0.5f, -4.0f), 5),        // straddling the right plane
+            makeObject(glm::vec3(-0.5f, -0.5f, -5.0f), glm::vec3(0.5f, 0.5f, -4.0f), 6, false) // disabled
+        };
+
+        std::vector<VkDrawIndexedIndirectCommand> commands;
+        const uint32_t drawCount = GPUCulling::cullReference(objects, makePerspectiveFrustum(), commands);
+
+        check(drawCount == 3, "perspective frustum: draw count");
+        if (commands.size() != 3)
+            return;
+
+        check(commands[0].firstInstance == 0, "perspective frustum: inside");
+        check(commands[1].firstInstance == 3, "perspective frustum: straddling the far plane");
+        check(commands[2].firstInstance == 5, "perspective frustum: straddling a side plane");
+    }
+
+    void testEmpty()
+    {
+        std::vector<VkDrawIndexedIndirectCommand> commands(3);
+        const uint32_t drawCount = GPUCulling::cullReference({}, makeUnitFrustum(), commands);
+
+        check(drawCount == 0 && commands.empty(), "no objects: the commands are cleared");
+    }
+}
+
+int main()
+{
+    testUnitFrustum();
+    testPerspectiveFrustum();
+    testEmpty();
+
+    if (failures != 0)
+    {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("All GPU culling checks passed\n");
+    return 0;
+}